@@ -12,8 +12,9 @@
  * I chose to implement MyString memory allocations in the following manner:
  * The struct MyString composes the chars of the string: it points to a certain
  * char and we can iterate the rest of the chars using pointers since they are
- * located one after another in the heap. The chars do not include '\0' and thus
- * they are different from a regular C String. In the struct we also have
+ * located one after another in the heap. The length of the string doesn't count
+ * '\0', but we always keep a '\0' after the chars (the block has room for it), so
+ * the chars can be handed to C functions as they are. In the struct we also have
  * the length of the string, meaning the number of chars the struct wraps.
  * Every time we change the amount of chars in the struct, we update the
  * length accordingly.
@@ -25,6 +26,9 @@
  * we use the same block and avoid using new blocks of memory, saving memory.
  * When our program stops using a block of memory and moves to another one such as
  * in myStringClone, we free the old block of memory.
+ * A string may also wrap the chars of a file mapped to memory (myStringMapFile).
+ * Such chars are read only, so they are copied to a block of their own on the
+ * first change of the string.
  *
  * I used quick sort to sort the array of MyStrings,
  * memcpy and memcmp to change the string in the struct and to compare it to
@@ -35,9 +39,465 @@
  */
 
 // ------------------------------ includes ------------------------------
+// For MAP_ANONYMOUS and madvise, which c99 alone doesn't declare.
+#define _DEFAULT_SOURCE
 #include "MyString.h"
+#include "MyStringInternal.h"
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __SSE2__
+// For scanning 16 chars at a time.
+#include <emmintrin.h>
+#endif
+#ifdef __SSSE3__
+// For the shuffles of base64.
+#include <tmmintrin.h>
+#endif
+#ifdef __PCLMUL__
+// For the carry-less multiply of the quotes of CSV.
+#include <wmmintrin.h>
+#endif
+#ifndef NDEBUG
+// For lowering the limit of open files in the tests of the external sort.
+#include <sys/resource.h>
+#endif
+
+// -------------------------- const definitions -------------------------
+
+/*
+* The factor by which a string grows when it outgrows its capacity.
+*/
+#define CAPACITY_GROWTH_FACTOR 2
+
+/*
+* The maximal number of chars of a long long in decimal (19 digits and a sign).
+*/
+#define MAX_DECIMAL_LENGTH 20
+
+/*
+* The number of chars we scan at once in a word.
+*/
+#define WORD_SIZE sizeof(unsigned long long)
+
+/*
+* A word with the high bit of every char set.
+*/
+#define HIGH_BITS_MASK 0x8080808080808080ULL
+
+/*
+* A word with the low bit of every char set.
+*/
+#define LOW_BITS_MASK 0x0101010101010101ULL
+
+/*
+* The number of chars we scan at once with SSE2.
+*/
+#define SSE2_BLOCK_SIZE 16
+
+/*
+* The shift which brings the top byte of a word to the bottom.
+*/
+#define TOP_BYTE_SHIFT ((WORD_SIZE - 1) * CHAR_BIT)
+
+/*
+* The bits which mark a UTF-8 continuation char (10xxxxxx).
+*/
+#define UTF8_CONTINUATION_MASK 0xC0
+#define UTF8_CONTINUATION_BITS 0x80
+
+/*
+* The states of the UTF-8 validation automaton.
+*/
+#define UTF8_ACCEPT 0
+#define UTF8_REJECT 8
+#define UTF8_STATES 9
+#define UTF8_CLASSES 12
+
+/*
+ * The class of every char for UTF-8 validation: 0 ascii, 1-3 continuation chars
+ * (80-8F, 90-9F, A0-BF), 4 never valid, 5 lead of two, 6 E0, 7 lead of three,
+ * 8 ED, 9 F0, 10 F1-F3, 11 F4.
+ */
+static const unsigned char utf8CharClasses[UCHAR_MAX + 1] =
+{
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   // 0x00
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   // 0x10
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   // 0x20
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   // 0x30
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   // 0x40
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   // 0x50
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   // 0x60
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,   // 0x70
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,   // 0x80
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,   // 0x90
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,   // 0xA0
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,   // 0xB0
+    4, 4, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,   // 0xC0
+    5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,   // 0xD0
+    6, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 8, 7, 7,   // 0xE0
+    9, 10, 10, 10, 11, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4   // 0xF0
+};
+
+/*
+ * The transitions of the UTF-8 validation automaton by state and char class.
+ * States: 0 accept, 1-3 expecting that many continuation chars, 4 after E0
+ * (A0-BF next), 5 after ED (80-9F next), 6 after F0 (90-BF next),
+ * 7 after F4 (80-8F next), 8 reject.
+ */
+static const unsigned char utf8Transitions[UTF8_STATES][UTF8_CLASSES] =
+{
+    {0, 8, 8, 8, 8, 1, 4, 2, 5, 6, 3, 7},
+    {8, 0, 0, 0, 8, 8, 8, 8, 8, 8, 8, 8},
+    {8, 1, 1, 1, 8, 8, 8, 8, 8, 8, 8, 8},
+    {8, 2, 2, 2, 8, 8, 8, 8, 8, 8, 8, 8},
+    {8, 8, 8, 1, 8, 8, 8, 8, 8, 8, 8, 8},
+    {8, 1, 1, 8, 8, 8, 8, 8, 8, 8, 8, 8},
+    {8, 8, 2, 2, 8, 8, 8, 8, 8, 8, 8, 8},
+    {8, 2, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8},
+    {8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8}
+};
+
+/*
+* The block cache keeps freed blocks of power of two sizes, from the smallest size to
+* the biggest, for reuse by the same thread.
+*/
+#define BLOCK_CACHE_MIN_SHIFT 4
+#define BLOCK_CACHE_CLASSES 9
+#define BLOCK_CACHE_MIN_SIZE (1UL << BLOCK_CACHE_MIN_SHIFT)
+#define BLOCK_CACHE_MAX_SIZE (BLOCK_CACHE_MIN_SIZE << (BLOCK_CACHE_CLASSES - 1))
+
+/*
+* The maximal number of free blocks the block cache keeps of every size.
+*/
+#define BLOCK_CACHE_DEPTH 64
+
+/*
+* Storage for every thread of its own (c99 only has the GNU keyword).
+*/
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define THREAD_LOCAL _Thread_local
+#else
+#define THREAD_LOCAL __thread
+#endif
+
+#ifdef MYSTRING_STATS
+/*
+* Change the library-wide counters, which all the threads share.
+*/
+#define STATS_ADD(counter, n) __atomic_fetch_add(&(counter), (unsigned long) (n), __ATOMIC_RELAXED)
+#define STATS_SUB(counter, n) __atomic_fetch_sub(&(counter), (unsigned long) (n), __ATOMIC_RELAXED)
+#define STATS_LOAD(counter) __atomic_load_n(&(counter), __ATOMIC_RELAXED)
+#define STATS_BYTES(n) addLiveBytes((long) (n))
+#define STATS_ALLOCATION(isReallocation) countAllocation(isReallocation)
+#define STATS_CHARS_BLOCK(str, sign) countCharsBlock(str, sign)
+/*
+* Count the allocations between STATS_ENTER and STATS_LEAVE by site, unless an outer
+* function already counts them by its own site.
+*/
+#define STATS_ENTER(site) MyStringSite outerStatsSite = enterStatsSite(site)
+#define STATS_LEAVE() (currentStatsSite = outerStatsSite)
+#else
+#define STATS_ADD(counter, n)
+#define STATS_SUB(counter, n)
+#define STATS_BYTES(n)
+#define STATS_ALLOCATION(isReallocation)
+#define STATS_CHARS_BLOCK(str, sign)
+#define STATS_ENTER(site)
+#define STATS_LEAVE()
+#endif
 
+/*
+* The defaults of myStringExternalSort: the bytes of strings sorted in memory at once,
+* and the size of the buffer of every file it reads or writes.
+*/
+#define EXTERNAL_SORT_DEFAULT_BUDGET (64UL << 20)
+#define EXTERNAL_SORT_DEFAULT_BUFFER (1UL << 20)
+
+/*
+* The bytes of the length before a length-prefixed string, and of its count in the
+* count mode, and the longest length the prefix can tell.
+*/
+#define RECORD_LENGTH_SIZE 4
+#define RECORD_COUNT_SIZE 8
+#define RECORD_MAX_LENGTH 0xFFFFFFFFUL
+
+/*
+* The chars which end a line, and which separate a count from its line.
+*/
+#define RECORD_LINE_END '\n'
+#define RECORD_COUNT_SEPARATOR '\t'
+
+/*
+* The name of the temporary files of the runs, under the directory of the options.
+*/
+#define RUN_FILE_TEMPLATE "/myStringSortXXXXXX"
+
+/*
+* The minimal number of runs merged at once.
+*/
+#define MIN_MERGE_FAN_IN 2
+
+/*
+* The number of records the array of a run starts with.
+*/
+#define RUN_INITIAL_RECORDS 64
+
+/*
+* The number of pattern chars matched at once by the bit-parallel edit distance, and
+* the bit of the last of them.
+*/
+#define EDIT_WORD_BITS (sizeof(unsigned long long) * CHAR_BIT)
+#define EDIT_WORD_HIGH_BIT (1ULL << (EDIT_WORD_BITS - 1))
+
+/*
+* The number of masks of every word of an edit pattern, one for every char value.
+*/
+#define EDIT_MASKS (UCHAR_MAX + 1)
+
+/*
+* The digits of hex, and the number of digits of a byte.
+*/
+#define HEX_DIGITS "0123456789abcdef"
+#define HEX_CHARS_PER_BYTE 2
+#define NIBBLE_BITS 4
+#define NIBBLE_MASK 0x0F
+#define HEX_INVALID 0xFF
+
+/*
+* The mask of _mm_movemask_epi8 when all 16 lanes are set.
+*/
+#define SSE2_ALL_LANES 0xFFFF
+
+/*
+* Base64 turns every group of 3 bytes to 4 chars of 6 bits each, and pads the last
+* group with '='.
+*/
+#define BASE64_ALPHABET "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"
+#define BASE64_GROUP_BYTES 3
+#define BASE64_GROUP_CHARS 4
+#define BASE64_CHAR_BITS 6
+#define BASE64_CHAR_MASK 0x3F
+#define BASE64_PADDING '='
+#define BASE64_INVALID 0xFF
+
+/*
+* The number of base64 groups a vector block handles. A block is 16 bytes, of which
+* the groups use 12, so that many more groups must follow it for its spare bytes.
+*/
+#define BASE64_BLOCK_GROUPS 4
+#define BASE64_BLOCK_SPARE_GROUPS 2
+/*
+* The symbols of a symbol table: at most 255 of up to 8 chars, since the code 255
+* marks a char which is not in a symbol, written after it.
+*/
+#define SYMBOL_MAX_LENGTH 8
+#define SYMBOL_MAX_COUNT 255
+#define SYMBOL_ESCAPE 255
+
+/*
+* The number of codes counted while training: the symbols, and then every escaped char.
+*/
+#define SYMBOL_TRAIN_CODES (SYMBOL_MAX_COUNT + UCHAR_MAX + 1)
+
+/*
+* Training builds the table again this many times, every time from the symbols and
+* the pairs of symbols of the last one, so the symbols may double their length.
+*/
+#define SYMBOL_TRAIN_ROUNDS 5
+
+/*
+* The number of chars of the sample the table is trained on.
+*/
+#define SYMBOL_TRAIN_SAMPLE_CHARS (1UL << 14)
+
+/*
+* The number of compressed chars a string is compressed into before they are appended.
+*/
+#define SYMBOL_CODES_BUFFER 512
+/*
+* The hash of the library, which mixes in 8 chars at a time by multiplies and
+* rotations, as the tail of xxHash64 does, and then avalanches the bits.
+*/
+#define HASH_PRIME1 0x9E3779B185EBCA87ULL
+#define HASH_PRIME2 0xC2B2AE3D27D4EB4FULL
+#define HASH_PRIME3 0x165667B19E3779F9ULL
+#define HASH_PRIME4 0x85EBCA77C2B2AE63ULL
+#define HASH_PRIME5 0x27D4EB2F165667C5ULL
+#define HASH_WORD_ROTATION 31
+#define HASH_MIX_ROTATION 27
+
+/*
+* A Bloom filter block is a cache line. The first bit of a key in its block is taken
+* from the low bits of its hash, and the step between its bits from the bits above.
+*/
+#define BLOOM_BLOCK_BYTES 64
+#define BLOOM_BLOCK_WORDS (BLOOM_BLOCK_BYTES / sizeof(unsigned long long))
+#define BLOOM_WORD_BITS (sizeof(unsigned long long) * CHAR_BIT)
+#define BLOOM_BIT_INDEX_BITS 9
+#define BLOOM_BLOCK_BITS (1U << BLOOM_BIT_INDEX_BITS)
+
+/*
+* The blocks are picked by the high 32 bits of a hash, so there are at most 2^32.
+*/
+#define BLOOM_MAX_BLOCKS (1ULL << 32)
+#define HASH_HIGH_BITS 32
+
+/*
+* The number of bits a key sets, about ln(2) of the bits per key.
+*/
+#define BLOOM_MIN_PROBES 1U
+#define BLOOM_MAX_PROBES 16U
+#define BLOOM_PROBES_PER_100_BITS 69
+
+/*
+* A cuckoo bucket has 4 slots of 16 bit fingerprints, and the buckets are filled up to
+* 95% before a filter is sized up.
+*/
+#define CUCKOO_BUCKET_SLOTS 4
+#define CUCKOO_MAX_LOAD_PERCENT 95
+#define PERCENT 100
+#define CUCKOO_EMPTY_SLOT 0
+#define CUCKOO_FINGERPRINT_SHIFT 48
+#define CUCKOO_FINGERPRINT_BYTES 2
+
+/*
+* The number of fingerprints an insertion kicks to their other bucket before the
+* filter is full, and the seed of the generator which picks them.
+*/
+#define CUCKOO_MAX_KICKS 500
+#define CUCKOO_RANDOM_SEED 88172645463325252ULL
+
+/*
+* Filters are written after a magic of 8 chars, with all their numbers little endian.
+*/
+#define BLOOM_MAGIC "MSBLOOM1"
+#define CUCKOO_MAGIC "MSCUCKO1"
+#define FILTER_MAGIC_LENGTH 8
+#define FILTER_NUMBER_BYTES 8
+
+/*
+* The number of keys a batch hashes and prefetches before it touches their lines.
+*/
+#define FILTER_BATCH_KEYS 16
+
+
+/*
+* Prefetches the cache line of an address, where the compiler can.
+*/
+#ifdef __GNUC__
+#define PREFETCH(address) __builtin_prefetch(address)
+#else
+#define PREFETCH(address) ((void) (address))
+#endif
 
+/*
+* A matcher is a table of the next state for every state and char, whose first state
+* is the one nothing was matched in.
+*/
+#define MATCHER_ALPHABET (UCHAR_MAX + 1)
+#define MATCHER_ROOT 0
+#define MATCHER_NO_STATE UINT_MAX
+#define MATCHER_NO_NEEDLE ULONG_MAX
+
+/*
+* Top-K selection keeps a heap of the K smallest strings when K is at most
+* 1/TOPK_HEAP_RATIO of them, and partitions them otherwise. Ranges of at most
+* SELECT_INSERTION_SIZE strings are sorted by insertion.
+*/
+#define TOPK_HEAP_RATIO 16
+#define SELECT_INSERTION_SIZE 16
+
+/*
+* The hash table of myStringCountDistinct has at least DISTINCT_TABLE_RATIO slots for
+* every string, and a slot holds the index of a distinct string plus 1, 0 if it's empty.
+*/
+#define DISTINCT_TABLE_RATIO 2
+#define DISTINCT_EMPTY_SLOT 0
+
+/*
+* The special chars of globs. A glob is run as a bit parallel NFA with a bit for every
+* state, and bit vectors of up to GLOB_STACK_WORDS words are kept on the stack.
+*/
+#define GLOB_STAR '*'
+#define GLOB_ANY '?'
+#define GLOB_CLASS_START '['
+#define GLOB_CLASS_END ']'
+#define GLOB_CLASS_RANGE '-'
+#define GLOB_CLASS_NOT '!'
+#define GLOB_CLASS_CARET '^'
+#define GLOB_ESCAPE '\\'
+#define GLOB_SEPARATOR '/'
+#define GLOB_CHARS (UCHAR_MAX + 1)
+#define GLOB_WORD_BITS (sizeof(unsigned long long) * CHAR_BIT)
+#define GLOB_STACK_WORDS 256
+
+/*
+* Content defined chunks are cut by a Gear hash, which shifts in a random word of every
+* byte, so it sees the last 64 bytes. A chunk is cut where the masked high bits of the
+* hash are all 0: before the average size by a mask of CDC_NORMALIZATION more bits than
+* log2 of it and after it by one of that many less, which keeps the sizes close to it.
+*/
+#define GEAR_TABLE_SIZE (UCHAR_MAX + 1)
+#define GEAR_HASH_BITS (sizeof(unsigned long long) * CHAR_BIT)
+#define CDC_NORMALIZATION 2
+
+/*
+* Winnowing keeps the smallest hash of every window of k-grams, which are hashed by a
+* rolling polynomial hash. The hashes of a window are kept on the stack.
+*/
+#define WINNOW_MAX_WINDOW 256
+#define WINNOW_BASE HASH_PRIME1
+#define WINNOW_NO_MINIMUM ULONG_MAX
+
+/*
+* The '\n' of lines are counted 16 chars at a time in byte lanes, which are summed up
+* before they overflow, and the sums of the two halves of the lanes are added.
+*/
+#define LINE_COUNT_MAX_BLOCKS UCHAR_MAX
+#define SSE2_HALF_SIZE (SSE2_BLOCK_SIZE / 2)
+
+/*
+* Delimited text is scanned CSV_BLOCK_SIZE bytes at a time, into a bit of a mask for
+* every byte. The block at the end of the text is padded with CSV_PADDING.
+*/
+#define CSV_BLOCK_SIZE 64
+#define CSV_PADDING '\0'
+#define CSV_QUOTE '"'
+#define CSV_CARRIAGE_RETURN '\r'
+
+/*
+ * The value of every char in base64, BASE64_INVALID for chars which aren't base64.
+ */
+static const unsigned char base64Values[UCHAR_MAX + 1] =
+{
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,   // 0x00
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,   // 0x10
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,  62, 255, 255, 255,  63,   // 0x20
+     52,  53,  54,  55,  56,  57,  58,  59,  60,  61, 255, 255, 255, 255, 255, 255,   // 0x30
+    255,   0,   1,   2,   3,   4,   5,   6,   7,   8,   9,  10,  11,  12,  13,  14,   // 0x40
+     15,  16,  17,  18,  19,  20,  21,  22,  23,  24,  25, 255, 255, 255, 255, 255,   // 0x50
+    255,  26,  27,  28,  29,  30,  31,  32,  33,  34,  35,  36,  37,  38,  39,  40,   // 0x60
+     41,  42,  43,  44,  45,  46,  47,  48,  49,  50,  51, 255, 255, 255, 255, 255,   // 0x70
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,   // 0x80
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,   // 0x90
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,   // 0xA0
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,   // 0xB0
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,   // 0xC0
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,   // 0xD0
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,   // 0xE0
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255    // 0xF0
+};
+
+
+/*
+ * The chars of strings which have no block of their own (their capacity is 0), for
+ * example after their block was moved to another string. It is never written to.
+ */
+static char noChars[1] = {END_OF_C_STRING};
 
 // ------------------------------ structures -----------------------------
 
@@ -45,22 +505,462 @@ typedef struct _MyString
 {
     char *_chars;
     unsigned long _length;
+    // The number of chars allocated, at least _length.
+    unsigned long _capacity;
+    // The size of the mapping the chars were read from, 0 if they aren't mapped.
+    unsigned long _mappedSize;
 }MyString;
+
+typedef struct _MyStringCollation
+{
+    unsigned char _weights[MYSTRING_COLLATION_MAX_LEVELS][MYSTRING_COLLATION_TABLE_SIZE];
+    // Levels without ignorable chars are compared in lockstep.
+    bool _hasIgnorables[MYSTRING_COLLATION_MAX_LEVELS];
+    unsigned int _levels;
+}MyStringCollation;
+
+typedef struct _MyStringEditPattern
+{
+    // The bits of the positions of every char value in the pattern, _words words for
+    // every char value.
+    unsigned long long *_masks;
+    unsigned long _words;
+    unsigned long _length;
+}MyStringEditPattern;
+
+typedef struct _MyStringSymbolTable
+{
+    // The chars of every symbol, padded with zeros, and the mask of its length.
+    unsigned long long _symbols[SYMBOL_MAX_COUNT];
+    unsigned long long _masks[SYMBOL_MAX_COUNT];
+    unsigned char _lengths[SYMBOL_MAX_COUNT];
+    unsigned int _count;
+    // The symbols are sorted by their first char and then longest first, and those
+    // which start with c are from _starts[c] up to _starts[c + 1].
+    unsigned int _starts[UCHAR_MAX + 2];
+}MyStringSymbolTable;
+
+typedef struct _MyStringBloomFilter
+{
+    // _blocks blocks of BLOOM_BLOCK_WORDS words, aligned to a cache line.
+    unsigned long long *_words;
+    unsigned long long _blocks;
+    unsigned int _probes;
+}MyStringBloomFilter;
+
+typedef struct _MyStringCuckooFilter
+{
+    // CUCKOO_BUCKET_SLOTS fingerprints for every bucket, 0 for an empty slot.
+    unsigned short *_slots;
+    // The number of buckets, a power of 2.
+    unsigned long long _buckets;
+    unsigned long long _count;
+    unsigned long long _random;
+    // A fingerprint which was kicked out and found no slot, kept aside. The filter is
+    // full while it has one.
+    unsigned short _victim;
+    unsigned long long _victimBucket;
+}MyStringCuckooFilter;
+
+typedef struct _MyStringMatcher
+{
+    // MATCHER_ALPHABET next states for every state.
+    unsigned int *_transitions;
+    // The length of the longest needle prefix every state matched.
+    unsigned long *_depths;
+    // The longest needle every state ends with, or MATCHER_NO_NEEDLE.
+    unsigned long *_outputs;
+    unsigned long *_needleLengths;
+    unsigned long _needles;
+}MyStringMatcher;
+
+/*
+ * A pattern of a glob: its states, and the literal chars it starts with.
+ */
+typedef struct _GlobPattern
+{
+    // The index of the pattern as it was given.
+    unsigned long _index;
+    // The first state, from which the states of its tokens follow.
+    unsigned long _start;
+    unsigned long _accept;
+    const char *_prefix;
+    unsigned long _prefixLength;
+}GlobPattern;
+
+typedef struct _MyStringGlob
+{
+    // For every char, the states its token moves to from the state before.
+    unsigned long long *_moves;
+    // For every char, the states of stars which match it.
+    unsigned long long *_loops;
+    // The states of stars, which may be entered without a char.
+    unsigned long long *_stars;
+    // The separators of "**/", which may be entered without a char from before the "**".
+    unsigned long long *_skips;
+    // The patterns, by the length of their literal prefix.
+    GlobPattern *_patterns;
+    char *_prefixChars;
+    unsigned long _count;
+    unsigned long _words;
+}MyStringGlob;
+
+/*
+ * The collation key of a string, computed once per string before sorting.
+ */
+typedef struct _CollationKey
+{
+    const unsigned char *_key;
+    unsigned long _length;
+    MyString *_str;
+}CollationKey;
+
+/*
+ * An integer sort key packed together with the index of its string.
+ */
+typedef struct _SortKeyPair
+{
+    unsigned long long _key;
+    unsigned long _index;
+}SortKeyPair;
+
+/*
+ * The order strings are selected in: by a comparator, or by myStringCompare when it's
+ * NULL, with the prefix keys of the strings deciding most comparisons.
+ */
+typedef struct _SelectOrder
+{
+    MyString **_strs;
+    int (*_comparator) (const void *, const void *);
+}SelectOrder;
+
+/*
+ * A distinct string of myStringSortUnique, with its number of occurrences.
+ */
+typedef struct _UniqueEntry
+{
+    MyString *_str;
+    unsigned long _count;
+}UniqueEntry;
+
+/*
+ * The header of an array of myStringAllocArray or myStringArrayFromLines, which is
+ * followed in the same block by the pointers to the strings, the strings and the chars
+ * of the lines.
+ */
+typedef struct _MyStringArrayHeader
+{
+    // The size of the block, with the header.
+    unsigned long _size;
+    unsigned long _count;
+}MyStringArrayHeader;
+
+typedef struct _MyStringTopKStream
+{
+    // A max heap of the kept strings, by their prefix keys and their slots in _strs.
+    SortKeyPair *_heap;
+    MyString **_strs;
+    unsigned long _k;
+    unsigned long _count;
+    int (*_comparator) (const void *, const void *);
+}MyStringTopKStream;
+
+/*
+ * A free block in the block cache, linked to the next free block of its size.
+ */
+typedef struct _FreeBlock
+{
+    struct _FreeBlock *_next;
+}FreeBlock;
+
+/*
+ * The free blocks a thread keeps for reuse, by size class. The blocks are plain
+ * malloc blocks which belong to no thread, so a block may be freed by any thread,
+ * into that thread's cache, without locking.
+ */
+typedef struct _BlockCache
+{
+    FreeBlock *_heads[BLOCK_CACHE_CLASSES];
+    unsigned int _counts[BLOCK_CACHE_CLASSES];
+    // Whether the blocks will be freed when the thread exits.
+    bool _isRegistered;
+}BlockCache;
+
+/*
+ * The block cache of the current thread.
+ */
+static THREAD_LOCAL BlockCache blockCache;
+
+/*
+ * The key through which the cache of a thread is flushed when it exits.
+ */
+static pthread_key_t blockCacheKey;
+static pthread_once_t blockCacheKeyOnce = PTHREAD_ONCE_INIT;
+static bool isBlockCacheKeyCreated = false;
+
+/*
+ * The random words of the bytes for the Gear hash, and the same words shifted by one,
+ * for hashing two bytes at a time. They are filled once, by the first chunker.
+ */
+static unsigned long long gearTable[GEAR_TABLE_SIZE];
+static unsigned long long gearShiftedTable[GEAR_TABLE_SIZE];
+static pthread_once_t gearTableOnce = PTHREAD_ONCE_INIT;
+
+/*
+ * Reads the records of a file through a buffer of its own, in big sequential reads.
+ */
+typedef struct _RecordReader
+{
+    FILE *_file;
+    char *_buffer;
+    unsigned long _bufferSize;
+    // The chars of the buffer which weren't read yet are between _start and _end.
+    unsigned long _start;
+    unsigned long _end;
+    MyStringRecordFormat _format;
+    // Whether the file is a run, whose records are a count, a length and the chars.
+    bool _isRun;
+    // The offset in the file of the chars of a run which weren't read yet, and their
+    // number, as the runs share a file.
+    unsigned long _offset;
+    unsigned long _left;
+}RecordReader;
+
+/*
+ * Writes records to a file through a buffer of its own, aggregating equal strings
+ * which follow each other by the merge mode.
+ */
+typedef struct _RecordWriter
+{
+    FILE *_file;
+    char *_buffer;
+    unsigned long _bufferSize;
+    unsigned long _used;
+    MyStringRecordFormat _format;
+    MyStringMergeMode _mode;
+    bool _isRun;
+    // The last string and the number of times it was seen, while more may follow.
+    MyString *_pending;
+    unsigned long _pendingCount;
+    bool _hasFailed;
+}RecordWriter;
+
+/*
+ * A run being merged, and its smallest string which wasn't merged yet.
+ */
+typedef struct _MergeRun
+{
+    RecordReader _reader;
+    MyString *_head;
+    unsigned long _count;
+    bool _hasHead;
+}MergeRun;
+
+/*
+ * The runs of a pass of an external sort, one after another in a single temporary file,
+ * so the number of runs isn't bound by the number of files a process may open.
+ */
+typedef struct _RunFile
+{
+    FILE *_file;
+    // The offset of every run in the file, and then the end of the last one.
+    unsigned long *_offsets;
+    unsigned long _count;
+    unsigned long _capacity;
+}RunFile;
+
+/*
+ * A symbol considered while training a symbol table, and how much it would save.
+ */
+typedef struct _SymbolCandidate
+{
+    unsigned char _chars[SYMBOL_MAX_LENGTH];
+    unsigned int _length;
+    unsigned long _gain;
+}SymbolCandidate;
+
+#ifdef MYSTRING_STATS
+/*
+ * The library-wide counters. The slack is kept as the capacity of the blocks of the
+ * strings and the part of it which is used.
+ */
+static MyStringStats libraryStats;
+static unsigned long charsCapacity = 0;
+static unsigned long charsUsed = 0;
+
+/*
+ * The site the allocations of the current thread are counted by.
+ */
+static THREAD_LOCAL MyStringSite currentStatsSite = MYSTRING_SITE_OTHER;
+
+/*
+ * Where and how often the counters are dumped, and the allocations since the
+ * last dump.
+ */
+static FILE *statsDumpStream = NULL;
+static unsigned long statsDumpPeriod = 0;
+static unsigned long statsDumpCountdown = 0;
+
+/*
+ * The names of the call sites in dumps.
+ */
+static const char *statsSiteNames[MYSTRING_SITES] =
+{
+    "other", "alloc", "set", "cat", "filter", "clone"
+};
+#endif
 // ------------------------------ functions -----------------------------
 
 /**
  * @brief Change the length of the string in the heap.
- * We use realloc to reuse the same address in the heap each time we change
- * the size of the string. This way we save lots of memory.
- * @param chars the string we change the length of.
- * @param length pointer to the length we will change in the struct.
+ * We use realloc to reuse the same address in the heap each time the string
+ * outgrows its capacity, and grow it at least twice so appending is amortized O(1).
+ * The chars are kept terminated by '\0', so the capacity is always bigger than
+ * the length.
+ * @param str the string we change the length of.
  * @param newSize the new length to assign to the string.
  *
- * @return MYSTRING_ERROR if the reallocation failed,
+ * @return MYSTRING_ERROR if the reallocation failed (str is left unchanged),
+ * 			MYSTRING_SUCCESS if the reallocation succeeded.
+ */
+static MyStringRetVal adjustMyStringLength(MyString *str, unsigned long newSize);
+
+/**
+ * @brief Write the '\0' after the chars of a string.
+ * @param str the string.
+ */
+static void terminateMyString(MyString *str);
+
+/**
+ * @brief Reallocate the chars of a string to an exact capacity, which isn't
+ * smaller than the length of the string.
+ * @param str the string.
+ * @param capacity the new capacity.
+ *
+ * @return MYSTRING_ERROR if the reallocation failed (str is left unchanged),
  * 			MYSTRING_SUCCESS if the reallocation succeeded.
  */
-static MyStringRetVal adjustMyStringLength(char **chars, unsigned long *length,
-										   unsigned long newSize);
+static MyStringRetVal setMyStringCapacity(MyString *str, unsigned long capacity);
+
+/**
+ * @brief Write the decimal digits of a number backwards.
+ * @param end pointer to the char after the last digit.
+ * @param n the number.
+ * @return pointer to the first digit (the minus sign if n is negative).
+ */
+static char* writeDecimalBackwards(char *end, long long n);
+
+/**
+ * @brief Free the block of a string, if it has one, leaving it empty without a block.
+ * @param str the string.
+ */
+static void releaseMyStringChars(MyString *str);
+
+/**
+ * @brief Give a string a block of its own to write to, if it doesn't have one (its
+ * chars are mapped from a file or it has no chars at all).
+ * @param str the string.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal ownMyStringChars(MyString *str);
+
+/**
+ * @brief Allocate a block from the block cache of the thread. Blocks up to the
+ * biggest cached size are rounded up to a power of two, bigger ones are allocated
+ * as they are.
+ * @param size pointer to the size to allocate, set to the size of the block.
+ * @return the block, or NULL if the allocation failed.
+ */
+static void * allocateBlock(unsigned long *size);
+
+/**
+ * @brief Give a block back to the block cache of the thread, or free it if the cache
+ * is full or the block is too big.
+ * @param block the block, allocated by allocateBlock or malloc.
+ * @param size the size of the block, or the size it was requested with.
+ */
+static void releaseBlock(void *block, unsigned long size);
+
+/**
+ * @brief Get the size class of a block, the first whose size is big enough.
+ * @param size the size of the block, at most the biggest cached size.
+ * @return the size class.
+ */
+static unsigned int getBlockClass(unsigned long size);
+
+/**
+ * @brief Make sure the block cache of the thread is flushed when the thread exits.
+ * @return true if the cache may keep blocks, false otherwise.
+ */
+static bool registerBlockCache();
+
+/**
+ * @brief Create the key through which block caches are flushed.
+ */
+static void createBlockCacheKey();
+
+/**
+ * @brief Free all the blocks of a block cache.
+ * @param cache the cache.
+ */
+static void flushBlockCache(void *cache);
+
+/**
+ * @brief Set the length of a string and write the '\0' after its chars.
+ * @param str the string, whose block is big enough.
+ * @param length the new length.
+ */
+static void setMyStringLength(MyString *str, unsigned long length);
+
+#ifdef MYSTRING_STATS
+/**
+ * @brief Start counting the allocations of the thread by a site, unless they are
+ * already counted by another one.
+ * @param site the site.
+ * @return the site the allocations were counted by before.
+ */
+static MyStringSite enterStatsSite(MyStringSite site);
+
+/**
+ * @brief Add to the live bytes, keeping the peak.
+ * @param delta the bytes to add, negative to subtract.
+ */
+static void addLiveBytes(long delta);
+
+/**
+ * @brief Count an allocation by the current site, and dump the counters if it's time.
+ * @param isReallocation whether a block was replaced by a bigger one.
+ */
+static void countAllocation(bool isReallocation);
+
+/**
+ * @brief Count the block of a string in the slack, as it's given to the string or
+ * taken from it.
+ * @param str the string.
+ * @param sign 1 when the block is given, -1 when it's taken.
+ */
+static void countCharsBlock(const MyString *str, int sign);
+#endif
+
+/**
+ * @brief Map the chars of a file to a string, with a '\0' after them.
+ * @param str the string, which has no block.
+ * @param fd the file.
+ * @param fileSize the size of the file, bigger than 0.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal mapFileChars(MyString *str, int fd, unsigned long fileSize);
+
+/**
+ * @brief Sets dst to be the strings of parts, with sep between every two of them.
+ * @param dst
+ * @param parts
+ * @param n the number of parts.
+ * @param sep the separator, or NULL for none.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal joinMyStrings(MyString *dst, const MyString *parts[], unsigned long n,
+									const MyString *sep);
 
 /**
  * @brief Calculate the length of a cString.
@@ -76,24 +976,6 @@ static unsigned long getCStringLength(const char *str);
  * @return the number of digits.
  */
 static int getNumOfDigits(int n);
-/**
- * @brief Calculate the length of the filtered string to be created. we do this
- * in order to pre-determine the size we need for the string in the heap.
- * @param str the source string we would like to filter.
- * @param filt pointer to a function that filters in some manner.
- * @return the length of the filtered string.
- *
- */
-static unsigned long getFilteredStringLength(const char *str, bool (*filt)(const char *));
-/**
- * @brief Filter the chars of a string according to a filter and create a new string.
- * @param filteredString the new filtered string.
- * @param unfilteredString the source string we would like to filter.
- * @param filt pointer to a function that filters in some manner.
- *
- */
-static void createFilteredString(char *filteredString, const char *unfilteredString,
-								 bool (*filt)(const char *));
 /**
  * @brief Creates an empty string with length 0 in the heap.
  * @param p_myString The string we alloc.
@@ -111,948 +993,11103 @@ static char* emptyStringAlloc(MyString *p_myString);
  */
 static int myStringComparator(const void *str1, const void *str2);
 
+/**
+ * @brief Compare two arrays of chars by the weights of a single collation level.
+ * @param weights the weight table of the level.
+ * @param hasIgnorables whether some of the weights are ignorable.
+ * @param chars1
+ * @param length1
+ * @param chars2
+ * @param length2
+ * @return STR1_BIGGER, STR2_BIGGER or EQUAL_STRINGS.
+ */
+static int collationCompareLevel(const unsigned char *weights, bool hasIgnorables,
+								 const char *chars1, unsigned long length1,
+								 const char *chars2, unsigned long length2);
 
+/**
+ * @brief Calculate the length of the collation key of a string.
+ * @param str the string.
+ * @param collation the collation.
+ * @return the length of the key.
+ */
+static unsigned long getCollationKeyLength(const MyString *str,
+										   const MyStringCollation *collation);
 
-// ------------------------------ implementation -----------------------------
+/**
+ * @brief Create the collation key of a string: the weights of every level without
+ * the ignorable ones, levels separated by MYSTRING_COLLATION_IGNORABLE. Comparing
+ * two keys with memcmp gives the same order as myStringCollationCompare.
+ * @param key the key to fill, of the length getCollationKeyLength returned.
+ * @param str the string.
+ * @param collation the collation.
+ */
+static void createCollationKey(unsigned char *key, const MyString *str,
+							   const MyStringCollation *collation);
 
+/**
+ * @brief Comparator of collation keys for the qsort function.
+ * @param key1
+ * @param key2
+ * @return The value the keys comparison returned (1/0/-1).
+ */
+static int collationKeyComparator(const void *key1, const void *key2);
 
 /**
- * @brief Allocates a new MyString and sets its value to "" (the empty string).
- * 			It is the caller's responsibility to free the returned MyString.
- *
- * RETURN VALUE:
- * @return a pointer to the new string, or NULL if the allocation failed.
- *
- *
- * Complexity: O(1) since we only initialize the struct with an empty string
- * (one char).
+ * @brief Sort pairs by their keys with an LSD radix sort. The sort is stable.
+ * @param pairs the pairs to sort.
+ * @param len the number of pairs.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR if an allocation failed.
  */
-MyString * myStringAlloc()
-{
-    // Attempt to allocate memory for myString on the heap.
-    MyString *p_myString = (MyString *) malloc(sizeof(MyString));
-    if (p_myString == NULL)
-    {
-        return NULL;
-    }
-    // The struct on the heap now wraps an empty string.
-    if (emptyStringAlloc(p_myString) == NULL)
-    {
-    	return NULL;
-    }
+static MyStringRetVal radixSortKeyPairs(SortKeyPair *pairs, unsigned long len);
 
-    return p_myString;
-}
+/**
+ * @brief Get the first chars of an array of chars as an integer, so that the order
+ * of the integers is the order of the chars (shorter arrays are padded with zeros).
+ * @param chars
+ * @param length
+ * @return the prefix key.
+ */
+static unsigned long long getPrefixKey(const char *chars, unsigned long length);
 
+/**
+ * @brief Reorder arr by the indices of sorted pairs.
+ * @param arr
+ * @param pairs sorted pairs, holding every index of arr once.
+ * @param len
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR if an allocation failed.
+ */
+static MyStringRetVal applySortPermutation(MyString *arr[], const SortKeyPair *pairs,
+										   unsigned long len);
 
 /**
- * @brief Frees the memory and resources allocated to str.
- * @param str the MyString to free.
- * If str is NULL, no operation is performed.
- *
- * Complexity: O(n) since str -> _chars points to the address on the heap
- * we allocated before, and each time we realloc size of n bytes we take
- * O(n) memory space.
+ * @brief Load a word of chars from any address.
+ * @param chars
+ * @return the word.
  */
-void myStringFree(MyString *str)
-{
-	if (str == NULL)
-	{
-		return;
-	}
-    free(str -> _chars);
-    str -> _chars = NULL;
-    free(str);
-}
+static unsigned long long loadWord(const unsigned char *chars);
 
+/**
+ * @brief Count the chars of a word which have their high bit set.
+ * @param highBits a word where only the high bits of chars may be set.
+ * @return the number of set high bits.
+ */
+static unsigned int countHighBits(unsigned long long highBits);
 
 /**
- * @brief Allocates a new MyString with the same value as str. It is the caller's
- * 			responsibility to free the returned MyString.
- * @param str the MyString to clone.
- * RETURN VALUE:
- *   Complexity: O(n) since we create a new struct in the memory with size of
- *   n bytes as chars.
+ * @brief Get the length of the ascii prefix of an array of chars.
+ * @param chars
+ * @param length
+ * @return the number of chars until the first non ascii char.
  */
-MyString * myStringClone(const MyString *str)
-{
-	if (str == NULL)
-	{
-		return NULL;
-	}
-    // Indicator of the cloning success or failure.
-    MyStringRetVal retVal = MYSTRING_SUCCESS;
-    // The cloned string to be returned.
-    MyString *newMyString = myStringAlloc();
-    // Attempt to clone the string.
-    retVal = myStringSetFromMyString(newMyString, str);
-    if (retVal == MYSTRING_ERROR)
-    {
-        return NULL;
-    }
-    return newMyString;
-}
+static unsigned long getAsciiPrefixLength(const unsigned char *chars, unsigned long length);
+
+/**
+ * @brief Skip code points in UTF-8 chars.
+ * @param chars
+ * @param length
+ * @param from the index of the lead char to start from.
+ * @param count pointer to the number of code points to skip, we decrease it by the
+ *  number of code points skipped.
+ * @return the index of the lead char of the code point after the skipped ones, or
+ *  length if the chars ran out before.
+ */
+static unsigned long skipCodePoints(const unsigned char *chars, unsigned long length,
+									unsigned long from, unsigned long *count);
+
 
 
 /**
- * @brief Sets the value of str to the value of other.
- * @param str the MyString to set
- * @param other the MyString to set from
- * RETURN VALUE:
- *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
- *   Complexity: O(n) since we allocate memory as the size of the other string.
+ * @brief Sort the strings of a reader in runs which fit in the memory budget, and
+ * write the runs one after another to a temporary file. If all the strings fit in a
+ * single run, they are written to out instead.
+ * @param reader the reader of the input.
+ * @param out the output.
+ * @param options the options of the sort.
+ * @param runs the runs, to add the runs to.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
  */
-MyStringRetVal myStringSetFromMyString(MyString *str, const MyString *other)
-{
-	if (str == NULL || other == NULL)
-	{
-		return MYSTRING_ERROR;
-	}
-	// Empty string set.
-	if (other -> _length == EMPTY_STRING_LENGTH)
-	{
-		if (emptyStringAlloc(str) == NULL)
-		{
-			return MYSTRING_ERROR;
-		}
-		return MYSTRING_SUCCESS;
-	}
-    // The length of the other string.
-    unsigned long otherStringLength = myStringLen(other);
-    // Change the size of the string to the size of the other string.
-    MyStringRetVal adjustLengthRetVal = adjustMyStringLength(&str -> _chars,
-    		&str -> _length, otherStringLength);
-    if (adjustLengthRetVal == MYSTRING_ERROR)
-    {
-        return MYSTRING_ERROR;
-    }
-    memcpy(str -> _chars, other -> _chars, otherStringLength);
-    return MYSTRING_SUCCESS;
-}
+static MyStringRetVal createSortedRuns(RecordReader *reader, FILE *out,
+                                       const MyStringExternalSortOptions *options,
+                                       RunFile *runs);
 
 /**
- * @brief filter the value of str acording to a filter.
- * 	remove from str all the occurrence of chars that are filtered by filt
- *	(i.e. filr(char)==true)
- * @param str the MyString to filter
- * @param filt the filter
- * RETURN VALUE:
- *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
- *
- *   Complexity: O(n) since we allocate a new block in the memory
- *   for the filtered string with a size of n bytes at most.
- *   */
-MyStringRetVal myStringFilter(MyString *str, bool (*filt)(const char *))
+ * @brief Sort the strings of a run and write them, as a new run after the others or
+ * to out.
+ * @param records the strings, which may be changed.
+ * @param n the number of strings.
+ * @param out the output, or NULL to write a new run.
+ * @param options the options of the sort.
+ * @param runs the runs, to add a new run to.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal writeSortedRun(MyString *records[], unsigned long n, FILE *out,
+                                     const MyStringExternalSortOptions *options,
+                                     RunFile *runs);
+
+/**
+ * @brief Merge all the runs to out, first merging as many of them at once as the
+ * memory budget allows to the runs of a new file, pass after pass, until all of them
+ * can be merged at once. At most two files of runs are open at once.
+ * @param runs the runs, replaced by the runs they were merged to.
+ * @param out the output.
+ * @param options the options of the sort.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal mergeAllRuns(RunFile *runs, FILE *out,
+                                   const MyStringExternalSortOptions *options);
+
+/**
+ * @brief Merge runs to a file by a loser tree, aggregating equal strings by the mode.
+ * @param runs the runs.
+ * @param first the first run to merge.
+ * @param n the number of runs to merge, at least 1.
+ * @param file the file to write to.
+ * @param options the options of the sort.
+ * @param isRun whether file is a run rather than the output.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal mergeRuns(const RunFile *runs, unsigned long first, unsigned long n,
+                                FILE *file, const MyStringExternalSortOptions *options,
+                                bool isRun);
+
+/**
+ * @brief Add a run which was written to the end of the file of the runs.
+ * @param runs the runs.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal addRunEnd(RunFile *runs);
+
+/**
+ * @brief Close the file of runs and free their offsets.
+ * @param runs the runs.
+ */
+static void closeRunFile(RunFile *runs);
+
+/**
+ * @brief Build a loser tree over the heads of runs.
+ * @param runs the runs.
+ * @param tree the n nodes of the tree, set to the loser of every match and the
+ * winner at 0.
+ * @param n the number of runs.
+ */
+static void initLoserTree(const MergeRun *runs, unsigned long *tree, unsigned long n);
+
+/**
+ * @brief Replay the matches of a run from its leaf to the root, after its head changed.
+ * Every node keeps the loser of its match and the winner goes on, so the root ends
+ * with the run of the smallest head.
+ * @param runs the runs.
+ * @param tree the nodes of the tree.
+ * @param n the number of runs.
+ * @param run the run whose head changed.
+ */
+static void replayLoserTree(const MergeRun *runs, unsigned long *tree, unsigned long n,
+                            unsigned long run);
+
+/**
+ * @brief Check if the head of a run comes before the head of another. The run n
+ * stands for one before all, and runs without a head come after all.
+ * @param runs the runs.
+ * @param n the number of runs.
+ * @param run1
+ * @param run2
+ * @return true if the head of run1 comes first.
+ */
+static bool isMergeRunBefore(const MergeRun *runs, unsigned long n, unsigned long run1,
+                             unsigned long run2);
+
+/**
+ * @brief Create a temporary file for a run, which is deleted when it's closed.
+ * @param dir the directory of the file, or NULL for that of tmpfile().
+ * @return the file, or NULL on failure.
+ */
+static FILE * createRunFile(const char *dir);
+
+/**
+ * @brief Initialize a reader of records, with a buffer of its own.
+ * @param reader the reader.
+ * @param file the file to read.
+ * @param format the format of the records.
+ * @param isRun whether the file is a run.
+ * @param bufferSize the size of the buffer.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal initRecordReader(RecordReader *reader, FILE *file,
+                                       MyStringRecordFormat format, bool isRun,
+                                       unsigned long bufferSize);
+
+/**
+ * @brief Read the next chars of the file to the buffer of a reader, if it has read all
+ * of its buffer.
+ * @param reader the reader.
+ * @return the number of chars in the buffer which weren't read yet, 0 at the end.
+ */
+static unsigned long fillRecordReader(RecordReader *reader);
+
+/**
+ * @brief Read the next record of a reader.
+ * @param reader the reader.
+ * @param record the string to set to the string of the record.
+ * @param count pointer to set to the count of the record (1 unless it's a run).
+ * @param hasRecord pointer to set to false at the end of the file, true otherwise.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal readRecord(RecordReader *reader, MyString *record,
+                                 unsigned long *count, bool *hasRecord);
+
+/**
+ * @brief Read a line, without its '\n', appending it to a string.
+ * @param reader the reader.
+ * @param record the string.
+ * @param hasRecord pointer to set to false at the end of the file, true otherwise.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal readRecordLine(RecordReader *reader, MyString *record, bool *hasRecord);
+
+/**
+ * @brief Read a little endian number.
+ * @param reader the reader.
+ * @param size the number of bytes of the number.
+ * @param number pointer to set to the number.
+ * @param hasNumber pointer to set to false at the end of the file, true otherwise.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR if the file ends in the number.
+ */
+static MyStringRetVal readRecordNumber(RecordReader *reader, int size, unsigned long *number,
+                                       bool *hasNumber);
+
+/**
+ * @brief Read chars, appending them to a string.
+ * @param reader the reader.
+ * @param record the string.
+ * @param length the number of chars.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR if the file ends before them.
+ */
+static MyStringRetVal readRecordChars(RecordReader *reader, MyString *record,
+                                      unsigned long length);
+
+/**
+ * @brief Initialize a writer of records, with a buffer of its own. The writer has to
+ * be closed by closeRecordWriter even if this fails.
+ * @param writer the writer.
+ * @param file the file to write to.
+ * @param options the options of the sort.
+ * @param isRun whether the file is a run rather than the output.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal initRecordWriter(RecordWriter *writer, FILE *file,
+                                       const MyStringExternalSortOptions *options, bool isRun);
+
+/**
+ * @brief Put a string which was read count times to a writer. Strings are put in
+ * order, so the writer aggregates equal strings by keeping the last one until a
+ * different one comes.
+ * @param writer the writer.
+ * @param record the string, which is left with any value.
+ * @param count the number of times the string was read.
+ */
+static void putRecord(RecordWriter *writer, MyString *record, unsigned long count);
+
+/**
+ * @brief Write a record in the format of the file of a writer.
+ * @param writer the writer.
+ * @param record the string.
+ * @param count the number of times the string was read.
+ */
+static void writeRecord(RecordWriter *writer, const MyString *record, unsigned long count);
+
+/**
+ * @brief Write a little endian number.
+ * @param writer the writer.
+ * @param number the number.
+ * @param size the number of bytes to write.
+ */
+static void writeRecordNumber(RecordWriter *writer, unsigned long number, int size);
+
+/**
+ * @brief Write chars through the buffer of a writer.
+ * @param writer the writer.
+ * @param chars the chars.
+ * @param n the number of chars.
+ */
+static void writeRecordChars(RecordWriter *writer, const char *chars, unsigned long n);
+
+/**
+ * @brief Write the buffer of a writer to its file.
+ * @param writer the writer.
+ */
+static void flushRecordWriter(RecordWriter *writer);
+
+/**
+ * @brief Write the last string and the buffer of a writer, and free the writer.
+ * @param writer the writer.
+ * @return MYSTRING_SUCCESS if all the writes succeeded, MYSTRING_ERROR otherwise.
+ */
+static MyStringRetVal closeRecordWriter(RecordWriter *writer);
+
+/**
+ * @brief Compute the edit distance between the chars of two strings, up to a bound.
+ * @param chars1
+ * @param length1
+ * @param chars2
+ * @param length2
+ * @param maxDistance the bound.
+ * @param distance pointer to set to the distance, or to maxDistance + 1 if it's bigger.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal computeEditDistance(const char *chars1, unsigned long length1,
+                                          const char *chars2, unsigned long length2,
+                                          unsigned long maxDistance, unsigned long *distance);
+
+/**
+ * @brief Set the bits of the chars of a pattern in its masks, which are cleared.
+ * @param pattern the pattern, with its length, words and masks set.
+ * @param chars the chars of the pattern.
+ */
+static void setEditMasks(MyStringEditPattern *pattern, const char *chars);
+
+/**
+ * @brief Compute the edit distance between a pattern and a text by the bit-parallel
+ * algorithm of Myers, in blocks of a word as extended by Hyyro. Every column of the
+ * dynamic programming matrix is kept as the vertical differences between its cells,
+ * a bit each, so a word of the pattern takes a few word operations per char.
+ * @param pattern the pattern.
+ * @param text the chars of the text.
+ * @param length the length of the text.
+ * @param maxDistance the bound.
+ * @param blocks room for 2 words for every word of the pattern.
+ * @return the distance, or maxDistance + 1 if it's bigger.
+ */
+static unsigned long runEditDistance(const MyStringEditPattern *pattern, const char *text,
+                                     unsigned long length, unsigned long maxDistance,
+                                     unsigned long long *blocks);
+
+/**
+ * @brief Advance a block of a column of the edit distance by a char of the text.
+ * @param positives the bits of the rows which are bigger by 1 than the row above.
+ * @param negatives the bits of the rows which are smaller by 1 than the row above.
+ * @param matches the bits of the rows whose pattern char is the text char.
+ * @param carry the difference between the new and the old cell above the block.
+ * @param lastBit the bit of the last row of the block.
+ * @return the difference between the new and the old cell of the last row.
+ */
+static int advanceEditBlock(unsigned long long *positives, unsigned long long *negatives,
+                            unsigned long long matches, int carry, unsigned long long lastBit);
+
+/**
+ * @brief Make room for n more chars at the end of a string, keeping a view into the
+ * string valid.
+ * @param str the string.
+ * @param view a view, moved with the chars if it's a view of str.
+ * @param n the number of chars.
+ * @param room pointer to set to the first new char.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal growMyString(MyString *str, MyStringView *view, unsigned long n,
+                                   char **room);
+
+/**
+ * @brief Write the hex of bytes.
+ * @param hex room for 2 chars for every byte.
+ * @param bytes the bytes.
+ * @param length the number of bytes.
+ */
+static void encodeHex(char *hex, const unsigned char *bytes, unsigned long length);
+
+/**
+ * @brief Write the bytes of hex, checking it as we go.
+ * @param bytes room for the bytes.
+ * @param hex the hex, 2 chars for every byte.
+ * @param length the number of bytes.
+ * @return true if the hex is valid, false otherwise.
+ */
+static bool decodeHex(unsigned char *bytes, const char *hex, unsigned long length);
+
+/**
+ * @brief Get the value of a hex digit.
+ * @param c the char.
+ * @return the value, or HEX_INVALID if c isn't a hex digit.
+ */
+static unsigned char getHexValue(char c);
+
+/**
+ * @brief Write the base64 of whole groups of bytes.
+ * @param base64 room for 4 chars for every group.
+ * @param bytes the bytes.
+ * @param groups the number of groups of 3 bytes.
+ */
+static void encodeBase64(char *base64, const unsigned char *bytes, unsigned long groups);
+
+/**
+ * @brief Write the base64 of the last bytes of a payload, padded to a whole group.
+ * @param base64 room for 4 chars.
+ * @param bytes the bytes.
+ * @param length the number of bytes, 1 or 2.
+ */
+static void encodeBase64Tail(char *base64, const unsigned char *bytes, unsigned long length);
+
+/**
+ * @brief Write the bytes of groups of base64, checking it as we go. Only the last
+ * group may be padded.
+ * @param bytes room for 3 bytes for every group.
+ * @param base64 the chars.
+ * @param groups the number of groups of 4 chars.
+ * @param length pointer to set to the number of bytes written.
+ * @return true if the base64 is valid, false otherwise (including a padded group
+ * whose bits past its last byte aren't zero).
+ */
+static bool decodeBase64(unsigned char *bytes, const char *base64, unsigned long groups,
+                         unsigned long *length);
+
+#ifdef __SSE2__
+/**
+ * @brief Turn 16 values of 4 bits to their hex digits.
+ * @param nibbles the values.
+ * @return the digits.
+ */
+static __m128i getHexBlockChars(__m128i nibbles);
+
+/**
+ * @brief Turn 16 hex digits to their values.
+ * @param chars the digits.
+ * @param values pointer to set to the values.
+ * @return true if all the chars are hex digits, false otherwise.
+ */
+static bool getHexBlockValues(__m128i chars, __m128i *values);
+#endif
+
+#ifdef __SSSE3__
+/**
+ * @brief Write the base64 of 4 groups of bytes by shuffling their bits into place and
+ * looking their chars up by shuffles.
+ * @param base64 room for 16 chars.
+ * @param bytes the bytes, of which 16 are read.
+ */
+static void encodeBase64Block(char *base64, const unsigned char *bytes);
+
+/**
+ * @brief Write the bytes of 4 groups of base64 chars, which have no padding.
+ * @param bytes room for 16 bytes, of which 12 are the groups.
+ * @param base64 the 16 chars.
+ * @return true if all the chars are base64, false otherwise.
+ */
+static bool decodeBase64Block(unsigned char *bytes, const char *base64);
+#endif
+
+/**
+ * @brief Find the longest symbol the chars start with.
+ * @param table the symbol table.
+ * @param chars the chars, at least 1.
+ * @param length the number of chars.
+ * @param symbolLength pointer to set to the length of the symbol, 1 if there's none.
+ * @return the code of the symbol, or SYMBOL_ESCAPE if there's none.
+ */
+static unsigned int findSymbol(const MyStringSymbolTable *table, const unsigned char *chars,
+                               unsigned long length, unsigned int *symbolLength);
+
+/**
+ * @brief Count the codes a symbol table compresses chars to, and the pairs of
+ * successive codes. Escaped chars are counted as codes of their own.
+ * @param table the symbol table.
+ * @param chars the chars.
+ * @param length the number of chars.
+ * @param counts the SYMBOL_TRAIN_CODES counts of the codes, and then the counts of
+ * the pairs.
+ */
+static void countSymbolCodes(const MyStringSymbolTable *table, const unsigned char *chars,
+                             unsigned long length, unsigned int *counts);
+
+/**
+ * @brief Build a symbol table again from the codes and the pairs of codes counted by
+ * the current one: every code and every concatenated pair is a candidate symbol, and
+ * those which save the most chars are kept.
+ * @param table the symbol table.
+ * @param counts the counts of countSymbolCodes.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal rebuildSymbolTable(MyStringSymbolTable *table, const unsigned int *counts);
+
+/**
+ * @brief Get the chars of a code counted by countSymbolCodes.
+ * @param table the symbol table.
+ * @param code the code.
+ * @param chars room for SYMBOL_MAX_LENGTH chars.
+ * @return the number of chars.
+ */
+static unsigned int getCodeChars(const MyStringSymbolTable *table, unsigned int code,
+                                 unsigned char *chars);
+
+/**
+ * @brief Comparator of symbol candidates by their chars.
+ */
+static int symbolCharsComparator(const void *candidate1, const void *candidate2);
+
+/**
+ * @brief Comparator of symbol candidates by their gain, biggest first.
+ */
+static int symbolGainComparator(const void *candidate1, const void *candidate2);
+
+/**
+ * @brief Comparator of symbol candidates by their first char, and then longest first.
+ */
+static int symbolOrderComparator(const void *candidate1, const void *candidate2);
+
+/**
+ * @brief Count the chars compressed chars decompress to, checking them as we go.
+ * @param table the symbol table.
+ * @param codes the compressed chars.
+ * @param length the number of compressed chars.
+ * @param decompressedLength pointer to set to the number of chars.
+ * @return true if the compressed chars are valid, false otherwise.
+ */
+static bool getDecompressedLength(const MyStringSymbolTable *table, const unsigned char *codes,
+                                  unsigned long length, unsigned long *decompressedLength);
+
+/**
+ * @brief Decompress chars, checking them as we go.
+ * @param table the symbol table.
+ * @param codes the compressed chars.
+ * @param length the number of compressed chars.
+ * @param out room for the chars.
+ * @param size the room.
+ * @param outLength pointer to set to the number of chars.
+ * @return true if the compressed chars are valid and fit, false otherwise.
+ */
+static bool decompressSymbols(const MyStringSymbolTable *table, const unsigned char *codes,
+                              unsigned long length, char *out, unsigned long size,
+                              unsigned long *outLength);
+
+/**
+ * @brief Read up to 8 chars as a little endian word.
+ * @param chars the chars.
+ * @param n the number of chars, at most WORD_SIZE.
+ * @return the word, with zeros above the chars.
+ */
+static unsigned long long readHashWord(const unsigned char *chars, unsigned long n);
+
+/**
+ * @brief Mix a word into a hash.
+ * @param hash the hash.
+ * @param word the word.
+ * @return the new hash.
+ */
+static unsigned long long mixHashWord(unsigned long long hash, unsigned long long word);
+
+/**
+ * @brief Rotate a word left.
+ * @param word the word.
+ * @param bits the number of bits, between 1 and 63.
+ * @return the rotated word.
+ */
+static unsigned long long rotateLeft(unsigned long long word, unsigned int bits);
+
+/**
+ * @brief Allocate a cleared Bloom filter.
+ * @param blocks the number of blocks, between 1 and BLOOM_MAX_BLOCKS.
+ * @param probes the number of bits of a key.
+ * @return the filter, or NULL on failure.
+ */
+static MyStringBloomFilter * allocBloomFilter(unsigned long long blocks, unsigned int probes);
+
+/**
+ * @brief Get the block of a Bloom filter a hash sets its bits in.
+ * @param filter the filter.
+ * @param hash the hash.
+ * @return the words of the block.
+ */
+static unsigned long long * getBloomBlock(const MyStringBloomFilter *filter,
+                                          unsigned long long hash);
+
+/**
+ * @brief Set the bits of a hash in a Bloom filter.
+ * @param filter the filter.
+ * @param hash the hash.
+ */
+static void addBloomHash(MyStringBloomFilter *filter, unsigned long long hash);
+
+/**
+ * @brief Check the bits of a hash in a Bloom filter.
+ * @param filter the filter.
+ * @param hash the hash.
+ * @return true if all its bits are set, false otherwise.
+ */
+static bool containsBloomHash(const MyStringBloomFilter *filter, unsigned long long hash);
+
+/**
+ * @brief Allocate an empty cuckoo filter.
+ * @param buckets the number of buckets, a power of 2.
+ * @return the filter, or NULL on failure.
+ */
+static MyStringCuckooFilter * allocCuckooFilter(unsigned long long buckets);
+
+/**
+ * @brief Get the fingerprint of a hash in a cuckoo filter, which is never an empty slot.
+ * @param hash the hash.
+ * @return the fingerprint.
+ */
+static unsigned short getCuckooFingerprint(unsigned long long hash);
+
+/**
+ * @brief Get the other bucket of a fingerprint. Either bucket is the other of the
+ * other, so a fingerprint can be moved without its hash.
+ * @param filter the filter.
+ * @param bucket a bucket of the fingerprint.
+ * @param fingerprint the fingerprint.
+ * @return the other bucket.
+ */
+static unsigned long long getCuckooOtherBucket(const MyStringCuckooFilter *filter,
+                                               unsigned long long bucket,
+                                               unsigned short fingerprint);
+
+/**
+ * @brief Put a fingerprint in an empty slot of a bucket.
+ * @param filter the filter.
+ * @param bucket the bucket.
+ * @param fingerprint the fingerprint.
+ * @return true if the bucket had an empty slot, false otherwise.
+ */
+static bool putCuckooFingerprint(MyStringCuckooFilter *filter, unsigned long long bucket,
+                                 unsigned short fingerprint);
+
+/**
+ * @brief Add a hash to a cuckoo filter.
+ * @param filter the filter.
+ * @param hash the hash.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR if the filter is full.
+ */
+static MyStringRetVal addCuckooHash(MyStringCuckooFilter *filter, unsigned long long hash);
+
+/**
+ * @brief Get the next number of the generator of a cuckoo filter.
+ * @param filter the filter.
+ * @return a pseudo random number.
+ */
+static unsigned long long nextCuckooRandom(MyStringCuckooFilter *filter);
+
+/**
+ * @brief Check if a cuckoo filter has the fingerprint of a hash in one of its buckets.
+ * @param filter the filter.
+ * @param hash the hash.
+ * @return true if it has, false otherwise.
+ */
+static bool containsCuckooHash(const MyStringCuckooFilter *filter, unsigned long long hash);
+
+/**
+ * @brief Write a little endian number to a stream.
+ * @param stream the stream.
+ * @param number the number.
+ * @param size the number of bytes.
+ * @return true on success, false otherwise.
+ */
+static bool writeFilterNumber(FILE *stream, unsigned long long number, int size);
+
+/**
+ * @brief Read a little endian number from a stream.
+ * @param stream the stream.
+ * @param size the number of bytes.
+ * @param number pointer to set to the number.
+ * @return true on success, false otherwise.
+ */
+static bool readFilterNumber(FILE *stream, int size, unsigned long long *number);
+
+/**
+ * @brief Read the magic of a filter from a stream.
+ * @param stream the stream.
+ * @param magic the expected magic.
+ * @return true if the stream starts with it, false otherwise.
+ */
+static bool readFilterMagic(FILE *stream, const char *magic);
+
+/**
+ * @brief Find the first occurrence of a needle in chars.
+ * @param chars the chars.
+ * @param length the number of chars.
+ * @param needle the needle, at least 1 char.
+ * @param needleLength the length of the needle.
+ * @return the first occurrence, or NULL if there's none.
+ */
+static const char * findChars(const char *chars, unsigned long length, const char *needle,
+                              unsigned long needleLength);
+
+/**
+ * @brief Check if a view is of chars in the block of a string.
+ * @param str the string.
+ * @param view the view.
+ * @return true if it is, false otherwise.
+ */
+static bool isViewOfMyString(const MyString *str, MyStringView view);
+
+/**
+ * @brief Start a string of new chars of a length in a block of their own, for the caller
+ * to write and then move to the string they replace.
+ * @param newChars the string to start.
+ * @param length the length.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal allocMyStringChars(MyString *newChars, unsigned long length);
+
+/**
+ * @brief Find the next occurrence of any needle of a matcher: the one which starts
+ * first, and the longest of those.
+ * @param matcher the matcher.
+ * @param chars the chars.
+ * @param length the number of chars.
+ * @param from the index to search from.
+ * @param start pointer to set to the index of the occurrence.
+ * @param needle pointer to set to the index of its needle.
+ * @return true if there is one, false otherwise.
+ */
+static bool findNextMatch(const MyStringMatcher *matcher, const unsigned char *chars,
+                          unsigned long length, unsigned long from, unsigned long *start,
+                          unsigned long *needle);
+
+/**
+ * @brief Build the transitions of a matcher which no needle has by following the
+ * failure links, breadth first, and give every state the output of its failure link
+ * if it has none.
+ * @param matcher the matcher, with the trie of its needles.
+ * @param states the number of states.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal linkMatcherStates(MyStringMatcher *matcher, unsigned long states);
+
+/**
+ * @brief Pair every string of an array with its prefix key, or 0 for a comparator.
+ * @param arr the strings.
+ * @param len the number of strings.
+ * @param order the order.
+ * @return the pairs, which the caller frees, or NULL on failure or if a string is NULL.
+ */
+static SortKeyPair * createSelectPairs(MyString *arr[], unsigned long len,
+                                       const SelectOrder *order);
+
+/**
+ * @brief Get the prefix key of a string in an order.
+ * @param order the order.
+ * @param str the string.
+ * @return the key, 0 for a comparator.
+ */
+static unsigned long long getSelectKey(const SelectOrder *order, const MyString *str);
+
+/**
+ * @brief Compare two strings with their keys in an order.
+ * @param order the order.
+ * @param key1
+ * @param str1
+ * @param key2
+ * @param str2
+ * @return negative if str1 comes first, positive if str2 does, 0 if they're equal.
+ */
+static int compareSelectKeys(const SelectOrder *order, unsigned long long key1,
+                             const MyString *str1, unsigned long long key2,
+                             const MyString *str2);
+
+/**
+ * @brief Check if the string of a pair comes before the string of another.
+ * @param order the order, whose strings the pairs index.
+ * @param pair1
+ * @param pair2
+ * @return true if it does, false otherwise.
+ */
+static bool isPairBefore(const SelectOrder *order, SortKeyPair pair1, SortKeyPair pair2);
+
+/**
+ * @brief Swap two pairs.
+ * @param pair1
+ * @param pair2
+ */
+static void swapPairs(SortKeyPair *pair1, SortKeyPair *pair2);
+
+/**
+ * @brief Move a pair of a max heap down to its place.
+ * @param order the order.
+ * @param heap the heap.
+ * @param n the number of pairs in the heap.
+ * @param i the index of the pair.
+ */
+static void siftDownPairs(const SelectOrder *order, SortKeyPair *heap, unsigned long n,
+                          unsigned long i);
+
+/**
+ * @brief Move a pair of a max heap up to its place.
+ * @param order the order.
+ * @param heap the heap.
+ * @param i the index of the pair.
+ */
+static void siftUpPairs(const SelectOrder *order, SortKeyPair *heap, unsigned long i);
+
+/**
+ * @brief Move the smallest k pairs to the start, as a max heap.
+ * @param order the order.
+ * @param pairs the pairs.
+ * @param n the number of pairs.
+ * @param k the number of pairs to keep, between 1 and n.
+ */
+static void heapSelectPairs(const SelectOrder *order, SortKeyPair *pairs, unsigned long n,
+                            unsigned long k);
+
+/**
+ * @brief Sort a max heap of pairs in ascending order.
+ * @param order the order.
+ * @param heap the heap.
+ * @param n the number of pairs.
+ */
+static void sortPairHeap(const SelectOrder *order, SortKeyPair *heap, unsigned long n);
+
+/**
+ * @brief Sort pairs by insertion.
+ * @param order the order.
+ * @param pairs the pairs.
+ * @param n the number of pairs.
+ */
+static void insertionSortPairs(const SelectOrder *order, SortKeyPair *pairs, unsigned long n);
+
+/**
+ * @brief Partition a range of pairs around the median of its first, middle and last.
+ * @param order the order.
+ * @param pairs the pairs.
+ * @param low the first index of the range.
+ * @param high the index after the range, at least low + 3.
+ * @return the index the median ends at, with no bigger pair before and no smaller after.
+ */
+static unsigned long partitionPairs(const SelectOrder *order, SortKeyPair *pairs,
+                                    unsigned long low, unsigned long high);
+
+/**
+ * @brief Put the pair which would be at an index of the sorted pairs there, by
+ * introselect.
+ * @param order the order.
+ * @param pairs the pairs.
+ * @param n the number of pairs.
+ * @param nth the index, smaller than n.
+ */
+static void introSelectPairs(const SelectOrder *order, SortKeyPair *pairs, unsigned long n,
+                             unsigned long nth);
+
+/**
+ * @brief Compare two strings whose prefix keys are equal.
+ * @param str1
+ * @param str2
+ * @return negative if str1 is smaller, positive if it's bigger, 0 if they're equal.
+ */
+static int compareAfterPrefixKey(const MyString *str1, const MyString *str2);
+
+/**
+ * @brief Sort entries of strings with equal prefix keys by merge sort, merging equal
+ * strings into the first of them as they meet.
+ * @param entries the entries, each of count 1 or more.
+ * @param n the number of entries.
+ * @param temp room for n entries.
+ * @param duplicates the array to put the merged strings in, before index *duplicateIndex.
+ * @param duplicateIndex pointer to the index, decreased for every merged string.
+ * @return the number of distinct entries, which are left sorted at the start.
+ */
+static unsigned long sortUniqueEntries(UniqueEntry *entries, unsigned long n, UniqueEntry *temp,
+                                       MyString *duplicates[], unsigned long *duplicateIndex);
+
+/**
+ * @brief Parse a glob pattern to its states, after a first state. Every token of the
+ * pattern is a state, and adjacent stars are one.
+ * @param glob the glob to set the masks of, or NULL to only count the states.
+ * @param pattern the pattern.
+ * @param start the first state.
+ * @param states pointer to set to the number of states, with the first.
+ * @param prefix room for the literal chars the pattern starts with, or NULL.
+ * @param prefixLength pointer to set to their number.
+ * @return true if the pattern is valid, false otherwise.
+ */
+static bool compileGlobPattern(MyStringGlob *glob, MyStringView pattern, unsigned long start,
+                               unsigned long *states, char *prefix, unsigned long *prefixLength);
+
+/**
+ * @brief Parse a class of a glob pattern.
+ * @param pattern the pattern.
+ * @param i pointer to the index of the '[', set to the index after the class.
+ * @param members set to whether every char is matched by the class.
+ * @return true if the class is closed, false otherwise.
+ */
+static bool parseGlobClass(MyStringView pattern, unsigned long *i, bool members[]);
+
+/**
+ * @brief Set the bit of a state in the masks of the chars of a token.
+ * @param glob the glob.
+ * @param masks the masks of every char.
+ * @param state the state.
+ * @param members whether every char is matched by the token.
+ */
+static void setGlobTransitions(const MyStringGlob *glob, unsigned long long *masks,
+                               unsigned long state, const bool members[]);
+
+/**
+ * @brief Set the bit of a state.
+ * @param bits the bit vector.
+ * @param state the state.
+ */
+static void setGlobBit(unsigned long long *bits, unsigned long state);
+
+/**
+ * @brief Check the bit of a state.
+ * @param bits the bit vector.
+ * @param state the state.
+ * @return true if it's set, false otherwise.
+ */
+static bool isGlobBitSet(const unsigned long long *bits, unsigned long state);
+
+/**
+ * @brief Enter a state of a glob, and the states which follow it without a char.
+ * @param glob the glob.
+ * @param states the states.
+ * @param state the state.
+ */
+static void enterGlobState(const MyStringGlob *glob, unsigned long long *states,
+                           unsigned long state);
+
+/**
+ * @brief Run the states of all the patterns of a glob over chars.
+ * @param glob the glob.
+ * @param str the chars.
+ * @param states room for the states.
+ * @param matches room for a result for every pattern, or NULL.
+ * @return true if any pattern matches, false otherwise.
+ */
+static bool runGlob(const MyStringGlob *glob, MyStringView str, unsigned long long *states,
+                    bool matches[]);
+
+/**
+ * @brief Comparator of glob patterns by the length of their literal prefix.
+ */
+static int globPrefixComparator(const void *pattern1, const void *pattern2);
+
+/**
+ * @brief Fill the tables of the Gear hash, by the avalanche of the hash of the library.
+ */
+static void createGearTables();
+
+/**
+ * @brief Avalanche the bits of a hash, as the end of xxHash64 does.
+ * @param hash the hash.
+ * @return the mixed hash.
+ */
+static unsigned long long avalancheHash(unsigned long long hash);
+
+/**
+ * @brief Rolls the Gear hash over chars, two at a time, until its masked bits are all 0.
+ * @param chars the chars.
+ * @param i pointer to the index of the first char to roll in, set to the index after
+ * the cut or to end.
+ * @param end the index to stop at.
+ * @param mask the mask.
+ * @param hash pointer to the hash, which is rolled.
+ * @return true if a cut was found, false otherwise.
+ */
+static bool findChunkCut(const unsigned char *chars, unsigned long *i, unsigned long end,
+                         unsigned long long mask, unsigned long long *hash);
+
+/**
+ * @brief Add a fingerprint to those found by winnowing, if there is room for it.
+ * @param fingerprints the room for the fingerprints.
+ * @param capacity its size.
+ * @param count pointer to the number of fingerprints found so far, which is incremented.
+ * @param hash the hash of the k-gram.
+ * @param offset the offset of the k-gram.
+ */
+static void addFingerprint(MyStringFingerprint fingerprints[], unsigned long capacity,
+                           unsigned long *count, unsigned long long hash, unsigned long offset);
+
+/**
+ * @brief Allocate the block of an array of n strings and point its pointers to its
+ * strings, which are left for the caller to set.
+ * @param n the number of strings.
+ * @param charsSize the number of chars to keep room for after the strings.
+ * @return the pointers, or NULL on failure.
+ */
+static MyString ** allocMyStringArray(unsigned long n, unsigned long charsSize);
+
+/**
+ * @brief Count the '\n' of chars, 16 at a time in byte lanes.
+ * @param chars the chars.
+ * @param length the number of chars.
+ * @return the number of '\n'.
+ */
+static unsigned long countLineEnds(const char *chars, unsigned long length);
+
+/**
+ * @brief Set a string of myStringArrayFromLines to a line, replacing the '\n' after it by
+ * '\0'. The string borrows the chars of the array until it's changed, as mapped strings
+ * borrow theirs, and an empty line has none.
+ * @param str the string.
+ * @param start the first char of the line.
+ * @param end the char after the line.
+ */
+static void setLineChars(MyString *str, char *start, char *end);
+
+/**
+ * @brief Compute the prefix XOR of a mask: every bit of it is the XOR of the bits of the
+ * mask up to it, so the bits from a quote to the next one are set. With PCLMUL it's a
+ * carry-less multiply by all ones.
+ * @param mask the mask.
+ * @return the prefix XOR.
+ */
+static unsigned long long prefixXorMask(unsigned long long mask);
+
+/**
+ * @brief Classify a block of CSV_BLOCK_SIZE chars into masks of its quotes, delimiters
+ * and newlines, with a bit for every char, from the lowest one.
+ * @param chars the chars.
+ * @param delimiter the delimiter.
+ * @param quotes pointer to set to the mask of the quotes.
+ * @param delimiters pointer to set to the mask of the delimiters.
+ * @param newlines pointer to set to the mask of the newlines.
+ */
+static void classifyCsvBlock(const char *chars, char delimiter, unsigned long long *quotes,
+                             unsigned long long *delimiters, unsigned long long *newlines);
+
+/**
+ * @brief Scan the next block of the data of a reader for the delimiters and newlines
+ * out of quotes. The block at the end of the data is copied and padded first.
+ * @param reader the reader.
+ */
+static void scanCsvBlock(MyStringCsvReader *reader);
+
+/**
+ * @brief Remove the quotes of the quoted fields of a row. A field whose only quotes
+ * are the opening and the closing ones stays a view of the data, and the others are
+ * unescaped into an arena.
+ * @param arena the arena, whose value is replaced.
+ * @param fields the fields.
+ * @param n the number of fields.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal unquoteCsvFields(MyString *arena, MyStringView fields[], unsigned long n);
+
+// ------------------------------ implementation -----------------------------
+
+
+/**
+ * @brief Allocates a new MyString and sets its value to "" (the empty string).
+ * 			It is the caller's responsibility to free the returned MyString.
+ *
+ * RETURN VALUE:
+ * @return a pointer to the new string, or NULL if the allocation failed.
+ *
+ *
+ * Complexity: O(1) since we only initialize the struct with an empty string
+ * (one char).
+ */
+MyString * myStringAlloc()
+{
+    STATS_ENTER(MYSTRING_SITE_ALLOC);
+    // Attempt to allocate memory for myString on the heap.
+    unsigned long structSize = sizeof(MyString);
+    MyString *p_myString = (MyString *) allocateBlock(&structSize);
+    if (p_myString != NULL)
+    {
+        STATS_ALLOCATION(false);
+        // The struct on the heap now wraps an empty string.
+        if (emptyStringAlloc(p_myString) == NULL)
+        {
+            releaseBlock(p_myString, sizeof(MyString));
+            p_myString = NULL;
+        }
+    }
+    STATS_LEAVE();
+    if (p_myString != NULL)
+    {
+        STATS_ADD(libraryStats._liveStrings, 1);
+    }
+    return p_myString;
+}
+
+
+/**
+ * @brief Frees the memory and resources allocated to str.
+ * @param str the MyString to free.
+ * If str is NULL, no operation is performed.
+ *
+ * Complexity: O(n) since str -> _chars points to the address on the heap
+ * we allocated before, and each time we realloc size of n bytes we take
+ * O(n) memory space.
+ */
+void myStringFree(MyString *str)
+{
+	if (str == NULL)
+	{
+		return;
+	}
+    releaseMyStringChars(str);
+    releaseBlock(str, sizeof(MyString));
+    STATS_SUB(libraryStats._liveStrings, 1);
+}
+
+/**
+ * @brief Frees the blocks which the calling thread keeps for reuse.
+ *
+ * Complexity: O(k) for the k blocks in the cache of the thread.
+ */
+void myStringReleaseThreadCache()
+{
+    flushBlockCache(&blockCache);
+}
+
+
+/**
+ * @brief Allocates a new MyString with the same value as str. It is the caller's
+ * 			responsibility to free the returned MyString.
+ * @param str the MyString to clone.
+ * RETURN VALUE:
+ *   Complexity: O(n) since we create a new struct in the memory with size of
+ *   n bytes as chars.
+ */
+MyString * myStringClone(const MyString *str)
+{
+	if (str == NULL)
+	{
+		return NULL;
+	}
+    // Indicator of the cloning success or failure.
+    MyStringRetVal retVal = MYSTRING_SUCCESS;
+    STATS_ENTER(MYSTRING_SITE_CLONE);
+    // The cloned string to be returned.
+    MyString *newMyString = myStringAlloc();
+    // Attempt to clone the string.
+    retVal = myStringSetFromMyString(newMyString, str);
+    STATS_LEAVE();
+    if (retVal == MYSTRING_ERROR)
+    {
+        myStringFree(newMyString);
+        return NULL;
+    }
+    return newMyString;
+}
+
+
+/**
+ * @brief Sets the value of str to the value of other.
+ * @param str the MyString to set
+ * @param other the MyString to set from
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *   Complexity: O(n) since we allocate memory as the size of the other string.
+ */
+MyStringRetVal myStringSetFromMyString(MyString *str, const MyString *other)
+{
+	if (str == NULL || other == NULL)
+	{
+		return MYSTRING_ERROR;
+	}
+    // The length of the other string.
+    unsigned long otherStringLength = myStringLen(other);
+    // Change the size of the string to the size of the other string.
+    STATS_ENTER(MYSTRING_SITE_SET);
+    MyStringRetVal adjustLengthRetVal = adjustMyStringLength(str, otherStringLength);
+    STATS_LEAVE();
+    if (adjustLengthRetVal == MYSTRING_ERROR)
+    {
+        return MYSTRING_ERROR;
+    }
+    memcpy(str -> _chars, other -> _chars, otherStringLength);
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief filter the value of str acording to a filter.
+ * 	remove from str all the occurrence of chars that are filtered by filt
+ *	(i.e. filr(char)==true)
+ * @param str the MyString to filter
+ * @param filt the filter
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *   Complexity: O(n) since we pass over the string once. The filtered string is
+ *   never longer than the original, so we compact it in place without allocating.
+ *   */
+MyStringRetVal myStringFilter(MyString *str, bool (*filt)(const char *))
+{
+	if (str == NULL || filt == NULL)
+	{
+		return MYSTRING_ERROR;
+	}
+    // Mapped chars are read only.
+    STATS_ENTER(MYSTRING_SITE_FILTER);
+    MyStringRetVal ownRetVal = ownMyStringChars(str);
+    STATS_LEAVE();
+    if (ownRetVal == MYSTRING_ERROR)
+    {
+        return MYSTRING_ERROR;
+    }
+    unsigned long filteredLength = 0;
+    unsigned long i = 0;
+    for (i = 0; i < str -> _length; i++)
+    {
+        // The char remained after the filtering.
+        if (filt(str -> _chars + i))
+        {
+            str -> _chars[filteredLength] = str -> _chars[i];
+            filteredLength++;
+        }
+    }
+    setMyStringLength(str, filteredLength);
+    return MYSTRING_SUCCESS;
+}
+
+
+/**
+ * @brief Sets the value of str to the value of the given C string.
+ * 			The given C string must be terminated by the null character.
+ * 			Checking will not use a string without the null character.
+ * @param str the MyString to set.
+ * @param cString the C string to set from.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *   Complexity: O(n) since we allocate memory of the length of the
+ *   cString.
+ */
+MyStringRetVal myStringSetFromCString(MyString *str, const char * cString)
+{
+	if (str == NULL || cString == NULL)
+	{
+		return MYSTRING_ERROR;
+	}
+    unsigned long cStringLength = getCStringLength(cString);
+    // Checking that the cString is legal.
+    if (*(cString + cStringLength) != END_OF_C_STRING)
+    {
+    	return MYSTRING_ERROR;
+    }
+
+    // Change the size of the string to the size of the cString.
+    STATS_ENTER(MYSTRING_SITE_SET);
+    MyStringRetVal adjustLengthRetVal = adjustMyStringLength(str, cStringLength);
+    STATS_LEAVE();
+    if (adjustLengthRetVal == MYSTRING_ERROR)
+    {
+        return MYSTRING_ERROR;
+    }
+    memcpy(str -> _chars, cString, cStringLength);
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Sets the value of str to the chars of view.
+ * @param str the MyString to set.
+ * @param view the view to set from.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *   Complexity: O(m) where m is the length of the view, or O(n) for a view into
+ *   the mapped chars of str, which are copied first.
+ */
+MyStringRetVal myStringSetFromView(MyString *str, MyStringView view)
+{
+    if (str == NULL || (view._chars == NULL && view._length != EMPTY_STRING_LENGTH))
+    {
+        return MYSTRING_ERROR;
+    }
+    // A view into str itself is moved to the start of the chars, after they are
+    // copied to a block of their own if they are mapped, since releasing or
+    // reallocating them would leave the view dangling.
+    bool isInnerView = view._chars >= str -> _chars &&
+                       view._chars < str -> _chars + str -> _length;
+    if (isInnerView)
+    {
+        unsigned long innerOffset = (unsigned long) (view._chars - str -> _chars);
+        if (ownMyStringChars(str) == MYSTRING_ERROR)
+        {
+            return MYSTRING_ERROR;
+        }
+        memmove(str -> _chars, str -> _chars + innerOffset, view._length);
+        setMyStringLength(str, view._length);
+        return MYSTRING_SUCCESS;
+    }
+    STATS_ENTER(MYSTRING_SITE_SET);
+    MyStringRetVal adjustLengthRetVal = adjustMyStringLength(str, view._length);
+    STATS_LEAVE();
+    if (adjustLengthRetVal == MYSTRING_ERROR)
+    {
+        return MYSTRING_ERROR;
+    }
+    if (view._length > EMPTY_STRING_LENGTH)
+    {
+        memcpy(str -> _chars, view._chars, view._length);
+    }
+    return MYSTRING_SUCCESS;
+}
+
+
+/**
+ * @brief Sets the value of str to the value of the integer n.
+ *	(i.e. if n=7 than str should contain �7�)
+ * 	You are not allowed to use itoa (or a similar functions) here but
+ * 	 must code your own conversion function.
+ * @param str the MyString to set.
+ * @param n the int to set from.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *   Complexity: O(k) where k is the number of digits since we allocate
+ *   a block of the length of the number.
+ */
+MyStringRetVal myStringSetFromInt(MyString *str, int n)
+{
+	if (str == NULL)
+	{
+		return MYSTRING_ERROR;
+	}
+    unsigned long numOfDigits = (unsigned long) getNumOfDigits(n);
+    // Change the size of the string to the number of digits.
+    STATS_ENTER(MYSTRING_SITE_SET);
+    MyStringRetVal adjustLengthRetVal = adjustMyStringLength(str, numOfDigits);
+    STATS_LEAVE();
+    if (adjustLengthRetVal == MYSTRING_ERROR)
+    {
+        return MYSTRING_ERROR;
+    }
+    // Write the number right into the string, from its last digit.
+    writeDecimalBackwards(str -> _chars + numOfDigits, n);
+    return MYSTRING_SUCCESS;
+}
+
+
+/**
+ * @brief Returns the value of str as an integer.
+ * 	If str cannot be parsed as an integer,
+ * 	the return value should be MYSTR_ERROR_CODE
+ * 	NOTE: positive and negative integers should be supported.
+ * @param str the MyString
+ * @return an integer
+ *
+ *  Complexity: O(k) where k is the length of the number since we iterate
+ *   over the digits of the number.
+ */
+int myStringToInt(const MyString *str)
+{
+	if (str == NULL)
+	{
+		return MYSTRING_ERROR;
+	}
+    int value = 0;
+    int numberOfDigits = 0;
+    // Attempt to parse the string as an integer.
+    numberOfDigits = sscanf(str -> _chars, "%d", &value);
+    if(numberOfDigits <= 0)
+    {
+        return MYSTR_ERROR_CODE;
+    }
+    return value;
+}
+
+
+/**
+ * @brief Returns the value of str as a C string, terminated with the
+ * 	null character. It is the caller's responsibility to free the returned
+ * 	string by calling free().
+ * @param str the MyString
+ * RETURN VALUE:
+ *  @return the new string, or NULL if the allocation failed.
+ *
+ *   Complexity: O(n) since we allocate a new block of memory as the length
+ *   of the string.
+ */
+char * myStringToCString(const MyString *str)
+{
+	if (str == NULL)
+	{
+		return NULL;
+	}
+	// Get the length of the string before change.
+    unsigned long oldLength = myStringLen(str);
+    // Allocate memory for the string along with '\0'.
+    char *newString = (char *) malloc(oldLength + 1);
+    if (newString == NULL)
+    {
+        return NULL;
+    }
+    // Create the new CString.
+    memcpy(newString, str -> _chars, oldLength);
+    newString[oldLength] = END_OF_C_STRING;
+    return newString;
+}
+
+
+/**
+ * @brief Appends a copy of the source MyString src to the destination MyString dst.
+ * @param dest the destination
+ * @param src the MyString to append
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *   Complexity: O(m) where m  is the size of src
+ *   since we cat the src string and the dest is already allocated.
+ *   n bytes as chars.
+ */
+MyStringRetVal myStringCat(MyString * dest, const MyString * src)
+{
+	if (dest == NULL || src == NULL)
+	{
+		return MYSTRING_ERROR;
+	}
+	// Empty string, nothing to cat.
+	if (src -> _length == EMPTY_STRING_LENGTH)
+	{
+		return MYSTRING_SUCCESS;
+	}
+    unsigned long srcLength = myStringLen(src);
+    unsigned long destLength = myStringLen(dest);
+    // Allocate memory of the summed length of the strings.
+    STATS_ENTER(MYSTRING_SITE_CAT);
+    MyStringRetVal adjustLengthRetVal = adjustMyStringLength(dest, srcLength + destLength);
+    STATS_LEAVE();
+    if (adjustLengthRetVal == MYSTRING_ERROR)
+    {
+        return MYSTRING_ERROR;
+    }
+    // Cat the strings.
+    memcpy(dest -> _chars + destLength, src -> _chars, srcLength);
+    return MYSTRING_SUCCESS;
+
+}
+
+/**
+ * @brief Sets result to be the concatenation of str1 and str2.
+ * 	result should be initially allocated by the caller.
+ * 	result shouldn't be the same struct as str1 or str2.
+ * @param str1
+ * @param str2
+ * @param result
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *   Complexity: O(n+m) since we copy both of the strings to a new location
+ *   so we iterate over the sum of their lengths.
+ */
+MyStringRetVal myStringCatTo(const MyString *str1, const MyString *str2, MyString *result)
+{
+	if (str1 == NULL || str2 == NULL || result == NULL)
+	{
+		return MYSTRING_ERROR;
+	}
+    unsigned long strLength1 = myStringLen(str1);
+    unsigned long strLength2 = myStringLen(str2);
+    // Allocate memory of the summed length of the strings.
+    STATS_ENTER(MYSTRING_SITE_CAT);
+    MyStringRetVal adjustLengthRetVal = adjustMyStringLength(result, strLength1 + strLength2);
+    STATS_LEAVE();
+    if (adjustLengthRetVal == MYSTRING_ERROR)
+    {
+        return MYSTRING_ERROR;
+    }
+    // Create the first string in the new memory address.
+    memcpy(result -> _chars, str1 -> _chars, strLength1);
+    // Cat the second string to the first string in the new address.
+    memcpy(result -> _chars + strLength1, str2 -> _chars, strLength2);
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Compare str1 and str2.
+ * @param str1
+ * @param str2
+ *
+ * RETURN VALUE:
+ * @return an integral value indicating the relationship between the strings:
+ * 	A zero value indicates that the strings are equal.
+ * 	A value greater than zero indicates that the first character that does not match
+ * 	 has a greater ASCII value in str1 than in str2;
+ * 	And a value less than zero indicates the opposite.
+ * 	If strings cannot be compared, the return value should be MYSTR_ERROR_CODE
+ *
+ * 	 Complexity: O(n) where n is the length of the shorter string since at the worst
+ * 	 case we will reach the end of the shorter string and then the longer is bigger.
+ *
+ */
+int myStringCompare(const MyString *str1, const MyString *str2)
+{
+    if (str1 == NULL || str2 == NULL)
+    {
+        return MYSTR_ERROR_CODE;
+    }
+
+    unsigned long strLength1 = myStringLen(str1);
+    unsigned long strLength2 = myStringLen(str2);
+    // str1 has a greater ascii value.
+    if (strLength1 > strLength2)
+    {
+        int equalUntilLength2 = memcmp(str1 -> _chars, str2 -> _chars, strLength2);
+        return equalUntilLength2 >= EQUAL_STRINGS ? STR1_BIGGER : STR2_BIGGER;
+    }
+      // str2 has a greater ascii value.
+    else if (strLength1 < strLength2)
+    {
+        int equalUntilLength1 = memcmp(str1 -> _chars, str2 -> _chars, strLength1);
+        return equalUntilLength1 <= EQUAL_STRINGS ? STR2_BIGGER : STR1_BIGGER;
+    }
+        // The strings have equal lengths.
+    else
+    {
+        return memcmp(str1 -> _chars, str2 -> _chars, strLength1);
+    }
+}
+
+
+/**
+ * @brief Compares str1 and str2.
+ * @param str1
+ * @param str2
+ * @param comparator
+ * RETURN VALUE:
+ * @return an integral value indicating the relationship between the strings:
+ * 	A zero value indicates that the strings are equal according to the
+ * 	 custom comparator (3rd parameter).
+ * 	A value greater than zero indicates that the first
+ * 	 MyString is bigger according to the comparator.
+ * 	And a value less than zero indicates the opposite.
+ * 	If strings cannot be compared, the return value should be MYSTR_ERROR_CODE
+ *
+ * 	 Complexity: O(1) plus the cost of a single comparator call, since the comparator
+ * 	 already compares the whole strings. For per-character orderings see
+ * 	 myStringCollationCompare which works by table lookups.
+ */
+
+int myStringCustomCompare(const MyString *str1, const MyString *str2,
+						  int (*comparator) (const MyString *, const MyString *))
+{
+    if (str1 == NULL || str2 == NULL || comparator == NULL)
+    {
+        return MYSTR_ERROR_CODE;
+    }
+    // The length of the strings.
+    unsigned long strLength1 = myStringLen(str1);
+    unsigned long strLength2 = myStringLen(str2);
+    // The comparator looks at the whole strings, so one call is enough - its answer
+    // can't change from one index to the next.
+    if (strLength1 != EMPTY_STRING_LENGTH && strLength2 != EMPTY_STRING_LENGTH)
+    {
+        int result = comparator(str1, str2);
+        if (result > EQUAL_STRINGS)
+        {
+            return STR1_BIGGER;
+        }
+        if (result < EQUAL_STRINGS)
+        {
+            return STR2_BIGGER;
+        }
+    }
+    // The strings are of different lengths and the common substrings are equal.
+    if (strLength1 > strLength2)
+    {
+        return STR1_BIGGER;
+    }
+    if (strLength1 < strLength2)
+    {
+        return STR2_BIGGER;
+    }
+    // The strings are truly identical.
+    return EQUAL_STRINGS;
+}
+
+
+
+/**
+ * @brief Check if str1 is equal to str2.
+ * @param str1
+ * @param str2
+ *
+ * RETURN VALUE:
+ * @return an integral value indicating the equality of the strings (logical equality -
+ *  that they are composed of the very same characters):
+ * 	A zero value indicates that the strings are not equal.
+ * 	A greater than zero value indicates that the strings are equal.
+ * 	If strings cannot be compared, the return value should be MYSTR_ERROR_CODE
+ *
+ * 	 Complexity: O(n) where n is the length of the shorter string since at the worst
+ * 	 case we will reach the end of the shorter string and then we will know if the strings
+ * 	 are equal or not.
+ *
+  */
+int myStringEqual(const MyString *str1, const MyString *str2)
+{
+    // The strings cannot be compared.
+    if (str1 == NULL || str2 == NULL)
+    {
+        return MYSTR_ERROR_CODE;
+    }
+    // Compare the strings to see if they're equal.
+    int areEqual = myStringCompare(str1, str2);
+    return areEqual == EQUAL_STRINGS ? TRUE : FALSE;
+}
+
+/**
+ * @brief Check if str1 is equal to str2.
+ * @param str1
+ * @param str2
+ * @param comparator
+ *
+ * RETURN VALUE:
+ * @return an integral value indicating the equality of the strings using a
+ * custom comparator (3rd parameter):
+ * 	A zero value indicates that the strings are not equal.
+ * 	A greater than zero value indicates that the strings are equal.
+ * 	If string cannot be compared, the return value should be MYSTR_ERROR_CODE
+ *
+ * 	 Complexity: O(n) where n is the length of the shorter string since at the worst
+ * 	 case we will reach the end of the shorter string and then we will know if the strings
+ * 	 are equal or not.
+ */
+int myStringCustomEqual(const MyString *str1, const MyString *str2,
+						int (*comparator) (const MyString *, const MyString *))
+{
+    // The strings cannot be compared.
+    if (str1 == NULL || str2 == NULL)
+    {
+        return MYSTR_ERROR_CODE;
+    }
+    // Compare the strings to see if they're equal by the comparator.
+    int areEqual = myStringCustomCompare(str1, str2, comparator);
+    return areEqual == EQUAL_STRINGS ? TRUE : FALSE;
+}
+
+
+/**
+ * @return the amount of memory (all the memory that used by the MyString object
+ *  itself and its allocations), in bytes, allocated to str1.
+ *
+ *  Complexity: O(1) because the capacity is kept in the structure .
+ */
+unsigned long myStringMemUsage(const MyString *str1)
+{
+	if (str1 == NULL)
+	{
+		return NO_MEMORY_USAGE;
+	}
+	return (sizeof(MyString) + str1 -> _capacity);
+}
+
+/**
+ * @return the length of the string in str1.
+ *
+ * Complexity: O(1) because the length is kept in the structure .
+ */
+unsigned long myStringLen(const MyString *str1)
+{
+	if (str1 == NULL)
+	{
+		return MYSTRING_ERROR;
+	}
+    return str1 -> _length;
+}
+
+/**
+ * Writes the content of str to stream. (like fputs())
+ *
+ * RETURNS:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(n) since we write the n chars with fwrite, right from the
+ *  string without copying them to a C string first.
+ */
+MyStringRetVal myStringWrite(const MyString *str, FILE *stream)
+{
+    if (stream == NULL || str == NULL)
+    {
+        return MYSTRING_ERROR;
+    }
+    // Write the chars to the file right from the string, no copy is needed.
+    size_t charsWritten = fwrite(str -> _chars, sizeof(char), str -> _length, stream);
+    // Checks if the writing process was successful.
+	if (charsWritten != str -> _length)
+	{
+		return MYSTRING_ERROR;
+	}
+	fclose(stream);
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief sort an array of MyString pointers
+ * @param arr
+ * @param len
+ * @param comparator custom comparator
+ *
+ * RETURN VALUE:none
+ *
+ *  Complexity: O(n^2) because quick sort performs this way at the worst case.
+ *  On average we will acheive O(nlogn)
+  */
+
+void myStringCustomSort(MyString *arr[], unsigned long len,
+						int (*comparator) (const void *, const void *))
+{
+	if (arr == NULL || comparator == NULL)
+	{
+		return;
+	}
+    qsort(arr, len, sizeof(MyString*), comparator);
+}
+
+/**
+ * @brief sorts an array of MyString pointers according to the default comparison
+ *  (like in myStringCompare)
+ * @param arr
+ * @param len
+ *
+ * RETURN VALUE: none
+ *
+ * *  Complexity: O(n^2) because quick sort performs this way at the worst case.
+ *  On average we will acheive O(nlogn)
+  */
+
+void myStringSort(MyString *arr[], unsigned long len)
+{
+	if (arr == NULL)
+	{
+		return;
+	}
+    qsort(arr, len, sizeof(MyString*), myStringComparator);
+}
+
+/**
+ * @brief Allocates a new collation out of weight tables.
+ * @param weights array of levels weight tables.
+ * @param levels the number of levels, between 1 and MYSTRING_COLLATION_MAX_LEVELS.
+ * RETURN VALUE:
+ *  @return a pointer to the new collation, or NULL on failure.
+ *
+ *  Complexity: O(1) since we copy and scan a constant number of tables.
+ */
+MyStringCollation * myStringCollationAlloc(const unsigned char *weights[], unsigned int levels)
+{
+    if (weights == NULL || levels == 0 || levels > MYSTRING_COLLATION_MAX_LEVELS)
+    {
+        return NULL;
+    }
+    MyStringCollation *collation = (MyStringCollation *) malloc(sizeof(MyStringCollation));
+    if (collation == NULL)
+    {
+        return NULL;
+    }
+    unsigned int level = 0;
+    for (level = 0; level < levels; level++)
+    {
+        if (weights[level] == NULL)
+        {
+            free(collation);
+            return NULL;
+        }
+        memcpy(collation -> _weights[level], weights[level], MYSTRING_COLLATION_TABLE_SIZE);
+        // Compile the level: remember if we ever need to skip chars in it.
+        collation -> _hasIgnorables[level] = false;
+        unsigned int c = 0;
+        for (c = 0; c < MYSTRING_COLLATION_TABLE_SIZE; c++)
+        {
+            if (weights[level][c] == MYSTRING_COLLATION_IGNORABLE)
+            {
+                collation -> _hasIgnorables[level] = true;
+                break;
+            }
+        }
+    }
+    collation -> _levels = levels;
+    return collation;
+}
+
+/**
+ * @brief Frees the memory allocated to collation.
+ * @param collation the collation to free.
+ *
+ * Complexity: O(1).
+ */
+void myStringCollationFree(MyStringCollation *collation)
+{
+    free(collation);
+}
+
+/**
+ * @brief Compares str1 and str2 according to collation.
+ * @param str1
+ * @param str2
+ * @param collation
+ * RETURN VALUE:
+ * @return STR1_BIGGER, STR2_BIGGER or EQUAL_STRINGS.
+ * 	If strings cannot be compared, the return value should be MYSTR_ERROR_CODE
+ *
+ * 	 Complexity: O(n*l) where n is the length of the longer string and l the number
+ * 	 of levels, with one table lookup per char.
+ */
+int myStringCollationCompare(const MyString *str1, const MyString *str2,
+							 const MyStringCollation *collation)
+{
+    if (str1 == NULL || str2 == NULL || collation == NULL)
+    {
+        return MYSTR_ERROR_CODE;
+    }
+    unsigned int level = 0;
+    for (level = 0; level < collation -> _levels; level++)
+    {
+        int result = collationCompareLevel(collation -> _weights[level],
+                                           collation -> _hasIgnorables[level],
+                                           str1 -> _chars, str1 -> _length,
+                                           str2 -> _chars, str2 -> _length);
+        if (result != EQUAL_STRINGS)
+        {
+            return result;
+        }
+    }
+    return EQUAL_STRINGS;
+}
+
+/**
+ * @brief Check if str1 is equal to str2 according to collation.
+ * @param str1
+ * @param str2
+ * @param collation
+ * RETURN VALUE:
+ * @return TRUE if the strings are equal, FALSE otherwise.
+ * 	If strings cannot be compared, the return value should be MYSTR_ERROR_CODE
+ *
+ * 	 Complexity: O(n*l) like myStringCollationCompare, O(1) for strings of different
+ * 	 lengths when the collation has no ignorable chars.
+ */
+int myStringCollationEqual(const MyString *str1, const MyString *str2,
+						   const MyStringCollation *collation)
+{
+    if (str1 == NULL || str2 == NULL || collation == NULL)
+    {
+        return MYSTR_ERROR_CODE;
+    }
+    // Without ignorable chars every char has a weight at the first level.
+    if (!collation -> _hasIgnorables[0] && str1 -> _length != str2 -> _length)
+    {
+        return FALSE;
+    }
+    return myStringCollationCompare(str1, str2, collation) == EQUAL_STRINGS ? TRUE : FALSE;
+}
+
+/**
+ * @brief sorts an array of MyString pointers according to collation.
+ * @param arr
+ * @param len
+ * @param collation
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(N) to build the keys, where N is the total length of the strings,
+ *  and then O(nlogn) key comparisons by memcmp as in quick sort on average.
+ */
+MyStringRetVal myStringCollationSort(MyString *arr[], unsigned long len,
+									 const MyStringCollation *collation)
+{
+    if (arr == NULL || collation == NULL)
+    {
+        return MYSTRING_ERROR;
+    }
+    if (len <= 1)
+    {
+        return MYSTRING_SUCCESS;
+    }
+    CollationKey *keys = (CollationKey *) malloc(len * sizeof(CollationKey));
+    if (keys == NULL)
+    {
+        return MYSTRING_ERROR;
+    }
+    // All the keys are kept in one block, so first we sum their lengths.
+    unsigned long totalKeysLength = 0;
+    unsigned long i = 0;
+    for (i = 0; i < len; i++)
+    {
+        if (arr[i] == NULL)
+        {
+            free(keys);
+            return MYSTRING_ERROR;
+        }
+        keys[i]._length = getCollationKeyLength(arr[i], collation);
+        keys[i]._str = arr[i];
+        totalKeysLength += keys[i]._length;
+    }
+    // Add one so an array of empty keys still gets a valid block.
+    unsigned char *keysBlock = (unsigned char *) malloc(totalKeysLength + 1);
+    if (keysBlock == NULL)
+    {
+        free(keys);
+        return MYSTRING_ERROR;
+    }
+    unsigned char *nextKey = keysBlock;
+    for (i = 0; i < len; i++)
+    {
+        createCollationKey(nextKey, arr[i], collation);
+        keys[i]._key = nextKey;
+        nextKey += keys[i]._length;
+    }
+    qsort(keys, len, sizeof(CollationKey), collationKeyComparator);
+    for (i = 0; i < len; i++)
+    {
+        arr[i] = keys[i]._str;
+    }
+    free(keysBlock);
+    free(keys);
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief sorts an array of MyString pointers by integer keys in ascending order.
+ * @param arr
+ * @param len
+ * @param keyExtractor returns the key of a string.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(n) since keyExtractor is called n times and the radix sort does
+ *  a constant number of passes over the (key, index) pairs.
+ */
+MyStringRetVal myStringSortByKey(MyString *arr[], unsigned long len,
+								 unsigned long long (*keyExtractor) (const MyString *))
+{
+    if (arr == NULL || keyExtractor == NULL)
+    {
+        return MYSTRING_ERROR;
+    }
+    if (len <= 1)
+    {
+        return MYSTRING_SUCCESS;
+    }
+    SortKeyPair *pairs = (SortKeyPair *) malloc(len * sizeof(SortKeyPair));
+    if (pairs == NULL)
+    {
+        return MYSTRING_ERROR;
+    }
+    unsigned long i = 0;
+    for (i = 0; i < len; i++)
+    {
+        if (arr[i] == NULL)
+        {
+            free(pairs);
+            return MYSTRING_ERROR;
+        }
+        pairs[i]._key = keyExtractor(arr[i]);
+        pairs[i]._index = i;
+    }
+    if (radixSortKeyPairs(pairs, len) == MYSTRING_ERROR ||
+        applySortPermutation(arr, pairs, len) == MYSTRING_ERROR)
+    {
+        free(pairs);
+        return MYSTRING_ERROR;
+    }
+    free(pairs);
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief sorts an array of MyString pointers by string keys.
+ * @param arr
+ * @param len
+ * @param keyExtractor sets key to the key of str.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(N) to extract the keys, where N is their total length, then a radix
+ *  sort of their prefixes. Only strings whose keys share a prefix are compared, at
+ *  worst O(nlogn) comparisons when all of them do.
+ */
+MyStringRetVal myStringSortByStringKey(MyString *arr[], unsigned long len,
+									   MyStringRetVal (*keyExtractor) (const MyString *str,
+																	   MyString *key))
+{
+    if (arr == NULL || keyExtractor == NULL)
+    {
+        return MYSTRING_ERROR;
+    }
+    if (len <= 1)
+    {
+        return MYSTRING_SUCCESS;
+    }
+    MyStringRetVal retVal = MYSTRING_ERROR;
+    // The keys are packed one after another, key i is at [keyOffsets[i], keyOffsets[i + 1]).
+    unsigned long *keyOffsets = (unsigned long *) malloc((len + 1) * sizeof(unsigned long));
+    SortKeyPair *pairs = (SortKeyPair *) malloc(len * sizeof(SortKeyPair));
+    CollationKey *run = (CollationKey *) malloc(len * sizeof(CollationKey));
+    MyString **sorted = (MyString **) malloc(len * sizeof(MyString *));
+    MyString *key = myStringAlloc();
+    // Start with a char per key, the block grows as needed.
+    unsigned long keysCapacity = len;
+    char *keysBlock = (char *) malloc(keysCapacity);
+    if (keyOffsets == NULL || pairs == NULL || run == NULL || sorted == NULL || key == NULL ||
+        keysBlock == NULL)
+    {
+        goto cleanup;
+    }
+    keyOffsets[0] = 0;
+    unsigned long i = 0;
+    for (i = 0; i < len; i++)
+    {
+        if (arr[i] == NULL || keyExtractor(arr[i], key) == MYSTRING_ERROR)
+        {
+            goto cleanup;
+        }
+        keyOffsets[i + 1] = keyOffsets[i] + key -> _length;
+        // Grow the keys block geometrically so copying the keys stays linear.
+        if (keyOffsets[i + 1] > keysCapacity)
+        {
+            unsigned long newCapacity = keysCapacity * 2 > keyOffsets[i + 1] ?
+                                        keysCapacity * 2 : keyOffsets[i + 1];
+            char *newBlock = (char *) realloc(keysBlock, newCapacity);
+            if (newBlock == NULL)
+            {
+                goto cleanup;
+            }
+            keysBlock = newBlock;
+            keysCapacity = newCapacity;
+        }
+        memcpy(keysBlock + keyOffsets[i], key -> _chars, key -> _length);
+    }
+    for (i = 0; i < len; i++)
+    {
+        pairs[i]._key = getPrefixKey(keysBlock + keyOffsets[i], keyOffsets[i + 1] - keyOffsets[i]);
+        pairs[i]._index = i;
+    }
+    if (radixSortKeyPairs(pairs, len) == MYSTRING_ERROR)
+    {
+        goto cleanup;
+    }
+    // Only keys with the same prefix are left to be compared.
+    i = 0;
+    while (i < len)
+    {
+        unsigned long runEnd = i + 1;
+        while (runEnd < len && pairs[runEnd]._key == pairs[i]._key)
+        {
+            runEnd++;
+        }
+        if (runEnd - i == 1)
+        {
+            sorted[i] = arr[pairs[i]._index];
+        }
+        else
+        {
+            unsigned long j = 0;
+            for (j = i; j < runEnd; j++)
+            {
+                unsigned long index = pairs[j]._index;
+                run[j - i]._key = (const unsigned char *) keysBlock + keyOffsets[index];
+                run[j - i]._length = keyOffsets[index + 1] - keyOffsets[index];
+                run[j - i]._str = arr[index];
+            }
+            qsort(run, runEnd - i, sizeof(CollationKey), collationKeyComparator);
+            for (j = i; j < runEnd; j++)
+            {
+                sorted[j] = run[j - i]._str;
+            }
+        }
+        i = runEnd;
+    }
+    memcpy(arr, sorted, len * sizeof(MyString *));
+    retVal = MYSTRING_SUCCESS;
+
+cleanup:
+    myStringFree(key);
+    free(keysBlock);
+    free(sorted);
+    free(run);
+    free(pairs);
+    free(keyOffsets);
+    return retVal;
+}
+
+/**
+ * @brief Get a view of all the chars of str.
+ * @param str
+ * RETURN VALUE:
+ *  @return the view, an empty view if str is NULL.
+ *
+ *  Complexity: O(1).
+ */
+MyStringView myStringGetView(const MyString *str)
+{
+    MyStringView view = {NULL, EMPTY_STRING_LENGTH};
+    if (str != NULL)
+    {
+        view._chars = str -> _chars;
+        view._length = str -> _length;
+    }
+    return view;
+}
+
+/**
+ * @brief Check if the chars of str are valid UTF-8.
+ * @param str
+ * RETURN VALUE:
+ * @return TRUE if str is valid UTF-8, FALSE otherwise.
+ * 	If str is NULL, the return value should be MYSTR_ERROR_CODE
+ *
+ *  Complexity: O(n). Ascii runs are skipped a block of chars at a time, the other
+ *  chars take two table lookups each.
+ */
+int myStringValidateUTF8(const MyString *str)
+{
+    if (str == NULL)
+    {
+        return MYSTR_ERROR_CODE;
+    }
+    const unsigned char *chars = (const unsigned char *) str -> _chars;
+    unsigned long length = str -> _length;
+    unsigned long i = 0;
+    unsigned char state = UTF8_ACCEPT;
+    while (i < length)
+    {
+        // Between code points we may jump over a whole run of ascii.
+        if (state == UTF8_ACCEPT)
+        {
+            i += getAsciiPrefixLength(chars + i, length - i);
+            if (i == length)
+            {
+                break;
+            }
+        }
+        state = utf8Transitions[state][utf8CharClasses[chars[i]]];
+        if (state == UTF8_REJECT)
+        {
+            return FALSE;
+        }
+        i++;
+    }
+    // A truncated code point at the end leaves us waiting for continuation chars.
+    return state == UTF8_ACCEPT ? TRUE : FALSE;
+}
+
+/**
+ * @brief Count the code points of str.
+ * @param str
+ * RETURN VALUE:
+ * @return the number of code points in str, 0 if str is NULL.
+ *
+ *  Complexity: O(n), a word of chars at a time. Every char which isn't a
+ *  continuation char starts a code point.
+ */
+unsigned long myStringCodePointLen(const MyString *str)
+{
+    if (str == NULL)
+    {
+        return EMPTY_STRING_LENGTH;
+    }
+    const unsigned char *chars = (const unsigned char *) str -> _chars;
+    unsigned long length = str -> _length;
+    unsigned long continuationChars = 0;
+    unsigned long i = 0;
+    for (i = 0; i + WORD_SIZE <= length; i += WORD_SIZE)
+    {
+        unsigned long long word = loadWord(chars + i);
+        // A continuation char has the high bit set and the next bit clear.
+        continuationChars += countHighBits(word & ~(word << 1) & HIGH_BITS_MASK);
+    }
+    for (; i < length; i++)
+    {
+        if ((chars[i] & UTF8_CONTINUATION_MASK) == UTF8_CONTINUATION_BITS)
+        {
+            continuationChars++;
+        }
+    }
+    return length - continuationChars;
+}
+
+/**
+ * @brief Get a view of count code points of str starting at code point start.
+ * @param str
+ * @param start the index of the first code point of the view.
+ * @param count the maximal number of code points in the view.
+ * @param view the view to set.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR if start is beyond the
+ *   last code point of str.
+ *
+ *  Complexity: O(n) where n is the number of chars until the end of the view,
+ *  skipped a word at a time.
+ */
+MyStringRetVal myStringCodePointSlice(const MyString *str, unsigned long start,
+									  unsigned long count, MyStringView *view)
+{
+    if (str == NULL || view == NULL)
+    {
+        return MYSTRING_ERROR;
+    }
+    const unsigned char *chars = (const unsigned char *) str -> _chars;
+    unsigned long length = str -> _length;
+    unsigned long toSkip = start;
+    unsigned long begin = skipCodePoints(chars, length, 0, &toSkip);
+    // The string ended before reaching start (start == the number of code points is
+    // still fine and gives an empty view).
+    if (toSkip > 0)
+    {
+        return MYSTRING_ERROR;
+    }
+    unsigned long end = skipCodePoints(chars, length, begin, &count);
+    view -> _chars = str -> _chars + begin;
+    view -> _length = end - begin;
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Make sure str has room for at least capacity chars.
+ * @param str
+ * @param capacity
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(n) if we need to reallocate, O(1) otherwise.
+ */
+MyStringRetVal myStringReserve(MyString *str, unsigned long capacity)
+{
+    if (str == NULL)
+    {
+        return MYSTRING_ERROR;
+    }
+    if (capacity < str -> _length)
+    {
+        capacity = str -> _length;
+    }
+    // One more char for the '\0'.
+    if (capacity < str -> _capacity)
+    {
+        return MYSTRING_SUCCESS;
+    }
+    return setMyStringCapacity(str, capacity + 1);
+}
+
+/**
+ * @brief Appends to str the text formatted by format and the following arguments.
+ * @param str
+ * @param format
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(m) where m is the length of the formatted text.
+ */
+MyStringRetVal myStringAppendf(MyString *str, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    MyStringRetVal retVal = myStringVAppendf(str, format, args);
+    va_end(args);
+    return retVal;
+}
+
+/**
+ * @brief Like myStringAppendf, with the arguments given as a va_list.
+ * @param str
+ * @param format
+ * @param args
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(m) where m is the length of the formatted text. The text is
+ *  formatted once if it fits the spare capacity, otherwise once more after a
+ *  single reallocation to the measured size.
+ */
+MyStringRetVal myStringVAppendf(MyString *str, const char *format, va_list args)
+{
+    if (str == NULL || format == NULL)
+    {
+        return MYSTRING_ERROR;
+    }
+    // We format right into the spare capacity, so mapped chars are copied first.
+    if (ownMyStringChars(str) == MYSTRING_ERROR)
+    {
+        return MYSTRING_ERROR;
+    }
+    va_list retryArgs;
+    va_copy(retryArgs, args);
+    unsigned long spareCapacity = str -> _capacity - str -> _length;
+    // vsnprintf always ends with '\0', so it needs a char more than the text.
+    int textLength = vsnprintf(str -> _chars + str -> _length, spareCapacity, format, args);
+    if (textLength < 0)
+    {
+        va_end(retryArgs);
+        terminateMyString(str);
+        return MYSTRING_ERROR;
+    }
+    if ((unsigned long) textLength >= spareCapacity)
+    {
+        unsigned long requiredCapacity = str -> _length + textLength + 1;
+        unsigned long newCapacity = str -> _capacity * CAPACITY_GROWTH_FACTOR;
+        if (newCapacity < requiredCapacity)
+        {
+            newCapacity = requiredCapacity;
+        }
+        if (setMyStringCapacity(str, newCapacity) == MYSTRING_ERROR)
+        {
+            va_end(retryArgs);
+            // The cut text overwrote the '\0'.
+            terminateMyString(str);
+            return MYSTRING_ERROR;
+        }
+        vsnprintf(str -> _chars + str -> _length, textLength + 1, format, retryArgs);
+    }
+    va_end(retryArgs);
+    setMyStringLength(str, str -> _length + textLength);
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Sets the value of str to the text formatted by format and the following
+ * 	arguments.
+ * @param str
+ * @param format
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(m) where m is the length of the formatted text.
+ */
+MyStringRetVal myStringSetf(MyString *str, const char *format, ...)
+{
+    if (str == NULL)
+    {
+        return MYSTRING_ERROR;
+    }
+    // Mapped chars are dropped rather than written over.
+    adjustMyStringLength(str, EMPTY_STRING_LENGTH);
+    va_list args;
+    va_start(args, format);
+    STATS_ENTER(MYSTRING_SITE_SET);
+    MyStringRetVal retVal = myStringVAppendf(str, format, args);
+    STATS_LEAVE();
+    va_end(args);
+    return retVal;
+}
+
+/**
+ * @brief Appends the decimal value of n to str.
+ * @param str
+ * @param n
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(k) where k is the number of digits.
+ */
+MyStringRetVal myStringAppendInt(MyString *str, long long n)
+{
+    if (str == NULL)
+    {
+        return MYSTRING_ERROR;
+    }
+    char digits[MAX_DECIMAL_LENGTH];
+    char *firstDigit = writeDecimalBackwards(digits + MAX_DECIMAL_LENGTH, n);
+    unsigned long numOfDigits = (unsigned long) (digits + MAX_DECIMAL_LENGTH - firstDigit);
+    unsigned long oldLength = str -> _length;
+    if (adjustMyStringLength(str, oldLength + numOfDigits) == MYSTRING_ERROR)
+    {
+        return MYSTRING_ERROR;
+    }
+    memcpy(str -> _chars + oldLength, firstDigit, numOfDigits);
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Appends d to str with precision significant digits.
+ * @param str
+ * @param d
+ * @param precision the number of significant digits.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(k) where k is the number of chars written.
+ */
+MyStringRetVal myStringAppendDouble(MyString *str, double d, int precision)
+{
+    // Correctly rounded conversion of doubles is left to the C library.
+    return myStringAppendf(str, "%.*g", precision, d);
+}
+
+/**
+ * @brief Appends the chars of view to str.
+ * @param str
+ * @param view
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(m) where m is the length of the view.
+ */
+MyStringRetVal myStringAppendView(MyString *str, MyStringView view)
+{
+    if (str == NULL || (view._chars == NULL && view._length != EMPTY_STRING_LENGTH))
+    {
+        return MYSTRING_ERROR;
+    }
+    if (view._length == EMPTY_STRING_LENGTH)
+    {
+        return MYSTRING_SUCCESS;
+    }
+    // A view into str itself moves with the chars if we reallocate or copy them.
+    bool isInnerView = view._chars >= str -> _chars &&
+                       view._chars < str -> _chars + str -> _length;
+    unsigned long innerOffset = isInnerView ? (unsigned long) (view._chars - str -> _chars) : 0;
+    unsigned long oldLength = str -> _length;
+    if (adjustMyStringLength(str, oldLength + view._length) == MYSTRING_ERROR)
+    {
+        return MYSTRING_ERROR;
+    }
+    const char *source = isInnerView ? str -> _chars + innerOffset : view._chars;
+    memcpy(str -> _chars + oldLength, source, view._length);
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Sets dst to be the concatenation of the n strings of parts.
+ * @param dst
+ * @param parts
+ * @param n
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(N) where N is the total length of the parts, with at most one
+ *  allocation.
+ */
+MyStringRetVal myStringConcatMany(MyString *dst, const MyString *parts[], unsigned long n)
+{
+    return joinMyStrings(dst, parts, n, NULL);
+}
+
+/**
+ * @brief Sets dst to be the n strings of parts with sep between every two of them.
+ * @param dst
+ * @param parts
+ * @param n
+ * @param sep
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(N) where N is the total length of the result, with at most one
+ *  allocation.
+ */
+MyStringRetVal myStringJoin(MyString *dst, const MyString *parts[], unsigned long n,
+							const MyString *sep)
+{
+    if (sep == NULL)
+    {
+        return MYSTRING_ERROR;
+    }
+    return joinMyStrings(dst, parts, n, sep);
+}
+
+/**
+ * @brief Moves the value of src to dst without copying it.
+ * @param dst
+ * @param src
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(1) since only the block pointer changes hands.
+ */
+MyStringRetVal myStringMove(MyString *dst, MyString *src)
+{
+    if (dst == NULL || src == NULL)
+    {
+        return MYSTRING_ERROR;
+    }
+    if (dst == src)
+    {
+        return MYSTRING_SUCCESS;
+    }
+    releaseMyStringChars(dst);
+    *dst = *src;
+    // src gives up its block without getting a new one.
+    src -> _chars = noChars;
+    src -> _length = EMPTY_STRING_LENGTH;
+    src -> _capacity = 0;
+    src -> _mappedSize = 0;
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Swaps the values of str1 and str2 without copying them.
+ * @param str1
+ * @param str2
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(1).
+ */
+MyStringRetVal myStringSwap(MyString *str1, MyString *str2)
+{
+    if (str1 == NULL || str2 == NULL)
+    {
+        return MYSTRING_ERROR;
+    }
+    MyString temp = *str1;
+    *str1 = *str2;
+    *str2 = temp;
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Hands the chars of str over to the caller, leaving str as an empty string.
+ * @param str
+ * @param length pointer to set to the number of chars.
+ * RETURN VALUE:
+ *  @return the chars, or NULL on failure.
+ *
+ *  Complexity: O(1).
+ */
+char * myStringDetach(MyString *str, unsigned long *length)
+{
+    if (str == NULL || length == NULL)
+    {
+        return NULL;
+    }
+    // A string without a block of its own has nothing to hand over, so the caller
+    // gets a new one which it may free like any other.
+    if (ownMyStringChars(str) == MYSTRING_ERROR)
+    {
+        return NULL;
+    }
+    // The block isn't the library's anymore.
+    STATS_CHARS_BLOCK(str, -1);
+    STATS_BYTES(-(long) str -> _capacity);
+    char *chars = str -> _chars;
+    *length = str -> _length;
+    str -> _chars = noChars;
+    str -> _length = EMPTY_STRING_LENGTH;
+    str -> _capacity = 0;
+    return chars;
+}
+
+/**
+ * @brief Returns the value of str as a C string without copying it.
+ * @param str
+ * RETURN VALUE:
+ *  @return the C string, or NULL if str is NULL.
+ *
+ *  Complexity: O(1) since the chars are always terminated by '\0'.
+ */
+const char * myStringCStr(const MyString *str)
+{
+    if (str == NULL)
+    {
+        return NULL;
+    }
+    return str -> _chars;
+}
+
+/**
+ * @brief Returns the values of n strings as C strings, packed in a single allocation
+ * which is freed by a single call to free().
+ * @param strs
+ * @param n
+ * RETURN VALUE:
+ *  @return the array of C strings, or NULL on failure.
+ *
+ *  Complexity: O(n + m) where m is the total length of the strings - a single
+ *  allocation and a single copy of each string.
+ */
+char ** myStringToCStrings(const MyString *strs[], unsigned long n)
+{
+    if (strs == NULL)
+    {
+        return NULL;
+    }
+    unsigned long charsSize = 0;
+    for (unsigned long i = 0; i < n; i++)
+    {
+        if (strs[i] == NULL)
+        {
+            return NULL;
+        }
+        charsSize += strs[i] -> _length + 1;
+    }
+    // The pointers come first so they stay aligned, the chars follow them.
+    char **cStrings = (char **) malloc(n * sizeof(char *) + charsSize * sizeof(char));
+    if (cStrings == NULL)
+    {
+        return NULL;
+    }
+    char *chars = (char *) (cStrings + n);
+    for (unsigned long i = 0; i < n; i++)
+    {
+        // Copying the '\0' as well.
+        memcpy(chars, strs[i] -> _chars, strs[i] -> _length + 1);
+        cStrings[i] = chars;
+        chars += strs[i] -> _length + 1;
+    }
+    return cStrings;
+}
+
+/**
+ * @brief Allocates a new MyString whose value is the content of a file, mapped to
+ * 	memory rather than read.
+ * @param path
+ * RETURN VALUE:
+ *  @return the new MyString, or NULL on failure.
+ *
+ *  Complexity: O(1) - the chars are read by the OS only when they are first used,
+ *  and copied (O(n)) only if the string is changed.
+ */
+MyString * myStringMapFile(const char *path)
+{
+    if (path == NULL)
+    {
+        return NULL;
+    }
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    struct stat fileStat;
+    MyString *str = NULL;
+    unsigned long structSize = sizeof(MyString);
+    if (fstat(fd, &fileStat) == 0 && S_ISREG(fileStat.st_mode))
+    {
+        str = (MyString *) allocateBlock(&structSize);
+    }
+    if (str != NULL)
+    {
+        STATS_ALLOCATION(false);
+        str -> _chars = noChars;
+        str -> _length = EMPTY_STRING_LENGTH;
+        str -> _capacity = 0;
+        str -> _mappedSize = 0;
+        // An empty file has nothing to map.
+        if (fileStat.st_size > 0 &&
+            mapFileChars(str, fd, (unsigned long) fileStat.st_size) == MYSTRING_ERROR)
+        {
+            releaseBlock(str, structSize);
+            str = NULL;
+        }
+    }
+    if (str != NULL)
+    {
+        STATS_ADD(libraryStats._liveStrings, 1);
+    }
+    // The mapping stays valid after the file is closed.
+    close(fd);
+    return str;
+}
+
+/**
+ * @brief Gets the library-wide memory counters.
+ * @param stats the counters to set.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(1). The counters are read one by one while other threads may
+ *  change them, so they may be slightly apart from each other.
+ */
+MyStringRetVal myStringStats(MyStringStats *stats)
+{
+#ifdef MYSTRING_STATS
+    if (stats == NULL)
+    {
+        return MYSTRING_ERROR;
+    }
+    stats -> _liveStrings = STATS_LOAD(libraryStats._liveStrings);
+    stats -> _liveBytes = STATS_LOAD(libraryStats._liveBytes);
+    stats -> _peakBytes = STATS_LOAD(libraryStats._peakBytes);
+    stats -> _cachedBytes = STATS_LOAD(libraryStats._cachedBytes);
+    stats -> _mappedBytes = STATS_LOAD(libraryStats._mappedBytes);
+    for (int site = 0; site < MYSTRING_SITES; site++)
+    {
+        stats -> _allocations[site] = STATS_LOAD(libraryStats._allocations[site]);
+        stats -> _reallocations[site] = STATS_LOAD(libraryStats._reallocations[site]);
+    }
+    unsigned long capacity = STATS_LOAD(charsCapacity);
+    unsigned long used = STATS_LOAD(charsUsed);
+    stats -> _slackBytes = capacity > used ? capacity - used : 0;
+    return MYSTRING_SUCCESS;
+#else
+    (void) stats;
+    return MYSTRING_ERROR;
+#endif
+}
+
+/**
+ * @brief Writes the library-wide memory counters to stream.
+ * @param stream
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(1).
+ */
+MyStringRetVal myStringStatsDump(FILE *stream)
+{
+    MyStringStats stats;
+    if (stream == NULL || myStringStats(&stats) == MYSTRING_ERROR)
+    {
+        return MYSTRING_ERROR;
+    }
+    fprintf(stream, "MyString: %lu strings, %lu bytes (peak %lu), %lu slack, %lu cached, "
+            "%lu mapped\n", stats._liveStrings, stats._liveBytes, stats._peakBytes,
+            stats._slackBytes, stats._cachedBytes, stats._mappedBytes);
+#ifdef MYSTRING_STATS
+    for (int site = 0; site < MYSTRING_SITES; site++)
+    {
+        fprintf(stream, "  %s: %lu allocations, %lu reallocations\n", statsSiteNames[site],
+                stats._allocations[site], stats._reallocations[site]);
+    }
+#endif
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Dumps the counters to stream every period allocations and reallocations.
+ * @param stream
+ * @param period
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(1).
+ */
+MyStringRetVal myStringStatsSetDump(FILE *stream, unsigned long period)
+{
+#ifdef MYSTRING_STATS
+    if (stream == NULL)
+    {
+        period = 0;
+    }
+    statsDumpStream = stream;
+    __atomic_store_n(&statsDumpCountdown, period, __ATOMIC_RELAXED);
+    __atomic_store_n(&statsDumpPeriod, period, __ATOMIC_RELAXED);
+    return MYSTRING_SUCCESS;
+#else
+    (void) stream;
+    (void) period;
+    return MYSTRING_ERROR;
+#endif
+}
+
+/**
+ * @brief Sets the options of myStringExternalSort to their defaults.
+ * @param options
+ *
+ *  Complexity: O(1).
+ */
+void myStringExternalSortDefaults(MyStringExternalSortOptions *options)
+{
+    if (options == NULL)
+    {
+        return;
+    }
+    options -> _format = MYSTRING_RECORDS_LINES;
+    options -> _mode = MYSTRING_MERGE_ALL;
+    options -> _memoryBudget = EXTERNAL_SORT_DEFAULT_BUDGET;
+    options -> _bufferSize = EXTERNAL_SORT_DEFAULT_BUFFER;
+    options -> _tempDir = NULL;
+}
+
+/**
+ * @brief Sorts the strings of in to out by myStringCompare, in sorted runs which fit in
+ * 	the memory budget, merged by a loser tree.
+ * @param in
+ * @param out
+ * @param options
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(N log N) comparisons where N is the number of strings, and
+ *  O(log_k R) passes over the runs, where R is the number of runs and k the number
+ *  of buffers which fit in the budget. Every pass reads and writes sequentially.
+ */
+MyStringRetVal myStringExternalSort(FILE *in, FILE *out, const MyStringExternalSortOptions *options)
+{
+    if (in == NULL || out == NULL || options == NULL || options -> _memoryBudget == 0 ||
+        options -> _bufferSize == 0 || options -> _format > MYSTRING_RECORDS_LENGTH_PREFIXED ||
+        options -> _mode > MYSTRING_MERGE_COUNT)
+    {
+        return MYSTRING_ERROR;
+    }
+    RecordReader reader;
+    if (initRecordReader(&reader, in, options -> _format, false,
+                         options -> _bufferSize) == MYSTRING_ERROR)
+    {
+        return MYSTRING_ERROR;
+    }
+    RunFile runs = {NULL, NULL, 0, 0};
+    MyStringRetVal result = createSortedRuns(&reader, out, options, &runs);
+    free(reader._buffer);
+    // Without runs all the strings were sorted in memory and written already.
+    if (result == MYSTRING_SUCCESS && runs._count > 0)
+    {
+        result = mergeAllRuns(&runs, out, options);
+    }
+    closeRunFile(&runs);
+    if (ferror(in) || ferror(out))
+    {
+        return MYSTRING_ERROR;
+    }
+    return result;
+}
+
+/**
+ * @brief Computes the edit distance between two strings.
+ * @param str1
+ * @param str2
+ * @param distance
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(ceil(m / w) * n) where m is the length of the shorter string, n of
+ *  the longer one and w the bits of a word, after their common prefix and suffix.
+ */
+MyStringRetVal myStringEditDistance(const MyString *str1, const MyString *str2,
+                                    unsigned long *distance)
+{
+    if (str1 == NULL || str2 == NULL || distance == NULL)
+    {
+        return MYSTRING_ERROR;
+    }
+    return computeEditDistance(str1 -> _chars, str1 -> _length, str2 -> _chars,
+                               str2 -> _length, ULONG_MAX, distance);
+}
+
+/**
+ * @brief Checks if the edit distance between two strings is at most k.
+ * @param str1
+ * @param str2
+ * @param k
+ * RETURN VALUE:
+ *  @return TRUE if the distance is at most k, FALSE if it's bigger, and
+ *  	MYSTR_ERROR_CODE on failure.
+ *
+ *  Complexity: O(ceil(m / w) * n) at worst, and O(1) when the lengths differ by more
+ *  than k.
+ */
+int myStringEditDistanceAtMost(const MyString *str1, const MyString *str2, unsigned long k)
+{
+    unsigned long distance = 0;
+    if (str1 == NULL || str2 == NULL ||
+        computeEditDistance(str1 -> _chars, str1 -> _length, str2 -> _chars, str2 -> _length,
+                            k, &distance) == MYSTRING_ERROR)
+    {
+        return MYSTR_ERROR_CODE;
+    }
+    return distance <= k ? TRUE : FALSE;
+}
+
+/**
+ * @brief Compiles a string for computing its edit distance to many strings.
+ * @param str
+ * RETURN VALUE:
+ *  @return the pattern, or NULL on failure.
+ *
+ *  Complexity: O(m) where m is the length of the string.
+ */
+MyStringEditPattern * myStringEditPatternAlloc(const MyString *str)
+{
+    if (str == NULL)
+    {
+        return NULL;
+    }
+    MyStringEditPattern *pattern = (MyStringEditPattern *) malloc(sizeof(MyStringEditPattern));
+    if (pattern == NULL)
+    {
+        return NULL;
+    }
+    pattern -> _length = str -> _length;
+    pattern -> _words = (str -> _length + EDIT_WORD_BITS - 1) / EDIT_WORD_BITS;
+    // An empty pattern still gets a block, so it's never confused with a failure.
+    unsigned long maskCount = (pattern -> _words > 0 ? pattern -> _words : 1) * EDIT_MASKS;
+    pattern -> _masks = (unsigned long long *) calloc(maskCount, sizeof(unsigned long long));
+    if (pattern -> _masks == NULL)
+    {
+        free(pattern);
+        return NULL;
+    }
+    setEditMasks(pattern, str -> _chars);
+    return pattern;
+}
+
+/**
+ * @brief Frees a pattern.
+ * @param pattern
+ *
+ *  Complexity: O(1).
+ */
+void myStringEditPatternFree(MyStringEditPattern *pattern)
+{
+    if (pattern == NULL)
+    {
+        return;
+    }
+    free(pattern -> _masks);
+    free(pattern);
+}
+
+/**
+ * @brief Computes the edit distances between a pattern and n strings, up to a bound.
+ * @param pattern
+ * @param strs
+ * @param n
+ * @param maxDistance
+ * @param distances
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(ceil(m / w) * N) where N is the total length of the strings, and the
+ *  masks of the pattern are computed only once.
+ */
+MyStringRetVal myStringEditPatternDistances(const MyStringEditPattern *pattern,
+                                            const MyString *strs[], unsigned long n,
+                                            unsigned long maxDistance, unsigned long distances[])
+{
+    if (pattern == NULL || ((strs == NULL || distances == NULL) && n > 0))
+    {
+        return MYSTRING_ERROR;
+    }
+    unsigned long long wordBlocks[2];
+    unsigned long long *blocks = wordBlocks;
+    if (pattern -> _words > 1)
+    {
+        blocks = (unsigned long long *) malloc(2 * pattern -> _words * sizeof(unsigned long long));
+        if (blocks == NULL)
+        {
+            return MYSTRING_ERROR;
+        }
+    }
+    MyStringRetVal result = MYSTRING_SUCCESS;
+    for (unsigned long i = 0; i < n && result == MYSTRING_SUCCESS; i++)
+    {
+        if (strs[i] == NULL)
+        {
+            result = MYSTRING_ERROR;
+            break;
+        }
+        distances[i] = runEditDistance(pattern, strs[i] -> _chars, strs[i] -> _length,
+                                       maxDistance, blocks);
+    }
+    if (blocks != wordBlocks)
+    {
+        free(blocks);
+    }
+    return result;
+}
+
+/**
+ * @brief Appends the bytes of a view to str as hex.
+ * @param str
+ * @param bytes
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(n) where n is the number of bytes, 16 at a time with SSE2, written
+ *  straight after the chars of str.
+ */
+MyStringRetVal myStringAppendHex(MyString *str, MyStringView bytes)
+{
+    char *hex = NULL;
+    if (str == NULL || (bytes._chars == NULL && bytes._length != EMPTY_STRING_LENGTH) ||
+        growMyString(str, &bytes, bytes._length * HEX_CHARS_PER_BYTE, &hex) == MYSTRING_ERROR)
+    {
+        return MYSTRING_ERROR;
+    }
+    encodeHex(hex, (const unsigned char *) bytes._chars, bytes._length);
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Appends to str the bytes whose hex is the chars of a view.
+ * @param str
+ * @param hex
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(n) where n is the number of chars, 32 at a time with SSE2, checked
+ *  while they are decoded.
+ */
+MyStringRetVal myStringAppendFromHex(MyString *str, MyStringView hex)
+{
+    MyStringCodecStream stream;
+    myStringCodecStreamInit(&stream);
+    return myStringAppendFromHexStream(str, hex, &stream, true);
+}
+
+/**
+ * @brief Appends the bytes of a view to str as base64.
+ * @param str
+ * @param bytes
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(n) where n is the number of bytes, 12 at a time with SSSE3.
+ */
+MyStringRetVal myStringAppendBase64(MyString *str, MyStringView bytes)
+{
+    MyStringCodecStream stream;
+    myStringCodecStreamInit(&stream);
+    return myStringAppendBase64Stream(str, bytes, &stream, true);
+}
+
+/**
+ * @brief Appends to str the bytes whose base64 is the chars of a view.
+ * @param str
+ * @param base64
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(n) where n is the number of chars, 16 at a time with SSSE3, checked
+ *  while they are decoded.
+ */
+MyStringRetVal myStringAppendFromBase64(MyString *str, MyStringView base64)
+{
+    MyStringCodecStream stream;
+    myStringCodecStreamInit(&stream);
+    return myStringAppendFromBase64Stream(str, base64, &stream, true);
+}
+
+/**
+ * @brief Sets up a stream for converting a payload in chunks.
+ * @param stream
+ *
+ *  Complexity: O(1).
+ */
+void myStringCodecStreamInit(MyStringCodecStream *stream)
+{
+    if (stream == NULL)
+    {
+        return;
+    }
+    stream -> _carryLength = 0;
+    stream -> _isPadded = false;
+}
+
+/**
+ * @brief Appends to str the bytes of the hex of a chunk of a payload.
+ * @param str
+ * @param chunk
+ * @param stream
+ * @param isLast
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(n) where n is the number of chars of the chunk.
+ */
+MyStringRetVal myStringAppendFromHexStream(MyString *str, MyStringView chunk,
+                                           MyStringCodecStream *stream, bool isLast)
+{
+    if (str == NULL || stream == NULL ||
+        (chunk._chars == NULL && chunk._length != EMPTY_STRING_LENGTH))
+    {
+        return MYSTRING_ERROR;
+    }
+    unsigned long available = stream -> _carryLength + chunk._length;
+    if (isLast && available % HEX_CHARS_PER_BYTE != 0)
+    {
+        return MYSTRING_ERROR;
+    }
+    unsigned long oldLength = str -> _length;
+    char *bytes = NULL;
+    if (growMyString(str, &chunk, available / HEX_CHARS_PER_BYTE, &bytes) == MYSTRING_ERROR)
+    {
+        return MYSTRING_ERROR;
+    }
+    bool isValid = true;
+    // A digit left from the last chunk makes a byte with the first of this one.
+    if (stream -> _carryLength > 0 && chunk._length > 0)
+    {
+        stream -> _carry[1] = *chunk._chars;
+        isValid = decodeHex((unsigned char *) bytes, stream -> _carry, 1);
+        bytes++;
+        chunk._chars++;
+        chunk._length--;
+        stream -> _carryLength = 0;
+    }
+    unsigned long length = chunk._length / HEX_CHARS_PER_BYTE;
+    isValid = isValid && decodeHex((unsigned char *) bytes, chunk._chars, length);
+    if (!isValid)
+    {
+        setMyStringLength(str, oldLength);
+        return MYSTRING_ERROR;
+    }
+    if (chunk._length % HEX_CHARS_PER_BYTE != 0)
+    {
+        stream -> _carry[0] = chunk._chars[chunk._length - 1];
+        stream -> _carryLength = 1;
+    }
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Appends to str the base64 of a chunk of a payload.
+ * @param str
+ * @param chunk
+ * @param stream
+ * @param isLast
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(n) where n is the number of bytes of the chunk.
+ */
+MyStringRetVal myStringAppendBase64Stream(MyString *str, MyStringView chunk,
+                                          MyStringCodecStream *stream, bool isLast)
+{
+    if (str == NULL || stream == NULL ||
+        (chunk._chars == NULL && chunk._length != EMPTY_STRING_LENGTH))
+    {
+        return MYSTRING_ERROR;
+    }
+    unsigned long available = stream -> _carryLength + chunk._length;
+    unsigned long groups = available / BASE64_GROUP_BYTES;
+    bool hasTail = isLast && available % BASE64_GROUP_BYTES != 0;
+    char *base64 = NULL;
+    if (growMyString(str, &chunk, (groups + hasTail) * BASE64_GROUP_CHARS,
+                     &base64) == MYSTRING_ERROR)
+    {
+        return MYSTRING_ERROR;
+    }
+    // The bytes left from the last chunk make a group with the first of this one.
+    if (stream -> _carryLength > 0 && groups > 0)
+    {
+        unsigned long missing = BASE64_GROUP_BYTES - stream -> _carryLength;
+        memcpy(stream -> _carry + stream -> _carryLength, chunk._chars, missing);
+        encodeBase64(base64, (const unsigned char *) stream -> _carry, 1);
+        base64 += BASE64_GROUP_CHARS;
+        chunk._chars += missing;
+        chunk._length -= missing;
+        stream -> _carryLength = 0;
+        groups--;
+    }
+    encodeBase64(base64, (const unsigned char *) chunk._chars, groups);
+    base64 += groups * BASE64_GROUP_CHARS;
+    unsigned long rest = chunk._length - groups * BASE64_GROUP_BYTES;
+    memcpy(stream -> _carry + stream -> _carryLength, chunk._chars + groups * BASE64_GROUP_BYTES,
+           rest);
+    stream -> _carryLength += rest;
+    if (hasTail)
+    {
+        encodeBase64Tail(base64, (const unsigned char *) stream -> _carry, stream -> _carryLength);
+        stream -> _carryLength = 0;
+    }
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Appends to str the bytes of the base64 of a chunk of a payload.
+ * @param str
+ * @param chunk
+ * @param stream
+ * @param isLast
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(n) where n is the number of chars of the chunk.
+ */
+MyStringRetVal myStringAppendFromBase64Stream(MyString *str, MyStringView chunk,
+                                              MyStringCodecStream *stream, bool isLast)
+{
+    if (str == NULL || stream == NULL ||
+        (chunk._chars == NULL && chunk._length != EMPTY_STRING_LENGTH))
+    {
+        return MYSTRING_ERROR;
+    }
+    unsigned long available = stream -> _carryLength + chunk._length;
+    unsigned long groups = available / BASE64_GROUP_CHARS;
+    unsigned long rest = available % BASE64_GROUP_CHARS;
+    // Nothing may follow the padding, and the payload must end with a whole group.
+    if ((stream -> _isPadded && chunk._length > 0) || (isLast && rest != 0))
+    {
+        return MYSTRING_ERROR;
+    }
+    unsigned long oldLength = str -> _length;
+    char *bytes = NULL;
+    if (growMyString(str, &chunk, groups * BASE64_GROUP_BYTES, &bytes) == MYSTRING_ERROR)
+    {
+        return MYSTRING_ERROR;
+    }
+    bool isValid = true;
+    unsigned long written = 0;
+    unsigned long length = 0;
+    if (stream -> _carryLength > 0 && groups > 0)
+    {
+        unsigned long missing = BASE64_GROUP_CHARS - stream -> _carryLength;
+        memcpy(stream -> _carry + stream -> _carryLength, chunk._chars, missing);
+        isValid = decodeBase64((unsigned char *) bytes, stream -> _carry, 1, &written);
+        chunk._chars += missing;
+        chunk._length -= missing;
+        stream -> _carryLength = 0;
+        groups--;
+        stream -> _isPadded = written < BASE64_GROUP_BYTES;
+    }
+    if (isValid && groups > 0)
+    {
+        isValid = !stream -> _isPadded &&
+                  decodeBase64((unsigned char *) bytes + written, chunk._chars, groups, &length);
+        written += length;
+        stream -> _isPadded = length < groups * BASE64_GROUP_BYTES;
+    }
+    rest = chunk._length - groups * BASE64_GROUP_CHARS;
+    if (!isValid || (stream -> _isPadded && rest > 0))
+    {
+        setMyStringLength(str, oldLength);
+        return MYSTRING_ERROR;
+    }
+    memcpy(stream -> _carry + stream -> _carryLength, chunk._chars + groups * BASE64_GROUP_CHARS,
+           rest);
+    stream -> _carryLength += rest;
+    setMyStringLength(str, oldLength + written);
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Builds a symbol table for compressing strings like the given ones.
+ * @param strs
+ * @param n
+ * RETURN VALUE:
+ *  @return the table, or NULL on failure.
+ *
+ *  Complexity: O(n + s * r) where s is the size of the sample, at most
+ *  SYMBOL_TRAIN_SAMPLE_CHARS, and r is the number of rounds.
+ */
+MyStringSymbolTable * myStringSymbolTableTrain(const MyString *strs[], unsigned long n)
+{
+    if (strs == NULL && n > 0)
+    {
+        return NULL;
+    }
+    unsigned long total = 0;
+    for (unsigned long i = 0; i < n; i++)
+    {
+        if (strs[i] == NULL)
+        {
+            return NULL;
+        }
+        total += strs[i] -> _length;
+    }
+    MyStringSymbolTable *table = (MyStringSymbolTable *) calloc(1, sizeof(MyStringSymbolTable));
+    unsigned int *counts = (unsigned int *) malloc((SYMBOL_TRAIN_CODES + 1) * SYMBOL_TRAIN_CODES *
+                                                   sizeof(unsigned int));
+    if (table == NULL || counts == NULL)
+    {
+        free(table);
+        free(counts);
+        return NULL;
+    }
+    // Spread the sample over the strings, rather than taking the first of them.
+    unsigned long step = total / SYMBOL_TRAIN_SAMPLE_CHARS + 1;
+    for (int round = 0; round < SYMBOL_TRAIN_ROUNDS && table != NULL; round++)
+    {
+        memset(counts, 0, (SYMBOL_TRAIN_CODES + 1) * SYMBOL_TRAIN_CODES * sizeof(unsigned int));
+        unsigned long sampled = 0;
+        for (unsigned long i = 0; i < n && sampled < SYMBOL_TRAIN_SAMPLE_CHARS; i += step)
+        {
+            unsigned long length = strs[i] -> _length;
+            if (length > SYMBOL_TRAIN_SAMPLE_CHARS - sampled)
+            {
+                length = SYMBOL_TRAIN_SAMPLE_CHARS - sampled;
+            }
+            countSymbolCodes(table, (const unsigned char *) strs[i] -> _chars, length, counts);
+            sampled += length;
+        }
+        if (rebuildSymbolTable(table, counts) == MYSTRING_ERROR)
+        {
+            free(table);
+            table = NULL;
+        }
+    }
+    free(counts);
+    return table;
+}
+
+/**
+ * @brief Frees a symbol table.
+ * @param table
+ *
+ *  Complexity: O(1).
+ */
+void myStringSymbolTableFree(MyStringSymbolTable *table)
+{
+    free(table);
+}
+
+/**
+ * @brief Appends the compressed chars of a view to str.
+ * @param table
+ * @param str
+ * @param view
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(n * k) where n is the length of the view and k is the number of
+ *  symbols which start with the same char, usually a few.
+ */
+MyStringRetVal myStringAppendCompressed(const MyStringSymbolTable *table, MyString *str,
+                                        MyStringView view)
+{
+    if (table == NULL || str == NULL ||
+        (view._chars == NULL && view._length != EMPTY_STRING_LENGTH))
+    {
+        return MYSTRING_ERROR;
+    }
+    unsigned long oldLength = str -> _length;
+    unsigned char codes[SYMBOL_CODES_BUFFER];
+    unsigned long i = 0;
+    while (i < view._length)
+    {
+        const unsigned char *chars = (const unsigned char *) view._chars;
+        unsigned long written = 0;
+        // Every char takes at most two compressed chars.
+        while (i < view._length && written + 2 <= SYMBOL_CODES_BUFFER)
+        {
+            unsigned int symbolLength = 0;
+            unsigned int code = findSymbol(table, chars + i, view._length - i, &symbolLength);
+            codes[written++] = (unsigned char) code;
+            if (code == SYMBOL_ESCAPE)
+            {
+                codes[written++] = chars[i];
+            }
+            i += symbolLength;
+        }
+        char *room = NULL;
+        if (growMyString(str, &view, written, &room) == MYSTRING_ERROR)
+        {
+            setMyStringLength(str, oldLength);
+            return MYSTRING_ERROR;
+        }
+        memcpy(room, codes, written);
+    }
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Appends to str the chars of a view compressed by the table.
+ * @param table
+ * @param str
+ * @param compressed
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(n) where n is the length of the decompressed chars, up to 8 of which
+ *  are copied at once.
+ */
+MyStringRetVal myStringAppendDecompressed(const MyStringSymbolTable *table, MyString *str,
+                                          MyStringView compressed)
+{
+    unsigned long length = 0;
+    char *room = NULL;
+    if (table == NULL || str == NULL ||
+        (compressed._chars == NULL && compressed._length != EMPTY_STRING_LENGTH) ||
+        !getDecompressedLength(table, (const unsigned char *) compressed._chars,
+                               compressed._length, &length) ||
+        growMyString(str, &compressed, length, &room) == MYSTRING_ERROR)
+    {
+        return MYSTRING_ERROR;
+    }
+    decompressSymbols(table, (const unsigned char *) compressed._chars, compressed._length, room,
+                      length, &length);
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Decompresses the chars of a view compressed by the table into a buffer.
+ * @param table
+ * @param compressed
+ * @param buffer
+ * @param size
+ * @param decompressed
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(n) where n is the length of the decompressed chars, in a single pass
+ *  which checks them too.
+ */
+MyStringRetVal myStringDecompressInto(const MyStringSymbolTable *table, MyStringView compressed,
+                                      char *buffer, unsigned long size,
+                                      MyStringView *decompressed)
+{
+    unsigned long length = 0;
+    if (table == NULL || decompressed == NULL || (buffer == NULL && size > 0) ||
+        (compressed._chars == NULL && compressed._length != EMPTY_STRING_LENGTH) ||
+        !decompressSymbols(table, (const unsigned char *) compressed._chars, compressed._length,
+                           buffer, size, &length))
+    {
+        return MYSTRING_ERROR;
+    }
+    decompressed -> _chars = buffer;
+    decompressed -> _length = length;
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Hashes the chars of a view to 64 bits.
+ * @param view
+ * RETURN VALUE:
+ *  @return the hash.
+ *
+ *  Complexity: O(n) where n is the length of the view, 8 chars at a time.
+ */
+unsigned long long myStringHashView(MyStringView view)
+{
+    const unsigned char *chars = (const unsigned char *) view._chars;
+    unsigned long long hash = HASH_PRIME5 + view._length;
+    unsigned long i = 0;
+    for (; i + WORD_SIZE <= view._length; i += WORD_SIZE)
+    {
+        hash = mixHashWord(hash, readHashWord(chars + i, WORD_SIZE));
+    }
+    if (i < view._length)
+    {
+        hash = mixHashWord(hash, readHashWord(chars + i, view._length - i));
+    }
+    return avalancheHash(hash);
+}
+
+/**
+ * @brief Hashes a string as myStringHashView hashes its chars.
+ * @param str
+ * RETURN VALUE:
+ *  @return the hash.
+ *
+ *  Complexity: O(n) where n is the length of the string.
+ */
+unsigned long long myStringHash(const MyString *str)
+{
+    MyStringView view = {NULL, EMPTY_STRING_LENGTH};
+    if (str != NULL)
+    {
+        view = myStringGetView(str);
+    }
+    return myStringHashView(view);
+}
+
+/**
+ * @brief Allocates an empty Bloom filter for the given number of strings.
+ * @param expected
+ * @param bitsPerKey
+ * RETURN VALUE:
+ *  @return the filter, or NULL on failure.
+ *
+ *  Complexity: O(m) where m is the size of the filter, which is cleared.
+ */
+MyStringBloomFilter * myStringBloomFilterAlloc(unsigned long expected, unsigned int bitsPerKey)
+{
+    if (bitsPerKey == 0)
+    {
+        return NULL;
+    }
+    unsigned long long bits = (unsigned long long) expected * bitsPerKey;
+    unsigned long long blocks = (bits + BLOOM_BLOCK_BITS - 1) / BLOOM_BLOCK_BITS;
+    blocks = blocks > 0 ? blocks : 1;
+    blocks = blocks < BLOOM_MAX_BLOCKS ? blocks : BLOOM_MAX_BLOCKS;
+    unsigned int probes = bitsPerKey * BLOOM_PROBES_PER_100_BITS / 100;
+    probes = probes > BLOOM_MIN_PROBES ? probes : BLOOM_MIN_PROBES;
+    probes = probes < BLOOM_MAX_PROBES ? probes : BLOOM_MAX_PROBES;
+    return allocBloomFilter(blocks, probes);
+}
+
+/**
+ * @brief Frees a Bloom filter.
+ * @param filter
+ *
+ *  Complexity: O(1).
+ */
+void myStringBloomFilterFree(MyStringBloomFilter *filter)
+{
+    if (filter == NULL)
+    {
+        return;
+    }
+    free(filter -> _words);
+    free(filter);
+}
+
+/**
+ * @brief Adds the chars of a view to a Bloom filter.
+ * @param filter
+ * @param key
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(n + k) where n is the length of the key and k is the number of bits
+ *  it sets, all in one cache line.
+ */
+MyStringRetVal myStringBloomFilterAdd(MyStringBloomFilter *filter, MyStringView key)
+{
+    return myStringBloomFilterAddBatch(filter, &key, 1);
+}
+
+/**
+ * @brief Checks if the chars of a view may have been added to a Bloom filter.
+ * @param filter
+ * @param key
+ * RETURN VALUE:
+ *  @return FALSE if they were surely not added, TRUE if they may have been, and
+ *  	MYSTR_ERROR_CODE on failure.
+ *
+ *  Complexity: O(n + k) where n is the length of the key and k is the number of bits
+ *  it checks, all in one cache line.
+ */
+int myStringBloomFilterContains(const MyStringBloomFilter *filter, MyStringView key)
+{
+    bool result = false;
+    if (myStringBloomFilterContainsBatch(filter, &key, 1, &result) == MYSTRING_ERROR)
+    {
+        return MYSTR_ERROR_CODE;
+    }
+    return result ? TRUE : FALSE;
+}
+
+/**
+ * @brief Adds n keys to a Bloom filter.
+ * @param filter
+ * @param keys
+ * @param n
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(l + n * k) where l is the total length of the keys, with the lines
+ *  of FILTER_BATCH_KEYS keys fetched at once.
+ */
+MyStringRetVal myStringBloomFilterAddBatch(MyStringBloomFilter *filter, const MyStringView keys[],
+                                           unsigned long n)
+{
+    if (filter == NULL || (keys == NULL && n > 0))
+    {
+        return MYSTRING_ERROR;
+    }
+    unsigned long long hashes[FILTER_BATCH_KEYS];
+    for (unsigned long start = 0; start < n; start += FILTER_BATCH_KEYS)
+    {
+        unsigned long batch = n - start < FILTER_BATCH_KEYS ? n - start : FILTER_BATCH_KEYS;
+        for (unsigned long i = 0; i < batch; i++)
+        {
+            if (keys[start + i]._chars == NULL && keys[start + i]._length != EMPTY_STRING_LENGTH)
+            {
+                return MYSTRING_ERROR;
+            }
+            hashes[i] = myStringHashView(keys[start + i]);
+            PREFETCH(getBloomBlock(filter, hashes[i]));
+        }
+        for (unsigned long i = 0; i < batch; i++)
+        {
+            addBloomHash(filter, hashes[i]);
+        }
+    }
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Checks n keys against a Bloom filter.
+ * @param filter
+ * @param keys
+ * @param n
+ * @param results
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(l + n * k) where l is the total length of the keys, with the lines
+ *  of FILTER_BATCH_KEYS keys fetched at once.
+ */
+MyStringRetVal myStringBloomFilterContainsBatch(const MyStringBloomFilter *filter,
+                                                const MyStringView keys[], unsigned long n,
+                                                bool results[])
+{
+    if (filter == NULL || ((keys == NULL || results == NULL) && n > 0))
+    {
+        return MYSTRING_ERROR;
+    }
+    unsigned long long hashes[FILTER_BATCH_KEYS];
+    for (unsigned long start = 0; start < n; start += FILTER_BATCH_KEYS)
+    {
+        unsigned long batch = n - start < FILTER_BATCH_KEYS ? n - start : FILTER_BATCH_KEYS;
+        for (unsigned long i = 0; i < batch; i++)
+        {
+            if (keys[start + i]._chars == NULL && keys[start + i]._length != EMPTY_STRING_LENGTH)
+            {
+                return MYSTRING_ERROR;
+            }
+            hashes[i] = myStringHashView(keys[start + i]);
+            PREFETCH(getBloomBlock(filter, hashes[i]));
+        }
+        for (unsigned long i = 0; i < batch; i++)
+        {
+            results[start + i] = containsBloomHash(filter, hashes[i]);
+        }
+    }
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Writes a Bloom filter to a stream.
+ * @param filter
+ * @param stream
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(m) where m is the size of the filter.
+ */
+MyStringRetVal myStringBloomFilterWrite(const MyStringBloomFilter *filter, FILE *stream)
+{
+    if (filter == NULL || stream == NULL ||
+        fwrite(BLOOM_MAGIC, sizeof(char), FILTER_MAGIC_LENGTH, stream) != FILTER_MAGIC_LENGTH ||
+        !writeFilterNumber(stream, filter -> _blocks, FILTER_NUMBER_BYTES) ||
+        !writeFilterNumber(stream, filter -> _probes, FILTER_NUMBER_BYTES))
+    {
+        return MYSTRING_ERROR;
+    }
+    for (unsigned long long i = 0; i < filter -> _blocks * BLOOM_BLOCK_WORDS; i++)
+    {
+        if (!writeFilterNumber(stream, filter -> _words[i], WORD_SIZE))
+        {
+            return MYSTRING_ERROR;
+        }
+    }
+    return fflush(stream) == 0 ? MYSTRING_SUCCESS : MYSTRING_ERROR;
+}
+
+/**
+ * @brief Reads a Bloom filter written by myStringBloomFilterWrite.
+ * @param stream
+ * RETURN VALUE:
+ *  @return the filter, or NULL on failure.
+ *
+ *  Complexity: O(m) where m is the size of the filter.
+ */
+MyStringBloomFilter * myStringBloomFilterRead(FILE *stream)
+{
+    unsigned long long blocks = 0;
+    unsigned long long probes = 0;
+    if (stream == NULL || !readFilterMagic(stream, BLOOM_MAGIC) ||
+        !readFilterNumber(stream, FILTER_NUMBER_BYTES, &blocks) ||
+        !readFilterNumber(stream, FILTER_NUMBER_BYTES, &probes) ||
+        blocks == 0 || blocks > BLOOM_MAX_BLOCKS ||
+        probes < BLOOM_MIN_PROBES || probes > BLOOM_MAX_PROBES)
+    {
+        return NULL;
+    }
+    MyStringBloomFilter *filter = allocBloomFilter(blocks, (unsigned int) probes);
+    if (filter == NULL)
+    {
+        return NULL;
+    }
+    for (unsigned long long i = 0; i < blocks * BLOOM_BLOCK_WORDS; i++)
+    {
+        if (!readFilterNumber(stream, WORD_SIZE, &filter -> _words[i]))
+        {
+            myStringBloomFilterFree(filter);
+            return NULL;
+        }
+    }
+    return filter;
+}
+
+/**
+ * @brief Allocates an empty cuckoo filter with room for at least capacity strings.
+ * @param capacity
+ * RETURN VALUE:
+ *  @return the filter, or NULL on failure.
+ *
+ *  Complexity: O(m) where m is the size of the filter, which is cleared.
+ */
+MyStringCuckooFilter * myStringCuckooFilterAlloc(unsigned long capacity)
+{
+    if (capacity > ULONG_MAX / PERCENT)
+    {
+        return NULL;
+    }
+    unsigned long long slots = (unsigned long long) capacity * PERCENT / CUCKOO_MAX_LOAD_PERCENT + 1;
+    unsigned long long buckets = 1;
+    while (buckets * CUCKOO_BUCKET_SLOTS < slots)
+    {
+        buckets *= 2;
+    }
+    return allocCuckooFilter(buckets);
+}
+
+/**
+ * @brief Frees a cuckoo filter.
+ * @param filter
+ *
+ *  Complexity: O(1).
+ */
+void myStringCuckooFilterFree(MyStringCuckooFilter *filter)
+{
+    if (filter == NULL)
+    {
+        return;
+    }
+    free(filter -> _slots);
+    free(filter);
+}
+
+/**
+ * @brief Adds the chars of a view to a cuckoo filter.
+ * @param filter
+ * @param key
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(n) where n is the length of the key, and O(1) expected kicks while
+ *  the filter isn't nearly full.
+ */
+MyStringRetVal myStringCuckooFilterAdd(MyStringCuckooFilter *filter, MyStringView key)
+{
+    return myStringCuckooFilterAddBatch(filter, &key, 1);
+}
+
+/**
+ * @brief Checks if the chars of a view may be in a cuckoo filter.
+ * @param filter
+ * @param key
+ * RETURN VALUE:
+ *  @return FALSE if they are surely not in it, TRUE if they may be, and
+ *  	MYSTR_ERROR_CODE on failure.
+ *
+ *  Complexity: O(n) where n is the length of the key, and two buckets are checked.
+ */
+int myStringCuckooFilterContains(const MyStringCuckooFilter *filter, MyStringView key)
+{
+    bool result = false;
+    if (myStringCuckooFilterContainsBatch(filter, &key, 1, &result) == MYSTRING_ERROR)
+    {
+        return MYSTR_ERROR_CODE;
+    }
+    return result ? TRUE : FALSE;
+}
+
+/**
+ * @brief Removes the chars of a view from a cuckoo filter.
+ * @param filter
+ * @param key
+ * RETURN VALUE:
+ *  @return TRUE if they were removed, FALSE if they are not in the filter, and
+ *  	MYSTR_ERROR_CODE on failure.
+ *
+ *  Complexity: O(n) where n is the length of the key.
+ */
+int myStringCuckooFilterRemove(MyStringCuckooFilter *filter, MyStringView key)
+{
+    if (filter == NULL || (key._chars == NULL && key._length != EMPTY_STRING_LENGTH))
+    {
+        return MYSTR_ERROR_CODE;
+    }
+    unsigned long long hash = myStringHashView(key);
+    unsigned short fingerprint = getCuckooFingerprint(hash);
+    unsigned long long bucket = hash & (filter -> _buckets - 1);
+    unsigned long long other = getCuckooOtherBucket(filter, bucket, fingerprint);
+    if (filter -> _victim == fingerprint &&
+        (filter -> _victimBucket == bucket || filter -> _victimBucket == other))
+    {
+        filter -> _victim = CUCKOO_EMPTY_SLOT;
+        filter -> _count--;
+        return TRUE;
+    }
+    for (int i = 0; i < 2; i++)
+    {
+        unsigned short *slots = filter -> _slots + (i == 0 ? bucket : other) * CUCKOO_BUCKET_SLOTS;
+        for (int slot = 0; slot < CUCKOO_BUCKET_SLOTS; slot++)
+        {
+            if (slots[slot] != fingerprint)
+            {
+                continue;
+            }
+            slots[slot] = CUCKOO_EMPTY_SLOT;
+            filter -> _count--;
+            // The freed slot may take the victim back, which frees the filter.
+            unsigned short victim = filter -> _victim;
+            if (victim != CUCKOO_EMPTY_SLOT &&
+                (putCuckooFingerprint(filter, filter -> _victimBucket, victim) ||
+                 putCuckooFingerprint(filter, getCuckooOtherBucket(filter, filter -> _victimBucket,
+                                                                   victim), victim)))
+            {
+                filter -> _victim = CUCKOO_EMPTY_SLOT;
+            }
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/**
+ * @brief Adds n keys to a cuckoo filter.
+ * @param filter
+ * @param keys
+ * @param n
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(l + n) expected, where l is the total length of the keys, with the
+ *  buckets of FILTER_BATCH_KEYS keys fetched at once.
+ */
+MyStringRetVal myStringCuckooFilterAddBatch(MyStringCuckooFilter *filter, const MyStringView keys[],
+                                            unsigned long n)
+{
+    if (filter == NULL || (keys == NULL && n > 0))
+    {
+        return MYSTRING_ERROR;
+    }
+    unsigned long long hashes[FILTER_BATCH_KEYS];
+    for (unsigned long start = 0; start < n; start += FILTER_BATCH_KEYS)
+    {
+        unsigned long batch = n - start < FILTER_BATCH_KEYS ? n - start : FILTER_BATCH_KEYS;
+        for (unsigned long i = 0; i < batch; i++)
+        {
+            if (keys[start + i]._chars == NULL && keys[start + i]._length != EMPTY_STRING_LENGTH)
+            {
+                return MYSTRING_ERROR;
+            }
+            hashes[i] = myStringHashView(keys[start + i]);
+            unsigned long long bucket = hashes[i] & (filter -> _buckets - 1);
+            PREFETCH(filter -> _slots + bucket * CUCKOO_BUCKET_SLOTS);
+            PREFETCH(filter -> _slots + getCuckooOtherBucket(filter, bucket,
+                                                             getCuckooFingerprint(hashes[i])) *
+                                        CUCKOO_BUCKET_SLOTS);
+        }
+        for (unsigned long i = 0; i < batch; i++)
+        {
+            if (addCuckooHash(filter, hashes[i]) == MYSTRING_ERROR)
+            {
+                return MYSTRING_ERROR;
+            }
+        }
+    }
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Checks n keys against a cuckoo filter.
+ * @param filter
+ * @param keys
+ * @param n
+ * @param results
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(l + n) where l is the total length of the keys, with the buckets of
+ *  FILTER_BATCH_KEYS keys fetched at once.
+ */
+MyStringRetVal myStringCuckooFilterContainsBatch(const MyStringCuckooFilter *filter,
+                                                 const MyStringView keys[], unsigned long n,
+                                                 bool results[])
+{
+    if (filter == NULL || ((keys == NULL || results == NULL) && n > 0))
+    {
+        return MYSTRING_ERROR;
+    }
+    unsigned long long hashes[FILTER_BATCH_KEYS];
+    for (unsigned long start = 0; start < n; start += FILTER_BATCH_KEYS)
+    {
+        unsigned long batch = n - start < FILTER_BATCH_KEYS ? n - start : FILTER_BATCH_KEYS;
+        for (unsigned long i = 0; i < batch; i++)
+        {
+            if (keys[start + i]._chars == NULL && keys[start + i]._length != EMPTY_STRING_LENGTH)
+            {
+                return MYSTRING_ERROR;
+            }
+            hashes[i] = myStringHashView(keys[start + i]);
+            unsigned long long bucket = hashes[i] & (filter -> _buckets - 1);
+            PREFETCH(filter -> _slots + bucket * CUCKOO_BUCKET_SLOTS);
+            PREFETCH(filter -> _slots + getCuckooOtherBucket(filter, bucket,
+                                                             getCuckooFingerprint(hashes[i])) *
+                                        CUCKOO_BUCKET_SLOTS);
+        }
+        for (unsigned long i = 0; i < batch; i++)
+        {
+            results[start + i] = containsCuckooHash(filter, hashes[i]);
+        }
+    }
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Writes a cuckoo filter to a stream.
+ * @param filter
+ * @param stream
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(m) where m is the size of the filter.
+ */
+MyStringRetVal myStringCuckooFilterWrite(const MyStringCuckooFilter *filter, FILE *stream)
+{
+    if (filter == NULL || stream == NULL ||
+        fwrite(CUCKOO_MAGIC, sizeof(char), FILTER_MAGIC_LENGTH, stream) != FILTER_MAGIC_LENGTH ||
+        !writeFilterNumber(stream, filter -> _buckets, FILTER_NUMBER_BYTES) ||
+        !writeFilterNumber(stream, filter -> _count, FILTER_NUMBER_BYTES) ||
+        !writeFilterNumber(stream, filter -> _random, FILTER_NUMBER_BYTES) ||
+        !writeFilterNumber(stream, filter -> _victim, FILTER_NUMBER_BYTES) ||
+        !writeFilterNumber(stream, filter -> _victimBucket, FILTER_NUMBER_BYTES))
+    {
+        return MYSTRING_ERROR;
+    }
+    for (unsigned long long i = 0; i < filter -> _buckets * CUCKOO_BUCKET_SLOTS; i++)
+    {
+        if (!writeFilterNumber(stream, filter -> _slots[i], CUCKOO_FINGERPRINT_BYTES))
+        {
+            return MYSTRING_ERROR;
+        }
+    }
+    return fflush(stream) == 0 ? MYSTRING_SUCCESS : MYSTRING_ERROR;
+}
+
+/**
+ * @brief Reads a cuckoo filter written by myStringCuckooFilterWrite.
+ * @param stream
+ * RETURN VALUE:
+ *  @return the filter, or NULL on failure.
+ *
+ *  Complexity: O(m) where m is the size of the filter.
+ */
+MyStringCuckooFilter * myStringCuckooFilterRead(FILE *stream)
+{
+    unsigned long long buckets = 0;
+    unsigned long long count = 0;
+    unsigned long long randomState = 0;
+    unsigned long long victim = 0;
+    unsigned long long victimBucket = 0;
+    // The buckets are a power of 2, and the victim is a fingerprint of one of them.
+    if (stream == NULL || !readFilterMagic(stream, CUCKOO_MAGIC) ||
+        !readFilterNumber(stream, FILTER_NUMBER_BYTES, &buckets) ||
+        !readFilterNumber(stream, FILTER_NUMBER_BYTES, &count) ||
+        !readFilterNumber(stream, FILTER_NUMBER_BYTES, &randomState) ||
+        !readFilterNumber(stream, FILTER_NUMBER_BYTES, &victim) ||
+        !readFilterNumber(stream, FILTER_NUMBER_BYTES, &victimBucket) ||
+        buckets == 0 || (buckets & (buckets - 1)) != 0 || victim > USHRT_MAX ||
+        victimBucket >= buckets)
+    {
+        return NULL;
+    }
+    MyStringCuckooFilter *filter = allocCuckooFilter(buckets);
+    if (filter == NULL)
+    {
+        return NULL;
+    }
+    filter -> _count = count;
+    filter -> _random = randomState;
+    filter -> _victim = (unsigned short) victim;
+    filter -> _victimBucket = victimBucket;
+    for (unsigned long long i = 0; i < buckets * CUCKOO_BUCKET_SLOTS; i++)
+    {
+        unsigned long long fingerprint = 0;
+        if (!readFilterNumber(stream, CUCKOO_FINGERPRINT_BYTES, &fingerprint))
+        {
+            myStringCuckooFilterFree(filter);
+            return NULL;
+        }
+        filter -> _slots[i] = (unsigned short) fingerprint;
+    }
+    return filter;
+}
+
+/**
+ * @brief Replaces every occurrence of needle in str by replacement, from left to
+ * 	right without overlaps. The new chars are built in a single pass: in place when
+ * 	replacement is not longer than needle, and otherwise in a block allocated once at
+ * 	their final size. needle and replacement may be views of str.
+ * @param str
+ * @param needle
+ * @param replacement
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure or if needle is
+ *  	empty (str is left unchanged).
+ *
+ *  Complexity: O(n + m) for n chars and m chars of the new string.
+ */
+MyStringRetVal myStringReplaceAll(MyString *str, MyStringView needle, MyStringView replacement)
+{
+    if (str == NULL || needle._chars == NULL || needle._length == EMPTY_STRING_LENGTH ||
+        (replacement._chars == NULL && replacement._length != EMPTY_STRING_LENGTH))
+    {
+        return MYSTRING_ERROR;
+    }
+    const char *end = str -> _chars + str -> _length;
+    const char *match = findChars(str -> _chars, str -> _length, needle._chars, needle._length);
+    if (match == NULL)
+    {
+        return MYSTRING_SUCCESS;
+    }
+    // Chars which only get shorter are moved down in place, unless the views read them.
+    if (replacement._length <= needle._length && str -> _capacity > 0 &&
+        !isViewOfMyString(str, needle) && !isViewOfMyString(str, replacement))
+    {
+        char *out = str -> _chars + (match - str -> _chars);
+        const char *next = match;
+        while (match != NULL)
+        {
+            memmove(out, next, (size_t) (match - next));
+            out += match - next;
+            memcpy(out, replacement._chars, replacement._length);
+            out += replacement._length;
+            next = match + needle._length;
+            match = findChars(next, (unsigned long) (end - next), needle._chars, needle._length);
+        }
+        memmove(out, next, (size_t) (end - next));
+        out += end - next;
+        setMyStringLength(str, (unsigned long) (out - str -> _chars));
+        return MYSTRING_SUCCESS;
+    }
+    // Count the occurrences, so the new chars are allocated once at their final size.
+    unsigned long count = 0;
+    for (const char *found = match; found != NULL; count++)
+    {
+        found += needle._length;
+        found = findChars(found, (unsigned long) (end - found), needle._chars, needle._length);
+    }
+    unsigned long newLength = str -> _length - count * needle._length;
+    if (count > (ULONG_MAX - newLength - 1) / (replacement._length > 0 ? replacement._length : 1))
+    {
+        return MYSTRING_ERROR;
+    }
+    newLength += count * replacement._length;
+    MyString newChars;
+    if (allocMyStringChars(&newChars, newLength) == MYSTRING_ERROR)
+    {
+        return MYSTRING_ERROR;
+    }
+    char *out = newChars._chars;
+    const char *next = str -> _chars;
+    while (match != NULL)
+    {
+        memcpy(out, next, (size_t) (match - next));
+        out += match - next;
+        memcpy(out, replacement._chars, replacement._length);
+        out += replacement._length;
+        next = match + needle._length;
+        match = findChars(next, (unsigned long) (end - next), needle._chars, needle._length);
+    }
+    memcpy(out, next, (size_t) (end - next));
+    return myStringMove(str, &newChars);
+}
+
+/**
+ * @brief Compiles n needles for myStringReplaceAllMatches. The needles are copied, so
+ * 	they may be changed or freed afterwards. It is the caller's responsibility to free
+ * 	the matcher.
+ * @param needles
+ * @param n
+ * RETURN VALUE:
+ *  @return the matcher, or NULL on failure or if a needle is empty.
+ *
+ *  Complexity: O(256 * m) time and memory for m chars of needles (an Aho-Corasick
+ *  automaton with a transition for every state and char).
+ */
+MyStringMatcher * myStringMatcherAlloc(const MyStringView needles[], unsigned long n)
+{
+    if (needles == NULL && n > 0)
+    {
+        return NULL;
+    }
+    // Every char of the needles adds at most one state to the first.
+    unsigned long states = 1;
+    for (unsigned long i = 0; i < n; i++)
+    {
+        if (needles[i]._chars == NULL || needles[i]._length == EMPTY_STRING_LENGTH ||
+            needles[i]._length >= MATCHER_NO_STATE - states)
+        {
+            return NULL;
+        }
+        states += needles[i]._length;
+    }
+    MyStringMatcher *matcher = (MyStringMatcher *) malloc(sizeof(MyStringMatcher));
+    if (matcher == NULL)
+    {
+        return NULL;
+    }
+    matcher -> _transitions = (unsigned int *) malloc(states * MATCHER_ALPHABET *
+                                                      sizeof(unsigned int));
+    matcher -> _depths = (unsigned long *) malloc(states * sizeof(unsigned long));
+    matcher -> _outputs = (unsigned long *) malloc(states * sizeof(unsigned long));
+    matcher -> _needleLengths = (unsigned long *) malloc((n > 0 ? n : 1) * sizeof(unsigned long));
+    matcher -> _needles = n;
+    if (matcher -> _transitions == NULL || matcher -> _depths == NULL ||
+        matcher -> _outputs == NULL || matcher -> _needleLengths == NULL)
+    {
+        myStringMatcherFree(matcher);
+        return NULL;
+    }
+    // Build the trie of the needles, whose states are numbered in the order they're added.
+    unsigned long usedStates = 1;
+    for (unsigned int c = 0; c < MATCHER_ALPHABET; c++)
+    {
+        matcher -> _transitions[c] = MATCHER_NO_STATE;
+    }
+    matcher -> _depths[MATCHER_ROOT] = 0;
+    matcher -> _outputs[MATCHER_ROOT] = MATCHER_NO_NEEDLE;
+    for (unsigned long i = 0; i < n; i++)
+    {
+        unsigned long state = MATCHER_ROOT;
+        const unsigned char *chars = (const unsigned char *) needles[i]._chars;
+        for (unsigned long j = 0; j < needles[i]._length; j++)
+        {
+            unsigned int *next = &matcher -> _transitions[state * MATCHER_ALPHABET + chars[j]];
+            if (*next == MATCHER_NO_STATE)
+            {
+                *next = (unsigned int) usedStates;
+                for (unsigned int c = 0; c < MATCHER_ALPHABET; c++)
+                {
+                    matcher -> _transitions[usedStates * MATCHER_ALPHABET + c] = MATCHER_NO_STATE;
+                }
+                matcher -> _depths[usedStates] = j + 1;
+                matcher -> _outputs[usedStates] = MATCHER_NO_NEEDLE;
+                usedStates++;
+            }
+            state = *next;
+        }
+        // A needle given twice keeps its first index.
+        if (matcher -> _outputs[state] == MATCHER_NO_NEEDLE)
+        {
+            matcher -> _outputs[state] = i;
+        }
+        matcher -> _needleLengths[i] = needles[i]._length;
+    }
+    if (linkMatcherStates(matcher, usedStates) == MYSTRING_ERROR)
+    {
+        myStringMatcherFree(matcher);
+        return NULL;
+    }
+    return matcher;
+}
+
+/**
+ * @brief Frees a matcher.
+ * @param matcher
+ */
+void myStringMatcherFree(MyStringMatcher *matcher)
+{
+    if (matcher == NULL)
+    {
+        return;
+    }
+    free(matcher -> _transitions);
+    free(matcher -> _depths);
+    free(matcher -> _outputs);
+    free(matcher -> _needleLengths);
+    free(matcher);
+}
+
+/**
+ * @brief Replaces every occurrence of the needles of a matcher in str by the
+ * 	replacement of the same index. Occurrences are taken from left to right without
+ * 	overlaps, the one which starts first and then the longest of those.
+ * @param str
+ * @param matcher
+ * @param replacements the array of replacements, one for every needle.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (str is left
+ *  	unchanged).
+ *
+ *  Complexity: O(n + m) for n chars and m chars of the new string, whatever the number
+ *  of needles.
+ */
+MyStringRetVal myStringReplaceAllMatches(MyString *str, const MyStringMatcher *matcher,
+                                         const MyStringView replacements[])
+{
+    if (str == NULL || matcher == NULL || (replacements == NULL && matcher -> _needles > 0))
+    {
+        return MYSTRING_ERROR;
+    }
+    for (unsigned long i = 0; i < matcher -> _needles; i++)
+    {
+        if (replacements[i]._chars == NULL && replacements[i]._length != EMPTY_STRING_LENGTH)
+        {
+            return MYSTRING_ERROR;
+        }
+    }
+    // Measure the new chars first, so they're allocated once at their final size.
+    const unsigned char *chars = (const unsigned char *) str -> _chars;
+    unsigned long newLength = str -> _length;
+    unsigned long start = 0;
+    unsigned long needle = 0;
+    bool hasMatches = false;
+    for (unsigned long i = 0; findNextMatch(matcher, chars, str -> _length, i, &start, &needle);
+         i = start + matcher -> _needleLengths[needle])
+    {
+        if (replacements[needle]._length > ULONG_MAX - 1 - newLength)
+        {
+            return MYSTRING_ERROR;
+        }
+        newLength += replacements[needle]._length;
+        newLength -= matcher -> _needleLengths[needle];
+        hasMatches = true;
+    }
+    if (!hasMatches)
+    {
+        return MYSTRING_SUCCESS;
+    }
+    MyString newChars;
+    if (allocMyStringChars(&newChars, newLength) == MYSTRING_ERROR)
+    {
+        return MYSTRING_ERROR;
+    }
+    char *out = newChars._chars;
+    unsigned long next = 0;
+    while (findNextMatch(matcher, chars, str -> _length, next, &start, &needle))
+    {
+        memcpy(out, chars + next, start - next);
+        out += start - next;
+        memcpy(out, replacements[needle]._chars, replacements[needle]._length);
+        out += replacements[needle]._length;
+        next = start + matcher -> _needleLengths[needle];
+    }
+    memcpy(out, chars + next, str -> _length - next);
+    return myStringMove(str, &newChars);
+}
+
+/**
+ * @brief Puts the smallest k strings of arr, in ascending order, at its start. The
+ * 	other strings follow them in no particular order.
+ * @param arr
+ * @param len
+ * @param k the number of strings, all of them if it's bigger than len.
+ * @param comparator custom comparator of MyString pointers, or NULL for myStringCompare.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(nlogk) comparisons by a heap when k is small, and otherwise O(n) on
+ *  average by introselect and O(klogk) to sort the k strings.
+ */
+MyStringRetVal myStringTopK(MyString *arr[], unsigned long len, unsigned long k,
+							int (*comparator) (const void *, const void *))
+{
+    if (arr == NULL)
+    {
+        return MYSTRING_ERROR;
+    }
+    k = k < len ? k : len;
+    if (k == 0)
+    {
+        return MYSTRING_SUCCESS;
+    }
+    SelectOrder order = {arr, comparator};
+    SortKeyPair *pairs = createSelectPairs(arr, len, &order);
+    if (pairs == NULL)
+    {
+        return MYSTRING_ERROR;
+    }
+    // A few strings are best kept in a heap, which most of the others don't get into.
+    if (k <= len / TOPK_HEAP_RATIO)
+    {
+        heapSelectPairs(&order, pairs, len, k);
+    }
+    else
+    {
+        introSelectPairs(&order, pairs, len, k - 1);
+        heapSelectPairs(&order, pairs, k, k);
+    }
+    sortPairHeap(&order, pairs, k);
+    MyStringRetVal result = applySortPermutation(arr, pairs, len);
+    free(pairs);
+    return result;
+}
+
+/**
+ * @brief Puts the string which would be at index n of the sorted arr there, with no
+ * 	bigger string before it and no smaller string after it.
+ * @param arr
+ * @param len
+ * @param n the index, smaller than len.
+ * @param comparator custom comparator of MyString pointers, or NULL for myStringCompare.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(n) on average, and O(nlogn) at worst when introselect falls back to
+ *  a heap.
+ */
+MyStringRetVal myStringNthElement(MyString *arr[], unsigned long len, unsigned long n,
+								  int (*comparator) (const void *, const void *))
+{
+    if (arr == NULL || n >= len)
+    {
+        return MYSTRING_ERROR;
+    }
+    SelectOrder order = {arr, comparator};
+    SortKeyPair *pairs = createSelectPairs(arr, len, &order);
+    if (pairs == NULL)
+    {
+        return MYSTRING_ERROR;
+    }
+    introSelectPairs(&order, pairs, len, n);
+    MyStringRetVal result = applySortPermutation(arr, pairs, len);
+    free(pairs);
+    return result;
+}
+
+/**
+ * @brief Allocates a stream which keeps the smallest k of the strings pushed to it.
+ * @param k
+ * @param comparator custom comparator of MyString pointers, or NULL for myStringCompare.
+ * RETURN VALUE:
+ *  @return the stream, or NULL on failure.
+ *
+ *  Complexity: O(k).
+ */
+MyStringTopKStream * myStringTopKStreamAlloc(unsigned long k,
+											 int (*comparator) (const void *, const void *))
+{
+    if (k > ULONG_MAX / sizeof(SortKeyPair))
+    {
+        return NULL;
+    }
+    MyStringTopKStream *stream = (MyStringTopKStream *) malloc(sizeof(MyStringTopKStream));
+    if (stream == NULL)
+    {
+        return NULL;
+    }
+    unsigned long slots = k > 0 ? k : 1;
+    stream -> _heap = (SortKeyPair *) malloc(slots * sizeof(SortKeyPair));
+    stream -> _strs = (MyString **) malloc(slots * sizeof(MyString *));
+    stream -> _k = k;
+    stream -> _count = 0;
+    stream -> _comparator = comparator;
+    if (stream -> _heap == NULL || stream -> _strs == NULL)
+    {
+        myStringTopKStreamFree(stream);
+        return NULL;
+    }
+    return stream;
+}
+
+/**
+ * @brief Frees a stream with the strings it keeps.
+ * @param stream
+ */
+void myStringTopKStreamFree(MyStringTopKStream *stream)
+{
+    if (stream == NULL)
+    {
+        return;
+    }
+    for (unsigned long i = 0; i < stream -> _count; i++)
+    {
+        myStringFree(stream -> _strs[i]);
+    }
+    free(stream -> _heap);
+    free(stream -> _strs);
+    free(stream);
+}
+
+/**
+ * @brief Pushes a string to a stream, which keeps a copy of it if it's among the
+ * 	smallest k so far.
+ * @param stream
+ * @param str
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(1) for a string bigger than all the kept ones, which is decided by
+ *  the prefix keys alone unless they're equal, and O(logk) for a kept one.
+ */
+MyStringRetVal myStringTopKStreamPush(MyStringTopKStream *stream, const MyString *str)
+{
+    if (stream == NULL || str == NULL)
+    {
+        return MYSTRING_ERROR;
+    }
+    if (stream -> _k == 0)
+    {
+        return MYSTRING_SUCCESS;
+    }
+    SelectOrder order = {stream -> _strs, stream -> _comparator};
+    unsigned long long key = getSelectKey(&order, str);
+    // The slots of the strings are taken in order, so the next free one is _count.
+    if (stream -> _count < stream -> _k)
+    {
+        MyString *copy = myStringClone(str);
+        if (copy == NULL)
+        {
+            return MYSTRING_ERROR;
+        }
+        stream -> _strs[stream -> _count] = copy;
+        stream -> _heap[stream -> _count]._key = key;
+        stream -> _heap[stream -> _count]._index = stream -> _count;
+        siftUpPairs(&order, stream -> _heap, stream -> _count);
+        stream -> _count++;
+        return MYSTRING_SUCCESS;
+    }
+    SortKeyPair *top = &stream -> _heap[0];
+    if (compareSelectKeys(&order, key, str, top -> _key, stream -> _strs[top -> _index]) >= 0)
+    {
+        return MYSTRING_SUCCESS;
+    }
+    // The biggest kept string drops out, and its copy takes the new one.
+    if (myStringSetFromMyString(stream -> _strs[top -> _index], str) == MYSTRING_ERROR)
+    {
+        return MYSTRING_ERROR;
+    }
+    top -> _key = key;
+    siftDownPairs(&order, stream -> _heap, stream -> _count, 0);
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Hands the strings a stream keeps over to the caller, in ascending order, and
+ * 	empties the stream.
+ * @param stream
+ * @param arr room for k strings.
+ * @param n pointer to set to the number of strings.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(klogk).
+ */
+MyStringRetVal myStringTopKStreamTake(MyStringTopKStream *stream, MyString *arr[],
+									  unsigned long *n)
+{
+    if (stream == NULL || arr == NULL || n == NULL)
+    {
+        return MYSTRING_ERROR;
+    }
+    SelectOrder order = {stream -> _strs, stream -> _comparator};
+    sortPairHeap(&order, stream -> _heap, stream -> _count);
+    for (unsigned long i = 0; i < stream -> _count; i++)
+    {
+        arr[i] = stream -> _strs[stream -> _heap[i]._index];
+    }
+    *n = stream -> _count;
+    stream -> _count = 0;
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Sorts arr as myStringSort does and moves the first occurrence of every distinct
+ * 	string to its start, in order. The other occurrences are moved after them.
+ * @param arr
+ * @param len
+ * @param uniqueLen pointer to set to the number of distinct strings.
+ * @param counts room for len numbers, set to the number of occurrences of every
+ * 	distinct string, or NULL.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: a radix sort of the prefix keys of the strings, and then a merge sort of
+ *  every run of equal keys which merges equal strings as they meet, O(mlogm)
+ *  comparisons for a run of m.
+ */
+MyStringRetVal myStringSortUnique(MyString *arr[], unsigned long len, unsigned long *uniqueLen,
+								  unsigned long counts[])
+{
+    if (arr == NULL || uniqueLen == NULL || len > ULONG_MAX / sizeof(UniqueEntry))
+    {
+        return MYSTRING_ERROR;
+    }
+    MyStringRetVal retVal = MYSTRING_ERROR;
+    SortKeyPair *pairs = (SortKeyPair *) malloc((len > 0 ? len : 1) * sizeof(SortKeyPair));
+    UniqueEntry *entries = (UniqueEntry *) malloc((len > 0 ? len : 1) * sizeof(UniqueEntry));
+    UniqueEntry *temp = (UniqueEntry *) malloc((len > 0 ? len : 1) * sizeof(UniqueEntry));
+    MyString **sorted = (MyString **) malloc((len > 0 ? len : 1) * sizeof(MyString *));
+    if (pairs == NULL || entries == NULL || temp == NULL || sorted == NULL)
+    {
+        goto cleanup;
+    }
+    unsigned long i = 0;
+    for (i = 0; i < len; i++)
+    {
+        if (arr[i] == NULL)
+        {
+            goto cleanup;
+        }
+        pairs[i]._key = getPrefixKey(arr[i] -> _chars, arr[i] -> _length);
+        pairs[i]._index = i;
+    }
+    if (radixSortKeyPairs(pairs, len) == MYSTRING_ERROR)
+    {
+        goto cleanup;
+    }
+    // The distinct strings fill sorted from its start, and the duplicates from its end.
+    unsigned long unique = 0;
+    unsigned long duplicateIndex = len;
+    i = 0;
+    while (i < len)
+    {
+        unsigned long runEnd = i + 1;
+        while (runEnd < len && pairs[runEnd]._key == pairs[i]._key)
+        {
+            runEnd++;
+        }
+        // The radix sort is stable, so the first occurrence of a string comes first.
+        unsigned long j = 0;
+        for (j = i; j < runEnd; j++)
+        {
+            entries[j - i]._str = arr[pairs[j]._index];
+            entries[j - i]._count = 1;
+        }
+        unsigned long runUnique = sortUniqueEntries(entries, runEnd - i, temp, sorted,
+                                                    &duplicateIndex);
+        for (j = 0; j < runUnique; j++)
+        {
+            sorted[unique] = entries[j]._str;
+            if (counts != NULL)
+            {
+                counts[unique] = entries[j]._count;
+            }
+            unique++;
+        }
+        i = runEnd;
+    }
+    memcpy(arr, sorted, len * sizeof(MyString *));
+    *uniqueLen = unique;
+    retVal = MYSTRING_SUCCESS;
+
+cleanup:
+    free(sorted);
+    free(temp);
+    free(entries);
+    free(pairs);
+    return retVal;
+}
+
+/**
+ * @brief Moves the first occurrence of every distinct string of arr to its start, in
+ * 	the order they first occur, by hashing rather than sorting.
+ * @param arr
+ * @param len
+ * @param distinctLen pointer to set to the number of distinct strings.
+ * @param counts room for len numbers, set to the number of occurrences of every
+ * 	distinct string, or NULL.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(N) on average for N chars, since every string is hashed once and
+ *  compared only to the distinct strings of the same hash.
+ */
+MyStringRetVal myStringCountDistinct(MyString *arr[], unsigned long len,
+									 unsigned long *distinctLen, unsigned long counts[])
+{
+    if (arr == NULL || distinctLen == NULL ||
+        len > ULONG_MAX / DISTINCT_TABLE_RATIO / sizeof(unsigned long long))
+    {
+        return MYSTRING_ERROR;
+    }
+    unsigned long slots = 1;
+    while (slots < len * DISTINCT_TABLE_RATIO)
+    {
+        slots <<= 1;
+    }
+    MyStringRetVal retVal = MYSTRING_ERROR;
+    unsigned long *table = (unsigned long *) calloc(slots, sizeof(unsigned long));
+    unsigned long long *hashes = (unsigned long long *) malloc((len > 0 ? len : 1) *
+                                                               sizeof(unsigned long long));
+    MyString **distinct = (MyString **) malloc((len > 0 ? len : 1) * sizeof(MyString *));
+    if (table == NULL || hashes == NULL || distinct == NULL)
+    {
+        goto cleanup;
+    }
+    unsigned long i = 0;
+    for (i = 0; i < len; i++)
+    {
+        if (arr[i] == NULL)
+        {
+            goto cleanup;
+        }
+    }
+    // The distinct strings fill distinct from its start, and the duplicates from its end.
+    unsigned long distinctCount = 0;
+    unsigned long duplicateIndex = len;
+    for (i = 0; i < len; i++)
+    {
+        unsigned long long hash = myStringHash(arr[i]);
+        unsigned long slot = (unsigned long) hash & (slots - 1);
+        bool isDuplicate = false;
+        while (table[slot] != DISTINCT_EMPTY_SLOT && !isDuplicate)
+        {
+            unsigned long index = table[slot] - 1;
+            isDuplicate = hashes[index] == hash && myStringEqual(distinct[index], arr[i]) == TRUE;
+            if (isDuplicate)
+            {
+                distinct[--duplicateIndex] = arr[i];
+                if (counts != NULL)
+                {
+                    counts[index]++;
+                }
+            }
+            slot = (slot + 1) & (slots - 1);
+        }
+        if (!isDuplicate)
+        {
+            table[slot] = distinctCount + 1;
+            hashes[distinctCount] = hash;
+            distinct[distinctCount] = arr[i];
+            if (counts != NULL)
+            {
+                counts[distinctCount] = 1;
+            }
+            distinctCount++;
+        }
+    }
+    memcpy(arr, distinct, len * sizeof(MyString *));
+    *distinctLen = distinctCount;
+    retVal = MYSTRING_SUCCESS;
+
+cleanup:
+    free(distinct);
+    free(hashes);
+    free(table);
+    return retVal;
+}
+
+/**
+ * @brief Compiles n glob patterns, which match whole strings.
+ * @param patterns
+ * @param n the number of patterns, at least 1.
+ * RETURN VALUE:
+ *  @return the glob, or NULL on failure or if a class isn't closed.
+ *
+ *  Complexity: O(256 * m / 64) for m chars of patterns, the masks of the states of
+ *  every char.
+ */
+MyStringGlob * myStringGlobCompile(const MyStringView patterns[], unsigned long n)
+{
+    if (patterns == NULL || n == 0 || n > ULONG_MAX / sizeof(GlobPattern))
+    {
+        return NULL;
+    }
+    // Count the states first, so the masks are allocated once.
+    unsigned long states = 0;
+    unsigned long prefixChars = 0;
+    unsigned long i = 0;
+    for (i = 0; i < n; i++)
+    {
+        unsigned long patternStates = 0;
+        unsigned long prefixLength = 0;
+        if ((patterns[i]._chars == NULL && patterns[i]._length != EMPTY_STRING_LENGTH) ||
+            !compileGlobPattern(NULL, patterns[i], 0, &patternStates, NULL, &prefixLength))
+        {
+            return NULL;
+        }
+        states += patternStates;
+        prefixChars += prefixLength;
+    }
+    MyStringGlob *glob = (MyStringGlob *) malloc(sizeof(MyStringGlob));
+    if (glob == NULL)
+    {
+        return NULL;
+    }
+    // A state may look 2 states ahead, so there's always a word for those.
+    glob -> _words = (states + 2) / GLOB_WORD_BITS + 1;
+    glob -> _count = n;
+    glob -> _moves = (unsigned long long *) calloc(GLOB_CHARS * glob -> _words,
+                                                   sizeof(unsigned long long));
+    glob -> _loops = (unsigned long long *) calloc(GLOB_CHARS * glob -> _words,
+                                                   sizeof(unsigned long long));
+    glob -> _stars = (unsigned long long *) calloc(glob -> _words, sizeof(unsigned long long));
+    glob -> _skips = (unsigned long long *) calloc(glob -> _words, sizeof(unsigned long long));
+    glob -> _patterns = (GlobPattern *) malloc(n * sizeof(GlobPattern));
+    glob -> _prefixChars = (char *) malloc(prefixChars > 0 ? prefixChars : 1);
+    if (glob -> _moves == NULL || glob -> _loops == NULL || glob -> _stars == NULL ||
+        glob -> _skips == NULL || glob -> _patterns == NULL || glob -> _prefixChars == NULL)
+    {
+        myStringGlobFree(glob);
+        return NULL;
+    }
+    unsigned long start = 0;
+    char *prefix = glob -> _prefixChars;
+    for (i = 0; i < n; i++)
+    {
+        GlobPattern *pattern = &glob -> _patterns[i];
+        unsigned long patternStates = 0;
+        compileGlobPattern(glob, patterns[i], start, &patternStates, prefix,
+                           &pattern -> _prefixLength);
+        pattern -> _index = i;
+        pattern -> _start = start;
+        pattern -> _accept = start + patternStates - 1;
+        pattern -> _prefix = prefix;
+        start += patternStates;
+        prefix += pattern -> _prefixLength;
+    }
+    qsort(glob -> _patterns, n, sizeof(GlobPattern), globPrefixComparator);
+    return glob;
+}
+
+/**
+ * @brief Frees a glob.
+ * @param glob
+ */
+void myStringGlobFree(MyStringGlob *glob)
+{
+    if (glob == NULL)
+    {
+        return;
+    }
+    free(glob -> _moves);
+    free(glob -> _loops);
+    free(glob -> _stars);
+    free(glob -> _skips);
+    free(glob -> _patterns);
+    free(glob -> _prefixChars);
+    free(glob);
+}
+
+/**
+ * @brief Checks if str matches any pattern of a glob.
+ * @param glob
+ * @param str
+ * RETURN VALUE:
+ *  @return TRUE if it does, FALSE otherwise, MYSTR_ERROR_CODE on failure.
+ *
+ *  Complexity: O(n * s / 64) for n chars and s states of all the patterns.
+ */
+int myStringGlobMatch(const MyStringGlob *glob, MyStringView str)
+{
+    if (glob == NULL || (str._chars == NULL && str._length != EMPTY_STRING_LENGTH))
+    {
+        return MYSTR_ERROR_CODE;
+    }
+    unsigned long long stackStates[GLOB_STACK_WORDS];
+    unsigned long long *states = stackStates;
+    if (glob -> _words > GLOB_STACK_WORDS)
+    {
+        states = (unsigned long long *) malloc(glob -> _words * sizeof(unsigned long long));
+        if (states == NULL)
+        {
+            return MYSTR_ERROR_CODE;
+        }
+    }
+    bool isMatch = runGlob(glob, str, states, NULL);
+    if (states != stackStates)
+    {
+        free(states);
+    }
+    return isMatch ? TRUE : FALSE;
+}
+
+/**
+ * @brief Checks which patterns of a glob str matches, in a single pass over its chars.
+ * @param glob
+ * @param str
+ * @param matches room for a result for every pattern, set to whether str matches it.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(n * s / 64) for n chars and s states of all the patterns.
+ */
+MyStringRetVal myStringGlobMatchAll(const MyStringGlob *glob, MyStringView str, bool matches[])
+{
+    if (glob == NULL || matches == NULL ||
+        (str._chars == NULL && str._length != EMPTY_STRING_LENGTH))
+    {
+        return MYSTRING_ERROR;
+    }
+    unsigned long long stackStates[GLOB_STACK_WORDS];
+    unsigned long long *states = stackStates;
+    if (glob -> _words > GLOB_STACK_WORDS)
+    {
+        states = (unsigned long long *) malloc(glob -> _words * sizeof(unsigned long long));
+        if (states == NULL)
+        {
+            return MYSTRING_ERROR;
+        }
+    }
+    runGlob(glob, str, states, matches);
+    if (states != stackStates)
+    {
+        free(states);
+    }
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Sets up a chunker, which cuts data into content defined chunks.
+ * @param chunker
+ * @param data
+ * @param minSize
+ * @param averageSize
+ * @param maxSize
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(1), and O(256) once for the tables of the hash.
+ */
+MyStringRetVal myStringChunkerInit(MyStringChunker *chunker, MyStringView data,
+                                   unsigned long minSize, unsigned long averageSize,
+                                   unsigned long maxSize)
+{
+    if (chunker == NULL || (data._chars == NULL && data._length != EMPTY_STRING_LENGTH) ||
+        minSize == 0 || minSize > averageSize || averageSize > maxSize)
+    {
+        return MYSTRING_ERROR;
+    }
+    unsigned long bits = 0;
+    while ((averageSize >> (bits + 1)) != 0)
+    {
+        bits++;
+    }
+    if (bits <= CDC_NORMALIZATION || bits + CDC_NORMALIZATION >= GEAR_HASH_BITS)
+    {
+        return MYSTRING_ERROR;
+    }
+    pthread_once(&gearTableOnce, createGearTables);
+    chunker -> _data = data;
+    chunker -> _offset = 0;
+    chunker -> _minSize = minSize;
+    chunker -> _averageSize = averageSize;
+    chunker -> _maxSize = maxSize;
+    chunker -> _smallMask = ~0ULL << (GEAR_HASH_BITS - (bits + CDC_NORMALIZATION));
+    chunker -> _largeMask = ~0ULL << (GEAR_HASH_BITS - (bits - CDC_NORMALIZATION));
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Sets chunk to the next chunk of the data of a chunker.
+ * @param chunker
+ * @param chunk
+ * RETURN VALUE:
+ *  @return TRUE if there was a chunk, FALSE at the end of the data, MYSTR_ERROR_CODE on
+ *  	failure.
+ *
+ *  Complexity: O(c) where c is the size of the chunk, less the min size, which isn't
+ *  hashed.
+ */
+int myStringChunkerNext(MyStringChunker *chunker, MyStringView *chunk)
+{
+    if (chunker == NULL || chunk == NULL)
+    {
+        return MYSTR_ERROR_CODE;
+    }
+    unsigned long remaining = chunker -> _data._length - chunker -> _offset;
+    if (remaining == 0)
+    {
+        return FALSE;
+    }
+    const unsigned char *chars = (const unsigned char *) chunker -> _data._chars +
+                                 chunker -> _offset;
+    unsigned long size = remaining;
+    if (remaining > chunker -> _minSize)
+    {
+        unsigned long end = remaining < chunker -> _maxSize ? remaining : chunker -> _maxSize;
+        unsigned long normalEnd = end < chunker -> _averageSize ? end : chunker -> _averageSize;
+        unsigned long long hash = 0;
+        size = chunker -> _minSize;
+        if (!findChunkCut(chars, &size, normalEnd, chunker -> _smallMask, &hash))
+        {
+            findChunkCut(chars, &size, end, chunker -> _largeMask, &hash);
+        }
+    }
+    chunk -> _chars = (const char *) chars;
+    chunk -> _length = size;
+    chunker -> _offset += size;
+    return TRUE;
+}
+
+/**
+ * @brief Winnows the k-grams of text: hashes every k-gram and keeps the smallest hash
+ * 	of every window of window k-grams.
+ * @param text
+ * @param k
+ * @param window
+ * @param fingerprints
+ * @param capacity
+ * @param count
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ *
+ *  Complexity: O(n) expected where n is the length of the text, as the minimum of the
+ *  window is looked for again only when it leaves the window.
+ */
+MyStringRetVal myStringWinnow(MyStringView text, unsigned long k, unsigned long window,
+                              MyStringFingerprint fingerprints[], unsigned long capacity,
+                              unsigned long *count)
+{
+    if ((text._chars == NULL && text._length != EMPTY_STRING_LENGTH) || k == 0 ||
+        window == 0 || window > WINNOW_MAX_WINDOW || count == NULL ||
+        (fingerprints == NULL && capacity != 0))
+    {
+        return MYSTRING_ERROR;
+    }
+    *count = 0;
+    if (text._length < k)
+    {
+        return MYSTRING_SUCCESS;
+    }
+    const unsigned char *chars = (const unsigned char *) text._chars;
+    // The hashes of the last window k-grams, by their index modulo window.
+    unsigned long long hashes[WINNOW_MAX_WINDOW];
+    // The power of the base by which the char leaving the k-gram was multiplied.
+    unsigned long long power = 1;
+    for (unsigned long i = 1; i < k; i++)
+    {
+        power *= WINNOW_BASE;
+    }
+    unsigned long long rolling = 0;
+    for (unsigned long i = 0; i + 1 < k; i++)
+    {
+        rolling = rolling * WINNOW_BASE + chars[i] + 1;
+    }
+    unsigned long grams = text._length - k + 1;
+    unsigned long minimum = WINNOW_NO_MINIMUM;
+    for (unsigned long i = 0; i < grams; i++)
+    {
+        rolling = rolling * WINNOW_BASE + chars[i + k - 1] + 1;
+        unsigned long long hash = avalancheHash(rolling);
+        rolling -= (chars[i] + 1ULL) * power;
+        hashes[i % window] = hash;
+        bool isNew = true;
+        if (minimum != WINNOW_NO_MINIMUM && minimum + window <= i)
+        {
+            // The minimum left the window, the rightmost smallest hash in it is the next.
+            minimum = i + 1 - window;
+            for (unsigned long j = minimum + 1; j <= i; j++)
+            {
+                if (hashes[j % window] <= hashes[minimum % window])
+                {
+                    minimum = j;
+                }
+            }
+        }
+        else if (minimum == WINNOW_NO_MINIMUM || hash <= hashes[minimum % window])
+        {
+            minimum = i;
+        }
+        else
+        {
+            isNew = false;
+        }
+        // The minimums before the first window is full are kept only if they're its.
+        if ((isNew && i >= window) || i + 1 == window)
+        {
+            addFingerprint(fingerprints, capacity, count, hashes[minimum % window], minimum);
+        }
+    }
+    if (grams < window)
+    {
+        addFingerprint(fingerprints, capacity, count, hashes[minimum % window], minimum);
+    }
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Allocates an array of n empty strings, in a single block.
+ * @param n
+ * RETURN VALUE:
+ *  @return the array, or NULL on failure.
+ *
+ *  Complexity: O(n), with a single allocation, as an empty string has no chars of its
+ *  own until it is set.
+ */
+MyString ** myStringAllocArray(unsigned long n)
+{
+    STATS_ENTER(MYSTRING_SITE_ALLOC);
+    MyString **arr = allocMyStringArray(n, 0);
+    STATS_LEAVE();
+    if (arr == NULL)
+    {
+        return NULL;
+    }
+    for (unsigned long i = 0; i < n; i++)
+    {
+        arr[i] -> _chars = noChars;
+        arr[i] -> _length = EMPTY_STRING_LENGTH;
+        arr[i] -> _capacity = 0;
+        arr[i] -> _mappedSize = 0;
+    }
+    return arr;
+}
+
+/**
+ * @brief Allocates an array of the lines of buffer, in a single block with their chars.
+ * @param buffer
+ * @param n
+ * RETURN VALUE:
+ *  @return the array, or NULL on failure.
+ *
+ *  Complexity: O(m) where m is the length of the buffer, with a single allocation.
+ */
+MyString ** myStringArrayFromLines(MyStringView buffer, unsigned long *n)
+{
+    if ((buffer._chars == NULL && buffer._length != EMPTY_STRING_LENGTH) || n == NULL)
+    {
+        return NULL;
+    }
+    unsigned long lines = countLineEnds(buffer._chars, buffer._length);
+    if (buffer._length > 0 && buffer._chars[buffer._length - 1] != RECORD_LINE_END)
+    {
+        lines++;
+    }
+    // Every line is followed by a '\0' in place of its '\n', which the last may lack.
+    STATS_ENTER(MYSTRING_SITE_ALLOC);
+    MyString **arr = buffer._length < ULONG_MAX ?
+                     allocMyStringArray(lines, buffer._length + 1) : NULL;
+    STATS_LEAVE();
+    if (arr == NULL)
+    {
+        return NULL;
+    }
+    char *chars = (char *) ((MyString *) (arr + lines) + lines);
+    if (buffer._length > 0)
+    {
+        memcpy(chars, buffer._chars, buffer._length);
+    }
+    unsigned long line = 0;
+    char *lineStart = chars;
+    unsigned long i = 0;
+#ifdef __SSE2__
+    const __m128i lineEnd = _mm_set1_epi8(RECORD_LINE_END);
+    for (; i + SSE2_BLOCK_SIZE <= buffer._length; i += SSE2_BLOCK_SIZE)
+    {
+        unsigned int ends = (unsigned int) _mm_movemask_epi8(
+            _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) (chars + i)), lineEnd));
+        for (; ends != 0; ends &= ends - 1)
+        {
+            char *end = chars + i + __builtin_ctz(ends);
+            setLineChars(arr[line++], lineStart, end);
+            lineStart = end + 1;
+        }
+    }
+#endif
+    for (; i < buffer._length; i++)
+    {
+        if (chars[i] == RECORD_LINE_END)
+        {
+            setLineChars(arr[line++], lineStart, chars + i);
+            lineStart = chars + i + 1;
+        }
+    }
+    if (line < lines)
+    {
+        setLineChars(arr[line], lineStart, chars + buffer._length);
+    }
+    *n = lines;
+    return arr;
+}
+
+/**
+ * @brief Frees an array of myStringAllocArray or myStringArrayFromLines, with its strings.
+ * @param arr
+ *
+ *  Complexity: O(n) where n is the number of strings, with a free for every string
+ *  which has chars of its own and one for the array.
+ */
+void myStringFreeArray(MyString **arr)
+{
+    if (arr == NULL)
+    {
+        return;
+    }
+    MyStringArrayHeader *header = (MyStringArrayHeader *) arr - 1;
+    for (unsigned long i = 0; i < header -> _count; i++)
+    {
+        releaseMyStringChars(arr[i]);
+    }
+    STATS_SUB(libraryStats._liveStrings, header -> _count);
+    releaseBlock(header, header -> _size);
+}
+
+/**
+ * @brief Sets up a reader of delimited text.
+ * @param reader
+ * @param data
+ * @param delimiter
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringCsvReaderInit(MyStringCsvReader *reader, MyStringView data,
+                                     char delimiter)
+{
+    if (reader == NULL || (data._chars == NULL && data._length != EMPTY_STRING_LENGTH) ||
+        delimiter == CSV_PADDING || delimiter == CSV_QUOTE || delimiter == CSV_CARRIAGE_RETURN ||
+        delimiter == RECORD_LINE_END)
+    {
+        return MYSTRING_ERROR;
+    }
+    reader -> _data = data;
+    reader -> _delimiter = delimiter;
+    reader -> _block = 0;
+    reader -> _nextBlock = 0;
+    reader -> _separators = 0;
+    reader -> _rowEnds = 0;
+    reader -> _inQuotes = 0;
+    reader -> _fieldStart = 0;
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Reads the next row of a reader.
+ * @param reader
+ * @param arena
+ * @param fields
+ * @param capacity
+ * @param count
+ * RETURN VALUE:
+ *  @return TRUE if there was a row, FALSE at the end of the data, MYSTR_ERROR_CODE on
+ *  	failure.
+ *
+ *  Complexity: O(n) for a row of n chars, with a few vector operations for every 64
+ *  chars and a few operations for every field.
+ */
+int myStringCsvNextRow(MyStringCsvReader *reader, MyString *arena, MyStringView fields[],
+                       unsigned long capacity, unsigned long *count)
+{
+    if (reader == NULL || arena == NULL || (fields == NULL && capacity > 0) || count == NULL)
+    {
+        return MYSTR_ERROR_CODE;
+    }
+    const char *chars = reader -> _data._chars;
+    unsigned long length = reader -> _data._length;
+    unsigned long n = 0;
+    while (true)
+    {
+        if (reader -> _separators == 0 && reader -> _nextBlock < length)
+        {
+            scanCsvBlock(reader);
+            continue;
+        }
+        unsigned long end = length;
+        bool isRowEnd = true;
+        if (reader -> _separators != 0)
+        {
+            unsigned int bit = (unsigned int) __builtin_ctzll(reader -> _separators);
+            end = reader -> _block + bit;
+            isRowEnd = (reader -> _rowEnds >> bit) & 1ULL;
+            reader -> _separators &= reader -> _separators - 1;
+        }
+        // The last row may end without a newline, but after the data there's no row.
+        else if (reader -> _fieldStart > length || (reader -> _fieldStart == length && n == 0))
+        {
+            return FALSE;
+        }
+        unsigned long fieldEnd = end;
+        // The row may end with "\r\n".
+        if (isRowEnd && fieldEnd > reader -> _fieldStart &&
+            chars[fieldEnd - 1] == CSV_CARRIAGE_RETURN)
+        {
+            fieldEnd--;
+        }
+        if (n < capacity)
+        {
+            fields[n]._chars = chars + reader -> _fieldStart;
+            fields[n]._length = fieldEnd - reader -> _fieldStart;
+        }
+        n++;
+        reader -> _fieldStart = end + 1;
+        if (isRowEnd)
+        {
+            break;
+        }
+    }
+    *count = n;
+    return unquoteCsvFields(arena, fields, n < capacity ? n : capacity) == MYSTRING_SUCCESS ?
+           TRUE : MYSTR_ERROR_CODE;
+}
+
+/**
+ * @brief Calculate the length of a cString.
+ * @param str the string to calculate the length of.
+ *
+ * @return the length of the string.
+ *
+  */
+
+static unsigned long getCStringLength(const char *str)
+{
+    unsigned long length = 0;
+    while (str[length] != END_OF_C_STRING)
+    {
+        length++;
+    }
+    return length;
+}
+
+/**
+ * @brief Change the length of the string in the heap.
+ * We use realloc to reuse the same address in the heap each time the string
+ * outgrows its capacity, and grow it at least twice so appending is amortized O(1).
+ * @param str the string we change the length of.
+ * @param newSize the new length to assign to the string.
+ *
+ * @return MYSTRING_ERROR if the reallocation failed (str is left unchanged),
+ * 			MYSTRING_SUCCESS if the reallocation succeeded.
+ */
+static MyStringRetVal adjustMyStringLength(MyString *str, unsigned long newSize)
+{
+    // An empty string doesn't need mapped or borrowed chars anymore.
+    if (newSize == EMPTY_STRING_LENGTH && str -> _capacity == 0)
+    {
+        releaseMyStringChars(str);
+    }
+    // Keep room for the '\0' after the chars. An empty string may stay without a block.
+    if (newSize >= str -> _capacity && newSize > EMPTY_STRING_LENGTH)
+    {
+        unsigned long newCapacity = str -> _capacity * CAPACITY_GROWTH_FACTOR;
+        if (newCapacity < newSize + 1)
+        {
+            newCapacity = newSize + 1;
+        }
+        if (setMyStringCapacity(str, newCapacity) == MYSTRING_ERROR)
+        {
+            return MYSTRING_ERROR;
+        }
+    }
+    // Update the size of the string in the struct.
+    setMyStringLength(str, newSize);
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Write the '\0' after the chars of a string.
+ * @param str the string.
+ */
+static void terminateMyString(MyString *str)
+{
+    // Without a block the string points to noChars, which is already terminated.
+    if (str -> _capacity > 0)
+    {
+        str -> _chars[str -> _length] = END_OF_C_STRING;
+    }
+}
+
+/**
+ * @brief Set the length of a string and write the '\0' after its chars.
+ * @param str the string.
+ * @param length the new length.
+ */
+static void setMyStringLength(MyString *str, unsigned long length)
+{
+    // Only the chars of blocks of the library count against the slack.
+    if (str -> _capacity > 0)
+    {
+        STATS_ADD(charsUsed, length - str -> _length);
+    }
+    str -> _length = length;
+    terminateMyString(str);
+}
+
+/**
+ * @brief Reallocate the chars of a string to an exact capacity.
+ * @param str the string.
+ * @param capacity the new capacity.
+ *
+ * @return MYSTRING_ERROR if the reallocation failed (str is left unchanged),
+ * 			MYSTRING_SUCCESS if the reallocation succeeded.
+ */
+static MyStringRetVal setMyStringCapacity(MyString *str, unsigned long capacity)
+{
+    // Small blocks come from the block cache, and so does the first block of a
+    // string without one. Mapped chars are copied to it on the first change.
+    if (capacity <= BLOCK_CACHE_MAX_SIZE || str -> _capacity == 0)
+    {
+        char *ownChars = (char *) allocateBlock(&capacity);
+        if (ownChars == NULL)
+        {
+            return MYSTRING_ERROR;
+        }
+        STATS_ALLOCATION(str -> _capacity > 0);
+        // Keep room for the '\0'.
+        unsigned long length = str -> _length < capacity ? str -> _length : capacity - 1;
+        memcpy(ownChars, str -> _chars, length);
+        releaseMyStringChars(str);
+        str -> _chars = ownChars;
+        str -> _capacity = capacity;
+        STATS_CHARS_BLOCK(str, 1);
+        setMyStringLength(str, length);
+        return MYSTRING_SUCCESS;
+    }
+    // Keep the old block until we know the reallocation succeeded.
+    char *newChars = (char *) realloc(str -> _chars, capacity);
+    if (newChars == NULL)
+    {
+        return MYSTRING_ERROR;
+    }
+    STATS_ALLOCATION(true);
+    STATS_BYTES(capacity - str -> _capacity);
+    STATS_ADD(charsCapacity, capacity - str -> _capacity);
+    str -> _chars = newChars;
+    str -> _capacity = capacity;
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Write the decimal digits of a number backwards.
+ * @param end pointer to the char after the last digit.
+ * @param n the number.
+ * @return pointer to the first digit (the minus sign if n is negative).
+ */
+static char* writeDecimalBackwards(char *end, long long n)
+{
+    // Work on the magnitude as unsigned, so the most negative number doesn't overflow.
+    unsigned long long magnitude = n < 0 ? 0ULL - (unsigned long long) n : (unsigned long long) n;
+    do
+    {
+        end--;
+        *end = (char) ('0' + magnitude % DIGIT_DIVIDER);
+        magnitude /= DIGIT_DIVIDER;
+    } while (magnitude != 0);
+    if (n < 0)
+    {
+        end--;
+        *end = '-';
+    }
+    return end;
+}
+
+/**
+ * @brief Free the block of a string, if it has one, leaving it empty without a block.
+ * @param str the string.
+ */
+static void releaseMyStringChars(MyString *str)
+{
+    // A string without a block points to noChars, which isn't ours to free.
+    if (str -> _mappedSize > 0)
+    {
+        munmap(str -> _chars, str -> _mappedSize);
+        STATS_SUB(libraryStats._mappedBytes, str -> _length);
+    }
+    else if (str -> _capacity > 0)
+    {
+        STATS_CHARS_BLOCK(str, -1);
+        releaseBlock(str -> _chars, str -> _capacity);
+    }
+    str -> _chars = noChars;
+    str -> _length = EMPTY_STRING_LENGTH;
+    str -> _capacity = 0;
+    str -> _mappedSize = 0;
+}
+
+/**
+ * @brief Give a string a block of its own to write to, if it doesn't have one.
+ * @param str the string.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal ownMyStringChars(MyString *str)
+{
+    if (str -> _capacity > 0)
+    {
+        return MYSTRING_SUCCESS;
+    }
+    if (setMyStringCapacity(str, str -> _length + 1) == MYSTRING_ERROR)
+    {
+        return MYSTRING_ERROR;
+    }
+    terminateMyString(str);
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Allocate a block from the block cache of the thread.
+ * @param size pointer to the size to allocate, set to the size of the block.
+ * @return the block, or NULL if the allocation failed.
+ */
+static void * allocateBlock(unsigned long *size)
+{
+    if (*size <= BLOCK_CACHE_MAX_SIZE)
+    {
+        unsigned int sizeClass = getBlockClass(*size);
+        *size = BLOCK_CACHE_MIN_SIZE << sizeClass;
+        FreeBlock *block = blockCache._heads[sizeClass];
+        if (block != NULL)
+        {
+            blockCache._heads[sizeClass] = block -> _next;
+            blockCache._counts[sizeClass]--;
+            STATS_SUB(libraryStats._cachedBytes, *size);
+            STATS_BYTES(*size);
+            return block;
+        }
+    }
+    void *block = malloc(*size);
+    if (block != NULL)
+    {
+        STATS_BYTES(*size);
+    }
+    return block;
+}
+
+/**
+ * @brief Give a block back to the block cache of the thread, or free it.
+ * @param block the block.
+ * @param size the size of the block, or the size it was requested with.
+ */
+static void releaseBlock(void *block, unsigned long size)
+{
+    if (size > BLOCK_CACHE_MAX_SIZE)
+    {
+        STATS_BYTES(-(long) size);
+        free(block);
+        return;
+    }
+    unsigned int sizeClass = getBlockClass(size);
+    STATS_BYTES(-(long) (BLOCK_CACHE_MIN_SIZE << sizeClass));
+    if (blockCache._counts[sizeClass] >= BLOCK_CACHE_DEPTH || !registerBlockCache())
+    {
+        free(block);
+        return;
+    }
+    FreeBlock *freeBlock = (FreeBlock *) block;
+    freeBlock -> _next = blockCache._heads[sizeClass];
+    blockCache._heads[sizeClass] = freeBlock;
+    blockCache._counts[sizeClass]++;
+    STATS_ADD(libraryStats._cachedBytes, BLOCK_CACHE_MIN_SIZE << sizeClass);
+}
+
+/**
+ * @brief Get the size class of a block, the first whose size is big enough.
+ * @param size the size of the block.
+ * @return the size class.
+ */
+static unsigned int getBlockClass(unsigned long size)
+{
+    if (size <= BLOCK_CACHE_MIN_SIZE)
+    {
+        return 0;
+    }
+#ifdef __GNUC__
+    // The number of bits of size - 1 is the shift of the first power of two which
+    // is at least size.
+    unsigned int shift = sizeof(unsigned long) * CHAR_BIT - __builtin_clzl(size - 1);
+    return shift - BLOCK_CACHE_MIN_SHIFT;
+#else
+    unsigned int sizeClass = 0;
+    while ((BLOCK_CACHE_MIN_SIZE << sizeClass) < size)
+    {
+        sizeClass++;
+    }
+    return sizeClass;
+#endif
+}
+
+/**
+ * @brief Make sure the block cache of the thread is flushed when the thread exits.
+ * @return true if the cache may keep blocks, false otherwise.
+ */
+static bool registerBlockCache()
+{
+    if (blockCache._isRegistered)
+    {
+        return true;
+    }
+    pthread_once(&blockCacheKeyOnce, createBlockCacheKey);
+    // Without the key the blocks would be lost when the thread exits.
+    if (!isBlockCacheKeyCreated || pthread_setspecific(blockCacheKey, &blockCache) != 0)
+    {
+        return false;
+    }
+    blockCache._isRegistered = true;
+    return true;
+}
+
+/**
+ * @brief Create the key through which block caches are flushed.
+ */
+static void createBlockCacheKey()
+{
+    isBlockCacheKeyCreated = pthread_key_create(&blockCacheKey, flushBlockCache) == 0;
+}
+
+/**
+ * @brief Free all the blocks of a block cache.
+ * @param cache the cache.
+ */
+static void flushBlockCache(void *cache)
+{
+    BlockCache *blocks = (BlockCache *) cache;
+    for (unsigned int sizeClass = 0; sizeClass < BLOCK_CACHE_CLASSES; sizeClass++)
+    {
+        while (blocks -> _heads[sizeClass] != NULL)
+        {
+            FreeBlock *block = blocks -> _heads[sizeClass];
+            blocks -> _heads[sizeClass] = block -> _next;
+            free(block);
+            STATS_SUB(libraryStats._cachedBytes, BLOCK_CACHE_MIN_SIZE << sizeClass);
+        }
+        blocks -> _counts[sizeClass] = 0;
+    }
+    // Blocks freed later by the thread (by other destructors) register it again.
+    blocks -> _isRegistered = false;
+}
+
+#ifdef MYSTRING_STATS
+/**
+ * @brief Start counting the allocations of the thread by a site, unless they are
+ * already counted by another one.
+ * @param site the site.
+ * @return the site the allocations were counted by before.
+ */
+static MyStringSite enterStatsSite(MyStringSite site)
+{
+    MyStringSite outerSite = currentStatsSite;
+    if (outerSite == MYSTRING_SITE_OTHER)
+    {
+        currentStatsSite = site;
+    }
+    return outerSite;
+}
+
+/**
+ * @brief Add to the live bytes, keeping the peak.
+ * @param delta the bytes to add, negative to subtract.
+ */
+static void addLiveBytes(long delta)
+{
+    unsigned long liveBytes = STATS_ADD(libraryStats._liveBytes, delta) + (unsigned long) delta;
+    unsigned long peakBytes = STATS_LOAD(libraryStats._peakBytes);
+    // Another thread may raise the peak meanwhile, so we retry until ours is lower.
+    while (delta > 0 && liveBytes > peakBytes &&
+           !__atomic_compare_exchange_n(&libraryStats._peakBytes, &peakBytes, liveBytes, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+    }
+}
+
+/**
+ * @brief Count an allocation by the current site, and dump the counters if it's time.
+ * @param isReallocation whether a block was replaced by a bigger one.
+ */
+static void countAllocation(bool isReallocation)
+{
+    if (isReallocation)
+    {
+        STATS_ADD(libraryStats._reallocations[currentStatsSite], 1);
+    }
+    else
+    {
+        STATS_ADD(libraryStats._allocations[currentStatsSite], 1);
+    }
+    if (STATS_LOAD(statsDumpPeriod) == 0)
+    {
+        return;
+    }
+    // The allocation which brings the countdown to 0 dumps, and starts it over.
+    if (STATS_SUB(statsDumpCountdown, 1) == 1)
+    {
+        STATS_ADD(statsDumpCountdown, STATS_LOAD(statsDumpPeriod));
+        myStringStatsDump(statsDumpStream);
+    }
+}
+
+/**
+ * @brief Count the block of a string in the slack, as it's given to the string or
+ * taken from it.
+ * @param str the string.
+ * @param sign 1 when the block is given, -1 when it's taken.
+ */
+static void countCharsBlock(const MyString *str, int sign)
+{
+    // The '\0' is used too.
+    if (sign > 0)
+    {
+        STATS_ADD(charsCapacity, str -> _capacity);
+        STATS_ADD(charsUsed, str -> _length + 1);
+    }
+    else
+    {
+        STATS_SUB(charsCapacity, str -> _capacity);
+        STATS_SUB(charsUsed, str -> _length + 1);
+    }
+}
+#endif
+
+/**
+ * @brief Map the chars of a file to a string, with a '\0' after them.
+ * We first reserve zeroed pages for the file and one more char, and then map the file
+ * over them, so the '\0' is there even when the file fills its last page.
+ * @param str the string, which has no block.
+ * @param fd the file.
+ * @param fileSize the size of the file, bigger than 0.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal mapFileChars(MyString *str, int fd, unsigned long fileSize)
+{
+    long pageSize = sysconf(_SC_PAGESIZE);
+    if (pageSize <= 0)
+    {
+        return MYSTRING_ERROR;
+    }
+    unsigned long mappedSize = (fileSize / pageSize + 1) * pageSize;
+    char *chars = (char *) mmap(NULL, mappedSize, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (chars == MAP_FAILED)
+    {
+        return MYSTRING_ERROR;
+    }
+    if (mmap(chars, fileSize, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED)
+    {
+        munmap(chars, mappedSize);
+        return MYSTRING_ERROR;
+    }
+    // The hints only save time, so we don't fail without them.
+    madvise(chars, fileSize, MADV_SEQUENTIAL);
+    madvise(chars, fileSize, MADV_WILLNEED);
+    str -> _chars = chars;
+    str -> _length = fileSize;
+    str -> _mappedSize = mappedSize;
+    STATS_ADD(libraryStats._mappedBytes, fileSize);
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Sets dst to be the strings of parts, with sep between every two of them.
+ * @param dst
+ * @param parts
+ * @param n the number of parts.
+ * @param sep the separator, or NULL for none.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal joinMyStrings(MyString *dst, const MyString *parts[], unsigned long n,
+									const MyString *sep)
+{
+    if (dst == NULL || (parts == NULL && n > 0))
+    {
+        return MYSTRING_ERROR;
+    }
+    // Sum the lengths first, so we allocate only once.
+    unsigned long sepLength = sep == NULL ? EMPTY_STRING_LENGTH : sep -> _length;
+    unsigned long totalLength = 0;
+    bool dstIsSource = (sep == dst);
+    unsigned long i = 0;
+    for (i = 0; i < n; i++)
+    {
+        if (parts[i] == NULL)
+        {
+            return MYSTRING_ERROR;
+        }
+        totalLength += parts[i] -> _length;
+        dstIsSource = dstIsSource || parts[i] == dst;
+    }
+    if (n > 1)
+    {
+        totalLength += sepLength * (n - 1);
+    }
+    // When dst is also a source we can't write over it, so we build the result in a
+    // new block and only then replace the chars of dst.
+    // The old value of dst is dropped anyway, so there's nothing to copy on growth.
+    char *chars = dst -> _chars;
+    // One more char for the '\0'.
+    unsigned long requiredCapacity = totalLength + 1;
+    unsigned long newCapacity = requiredCapacity > dst -> _capacity ?
+                                requiredCapacity : dst -> _capacity;
+    if (dstIsSource || requiredCapacity > dst -> _capacity)
+    {
+        chars = (char *) allocateBlock(&newCapacity);
+        if (chars == NULL)
+        {
+            return MYSTRING_ERROR;
+        }
+        STATS_ALLOCATION(dst -> _capacity > 0);
+    }
+    char *next = chars;
+    for (i = 0; i < n; i++)
+    {
+        if (i > 0 && sepLength > 0)
+        {
+            memcpy(next, sep -> _chars, sepLength);
+            next += sepLength;
+        }
+        memcpy(next, parts[i] -> _chars, parts[i] -> _length);
+        next += parts[i] -> _length;
+    }
+    if (chars != dst -> _chars)
+    {
+        releaseMyStringChars(dst);
+        dst -> _chars = chars;
+        dst -> _capacity = newCapacity;
+        STATS_CHARS_BLOCK(dst, 1);
+    }
+    setMyStringLength(dst, totalLength);
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Get the number of digits of a given integer number.
+ * @param n the number we get the digits of.
+ *
+ * @return the number of digits.
+ */
+static int getNumOfDigits(int n)
+{
+    int numOfDigits = 0;
+    // Minus sign or zero cases.
+    if (n <= 0)
+    {
+        numOfDigits++;
+    }
+    // The number is zero with 1 digit.
+    if (n == 0)
+    {
+        return numOfDigits;
+    }
+    // Go over the number's digits by division to calculate them.
+    while (n != 0)
+    {
+        n = n / DIGIT_DIVIDER;
+        numOfDigits++;
+    }
+    return numOfDigits;
+}
+/**
+ * @brief Wrapper function of a comparator for the qsort function.
+ * @param str1
+ * @param str2
+ * @return The value the default comparator returned (1/0/-1).
+ *
+ */
+static int myStringComparator(const void *str1, const void *str2)
+{
+	MyString** temp1 = (MyString **) str1;
+	MyString** temp2 = (MyString **) str2;
+	return myStringCompare(*temp1, *temp2);
+}
+
+/**
+ * @brief Creates an empty string with length 0 in the heap.
+ * @param p_myString The string we alloc.
+ * @return Pointer to the chars of the string if we succeeded, NULL otherwise.
+ *
+ */
+static char* emptyStringAlloc(MyString *p_myString)
+{
+    unsigned long capacity = sizeof(char);
+    p_myString -> _chars = (char *) allocateBlock(&capacity);
+    if (p_myString -> _chars == NULL)
+    {
+    	return NULL;
+    }
+    STATS_ALLOCATION(false);
+    // Assign empty string.
+    *(p_myString -> _chars) = END_OF_C_STRING;
+    p_myString -> _length = EMPTY_STRING_LENGTH;
+    p_myString -> _capacity = capacity;
+    p_myString -> _mappedSize = 0;
+    STATS_CHARS_BLOCK(p_myString, 1);
+    return p_myString -> _chars;
+}
+
+/**
+ * @brief Compare two arrays of chars by the weights of a single collation level.
+ * @param weights the weight table of the level.
+ * @param hasIgnorables whether some of the weights are ignorable.
+ * @param chars1
+ * @param length1
+ * @param chars2
+ * @param length2
+ * @return STR1_BIGGER, STR2_BIGGER or EQUAL_STRINGS.
+ */
+static int collationCompareLevel(const unsigned char *weights, bool hasIgnorables,
+								 const char *chars1, unsigned long length1,
+								 const char *chars2, unsigned long length2)
+{
+    const unsigned char *bytes1 = (const unsigned char *) chars1;
+    const unsigned char *bytes2 = (const unsigned char *) chars2;
+    unsigned long i = 0;
+    unsigned long j = 0;
+    if (!hasIgnorables)
+    {
+        // Every char has a weight, so the strings advance together.
+        unsigned long minLength = length1 < length2 ? length1 : length2;
+        for (i = 0; i < minLength; i++)
+        {
+            if (weights[bytes1[i]] != weights[bytes2[i]])
+            {
+                return weights[bytes1[i]] > weights[bytes2[i]] ? STR1_BIGGER : STR2_BIGGER;
+            }
+        }
+        if (length1 != length2)
+        {
+            return length1 > length2 ? STR1_BIGGER : STR2_BIGGER;
+        }
+        return EQUAL_STRINGS;
+    }
+    while (true)
+    {
+        // Skip the chars which have no weight at this level.
+        while (i < length1 && weights[bytes1[i]] == MYSTRING_COLLATION_IGNORABLE)
+        {
+            i++;
+        }
+        while (j < length2 && weights[bytes2[j]] == MYSTRING_COLLATION_IGNORABLE)
+        {
+            j++;
+        }
+        if (i == length1 || j == length2)
+        {
+            break;
+        }
+        if (weights[bytes1[i]] != weights[bytes2[j]])
+        {
+            return weights[bytes1[i]] > weights[bytes2[j]] ? STR1_BIGGER : STR2_BIGGER;
+        }
+        i++;
+        j++;
+    }
+    // One of the strings ran out of weighted chars, the other one is bigger if it still has some.
+    if (i < length1)
+    {
+        return STR1_BIGGER;
+    }
+    if (j < length2)
+    {
+        return STR2_BIGGER;
+    }
+    return EQUAL_STRINGS;
+}
+
+/**
+ * @brief Calculate the length of the collation key of a string.
+ * @param str the string.
+ * @param collation the collation.
+ * @return the length of the key.
+ */
+static unsigned long getCollationKeyLength(const MyString *str,
+										   const MyStringCollation *collation)
+{
+    // One separator between every two levels.
+    unsigned long keyLength = collation -> _levels - 1;
+    unsigned int level = 0;
+    for (level = 0; level < collation -> _levels; level++)
+    {
+        if (!collation -> _hasIgnorables[level])
+        {
+            keyLength += str -> _length;
+            continue;
+        }
+        const unsigned char *weights = collation -> _weights[level];
+        unsigned long i = 0;
+        for (i = 0; i < str -> _length; i++)
+        {
+            if (weights[(unsigned char) str -> _chars[i]] != MYSTRING_COLLATION_IGNORABLE)
+            {
+                keyLength++;
+            }
+        }
+    }
+    return keyLength;
+}
+
+/**
+ * @brief Create the collation key of a string.
+ * @param key the key to fill, of the length getCollationKeyLength returned.
+ * @param str the string.
+ * @param collation the collation.
+ */
+static void createCollationKey(unsigned char *key, const MyString *str,
+							   const MyStringCollation *collation)
+{
+    unsigned int level = 0;
+    for (level = 0; level < collation -> _levels; level++)
+    {
+        if (level > 0)
+        {
+            *key = MYSTRING_COLLATION_IGNORABLE;
+            key++;
+        }
+        const unsigned char *weights = collation -> _weights[level];
+        unsigned long i = 0;
+        for (i = 0; i < str -> _length; i++)
+        {
+            unsigned char weight = weights[(unsigned char) str -> _chars[i]];
+            if (weight != MYSTRING_COLLATION_IGNORABLE)
+            {
+                *key = weight;
+                key++;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Comparator of collation keys for the qsort function.
+ * @param key1
+ * @param key2
+ * @return The value the keys comparison returned (1/0/-1).
+ */
+static int collationKeyComparator(const void *key1, const void *key2)
+{
+    const CollationKey *temp1 = (const CollationKey *) key1;
+    const CollationKey *temp2 = (const CollationKey *) key2;
+    unsigned long minLength = temp1 -> _length < temp2 -> _length ?
+                              temp1 -> _length : temp2 -> _length;
+    int result = memcmp(temp1 -> _key, temp2 -> _key, minLength);
+    if (result != EQUAL_STRINGS)
+    {
+        return result > EQUAL_STRINGS ? STR1_BIGGER : STR2_BIGGER;
+    }
+    if (temp1 -> _length != temp2 -> _length)
+    {
+        return temp1 -> _length > temp2 -> _length ? STR1_BIGGER : STR2_BIGGER;
+    }
+    return EQUAL_STRINGS;
+}
+
+/**
+ * @brief Sort pairs by their keys with an LSD radix sort. The sort is stable.
+ * @param pairs the pairs to sort.
+ * @param len the number of pairs.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR if an allocation failed.
+ */
+static MyStringRetVal radixSortKeyPairs(SortKeyPair *pairs, unsigned long len)
+{
+    const unsigned int passes = MYSTRING_RADIX_PASSES;
+    unsigned long counts[MYSTRING_RADIX_PASSES][MYSTRING_RADIX_BUCKETS];
+    memset(counts, 0, sizeof(counts));
+    // Count the buckets of all the passes in a single scan.
+    unsigned long i = 0;
+    unsigned int pass = 0;
+    for (i = 0; i < len; i++)
+    {
+        unsigned long long key = pairs[i]._key;
+        for (pass = 0; pass < passes; pass++)
+        {
+            counts[pass][key & (MYSTRING_RADIX_BUCKETS - 1)]++;
+            key >>= MYSTRING_RADIX_BITS;
+        }
+    }
+    SortKeyPair *buffer = (SortKeyPair *) malloc(len * sizeof(SortKeyPair));
+    if (buffer == NULL)
+    {
+        return MYSTRING_ERROR;
+    }
+    SortKeyPair *source = pairs;
+    SortKeyPair *destination = buffer;
+    for (pass = 0; pass < passes; pass++)
+    {
+        unsigned int shift = pass * MYSTRING_RADIX_BITS;
+        unsigned long *passCounts = counts[pass];
+        // All the keys share this digit, the pass wouldn't move anything.
+        if (passCounts[(source[0]._key >> shift) & (MYSTRING_RADIX_BUCKETS - 1)] == len)
+        {
+            continue;
+        }
+        // Turn the counts into the first position of every bucket.
+        unsigned long position = 0;
+        unsigned int bucket = 0;
+        for (bucket = 0; bucket < MYSTRING_RADIX_BUCKETS; bucket++)
+        {
+            unsigned long count = passCounts[bucket];
+            passCounts[bucket] = position;
+            position += count;
+        }
+        for (i = 0; i < len; i++)
+        {
+            destination[passCounts[(source[i]._key >> shift) & (MYSTRING_RADIX_BUCKETS - 1)]++] =
+                source[i];
+        }
+        SortKeyPair *temp = source;
+        source = destination;
+        destination = temp;
+    }
+    if (source != pairs)
+    {
+        memcpy(pairs, source, len * sizeof(SortKeyPair));
+    }
+    free(buffer);
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Get the first chars of an array of chars as an integer.
+ * @param chars
+ * @param length
+ * @return the prefix key.
+ */
+static unsigned long long getPrefixKey(const char *chars, unsigned long length)
+{
+    unsigned long long key = 0;
+    unsigned int i = 0;
+    for (i = 0; i < sizeof(unsigned long long); i++)
+    {
+        key <<= CHAR_BIT;
+        if (i < length)
+        {
+            key |= (unsigned char) chars[i];
+        }
+    }
+    return key;
+}
+
+/**
+ * @brief Reorder arr by the indices of sorted pairs.
+ * @param arr
+ * @param pairs sorted pairs, holding every index of arr once.
+ * @param len
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR if an allocation failed.
+ */
+static MyStringRetVal applySortPermutation(MyString *arr[], const SortKeyPair *pairs,
+										   unsigned long len)
+{
+    MyString **sorted = (MyString **) malloc(len * sizeof(MyString *));
+    if (sorted == NULL)
+    {
+        return MYSTRING_ERROR;
+    }
+    unsigned long i = 0;
+    for (i = 0; i < len; i++)
+    {
+        sorted[i] = arr[pairs[i]._index];
+    }
+    memcpy(arr, sorted, len * sizeof(MyString *));
+    free(sorted);
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Load a word of chars from any address.
+ * @param chars
+ * @return the word.
+ */
+static unsigned long long loadWord(const unsigned char *chars)
+{
+    // memcpy is safe for unaligned addresses, and compiles to a single load.
+    unsigned long long word = 0;
+    memcpy(&word, chars, WORD_SIZE);
+    return word;
+}
+
+/**
+ * @brief Count the chars of a word which have their high bit set.
+ * @param highBits a word where only the high bits of chars may be set.
+ * @return the number of set high bits.
+ */
+static unsigned int countHighBits(unsigned long long highBits)
+{
+    // Move every high bit to the low bit of its char, then sum all the chars
+    // into the top char by multiplication.
+    return (unsigned int) ((((highBits >> (CHAR_BIT - 1)) * LOW_BITS_MASK)) >> TOP_BYTE_SHIFT);
+}
+
+/**
+ * @brief Get the length of the ascii prefix of an array of chars.
+ * @param chars
+ * @param length
+ * @return the number of chars until the first non ascii char.
+ */
+static unsigned long getAsciiPrefixLength(const unsigned char *chars, unsigned long length)
+{
+    unsigned long i = 0;
+#ifdef __SSE2__
+    for (; i + SSE2_BLOCK_SIZE <= length; i += SSE2_BLOCK_SIZE)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i *) (chars + i));
+        if (_mm_movemask_epi8(block) != 0)
+        {
+            break;
+        }
+    }
+#endif
+    for (; i + WORD_SIZE <= length; i += WORD_SIZE)
+    {
+        if ((loadWord(chars + i) & HIGH_BITS_MASK) != 0)
+        {
+            break;
+        }
+    }
+    while (i < length && chars[i] <= SCHAR_MAX)
+    {
+        i++;
+    }
+    return i;
+}
+
+/**
+ * @brief Skip code points in UTF-8 chars.
+ * @param chars
+ * @param length
+ * @param from the index of the lead char to start from.
+ * @param count pointer to the number of code points to skip.
+ * @return the index of the lead char of the code point after the skipped ones, or
+ *  length if the chars ran out before.
+ */
+static unsigned long skipCodePoints(const unsigned char *chars, unsigned long length,
+									unsigned long from, unsigned long *count)
+{
+    unsigned long i = from;
+    // Skip whole words as long as all of their code points should be skipped.
+    for (; i + WORD_SIZE <= length; i += WORD_SIZE)
+    {
+        unsigned long long word = loadWord(chars + i);
+        unsigned long leadChars = WORD_SIZE - countHighBits(word & ~(word << 1) & HIGH_BITS_MASK);
+        if (leadChars > *count)
+        {
+            break;
+        }
+        *count -= leadChars;
+    }
+    for (; i < length; i++)
+    {
+        if ((chars[i] & UTF8_CONTINUATION_MASK) != UTF8_CONTINUATION_BITS)
+        {
+            if (*count == 0)
+            {
+                break;
+            }
+            (*count)--;
+        }
+    }
+    return i;
+}
+
+
+
+
+
+
+/**
+ * @brief Sort the strings of a reader in runs which fit in the memory budget.
+ * @param reader the reader of the input.
+ * @param out the output, for strings which fit in a single run.
+ * @param options the options of the sort.
+ * @param runs the runs.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal createSortedRuns(RecordReader *reader, FILE *out,
+                                       const MyStringExternalSortOptions *options,
+                                       RunFile *runs)
+{
+    MyString **records = NULL;
+    unsigned long n = 0;
+    unsigned long capacity = 0;
+    unsigned long usedBytes = 0;
+    bool hasRecord = true;
+    MyStringRetVal result = MYSTRING_SUCCESS;
+    while (result == MYSTRING_SUCCESS && hasRecord)
+    {
+        if (n == capacity)
+        {
+            unsigned long newCapacity = capacity == 0 ? RUN_INITIAL_RECORDS :
+                                        capacity * CAPACITY_GROWTH_FACTOR;
+            MyString **newRecords = (MyString **) realloc(records, newCapacity * sizeof(MyString *));
+            if (newRecords == NULL)
+            {
+                result = MYSTRING_ERROR;
+                break;
+            }
+            records = newRecords;
+            capacity = newCapacity;
+        }
+        MyString *record = myStringAlloc();
+        unsigned long count = 0;
+        result = record == NULL ? MYSTRING_ERROR : readRecord(reader, record, &count, &hasRecord);
+        if (result == MYSTRING_SUCCESS && hasRecord)
+        {
+            records[n++] = record;
+            usedBytes += myStringMemUsage(record) + sizeof(MyString *);
+        }
+        else
+        {
+            myStringFree(record);
+        }
+        if (result == MYSTRING_SUCCESS && n > 0 &&
+            (usedBytes >= options -> _memoryBudget || !hasRecord))
+        {
+            // The last run goes straight to the output when it's the only one.
+            FILE *runOut = !hasRecord && runs -> _count == 0 ? out : NULL;
+            result = writeSortedRun(records, n, runOut, options, runs);
+            for (unsigned long i = 0; i < n; i++)
+            {
+                myStringFree(records[i]);
+            }
+            n = 0;
+            usedBytes = 0;
+        }
+    }
+    for (unsigned long i = 0; i < n; i++)
+    {
+        myStringFree(records[i]);
+    }
+    free(records);
+    return result;
+}
+
+/**
+ * @brief Sort the strings of a run and write them.
+ * @param records the strings.
+ * @param n the number of strings.
+ * @param out the output, or NULL to write a new run.
+ * @param options the options of the sort.
+ * @param runs the runs.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal writeSortedRun(MyString *records[], unsigned long n, FILE *out,
+                                     const MyStringExternalSortOptions *options,
+                                     RunFile *runs)
+{
+    myStringSort(records, n);
+    FILE *file = out;
+    if (out == NULL)
+    {
+        if (runs -> _file == NULL)
+        {
+            runs -> _file = createRunFile(options -> _tempDir);
+        }
+        if (runs -> _file == NULL)
+        {
+            return MYSTRING_ERROR;
+        }
+        file = runs -> _file;
+    }
+    RecordWriter writer;
+    if (initRecordWriter(&writer, file, options, out == NULL) == MYSTRING_SUCCESS)
+    {
+        for (unsigned long i = 0; i < n; i++)
+        {
+            putRecord(&writer, records[i], 1);
+        }
+    }
+    MyStringRetVal result = closeRecordWriter(&writer);
+    return result == MYSTRING_SUCCESS && out == NULL ? addRunEnd(runs) : result;
+}
+
+/**
+ * @brief Merge all the runs to out, in passes of as many runs as the budget allows.
+ * Every pass merges the runs of a file in groups to the runs of a new one.
+ * @param runs the runs.
+ * @param out the output.
+ * @param options the options of the sort.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal mergeAllRuns(RunFile *runs, FILE *out,
+                                   const MyStringExternalSortOptions *options)
+{
+    // Every run merged at once needs a buffer, and so does the file merged to.
+    unsigned long fanIn = options -> _memoryBudget / options -> _bufferSize;
+    fanIn = fanIn > MIN_MERGE_FAN_IN ? fanIn - 1 : MIN_MERGE_FAN_IN;
+    while (runs -> _count > fanIn)
+    {
+        RunFile merged = {createRunFile(options -> _tempDir), NULL, 0, 0};
+        MyStringRetVal result = merged._file == NULL ? MYSTRING_ERROR : MYSTRING_SUCCESS;
+        for (unsigned long first = 0; result == MYSTRING_SUCCESS && first < runs -> _count;
+             first += fanIn)
+        {
+            unsigned long n = runs -> _count - first < fanIn ? runs -> _count - first : fanIn;
+            result = mergeRuns(runs, first, n, merged._file, options, true);
+            if (result == MYSTRING_SUCCESS)
+            {
+                result = addRunEnd(&merged);
+            }
+        }
+        closeRunFile(runs);
+        *runs = merged;
+        if (result == MYSTRING_ERROR)
+        {
+            return MYSTRING_ERROR;
+        }
+    }
+    return mergeRuns(runs, 0, runs -> _count, out, options, false);
+}
+
+/**
+ * @brief Merge runs to a file by a loser tree.
+ * @param runs the runs.
+ * @param first the first run to merge.
+ * @param n the number of runs to merge.
+ * @param file the file to write to.
+ * @param options the options of the sort.
+ * @param isRun whether file is a run.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal mergeRuns(const RunFile *runs, unsigned long first, unsigned long n,
+                                FILE *file, const MyStringExternalSortOptions *options,
+                                bool isRun)
+{
+    MergeRun *merge = (MergeRun *) calloc(n, sizeof(MergeRun));
+    unsigned long *tree = (unsigned long *) malloc(n * sizeof(unsigned long));
+    RecordWriter writer;
+    bool isReady = initRecordWriter(&writer, file, options, isRun) == MYSTRING_SUCCESS &&
+                   merge != NULL && tree != NULL;
+    for (unsigned long i = 0; isReady && i < n; i++)
+    {
+        merge[i]._head = myStringAlloc();
+        isReady = merge[i]._head != NULL &&
+                  initRecordReader(&merge[i]._reader, runs -> _file, options -> _format, true,
+                                   options -> _bufferSize) == MYSTRING_SUCCESS;
+        if (isReady)
+        {
+            const unsigned long *offsets = runs -> _offsets + first + i;
+            merge[i]._reader._offset = offsets[0];
+            merge[i]._reader._left = offsets[1] - offsets[0];
+        }
+        isReady = isReady &&
+                  readRecord(&merge[i]._reader, merge[i]._head, &merge[i]._count,
+                             &merge[i]._hasHead) == MYSTRING_SUCCESS;
+    }
+    MyStringRetVal result = isReady ? MYSTRING_SUCCESS : MYSTRING_ERROR;
+    if (isReady)
+    {
+        initLoserTree(merge, tree, n);
+        while (merge[tree[0]]._hasHead && result == MYSTRING_SUCCESS)
+        {
+            MergeRun *winner = merge + tree[0];
+            putRecord(&writer, winner -> _head, winner -> _count);
+            result = readRecord(&winner -> _reader, winner -> _head, &winner -> _count,
+                                &winner -> _hasHead);
+            replayLoserTree(merge, tree, n, tree[0]);
+        }
+    }
+    if (closeRecordWriter(&writer) == MYSTRING_ERROR)
+    {
+        result = MYSTRING_ERROR;
+    }
+    for (unsigned long i = 0; merge != NULL && i < n; i++)
+    {
+        free(merge[i]._reader._buffer);
+        myStringFree(merge[i]._head);
+    }
+    free(merge);
+    free(tree);
+    return result;
+}
+
+/**
+ * @brief Build a loser tree over the heads of runs. Every node starts with the run
+ * which comes before all, and the runs are played from the last one, so every run
+ * replaces one of them until the root has the real winner.
+ * @param runs the runs.
+ * @param tree the nodes of the tree.
+ * @param n the number of runs.
+ */
+static void initLoserTree(const MergeRun *runs, unsigned long *tree, unsigned long n)
+{
+    for (unsigned long node = 0; node < n; node++)
+    {
+        tree[node] = n;
+    }
+    for (unsigned long run = n; run > 0; run--)
+    {
+        replayLoserTree(runs, tree, n, run - 1);
+    }
+}
+
+/**
+ * @brief Replay the matches of a run from its leaf to the root. The leaves are
+ * numbered after the nodes, so the leaf of run is n + run.
+ * @param runs the runs.
+ * @param tree the nodes of the tree.
+ * @param n the number of runs.
+ * @param run the run whose head changed.
+ */
+static void replayLoserTree(const MergeRun *runs, unsigned long *tree, unsigned long n,
+                            unsigned long run)
+{
+    unsigned long winner = run;
+    for (unsigned long node = (n + run) / 2; node > 0; node /= 2)
+    {
+        if (isMergeRunBefore(runs, n, tree[node], winner))
+        {
+            unsigned long loser = winner;
+            winner = tree[node];
+            tree[node] = loser;
+        }
+    }
+    tree[0] = winner;
+}
+
+/**
+ * @brief Check if the head of a run comes before the head of another. Equal heads
+ * come in the order of their runs.
+ * @param runs the runs.
+ * @param n the number of runs.
+ * @param run1
+ * @param run2
+ * @return true if the head of run1 comes first.
+ */
+static bool isMergeRunBefore(const MergeRun *runs, unsigned long n, unsigned long run1,
+                             unsigned long run2)
+{
+    if (run1 == n || run2 == n)
+    {
+        return run1 == n;
+    }
+    if (!runs[run1]._hasHead || !runs[run2]._hasHead)
+    {
+        return runs[run1]._hasHead;
+    }
+    int compared = myStringCompare(runs[run1]._head, runs[run2]._head);
+    return compared < EQUAL_STRINGS || (compared == EQUAL_STRINGS && run1 < run2);
+}
+
+/**
+ * @brief Create a temporary file for a run.
+ * @param dir the directory of the file, or NULL.
+ * @return the file, or NULL on failure.
+ */
+static FILE * createRunFile(const char *dir)
+{
+    if (dir == NULL)
+    {
+        return tmpfile();
+    }
+    unsigned long dirLength = getCStringLength(dir);
+    char *path = (char *) malloc(dirLength + sizeof(RUN_FILE_TEMPLATE));
+    if (path == NULL)
+    {
+        return NULL;
+    }
+    memcpy(path, dir, dirLength);
+    memcpy(path + dirLength, RUN_FILE_TEMPLATE, sizeof(RUN_FILE_TEMPLATE));
+    FILE *file = NULL;
+    int fd = mkstemp(path);
+    if (fd >= 0)
+    {
+        // Like tmpfile(), the file has no name, so it's deleted when it's closed.
+        unlink(path);
+        file = fdopen(fd, "w+b");
+        if (file == NULL)
+        {
+            close(fd);
+        }
+    }
+    free(path);
+    return file;
+}
+
+/**
+ * @brief Add a run which was written to the end of the file of the runs.
+ * @param runs the runs.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal addRunEnd(RunFile *runs)
+{
+    // The offsets hold the end of the last run after the start of every run.
+    if (runs -> _count + 2 > runs -> _capacity)
+    {
+        unsigned long capacity = runs -> _capacity == 0 ? RUN_INITIAL_RECORDS :
+                                 runs -> _capacity * CAPACITY_GROWTH_FACTOR;
+        unsigned long *offsets = (unsigned long *) realloc(runs -> _offsets,
+                                                           capacity * sizeof(unsigned long));
+        if (offsets == NULL)
+        {
+            return MYSTRING_ERROR;
+        }
+        if (runs -> _capacity == 0)
+        {
+            offsets[0] = 0;
+        }
+        runs -> _offsets = offsets;
+        runs -> _capacity = capacity;
+    }
+    off_t end = ftello(runs -> _file);
+    if (end < 0)
+    {
+        return MYSTRING_ERROR;
+    }
+    runs -> _offsets[++runs -> _count] = (unsigned long) end;
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Close the file of runs and free their offsets.
+ * @param runs the runs.
+ */
+static void closeRunFile(RunFile *runs)
+{
+    if (runs -> _file != NULL)
+    {
+        fclose(runs -> _file);
+    }
+    free(runs -> _offsets);
+    runs -> _file = NULL;
+    runs -> _offsets = NULL;
+    runs -> _count = 0;
+    runs -> _capacity = 0;
+}
+
+/**
+ * @brief Initialize a reader of records.
+ * @param reader the reader.
+ * @param file the file to read.
+ * @param format the format of the records.
+ * @param isRun whether the file is a run.
+ * @param bufferSize the size of the buffer.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal initRecordReader(RecordReader *reader, FILE *file,
+                                       MyStringRecordFormat format, bool isRun,
+                                       unsigned long bufferSize)
+{
+    reader -> _file = file;
+    reader -> _buffer = (char *) malloc(bufferSize);
+    reader -> _bufferSize = bufferSize;
+    reader -> _start = 0;
+    reader -> _end = 0;
+    reader -> _format = format;
+    reader -> _isRun = isRun;
+    reader -> _offset = 0;
+    reader -> _left = 0;
+    return reader -> _buffer == NULL ? MYSTRING_ERROR : MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Read the next chars of the file to the buffer of a reader. The runs share a
+ * file, so the chars of a run are read from its own offset, up to its end.
+ * @param reader the reader.
+ * @return the number of chars in the buffer which weren't read yet.
+ */
+static unsigned long fillRecordReader(RecordReader *reader)
+{
+    if (reader -> _start == reader -> _end)
+    {
+        reader -> _start = 0;
+        if (!reader -> _isRun)
+        {
+            reader -> _end = fread(reader -> _buffer, sizeof(char), reader -> _bufferSize,
+                                   reader -> _file);
+        }
+        else if (reader -> _left == 0 || fseeko(reader -> _file, (off_t) reader -> _offset,
+                                                SEEK_SET) != 0)
+        {
+            reader -> _end = 0;
+        }
+        else
+        {
+            unsigned long size = reader -> _left < reader -> _bufferSize ? reader -> _left :
+                                 reader -> _bufferSize;
+            reader -> _end = fread(reader -> _buffer, sizeof(char), size, reader -> _file);
+            reader -> _offset += reader -> _end;
+            reader -> _left -= reader -> _end;
+        }
+    }
+    return reader -> _end - reader -> _start;
+}
+
+/**
+ * @brief Read the next record of a reader.
+ * @param reader the reader.
+ * @param record the string to set.
+ * @param count pointer to set to the count of the record.
+ * @param hasRecord pointer to set to whether there was a record.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal readRecord(RecordReader *reader, MyString *record,
+                                 unsigned long *count, bool *hasRecord)
+{
+    if (adjustMyStringLength(record, EMPTY_STRING_LENGTH) == MYSTRING_ERROR)
+    {
+        return MYSTRING_ERROR;
+    }
+    *count = 1;
+    if (!reader -> _isRun && reader -> _format == MYSTRING_RECORDS_LINES)
+    {
+        return readRecordLine(reader, record, hasRecord);
+    }
+    if (reader -> _isRun)
+    {
+        if (readRecordNumber(reader, RECORD_COUNT_SIZE, count, hasRecord) == MYSTRING_ERROR)
+        {
+            return MYSTRING_ERROR;
+        }
+        if (!*hasRecord)
+        {
+            return MYSTRING_SUCCESS;
+        }
+    }
+    unsigned long length = 0;
+    bool hasLength = false;
+    int lengthSize = reader -> _isRun ? RECORD_COUNT_SIZE : RECORD_LENGTH_SIZE;
+    if (readRecordNumber(reader, lengthSize, &length, &hasLength) == MYSTRING_ERROR)
+    {
+        return MYSTRING_ERROR;
+    }
+    // A run can't end between the count and the length of a record.
+    if (!hasLength)
+    {
+        *hasRecord = false;
+        return reader -> _isRun ? MYSTRING_ERROR : MYSTRING_SUCCESS;
+    }
+    *hasRecord = true;
+    return readRecordChars(reader, record, length);
+}
+
+/**
+ * @brief Read a line, appending it to a string. The last line may end without '\n'.
+ * @param reader the reader.
+ * @param record the string.
+ * @param hasRecord pointer to set to whether there was a line.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal readRecordLine(RecordReader *reader, MyString *record, bool *hasRecord)
+{
+    *hasRecord = false;
+    while (fillRecordReader(reader) > 0)
+    {
+        *hasRecord = true;
+        MyStringView view = {reader -> _buffer + reader -> _start, reader -> _end - reader -> _start};
+        const char *lineEnd = (const char *) memchr(view._chars, RECORD_LINE_END, view._length);
+        if (lineEnd != NULL)
+        {
+            view._length = (unsigned long) (lineEnd - view._chars);
+        }
+        if (myStringAppendView(record, view) == MYSTRING_ERROR)
+        {
+            return MYSTRING_ERROR;
+        }
+        reader -> _start += view._length;
+        if (lineEnd != NULL)
+        {
+            reader -> _start++;
+            break;
+        }
+    }
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Read a little endian number.
+ * @param reader the reader.
+ * @param size the number of bytes of the number.
+ * @param number pointer to set to the number.
+ * @param hasNumber pointer to set to whether there was a number.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR if the file ends in the number.
+ */
+static MyStringRetVal readRecordNumber(RecordReader *reader, int size, unsigned long *number,
+                                       bool *hasNumber)
+{
+    *number = 0;
+    *hasNumber = false;
+    for (int i = 0; i < size; i++)
+    {
+        if (fillRecordReader(reader) == 0)
+        {
+            return i == 0 ? MYSTRING_SUCCESS : MYSTRING_ERROR;
+        }
+        unsigned char byte = (unsigned char) reader -> _buffer[reader -> _start++];
+        *number |= (unsigned long) byte << (i * CHAR_BIT);
+    }
+    *hasNumber = true;
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Read chars, appending them to a string.
+ * @param reader the reader.
+ * @param record the string.
+ * @param length the number of chars.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal readRecordChars(RecordReader *reader, MyString *record,
+                                      unsigned long length)
+{
+    while (length > 0)
+    {
+        unsigned long available = fillRecordReader(reader);
+        if (available == 0)
+        {
+            return MYSTRING_ERROR;
+        }
+        MyStringView view = {reader -> _buffer + reader -> _start,
+                             available < length ? available : length};
+        if (myStringAppendView(record, view) == MYSTRING_ERROR)
+        {
+            return MYSTRING_ERROR;
+        }
+        reader -> _start += view._length;
+        length -= view._length;
+    }
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Initialize a writer of records.
+ * @param writer the writer.
+ * @param file the file to write to.
+ * @param options the options of the sort.
+ * @param isRun whether the file is a run.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal initRecordWriter(RecordWriter *writer, FILE *file,
+                                       const MyStringExternalSortOptions *options, bool isRun)
+{
+    writer -> _file = file;
+    writer -> _buffer = (char *) malloc(options -> _bufferSize);
+    writer -> _bufferSize = options -> _bufferSize;
+    writer -> _used = 0;
+    writer -> _format = options -> _format;
+    writer -> _mode = options -> _mode;
+    writer -> _isRun = isRun;
+    writer -> _pending = myStringAlloc();
+    writer -> _pendingCount = 0;
+    writer -> _hasFailed = writer -> _buffer == NULL || writer -> _pending == NULL;
+    return writer -> _hasFailed ? MYSTRING_ERROR : MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Put a string which was read count times to a writer. The string is swapped
+ * with the pending one rather than copied.
+ * @param writer the writer.
+ * @param record the string.
+ * @param count the number of times the string was read.
+ */
+static void putRecord(RecordWriter *writer, MyString *record, unsigned long count)
+{
+    if (writer -> _mode == MYSTRING_MERGE_ALL)
+    {
+        writeRecord(writer, record, count);
+        return;
+    }
+    if (writer -> _pendingCount > 0 && myStringEqual(writer -> _pending, record) == TRUE)
+    {
+        writer -> _pendingCount += count;
+        return;
+    }
+    if (writer -> _pendingCount > 0)
+    {
+        writeRecord(writer, writer -> _pending, writer -> _pendingCount);
+    }
+    myStringSwap(writer -> _pending, record);
+    writer -> _pendingCount = count;
+}
+
+/**
+ * @brief Write a record in the format of the file of a writer. Runs keep the count of
+ * every record, so they are aggregated again when they are merged.
+ * @param writer the writer.
+ * @param record the string.
+ * @param count the number of times the string was read.
+ */
+static void writeRecord(RecordWriter *writer, const MyString *record, unsigned long count)
+{
+    if (writer -> _isRun)
+    {
+        writeRecordNumber(writer, count, RECORD_COUNT_SIZE);
+        writeRecordNumber(writer, record -> _length, RECORD_COUNT_SIZE);
+        writeRecordChars(writer, record -> _chars, record -> _length);
+        return;
+    }
+    bool isLines = writer -> _format == MYSTRING_RECORDS_LINES;
+    if (!isLines && record -> _length > RECORD_MAX_LENGTH)
+    {
+        writer -> _hasFailed = true;
+        return;
+    }
+    // Only all the strings are written as many times as they were read.
+    unsigned long times = writer -> _mode == MYSTRING_MERGE_ALL ? count : 1;
+    for (unsigned long i = 0; i < times; i++)
+    {
+        if (writer -> _mode == MYSTRING_MERGE_COUNT && isLines)
+        {
+            char digits[MAX_DECIMAL_LENGTH + 1];
+            digits[MAX_DECIMAL_LENGTH] = RECORD_COUNT_SEPARATOR;
+            char *first = writeDecimalBackwards(digits + MAX_DECIMAL_LENGTH, (long long) count);
+            writeRecordChars(writer, first, (unsigned long) (digits + sizeof(digits) - first));
+        }
+        else if (writer -> _mode == MYSTRING_MERGE_COUNT)
+        {
+            writeRecordNumber(writer, count, RECORD_COUNT_SIZE);
+        }
+        if (!isLines)
+        {
+            writeRecordNumber(writer, record -> _length, RECORD_LENGTH_SIZE);
+        }
+        writeRecordChars(writer, record -> _chars, record -> _length);
+        if (isLines)
+        {
+            char lineEnd = RECORD_LINE_END;
+            writeRecordChars(writer, &lineEnd, 1);
+        }
+    }
+}
+
+/**
+ * @brief Write a little endian number.
+ * @param writer the writer.
+ * @param number the number.
+ * @param size the number of bytes to write.
+ */
+static void writeRecordNumber(RecordWriter *writer, unsigned long number, int size)
+{
+    char bytes[RECORD_COUNT_SIZE];
+    for (int i = 0; i < size; i++)
+    {
+        bytes[i] = (char) (number >> (i * CHAR_BIT));
+    }
+    writeRecordChars(writer, bytes, (unsigned long) size);
+}
+
+/**
+ * @brief Write chars through the buffer of a writer. Chars which don't fit in the
+ * buffer are written at once.
+ * @param writer the writer.
+ * @param chars the chars.
+ * @param n the number of chars.
+ */
+static void writeRecordChars(RecordWriter *writer, const char *chars, unsigned long n)
+{
+    if (n > writer -> _bufferSize - writer -> _used)
+    {
+        flushRecordWriter(writer);
+    }
+    if (n > writer -> _bufferSize)
+    {
+        if (fwrite(chars, sizeof(char), n, writer -> _file) != n)
+        {
+            writer -> _hasFailed = true;
+        }
+        return;
+    }
+    memcpy(writer -> _buffer + writer -> _used, chars, n);
+    writer -> _used += n;
+}
+
+/**
+ * @brief Write the buffer of a writer to its file.
+ * @param writer the writer.
+ */
+static void flushRecordWriter(RecordWriter *writer)
+{
+    if (writer -> _used > 0 &&
+        fwrite(writer -> _buffer, sizeof(char), writer -> _used, writer -> _file) != writer -> _used)
+    {
+        writer -> _hasFailed = true;
+    }
+    writer -> _used = 0;
+}
+
+/**
+ * @brief Write the last string and the buffer of a writer, and free the writer.
+ * @param writer the writer.
+ * @return MYSTRING_SUCCESS if all the writes succeeded, MYSTRING_ERROR otherwise.
+ */
+static MyStringRetVal closeRecordWriter(RecordWriter *writer)
+{
+    if (!writer -> _hasFailed)
+    {
+        if (writer -> _pendingCount > 0)
+        {
+            writeRecord(writer, writer -> _pending, writer -> _pendingCount);
+        }
+        flushRecordWriter(writer);
+        if (fflush(writer -> _file) != 0)
+        {
+            writer -> _hasFailed = true;
+        }
+    }
+    free(writer -> _buffer);
+    myStringFree(writer -> _pending);
+    return writer -> _hasFailed ? MYSTRING_ERROR : MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Compute the edit distance between the chars of two strings, up to a bound.
+ * The common prefix and suffix don't change the distance, so they are skipped, and
+ * the shorter string is the pattern, which takes fewer words.
+ * @param chars1
+ * @param length1
+ * @param chars2
+ * @param length2
+ * @param maxDistance the bound.
+ * @param distance pointer to set to the distance.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal computeEditDistance(const char *chars1, unsigned long length1,
+                                          const char *chars2, unsigned long length2,
+                                          unsigned long maxDistance, unsigned long *distance)
+{
+    if (length1 > length2)
+    {
+        const char *chars = chars1;
+        unsigned long length = length1;
+        chars1 = chars2;
+        length1 = length2;
+        chars2 = chars;
+        length2 = length;
+    }
+    while (length1 > 0 && *chars1 == *chars2)
+    {
+        chars1++;
+        chars2++;
+        length1--;
+        length2--;
+    }
+    while (length1 > 0 && chars1[length1 - 1] == chars2[length2 - 1])
+    {
+        length1--;
+        length2--;
+    }
+    // The distance is at least the difference of the lengths, and at most the length
+    // of the longer string.
+    if (length2 - length1 > maxDistance)
+    {
+        *distance = maxDistance + 1;
+        return MYSTRING_SUCCESS;
+    }
+    if (length1 == EMPTY_STRING_LENGTH)
+    {
+        *distance = length2;
+        return MYSTRING_SUCCESS;
+    }
+    MyStringEditPattern pattern;
+    pattern._length = length1;
+    pattern._words = (length1 + EDIT_WORD_BITS - 1) / EDIT_WORD_BITS;
+    unsigned long long wordMasks[EDIT_MASKS];
+    unsigned long long wordBlocks[2];
+    unsigned long long *blocks = wordBlocks;
+    if (pattern._words == 1)
+    {
+        // Only the masks of the chars of the text are ever read, so only they need
+        // clearing, which is cheaper than clearing all of them for short strings.
+        pattern._masks = wordMasks;
+        for (unsigned long i = 0; i < length2; i++)
+        {
+            wordMasks[(unsigned char) chars2[i]] = 0;
+        }
+    }
+    else
+    {
+        pattern._masks = (unsigned long long *) calloc(pattern._words * EDIT_MASKS,
+                                                        sizeof(unsigned long long));
+        blocks = (unsigned long long *) malloc(2 * pattern._words * sizeof(unsigned long long));
+        if (pattern._masks == NULL || blocks == NULL)
+        {
+            free(pattern._masks);
+            free(blocks);
+            return MYSTRING_ERROR;
+        }
+    }
+    setEditMasks(&pattern, chars1);
+    *distance = runEditDistance(&pattern, chars2, length2, maxDistance, blocks);
+    if (pattern._masks != wordMasks)
+    {
+        free(pattern._masks);
+        free(blocks);
+    }
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Set the bits of the chars of a pattern in its masks.
+ * @param pattern the pattern.
+ * @param chars the chars of the pattern.
+ */
+static void setEditMasks(MyStringEditPattern *pattern, const char *chars)
+{
+    for (unsigned long i = 0; i < pattern -> _length; i++)
+    {
+        unsigned long mask = (unsigned char) chars[i] * pattern -> _words + i / EDIT_WORD_BITS;
+        pattern -> _masks[mask] |= 1ULL << (i % EDIT_WORD_BITS);
+    }
+}
+
+/**
+ * @brief Compute the edit distance between a pattern and a text by the bit-parallel
+ * algorithm. The cell of the last row of a column is the distance of the pattern to
+ * the text so far, and it changes by at most 1 for every char of the text, so we stop
+ * as soon as the rest of the text can't bring it down to the bound.
+ * @param pattern the pattern.
+ * @param text the chars of the text.
+ * @param length the length of the text.
+ * @param maxDistance the bound.
+ * @param blocks room for 2 words for every word of the pattern.
+ * @return the distance, or maxDistance + 1 if it's bigger.
+ */
+static unsigned long runEditDistance(const MyStringEditPattern *pattern, const char *text,
+                                     unsigned long length, unsigned long maxDistance,
+                                     unsigned long long *blocks)
+{
+    unsigned long distance = pattern -> _length;
+    unsigned long difference = length > distance ? length - distance : distance - length;
+    if (difference > maxDistance)
+    {
+        return maxDistance + 1;
+    }
+    if (pattern -> _length == EMPTY_STRING_LENGTH)
+    {
+        return length;
+    }
+    unsigned long words = pattern -> _words;
+    unsigned long long *positives = blocks;
+    unsigned long long *negatives = blocks + words;
+    // The first column is the distance of every prefix of the pattern to "".
+    for (unsigned long word = 0; word < words; word++)
+    {
+        positives[word] = ~0ULL;
+        negatives[word] = 0;
+    }
+    // The last block is kept apart, so a pattern of one word is matched in registers.
+    unsigned long long lastPositives = ~0ULL;
+    unsigned long long lastNegatives = 0;
+    unsigned long long lastBit = 1ULL << ((pattern -> _length - 1) % EDIT_WORD_BITS);
+    for (unsigned long i = 0; i < length; i++)
+    {
+        const unsigned long long *masks = pattern -> _masks + (unsigned char) text[i] * words;
+        // The first row is the length of the text so far, so it always grows by 1.
+        int carry = 1;
+        for (unsigned long word = 0; word + 1 < words; word++)
+        {
+            carry = advanceEditBlock(positives + word, negatives + word, masks[word], carry,
+                                     EDIT_WORD_HIGH_BIT);
+        }
+        distance += advanceEditBlock(&lastPositives, &lastNegatives, masks[words - 1], carry,
+                                     lastBit);
+        unsigned long rest = length - i - 1;
+        if (distance > rest && distance - rest > maxDistance)
+        {
+            return maxDistance + 1;
+        }
+    }
+    return distance;
+}
+
+/**
+ * @brief Advance a block of a column of the edit distance by a char of the text.
+ * The carry of the block above enters at the lowest bit, as the carry of the first
+ * row does for the first block.
+ * @param positives the bits of the rows bigger by 1 than the row above.
+ * @param negatives the bits of the rows smaller by 1 than the row above.
+ * @param matches the bits of the rows whose pattern char is the text char.
+ * @param carry the difference of the cell above the block.
+ * @param lastBit the bit of the last row of the block.
+ * @return the difference of the cell of the last row.
+ */
+static int advanceEditBlock(unsigned long long *positives, unsigned long long *negatives,
+                            unsigned long long matches, int carry, unsigned long long lastBit)
+{
+    // The carries are random, so they are used as bits rather than branched on.
+    unsigned long long carryPositive = carry > 0;
+    unsigned long long carryNegative = carry < 0;
+    unsigned long long vertical = matches | *negatives;
+    matches |= carryNegative;
+    unsigned long long horizontal = (((matches & *positives) + *positives) ^ *positives) | matches;
+    unsigned long long horizontalPositives = *negatives | ~(horizontal | *positives);
+    unsigned long long horizontalNegatives = *positives & horizontal;
+    int carryOut = ((horizontalPositives & lastBit) != 0) - ((horizontalNegatives & lastBit) != 0);
+    horizontalPositives = (horizontalPositives << 1) | carryPositive;
+    horizontalNegatives = (horizontalNegatives << 1) | carryNegative;
+    *positives = horizontalNegatives | ~(vertical | horizontalPositives);
+    *negatives = horizontalPositives & vertical;
+    return carryOut;
+}
+
+/**
+ * @brief Make room for n more chars at the end of a string.
+ * @param str the string.
+ * @param view a view, moved with the chars if it's a view of str.
+ * @param n the number of chars.
+ * @param room pointer to set to the first new char.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal growMyString(MyString *str, MyStringView *view, unsigned long n,
+                                   char **room)
+{
+    bool isInnerView = view -> _chars >= str -> _chars &&
+                       view -> _chars < str -> _chars + str -> _length;
+    unsigned long innerOffset = isInnerView ? (unsigned long) (view -> _chars - str -> _chars) : 0;
+    unsigned long oldLength = str -> _length;
+    if (adjustMyStringLength(str, oldLength + n) == MYSTRING_ERROR)
+    {
+        return MYSTRING_ERROR;
+    }
+    if (isInnerView)
+    {
+        view -> _chars = str -> _chars + innerOffset;
+    }
+    *room = str -> _chars + oldLength;
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Write the hex of bytes. SSE2 splits 16 bytes to their 32 digits at once.
+ * @param hex room for the hex.
+ * @param bytes the bytes.
+ * @param length the number of bytes.
+ */
+static void encodeHex(char *hex, const unsigned char *bytes, unsigned long length)
+{
+    unsigned long i = 0;
+#ifdef __SSE2__
+    const __m128i nibbleMask = _mm_set1_epi8(NIBBLE_MASK);
+    for (; i + SSE2_BLOCK_SIZE <= length; i += SSE2_BLOCK_SIZE)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i *) (bytes + i));
+        __m128i high = _mm_and_si128(_mm_srli_epi16(block, NIBBLE_BITS), nibbleMask);
+        __m128i low = _mm_and_si128(block, nibbleMask);
+        char *out = hex + i * HEX_CHARS_PER_BYTE;
+        _mm_storeu_si128((__m128i *) out, getHexBlockChars(_mm_unpacklo_epi8(high, low)));
+        _mm_storeu_si128((__m128i *) (out + SSE2_BLOCK_SIZE),
+                         getHexBlockChars(_mm_unpackhi_epi8(high, low)));
+    }
+#endif
+    for (; i < length; i++)
+    {
+        hex[i * HEX_CHARS_PER_BYTE] = HEX_DIGITS[bytes[i] >> NIBBLE_BITS];
+        hex[i * HEX_CHARS_PER_BYTE + 1] = HEX_DIGITS[bytes[i] & NIBBLE_MASK];
+    }
+}
+
+/**
+ * @brief Write the bytes of hex. SSE2 checks and joins 32 digits at once.
+ * @param bytes room for the bytes.
+ * @param hex the hex.
+ * @param length the number of bytes.
+ * @return true if the hex is valid, false otherwise.
+ */
+static bool decodeHex(unsigned char *bytes, const char *hex, unsigned long length)
+{
+    unsigned long i = 0;
+#ifdef __SSE2__
+    const __m128i lowByteMask = _mm_set1_epi16(UCHAR_MAX);
+    for (; i + SSE2_BLOCK_SIZE <= length; i += SSE2_BLOCK_SIZE)
+    {
+        const char *in = hex + i * HEX_CHARS_PER_BYTE;
+        __m128i first;
+        __m128i second;
+        if (!getHexBlockValues(_mm_loadu_si128((const __m128i *) in), &first) ||
+            !getHexBlockValues(_mm_loadu_si128((const __m128i *) (in + SSE2_BLOCK_SIZE)), &second))
+        {
+            return false;
+        }
+        // Every pair of digits is a 16 bit lane, the high digit in its low byte.
+        first = _mm_and_si128(_mm_or_si128(_mm_slli_epi16(first, NIBBLE_BITS),
+                                           _mm_srli_epi16(first, CHAR_BIT)), lowByteMask);
+        second = _mm_and_si128(_mm_or_si128(_mm_slli_epi16(second, NIBBLE_BITS),
+                                            _mm_srli_epi16(second, CHAR_BIT)), lowByteMask);
+        _mm_storeu_si128((__m128i *) (bytes + i), _mm_packus_epi16(first, second));
+    }
+#endif
+    unsigned char invalid = 0;
+    for (; i < length; i++)
+    {
+        unsigned char high = getHexValue(hex[i * HEX_CHARS_PER_BYTE]);
+        unsigned char low = getHexValue(hex[i * HEX_CHARS_PER_BYTE + 1]);
+        invalid |= high | low;
+        bytes[i] = (unsigned char) (high << NIBBLE_BITS | low);
+    }
+    // Valid values have no bits above the nibble.
+    return (invalid & ~NIBBLE_MASK) == 0;
+}
+
+/**
+ * @brief Get the value of a hex digit.
+ * @param c the char.
+ * @return the value, or HEX_INVALID.
+ */
+static unsigned char getHexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return (unsigned char) (c - '0');
+    }
+    if (c >= 'a' && c <= 'f')
+    {
+        return (unsigned char) (c - 'a' + DIGIT_DIVIDER);
+    }
+    if (c >= 'A' && c <= 'F')
+    {
+        return (unsigned char) (c - 'A' + DIGIT_DIVIDER);
+    }
+    return HEX_INVALID;
+}
+
+/**
+ * @brief Write the base64 of whole groups of bytes, 4 groups at a time with SSSE3.
+ * @param base64 room for the chars.
+ * @param bytes the bytes.
+ * @param groups the number of groups.
+ */
+static void encodeBase64(char *base64, const unsigned char *bytes, unsigned long groups)
+{
+    unsigned long i = 0;
+#ifdef __SSSE3__
+    for (; i + BASE64_BLOCK_GROUPS + BASE64_BLOCK_SPARE_GROUPS <= groups; i += BASE64_BLOCK_GROUPS)
+    {
+        encodeBase64Block(base64 + i * BASE64_GROUP_CHARS, bytes + i * BASE64_GROUP_BYTES);
+    }
+#endif
+    for (; i < groups; i++)
+    {
+        const unsigned char *in = bytes + i * BASE64_GROUP_BYTES;
+        char *out = base64 + i * BASE64_GROUP_CHARS;
+        unsigned long bits = (unsigned long) in[0] << (2 * CHAR_BIT) |
+                             (unsigned long) in[1] << CHAR_BIT | in[2];
+        out[0] = BASE64_ALPHABET[bits >> (3 * BASE64_CHAR_BITS)];
+        out[1] = BASE64_ALPHABET[(bits >> (2 * BASE64_CHAR_BITS)) & BASE64_CHAR_MASK];
+        out[2] = BASE64_ALPHABET[(bits >> BASE64_CHAR_BITS) & BASE64_CHAR_MASK];
+        out[3] = BASE64_ALPHABET[bits & BASE64_CHAR_MASK];
+    }
+}
+
+/**
+ * @brief Write the base64 of the last bytes of a payload, padded to a whole group.
+ * @param base64 room for 4 chars.
+ * @param bytes the bytes.
+ * @param length the number of bytes, 1 or 2.
+ */
+static void encodeBase64Tail(char *base64, const unsigned char *bytes, unsigned long length)
+{
+    unsigned char group[BASE64_GROUP_BYTES] = {0};
+    memcpy(group, bytes, length);
+    encodeBase64(base64, group, 1);
+    // Every missing byte takes a char.
+    for (unsigned long i = length + 1; i < BASE64_GROUP_CHARS; i++)
+    {
+        base64[i] = BASE64_PADDING;
+    }
+}
+
+/**
+ * @brief Write the bytes of groups of base64, 4 groups at a time with SSSE3.
+ * @param bytes room for the bytes.
+ * @param base64 the chars.
+ * @param groups the number of groups, at least 1.
+ * @param length pointer to set to the number of bytes written.
+ * @return true if the base64 is valid, false otherwise (including a padded group
+ * whose bits past its last byte aren't zero).
+ */
+static bool decodeBase64(unsigned char *bytes, const char *base64, unsigned long groups,
+                         unsigned long *length)
+{
+    unsigned long i = 0;
+#ifdef __SSSE3__
+    for (; i + BASE64_BLOCK_GROUPS + BASE64_BLOCK_SPARE_GROUPS <= groups; i += BASE64_BLOCK_GROUPS)
+    {
+        if (!decodeBase64Block(bytes + i * BASE64_GROUP_BYTES, base64 + i * BASE64_GROUP_CHARS))
+        {
+            return false;
+        }
+    }
+#endif
+    unsigned char invalid = 0;
+    *length = groups * BASE64_GROUP_BYTES;
+    for (; i < groups; i++)
+    {
+        const unsigned char *in = (const unsigned char *) base64 + i * BASE64_GROUP_CHARS;
+        unsigned char *out = bytes + i * BASE64_GROUP_BYTES;
+        unsigned int chars = BASE64_GROUP_CHARS;
+        // Only the last group may end with one or two padding chars.
+        if (i + 1 == groups && in[3] == BASE64_PADDING)
+        {
+            chars = in[2] == BASE64_PADDING ? 2 : 3;
+            *length -= BASE64_GROUP_CHARS - chars;
+        }
+        unsigned long bits = 0;
+        for (unsigned int j = 0; j < BASE64_GROUP_CHARS; j++)
+        {
+            unsigned char value = j < chars ? base64Values[in[j]] : 0;
+            invalid |= value;
+            bits = bits << BASE64_CHAR_BITS | (value & BASE64_CHAR_MASK);
+        }
+        // The bits of a padded group past its last byte are zero, as RFC 4648 requires,
+        // so "QR==" isn't taken for "QQ==" and every bytes have a single encoding.
+        unsigned int unusedBits = (BASE64_GROUP_CHARS - chars) * CHAR_BIT;
+        if ((bits & ((1UL << unusedBits) - 1)) != 0)
+        {
+            return false;
+        }
+        out[0] = (unsigned char) (bits >> (2 * CHAR_BIT));
+        if (chars > 2)
+        {
+            out[1] = (unsigned char) (bits >> CHAR_BIT);
+        }
+        if (chars > 3)
+        {
+            out[2] = (unsigned char) bits;
+        }
+    }
+    // Valid values have no bits above the 6 of a char.
+    return (invalid & ~BASE64_CHAR_MASK) == 0;
+}
+
+#ifdef __SSE2__
+/**
+ * @brief Turn 16 values of 4 bits to their hex digits: '0' onwards, and 'a' onwards
+ * for the values past 9.
+ * @param nibbles the values.
+ * @return the digits.
+ */
+static __m128i getHexBlockChars(__m128i nibbles)
+{
+    __m128i isLetter = _mm_cmpgt_epi8(nibbles, _mm_set1_epi8(DIGIT_DIVIDER - 1));
+    __m128i digits = _mm_add_epi8(nibbles, _mm_set1_epi8('0'));
+    return _mm_add_epi8(digits, _mm_and_si128(isLetter, _mm_set1_epi8('a' - '0' - DIGIT_DIVIDER)));
+}
+
+/**
+ * @brief Turn 16 hex digits to their values. A char is in a range when its distance
+ * from the start of the range, as an unsigned byte, is at most the size of the range.
+ * @param chars the digits.
+ * @param values pointer to set to the values.
+ * @return true if all the chars are hex digits, false otherwise.
+ */
+static bool getHexBlockValues(__m128i chars, __m128i *values)
+{
+    const __m128i lastDigit = _mm_set1_epi8(DIGIT_DIVIDER - 1);
+    const __m128i lastLetter = _mm_set1_epi8('f' - 'a');
+    __m128i digits = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+    __m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(digits, lastDigit), digits);
+    // Setting the lowercase bit folds 'A' to 'F' onto 'a' to 'f', and nothing else.
+    __m128i letters = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8('a' - 'A')),
+                                   _mm_set1_epi8('a'));
+    __m128i isLetter = _mm_cmpeq_epi8(_mm_min_epu8(letters, lastLetter), letters);
+    letters = _mm_add_epi8(letters, _mm_set1_epi8(DIGIT_DIVIDER));
+    *values = _mm_or_si128(_mm_and_si128(isDigit, digits), _mm_and_si128(isLetter, letters));
+    return _mm_movemask_epi8(_mm_or_si128(isDigit, isLetter)) == SSE2_ALL_LANES;
+}
+#endif
+
+#ifdef __SSSE3__
+/**
+ * @brief Write the base64 of 4 groups of bytes. The bytes of every group are shuffled
+ * to a 32 bit lane, the 6 bit values are moved to bytes of their own by multiplies,
+ * and every value is turned to its char by adding the offset of its range of the
+ * alphabet, looked up by a shuffle.
+ * @param base64 room for 16 chars.
+ * @param bytes the bytes, of which 16 are read.
+ */
+static void encodeBase64Block(char *base64, const unsigned char *bytes)
+{
+    __m128i block = _mm_loadu_si128((const __m128i *) bytes);
+    block = _mm_shuffle_epi8(block, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+    __m128i first = _mm_mulhi_epu16(_mm_and_si128(block, _mm_set1_epi32(0x0FC0FC00)),
+                                    _mm_set1_epi32(0x04000040));
+    __m128i second = _mm_mullo_epi16(_mm_and_si128(block, _mm_set1_epi32(0x003F03F0)),
+                                     _mm_set1_epi32(0x01000010));
+    __m128i values = _mm_or_si128(first, second);
+    // Values 0-51 get range 0, the others 1 to 12, and then 0-25 are moved to 13.
+    __m128i ranges = _mm_subs_epu8(values, _mm_set1_epi8(51));
+    __m128i isUpper = _mm_cmpgt_epi8(_mm_set1_epi8(26), values);
+    ranges = _mm_or_si128(ranges, _mm_and_si128(isUpper, _mm_set1_epi8(13)));
+    // The offset of every range from its values to its chars.
+    const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                          '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                          '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    __m128i chars = _mm_add_epi8(values, _mm_shuffle_epi8(offsets, ranges));
+    _mm_storeu_si128((__m128i *) base64, chars);
+}
+
+/**
+ * @brief Write the bytes of 4 groups of base64 chars. Every char is checked against
+ * the chars its high nibble allows by a bit looked up by its low nibble, turned to its
+ * value by an offset looked up by its high nibble, and the values are joined back to
+ * bytes by multiply-adds.
+ * @param bytes room for 16 bytes.
+ * @param base64 the 16 chars.
+ * @return true if all the chars are base64, false otherwise.
+ */
+static bool decodeBase64Block(unsigned char *bytes, const char *base64)
+{
+    __m128i chars = _mm_loadu_si128((const __m128i *) base64);
+    const __m128i nibbleMask = _mm_set1_epi8(NIBBLE_MASK);
+    __m128i high = _mm_and_si128(_mm_srli_epi32(chars, NIBBLE_BITS), nibbleMask);
+    __m128i low = _mm_and_si128(chars, nibbleMask);
+    // For every low nibble, the high nibbles (bits 0-7) of the chars which are base64.
+    const __m128i allowed = _mm_setr_epi8((char) 0xA8, (char) 0xF8, (char) 0xF8, (char) 0xF8,
+                                          (char) 0xF8, (char) 0xF8, (char) 0xF8, (char) 0xF8,
+                                          (char) 0xF8, (char) 0xF8, (char) 0xF0, 0x54, 0x50,
+                                          0x50, 0x50, 0x54);
+    const __m128i highBits = _mm_setr_epi8(0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40,
+                                           (char) 0x80, 0, 0, 0, 0, 0, 0, 0, 0);
+    __m128i isBase64 = _mm_and_si128(_mm_shuffle_epi8(allowed, low),
+                                     _mm_shuffle_epi8(highBits, high));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(isBase64, _mm_setzero_si128())) != 0)
+    {
+        return false;
+    }
+    // The offsets by high nibble: '+' and '/' share 2, so '/' is fixed apart.
+    const __m128i offsets = _mm_setr_epi8(0, 0, 62 - '+', 52 - '0', -'A', -'A',
+                                          26 - 'a', 26 - 'a', 0, 0, 0, 0, 0, 0, 0, 0);
+    __m128i isSlash = _mm_cmpeq_epi8(chars, _mm_set1_epi8('/'));
+    __m128i values = _mm_add_epi8(chars, _mm_shuffle_epi8(offsets, high));
+    values = _mm_add_epi8(values, _mm_and_si128(isSlash, _mm_set1_epi8((63 - '/') - (62 - '+'))));
+    // Join every 2 values to 12 bits, then every 2 of those to 24, and pack the bytes.
+    __m128i pairs = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+    __m128i groups = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+    groups = _mm_shuffle_epi8(groups, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12,
+                                                    -1, -1, -1, -1));
+    _mm_storeu_si128((__m128i *) bytes, groups);
+    return true;
+}
+#endif
+
+/**
+ * @brief Find the longest symbol the chars start with. The chars are read as a word
+ * and compared with every symbol under the mask of its length.
+ * @param table the symbol table.
+ * @param chars the chars, at least 1.
+ * @param length the number of chars.
+ * @param symbolLength pointer to set to the length of the symbol, 1 if there's none.
+ * @return the code of the symbol, or SYMBOL_ESCAPE if there's none.
+ */
+static unsigned int findSymbol(const MyStringSymbolTable *table, const unsigned char *chars,
+                               unsigned long length, unsigned int *symbolLength)
+{
+    unsigned long long word = 0;
+    if (length >= SYMBOL_MAX_LENGTH)
+    {
+        memcpy(&word, chars, SYMBOL_MAX_LENGTH);
+    }
+    else
+    {
+        memcpy(&word, chars, length);
+    }
+    unsigned int end = table -> _starts[*chars + 1];
+    for (unsigned int code = table -> _starts[*chars]; code < end; code++)
+    {
+        if (table -> _lengths[code] <= length &&
+            (word & table -> _masks[code]) == table -> _symbols[code])
+        {
+            *symbolLength = table -> _lengths[code];
+            return code;
+        }
+    }
+    *symbolLength = 1;
+    return SYMBOL_ESCAPE;
+}
+
+/**
+ * @brief Count the codes a symbol table compresses chars to, and the pairs of
+ * successive codes.
+ * @param table the symbol table.
+ * @param chars the chars.
+ * @param length the number of chars.
+ * @param counts the counts of the codes, and then the counts of the pairs.
+ */
+static void countSymbolCodes(const MyStringSymbolTable *table, const unsigned char *chars,
+                             unsigned long length, unsigned int *counts)
+{
+    unsigned int *pairs = counts + SYMBOL_TRAIN_CODES;
+    unsigned int previous = SYMBOL_TRAIN_CODES;
+    unsigned long i = 0;
+    while (i < length)
+    {
+        unsigned int symbolLength = 0;
+        unsigned int code = findSymbol(table, chars + i, length - i, &symbolLength);
+        if (code == SYMBOL_ESCAPE)
+        {
+            code = SYMBOL_MAX_COUNT + chars[i];
+        }
+        counts[code]++;
+        if (previous != SYMBOL_TRAIN_CODES)
+        {
+            pairs[previous * SYMBOL_TRAIN_CODES + code]++;
+        }
+        previous = code;
+        i += symbolLength;
+    }
+}
+
+/**
+ * @brief Build a symbol table again from the codes and the pairs of codes counted by
+ * the current one. A candidate gains the chars it covers times the times it was seen,
+ * and the same chars may come from a code and from pairs, so their gains are merged.
+ * @param table the symbol table.
+ * @param counts the counts of countSymbolCodes.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal rebuildSymbolTable(MyStringSymbolTable *table, const unsigned int *counts)
+{
+    unsigned long seen = 0;
+    for (unsigned long i = 0; i < (SYMBOL_TRAIN_CODES + 1) * SYMBOL_TRAIN_CODES; i++)
+    {
+        seen += counts[i] > 0;
+    }
+    SymbolCandidate *candidates = (SymbolCandidate *) calloc(seen > 0 ? seen : 1,
+                                                             sizeof(SymbolCandidate));
+    if (candidates == NULL)
+    {
+        return MYSTRING_ERROR;
+    }
+    const unsigned int *pairs = counts + SYMBOL_TRAIN_CODES;
+    unsigned long count = 0;
+    for (unsigned int code = 0; code < SYMBOL_TRAIN_CODES; code++)
+    {
+        if (counts[code] == 0)
+        {
+            continue;
+        }
+        SymbolCandidate *candidate = &candidates[count++];
+        candidate -> _length = getCodeChars(table, code, candidate -> _chars);
+        candidate -> _gain = (unsigned long) counts[code] * candidate -> _length;
+        unsigned char next[SYMBOL_MAX_LENGTH];
+        for (unsigned int nextCode = 0; nextCode < SYMBOL_TRAIN_CODES; nextCode++)
+        {
+            unsigned int pairCount = pairs[code * SYMBOL_TRAIN_CODES + nextCode];
+            if (pairCount == 0 || candidate -> _length == SYMBOL_MAX_LENGTH)
+            {
+                continue;
+            }
+            SymbolCandidate *pair = &candidates[count++];
+            unsigned int nextLength = getCodeChars(table, nextCode, next);
+            memcpy(pair -> _chars, candidate -> _chars, candidate -> _length);
+            pair -> _length = candidate -> _length + nextLength;
+            if (pair -> _length > SYMBOL_MAX_LENGTH)
+            {
+                pair -> _length = SYMBOL_MAX_LENGTH;
+            }
+            memcpy(pair -> _chars + candidate -> _length, next, pair -> _length - candidate -> _length);
+            pair -> _gain = (unsigned long) pairCount * pair -> _length;
+        }
+    }
+    qsort(candidates, count, sizeof(SymbolCandidate), symbolCharsComparator);
+    unsigned long merged = 0;
+    for (unsigned long i = 0; i < count; i++)
+    {
+        if (merged > 0 && symbolCharsComparator(&candidates[merged - 1], &candidates[i]) == 0)
+        {
+            candidates[merged - 1]._gain += candidates[i]._gain;
+        }
+        else
+        {
+            candidates[merged++] = candidates[i];
+        }
+    }
+    qsort(candidates, merged, sizeof(SymbolCandidate), symbolGainComparator);
+    unsigned long kept = merged < SYMBOL_MAX_COUNT ? merged : SYMBOL_MAX_COUNT;
+    qsort(candidates, kept, sizeof(SymbolCandidate), symbolOrderComparator);
+    table -> _count = (unsigned int) kept;
+    for (unsigned int code = 0; code < kept; code++)
+    {
+        unsigned char mask[SYMBOL_MAX_LENGTH] = {0};
+        memset(mask, UCHAR_MAX, candidates[code]._length);
+        memcpy(&table -> _symbols[code], candidates[code]._chars, SYMBOL_MAX_LENGTH);
+        memcpy(&table -> _masks[code], mask, SYMBOL_MAX_LENGTH);
+        table -> _lengths[code] = (unsigned char) candidates[code]._length;
+    }
+    unsigned int code = 0;
+    for (unsigned int c = 0; c <= UCHAR_MAX + 1; c++)
+    {
+        while (code < kept && candidates[code]._chars[0] < c)
+        {
+            code++;
+        }
+        table -> _starts[c] = code;
+    }
+    free(candidates);
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Get the chars of a code counted by countSymbolCodes.
+ * @param table the symbol table.
+ * @param code the code.
+ * @param chars room for SYMBOL_MAX_LENGTH chars.
+ * @return the number of chars.
+ */
+static unsigned int getCodeChars(const MyStringSymbolTable *table, unsigned int code,
+                                 unsigned char *chars)
+{
+    if (code >= SYMBOL_MAX_COUNT)
+    {
+        chars[0] = (unsigned char) (code - SYMBOL_MAX_COUNT);
+        return 1;
+    }
+    memcpy(chars, &table -> _symbols[code], SYMBOL_MAX_LENGTH);
+    return table -> _lengths[code];
+}
+
+/**
+ * @brief Comparator of symbol candidates by their chars.
+ */
+static int symbolCharsComparator(const void *candidate1, const void *candidate2)
+{
+    const SymbolCandidate *symbol1 = (const SymbolCandidate *) candidate1;
+    const SymbolCandidate *symbol2 = (const SymbolCandidate *) candidate2;
+    if (symbol1 -> _length != symbol2 -> _length)
+    {
+        return symbol1 -> _length < symbol2 -> _length ? STR2_BIGGER : STR1_BIGGER;
+    }
+    return memcmp(symbol1 -> _chars, symbol2 -> _chars, symbol1 -> _length);
+}
+
+/**
+ * @brief Comparator of symbol candidates by their gain, biggest first. Equal gains
+ * are ordered by the chars, so training doesn't depend on the order of qsort.
+ */
+static int symbolGainComparator(const void *candidate1, const void *candidate2)
+{
+    const SymbolCandidate *symbol1 = (const SymbolCandidate *) candidate1;
+    const SymbolCandidate *symbol2 = (const SymbolCandidate *) candidate2;
+    if (symbol1 -> _gain != symbol2 -> _gain)
+    {
+        return symbol1 -> _gain > symbol2 -> _gain ? STR2_BIGGER : STR1_BIGGER;
+    }
+    return symbolCharsComparator(candidate1, candidate2);
+}
+
+/**
+ * @brief Comparator of symbol candidates by their first char, and then longest first,
+ * the order findSymbol tries them in.
+ */
+static int symbolOrderComparator(const void *candidate1, const void *candidate2)
+{
+    const SymbolCandidate *symbol1 = (const SymbolCandidate *) candidate1;
+    const SymbolCandidate *symbol2 = (const SymbolCandidate *) candidate2;
+    if (symbol1 -> _chars[0] != symbol2 -> _chars[0])
+    {
+        return symbol1 -> _chars[0] < symbol2 -> _chars[0] ? STR2_BIGGER : STR1_BIGGER;
+    }
+    if (symbol1 -> _length != symbol2 -> _length)
+    {
+        return symbol1 -> _length > symbol2 -> _length ? STR2_BIGGER : STR1_BIGGER;
+    }
+    return memcmp(symbol1 -> _chars, symbol2 -> _chars, symbol1 -> _length);
+}
+
+/**
+ * @brief Count the chars compressed chars decompress to, checking them as we go.
+ * @param table the symbol table.
+ * @param codes the compressed chars.
+ * @param length the number of compressed chars.
+ * @param decompressedLength pointer to set to the number of chars.
+ * @return true if the compressed chars are valid, false otherwise.
+ */
+static bool getDecompressedLength(const MyStringSymbolTable *table, const unsigned char *codes,
+                                  unsigned long length, unsigned long *decompressedLength)
+{
+    unsigned long total = 0;
+    unsigned long i = 0;
+    while (i < length)
+    {
+        if (codes[i] == SYMBOL_ESCAPE)
+        {
+            // An escape is followed by its char.
+            if (i + 1 == length)
+            {
+                return false;
+            }
+            total++;
+            i += 2;
+            continue;
+        }
+        if (codes[i] >= table -> _count)
+        {
+            return false;
+        }
+        total += table -> _lengths[codes[i]];
+        i++;
+    }
+    *decompressedLength = total;
+    return true;
+}
+
+/**
+ * @brief Decompress chars, checking them as we go. While there's room for a whole
+ * word, every symbol is copied as a word and only its length is kept, so the copy
+ * doesn't branch on the length.
+ * @param table the symbol table.
+ * @param codes the compressed chars.
+ * @param length the number of compressed chars.
+ * @param out room for the chars.
+ * @param size the room.
+ * @param outLength pointer to set to the number of chars.
+ * @return true if the compressed chars are valid and fit, false otherwise.
+ */
+static bool decompressSymbols(const MyStringSymbolTable *table, const unsigned char *codes,
+                              unsigned long length, char *out, unsigned long size,
+                              unsigned long *outLength)
+{
+    char *start = out;
+    char *end = out + size;
+    unsigned long i = 0;
+    // An escape here always has its char after it.
+    while (i + 1 < length && end - out >= SYMBOL_MAX_LENGTH)
+    {
+        unsigned char code = codes[i];
+        if (code < table -> _count)
+        {
+            memcpy(out, &table -> _symbols[code], SYMBOL_MAX_LENGTH);
+            out += table -> _lengths[code];
+            i++;
+        }
+        else if (code == SYMBOL_ESCAPE)
+        {
+            *out++ = (char) codes[i + 1];
+            i += 2;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    while (i < length)
+    {
+        unsigned char code = codes[i];
+        if (code == SYMBOL_ESCAPE)
+        {
+            if (i + 1 == length || out == end)
+            {
+                return false;
+            }
+            *out++ = (char) codes[i + 1];
+            i += 2;
+            continue;
+        }
+        if (code >= table -> _count || table -> _lengths[code] > (unsigned long) (end - out))
+        {
+            return false;
+        }
+        memcpy(out, &table -> _symbols[code], table -> _lengths[code]);
+        out += table -> _lengths[code];
+        i++;
+    }
+    *outLength = (unsigned long) (out - start);
+    return true;
+}
+
+/**
+ * @brief Read up to 8 chars as a little endian word, so the hash is the same on every
+ * machine. Compilers turn the full word into a single load.
+ * @param chars the chars.
+ * @param n the number of chars, at most WORD_SIZE.
+ * @return the word, with zeros above the chars.
+ */
+static unsigned long long readHashWord(const unsigned char *chars, unsigned long n)
+{
+    if (n == WORD_SIZE)
+    {
+        return (unsigned long long) chars[0] | (unsigned long long) chars[1] << 8 |
+               (unsigned long long) chars[2] << 16 | (unsigned long long) chars[3] << 24 |
+               (unsigned long long) chars[4] << 32 | (unsigned long long) chars[5] << 40 |
+               (unsigned long long) chars[6] << 48 | (unsigned long long) chars[7] << 56;
+    }
+    unsigned long long word = 0;
+    for (unsigned long i = 0; i < n; i++)
+    {
+        word |= (unsigned long long) chars[i] << (i * CHAR_BIT);
+    }
+    return word;
+}
+
+/**
+ * @brief Mix a word into a hash.
+ * @param hash the hash.
+ * @param word the word.
+ * @return the new hash.
+ */
+static unsigned long long mixHashWord(unsigned long long hash, unsigned long long word)
+{
+    word = rotateLeft(word * HASH_PRIME2, HASH_WORD_ROTATION) * HASH_PRIME1;
+    return rotateLeft(hash ^ word, HASH_MIX_ROTATION) * HASH_PRIME1 + HASH_PRIME4;
+}
+
+/**
+ * @brief Rotate a word left.
+ * @param word the word.
+ * @param bits the number of bits, between 1 and 63.
+ * @return the rotated word.
+ */
+static unsigned long long rotateLeft(unsigned long long word, unsigned int bits)
+{
+    return word << bits | word >> (WORD_SIZE * CHAR_BIT - bits);
+}
+
+/**
+ * @brief Allocate a cleared Bloom filter, its blocks aligned to cache lines.
+ * @param blocks the number of blocks, between 1 and BLOOM_MAX_BLOCKS.
+ * @param probes the number of bits of a key.
+ * @return the filter, or NULL on failure.
+ */
+static MyStringBloomFilter * allocBloomFilter(unsigned long long blocks, unsigned int probes)
+{
+    MyStringBloomFilter *filter = (MyStringBloomFilter *) malloc(sizeof(MyStringBloomFilter));
+    void *words = NULL;
+    if (filter == NULL || blocks > SIZE_MAX / BLOOM_BLOCK_BYTES ||
+        posix_memalign(&words, BLOOM_BLOCK_BYTES, blocks * BLOOM_BLOCK_BYTES) != 0)
+    {
+        free(filter);
+        return NULL;
+    }
+    memset(words, 0, blocks * BLOOM_BLOCK_BYTES);
+    filter -> _words = (unsigned long long *) words;
+    filter -> _blocks = blocks;
+    filter -> _probes = probes;
+    return filter;
+}
+
+/**
+ * @brief Get the block of a Bloom filter a hash sets its bits in, by mapping the high
+ * 32 bits of the hash onto the blocks with a multiply rather than a division.
+ * @param filter the filter.
+ * @param hash the hash.
+ * @return the words of the block.
+ */
+static unsigned long long * getBloomBlock(const MyStringBloomFilter *filter,
+                                          unsigned long long hash)
+{
+    unsigned long long block = ((hash >> HASH_HIGH_BITS) * filter -> _blocks) >> HASH_HIGH_BITS;
+    return filter -> _words + block * BLOOM_BLOCK_WORDS;
+}
+
+/**
+ * @brief Set the bits of a hash in a Bloom filter.
+ * @param filter the filter.
+ * @param hash the hash.
+ */
+static void addBloomHash(MyStringBloomFilter *filter, unsigned long long hash)
+{
+    unsigned long long *block = getBloomBlock(filter, hash);
+    unsigned int bit = (unsigned int) hash;
+    unsigned int step = bit >> BLOOM_BIT_INDEX_BITS | 1;
+    for (unsigned int i = 0; i < filter -> _probes; i++, bit += step)
+    {
+        unsigned int position = bit & (BLOOM_BLOCK_BITS - 1);
+        block[position / BLOOM_WORD_BITS] |= 1ULL << (position % BLOOM_WORD_BITS);
+    }
+}
+
+/**
+ * @brief Check the bits of a hash in a Bloom filter, stopping at the first clear one,
+ * as most keys checked are missing.
+ * @param filter the filter.
+ * @param hash the hash.
+ * @return true if all its bits are set, false otherwise.
+ */
+static bool containsBloomHash(const MyStringBloomFilter *filter, unsigned long long hash)
+{
+    const unsigned long long *block = getBloomBlock(filter, hash);
+    unsigned int bit = (unsigned int) hash;
+    unsigned int step = bit >> BLOOM_BIT_INDEX_BITS | 1;
+    for (unsigned int i = 0; i < filter -> _probes; i++, bit += step)
+    {
+        unsigned int position = bit & (BLOOM_BLOCK_BITS - 1);
+        if ((block[position / BLOOM_WORD_BITS] & 1ULL << (position % BLOOM_WORD_BITS)) == 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Allocate an empty cuckoo filter.
+ * @param buckets the number of buckets, a power of 2.
+ * @return the filter, or NULL on failure.
+ */
+static MyStringCuckooFilter * allocCuckooFilter(unsigned long long buckets)
+{
+    MyStringCuckooFilter *filter = (MyStringCuckooFilter *) malloc(sizeof(MyStringCuckooFilter));
+    if (filter == NULL || buckets > SIZE_MAX / (CUCKOO_BUCKET_SLOTS * sizeof(unsigned short)))
+    {
+        free(filter);
+        return NULL;
+    }
+    filter -> _slots = (unsigned short *) calloc(buckets * CUCKOO_BUCKET_SLOTS,
+                                                 sizeof(unsigned short));
+    if (filter -> _slots == NULL)
+    {
+        free(filter);
+        return NULL;
+    }
+    filter -> _buckets = buckets;
+    filter -> _count = 0;
+    filter -> _random = CUCKOO_RANDOM_SEED;
+    filter -> _victim = CUCKOO_EMPTY_SLOT;
+    filter -> _victimBucket = 0;
+    return filter;
+}
+
+/**
+ * @brief Get the fingerprint of a hash in a cuckoo filter, from the bits above those
+ * which pick its bucket.
+ * @param hash the hash.
+ * @return the fingerprint, never an empty slot.
+ */
+static unsigned short getCuckooFingerprint(unsigned long long hash)
+{
+    unsigned short fingerprint = (unsigned short) (hash >> CUCKOO_FINGERPRINT_SHIFT);
+    return fingerprint != CUCKOO_EMPTY_SLOT ? fingerprint : 1;
+}
+
+/**
+ * @brief Get the other bucket of a fingerprint, by xoring its bucket with a hash of the
+ * fingerprint.
+ * @param filter the filter.
+ * @param bucket a bucket of the fingerprint.
+ * @param fingerprint the fingerprint.
+ * @return the other bucket.
+ */
+static unsigned long long getCuckooOtherBucket(const MyStringCuckooFilter *filter,
+                                               unsigned long long bucket,
+                                               unsigned short fingerprint)
+{
+    return (bucket ^ (fingerprint * HASH_PRIME1 >> HASH_HIGH_BITS)) & (filter -> _buckets - 1);
+}
+
+/**
+ * @brief Put a fingerprint in an empty slot of a bucket.
+ * @param filter the filter.
+ * @param bucket the bucket.
+ * @param fingerprint the fingerprint.
+ * @return true if the bucket had an empty slot, false otherwise.
+ */
+static bool putCuckooFingerprint(MyStringCuckooFilter *filter, unsigned long long bucket,
+                                 unsigned short fingerprint)
+{
+    unsigned short *slots = filter -> _slots + bucket * CUCKOO_BUCKET_SLOTS;
+    for (int slot = 0; slot < CUCKOO_BUCKET_SLOTS; slot++)
+    {
+        if (slots[slot] == CUCKOO_EMPTY_SLOT)
+        {
+            slots[slot] = fingerprint;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Add a hash to a cuckoo filter. When both its buckets are full, a random
+ * fingerprint of one of them is kicked to its other bucket, and so on. A fingerprint
+ * which is still left without a slot is kept as the victim, which makes the filter
+ * full.
+ * @param filter the filter.
+ * @param hash the hash.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR if the filter is full.
+ */
+static MyStringRetVal addCuckooHash(MyStringCuckooFilter *filter, unsigned long long hash)
+{
+    if (filter -> _victim != CUCKOO_EMPTY_SLOT)
+    {
+        return MYSTRING_ERROR;
+    }
+    unsigned short fingerprint = getCuckooFingerprint(hash);
+    unsigned long long bucket = hash & (filter -> _buckets - 1);
+    unsigned long long other = getCuckooOtherBucket(filter, bucket, fingerprint);
+    filter -> _count++;
+    if (putCuckooFingerprint(filter, bucket, fingerprint) ||
+        putCuckooFingerprint(filter, other, fingerprint))
+    {
+        return MYSTRING_SUCCESS;
+    }
+    if (nextCuckooRandom(filter) % 2 == 0)
+    {
+        bucket = other;
+    }
+    for (int kick = 0; kick < CUCKOO_MAX_KICKS; kick++)
+    {
+        unsigned short *slot = filter -> _slots + bucket * CUCKOO_BUCKET_SLOTS +
+                               nextCuckooRandom(filter) % CUCKOO_BUCKET_SLOTS;
+        unsigned short kicked = *slot;
+        *slot = fingerprint;
+        fingerprint = kicked;
+        bucket = getCuckooOtherBucket(filter, bucket, fingerprint);
+        if (putCuckooFingerprint(filter, bucket, fingerprint))
+        {
+            return MYSTRING_SUCCESS;
+        }
+    }
+    filter -> _victim = fingerprint;
+    filter -> _victimBucket = bucket;
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Get the next number of the xorshift generator of a cuckoo filter, which picks
+ * the fingerprints to kick.
+ * @param filter the filter.
+ * @return a pseudo random number.
+ */
+static unsigned long long nextCuckooRandom(MyStringCuckooFilter *filter)
+{
+    filter -> _random ^= filter -> _random << 13;
+    filter -> _random ^= filter -> _random >> 7;
+    filter -> _random ^= filter -> _random << 17;
+    return filter -> _random;
+}
+
+/**
+ * @brief Check if a cuckoo filter has the fingerprint of a hash in one of its buckets,
+ * or as its victim.
+ * @param filter the filter.
+ * @param hash the hash.
+ * @return true if it has, false otherwise.
+ */
+static bool containsCuckooHash(const MyStringCuckooFilter *filter, unsigned long long hash)
+{
+    unsigned short fingerprint = getCuckooFingerprint(hash);
+    unsigned long long bucket = hash & (filter -> _buckets - 1);
+    unsigned long long other = getCuckooOtherBucket(filter, bucket, fingerprint);
+    const unsigned short *slots = filter -> _slots + bucket * CUCKOO_BUCKET_SLOTS;
+    const unsigned short *otherSlots = filter -> _slots + other * CUCKOO_BUCKET_SLOTS;
+    bool isFound = filter -> _victim == fingerprint &&
+                   (filter -> _victimBucket == bucket || filter -> _victimBucket == other);
+    for (int slot = 0; slot < CUCKOO_BUCKET_SLOTS; slot++)
+    {
+        isFound |= slots[slot] == fingerprint;
+        isFound |= otherSlots[slot] == fingerprint;
+    }
+    return isFound;
+}
+
+/**
+ * @brief Write a little endian number to a stream.
+ * @param stream the stream.
+ * @param number the number.
+ * @param size the number of bytes.
+ * @return true on success, false otherwise.
+ */
+static bool writeFilterNumber(FILE *stream, unsigned long long number, int size)
+{
+    unsigned char bytes[FILTER_NUMBER_BYTES];
+    for (int i = 0; i < size; i++)
+    {
+        bytes[i] = (unsigned char) (number >> (i * CHAR_BIT));
+    }
+    return fwrite(bytes, sizeof(unsigned char), (size_t) size, stream) == (size_t) size;
+}
+
+/**
+ * @brief Read a little endian number from a stream.
+ * @param stream the stream.
+ * @param size the number of bytes.
+ * @param number pointer to set to the number.
+ * @return true on success, false otherwise.
+ */
+static bool readFilterNumber(FILE *stream, int size, unsigned long long *number)
+{
+    unsigned char bytes[FILTER_NUMBER_BYTES];
+    if (fread(bytes, sizeof(unsigned char), (size_t) size, stream) != (size_t) size)
+    {
+        return false;
+    }
+    *number = 0;
+    for (int i = 0; i < size; i++)
+    {
+        *number |= (unsigned long long) bytes[i] << (i * CHAR_BIT);
+    }
+    return true;
+}
+
+/**
+ * @brief Read the magic of a filter from a stream.
+ * @param stream the stream.
+ * @param magic the expected magic.
+ * @return true if the stream starts with it, false otherwise.
+ */
+static bool readFilterMagic(FILE *stream, const char *magic)
+{
+    char chars[FILTER_MAGIC_LENGTH];
+    return fread(chars, sizeof(char), FILTER_MAGIC_LENGTH, stream) == FILTER_MAGIC_LENGTH &&
+           memcmp(chars, magic, FILTER_MAGIC_LENGTH) == 0;
+}
+
+/**
+ * @brief Find the first occurrence of a needle in chars. SSE2 compares 16 places at once
+ * by the first and the last char of the needle, and only the places where both match
+ * are compared in full.
+ * @param chars the chars.
+ * @param length the number of chars.
+ * @param needle the needle, at least 1 char.
+ * @param needleLength the length of the needle.
+ * @return the first occurrence, or NULL if there's none.
+ */
+static const char * findChars(const char *chars, unsigned long length, const char *needle,
+                              unsigned long needleLength)
+{
+    if (needleLength > length)
+    {
+        return NULL;
+    }
+    if (needleLength == 1)
+    {
+        return (const char *) memchr(chars, needle[0], length);
+    }
+    // The last place the needle may start at.
+    unsigned long last = length - needleLength;
+    unsigned long i = 0;
+#ifdef __SSE2__
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i lastChar = _mm_set1_epi8(needle[needleLength - 1]);
+    for (; i + SSE2_BLOCK_SIZE - 1 <= last; i += SSE2_BLOCK_SIZE)
+    {
+        __m128i starts = _mm_loadu_si128((const __m128i *) (chars + i));
+        __m128i ends = _mm_loadu_si128((const __m128i *) (chars + i + needleLength - 1));
+        unsigned int candidates = (unsigned int) _mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(starts, first), _mm_cmpeq_epi8(ends, lastChar)));
+        while (candidates != 0)
+        {
+            const char *candidate = chars + i + __builtin_ctz(candidates);
+            if (memcmp(candidate + 1, needle + 1, needleLength - 2) == 0)
+            {
+                return candidate;
+            }
+            candidates &= candidates - 1;
+        }
+    }
+#endif
+    while (i <= last)
+    {
+        const char *candidate = (const char *) memchr(chars + i, needle[0], last + 1 - i);
+        if (candidate == NULL)
+        {
+            return NULL;
+        }
+        if (memcmp(candidate, needle, needleLength) == 0)
+        {
+            return candidate;
+        }
+        i = (unsigned long) (candidate - chars) + 1;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Find the first occurrence of a needle in chars, for the other translation
+ * units of the library.
+ * @param chars the chars.
+ * @param length the number of chars.
+ * @param needle the needle, at least 1 char.
+ * @param needleLength the length of the needle.
+ * @return the first occurrence, or NULL if there's none.
+ */
+const char * myStringFindChars(const char *chars, unsigned long length, const char *needle,
+                               unsigned long needleLength)
+{
+    return findChars(chars, length, needle, needleLength);
+}
+
+/**
+ * @brief Check if a view is of chars in the block of a string.
+ * @param str the string.
+ * @param view the view.
+ * @return true if it is, false otherwise.
+ */
+static bool isViewOfMyString(const MyString *str, MyStringView view)
+{
+    return view._length > 0 && view._chars < str -> _chars + str -> _capacity &&
+           view._chars + view._length > str -> _chars;
+}
+
+/**
+ * @brief Start a string of new chars of a length in a block of their own, for the caller
+ * to write and then move to the string they replace.
+ * @param newChars the string to start.
+ * @param length the length.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal allocMyStringChars(MyString *newChars, unsigned long length)
+{
+    newChars -> _chars = noChars;
+    newChars -> _length = EMPTY_STRING_LENGTH;
+    newChars -> _capacity = 0;
+    newChars -> _mappedSize = 0;
+    if (setMyStringCapacity(newChars, length + 1) == MYSTRING_ERROR)
+    {
+        return MYSTRING_ERROR;
+    }
+    setMyStringLength(newChars, length);
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Find the next occurrence of any needle of a matcher: the one which starts
+ * first, and the longest of those. The scan goes on past the first occurrence only
+ * while the state may still be a longer one starting at the same place.
+ * @param matcher the matcher.
+ * @param chars the chars.
+ * @param length the number of chars.
+ * @param from the index to search from.
+ * @param start pointer to set to the index of the occurrence.
+ * @param needle pointer to set to the index of its needle.
+ * @return true if there is one, false otherwise.
+ */
+static bool findNextMatch(const MyStringMatcher *matcher, const unsigned char *chars,
+                          unsigned long length, unsigned long from, unsigned long *start,
+                          unsigned long *needle)
+{
+    bool isFound = false;
+    unsigned long state = MATCHER_ROOT;
+    for (unsigned long i = from; i < length; i++)
+    {
+        state = matcher -> _transitions[state * MATCHER_ALPHABET + chars[i]];
+        // The state is the longest needle prefix ending here, so nothing it may grow to
+        // starts before it.
+        if (isFound && i + 1 - matcher -> _depths[state] > *start)
+        {
+            break;
+        }
+        unsigned long output = matcher -> _outputs[state];
+        if (output == MATCHER_NO_NEEDLE)
+        {
+            continue;
+        }
+        unsigned long outputStart = i + 1 - matcher -> _needleLengths[output];
+        // Of two occurrences at the same place the later one is the longer.
+        if (!isFound || outputStart <= *start)
+        {
+            isFound = true;
+            *start = outputStart;
+            *needle = output;
+        }
+    }
+    return isFound;
+}
+
+/**
+ * @brief Build the transitions of a matcher which no needle has by following the
+ * failure links, breadth first, and give every state the output of its failure link
+ * if it has none.
+ * @param matcher the matcher, with the trie of its needles.
+ * @param states the number of states.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal linkMatcherStates(MyStringMatcher *matcher, unsigned long states)
+{
+    // The failure link of a state is the longest proper suffix of it which is a state.
+    unsigned int *links = (unsigned int *) malloc(states * sizeof(unsigned int));
+    unsigned int *queue = (unsigned int *) malloc(states * sizeof(unsigned int));
+    if (links == NULL || queue == NULL)
+    {
+        free(links);
+        free(queue);
+        return MYSTRING_ERROR;
+    }
+    unsigned long head = 0;
+    unsigned long tail = 0;
+    unsigned int *transitions = matcher -> _transitions;
+    for (unsigned int c = 0; c < MATCHER_ALPHABET; c++)
+    {
+        if (transitions[c] == MATCHER_NO_STATE)
+        {
+            transitions[c] = MATCHER_ROOT;
+        }
+        else
+        {
+            links[transitions[c]] = MATCHER_ROOT;
+            queue[tail++] = transitions[c];
+        }
+    }
+    // Shorter states are done first, so the links and the outputs they lend are final.
+    while (head < tail)
+    {
+        unsigned long state = queue[head++];
+        unsigned long link = links[state];
+        if (matcher -> _outputs[state] == MATCHER_NO_NEEDLE)
+        {
+            matcher -> _outputs[state] = matcher -> _outputs[link];
+        }
+        for (unsigned int c = 0; c < MATCHER_ALPHABET; c++)
+        {
+            unsigned int *next = &transitions[state * MATCHER_ALPHABET + c];
+            unsigned int linkNext = transitions[link * MATCHER_ALPHABET + c];
+            if (*next == MATCHER_NO_STATE)
+            {
+                *next = linkNext;
+            }
+            else
+            {
+                links[*next] = linkNext;
+                queue[tail++] = *next;
+            }
+        }
+    }
+    free(links);
+    free(queue);
+    return MYSTRING_SUCCESS;
+}
+
+/**
+ * @brief Pair every string of an array with its prefix key, or 0 for a comparator.
+ * @param arr the strings.
+ * @param len the number of strings.
+ * @param order the order.
+ * @return the pairs, which the caller frees, or NULL on failure or if a string is NULL.
+ */
+static SortKeyPair * createSelectPairs(MyString *arr[], unsigned long len,
+                                       const SelectOrder *order)
+{
+    if (len > ULONG_MAX / sizeof(SortKeyPair))
+    {
+        return NULL;
+    }
+    SortKeyPair *pairs = (SortKeyPair *) malloc(len * sizeof(SortKeyPair));
+    if (pairs == NULL)
+    {
+        return NULL;
+    }
+    for (unsigned long i = 0; i < len; i++)
+    {
+        if (arr[i] == NULL)
+        {
+            free(pairs);
+            return NULL;
+        }
+        pairs[i]._key = getSelectKey(order, arr[i]);
+        pairs[i]._index = i;
+    }
+    return pairs;
+}
+
+/**
+ * @brief Get the prefix key of a string in an order.
+ * @param order the order.
+ * @param str the string.
+ * @return the key, 0 for a comparator.
+ */
+static unsigned long long getSelectKey(const SelectOrder *order, const MyString *str)
+{
+    return order -> _comparator != NULL ? 0 : getPrefixKey(str -> _chars, str -> _length);
+}
+
+/**
+ * @brief Compare two strings with their keys in an order. Different prefix keys decide
+ * without reading the strings, since they're their first chars as a big endian number.
+ * @param order the order.
+ * @param key1
+ * @param str1
+ * @param key2
+ * @param str2
+ * @return negative if str1 comes first, positive if str2 does, 0 if they're equal.
+ */
+static int compareSelectKeys(const SelectOrder *order, unsigned long long key1,
+                             const MyString *str1, unsigned long long key2,
+                             const MyString *str2)
+{
+    if (order -> _comparator != NULL)
+    {
+        return order -> _comparator(&str1, &str2);
+    }
+    if (key1 != key2)
+    {
+        return key1 < key2 ? STR2_BIGGER : STR1_BIGGER;
+    }
+    return myStringCompare(str1, str2);
+}
+
+/**
+ * @brief Check if the string of a pair comes before the string of another.
+ * @param order the order, whose strings the pairs index.
+ * @param pair1
+ * @param pair2
+ * @return true if it does, false otherwise.
+ */
+static bool isPairBefore(const SelectOrder *order, SortKeyPair pair1, SortKeyPair pair2)
+{
+    return compareSelectKeys(order, pair1._key, order -> _strs[pair1._index], pair2._key,
+                             order -> _strs[pair2._index]) < 0;
+}
+
+/**
+ * @brief Swap two pairs.
+ * @param pair1
+ * @param pair2
+ */
+static void swapPairs(SortKeyPair *pair1, SortKeyPair *pair2)
+{
+    SortKeyPair temp = *pair1;
+    *pair1 = *pair2;
+    *pair2 = temp;
+}
+
+/**
+ * @brief Move a pair of a max heap down to its place.
+ * @param order the order.
+ * @param heap the heap.
+ * @param n the number of pairs in the heap.
+ * @param i the index of the pair.
+ */
+static void siftDownPairs(const SelectOrder *order, SortKeyPair *heap, unsigned long n,
+                          unsigned long i)
+{
+    SortKeyPair pair = heap[i];
+    while (i < n / 2)
+    {
+        unsigned long child = 2 * i + 1;
+        if (child + 1 < n && isPairBefore(order, heap[child], heap[child + 1]))
+        {
+            child++;
+        }
+        if (!isPairBefore(order, pair, heap[child]))
+        {
+            break;
+        }
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = pair;
+}
+
+/**
+ * @brief Move a pair of a max heap up to its place.
+ * @param order the order.
+ * @param heap the heap.
+ * @param i the index of the pair.
+ */
+static void siftUpPairs(const SelectOrder *order, SortKeyPair *heap, unsigned long i)
+{
+    SortKeyPair pair = heap[i];
+    while (i > 0 && isPairBefore(order, heap[(i - 1) / 2], pair))
+    {
+        heap[i] = heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    heap[i] = pair;
+}
+
+/**
+ * @brief Move the smallest k pairs to the start, as a max heap. Every other pair is
+ * compared to the biggest of the heap, and swapped in only if it's smaller.
+ * @param order the order.
+ * @param pairs the pairs.
+ * @param n the number of pairs.
+ * @param k the number of pairs to keep, between 1 and n.
+ */
+static void heapSelectPairs(const SelectOrder *order, SortKeyPair *pairs, unsigned long n,
+                            unsigned long k)
+{
+    for (unsigned long i = k / 2; i > 0; i--)
+    {
+        siftDownPairs(order, pairs, k, i - 1);
+    }
+    for (unsigned long i = k; i < n; i++)
+    {
+        if (isPairBefore(order, pairs[i], pairs[0]))
+        {
+            swapPairs(&pairs[0], &pairs[i]);
+            siftDownPairs(order, pairs, k, 0);
+        }
+    }
+}
+
+/**
+ * @brief Sort a max heap of pairs in ascending order.
+ * @param order the order.
+ * @param heap the heap.
+ * @param n the number of pairs.
+ */
+static void sortPairHeap(const SelectOrder *order, SortKeyPair *heap, unsigned long n)
+{
+    for (unsigned long i = n; i > 1; i--)
+    {
+        swapPairs(&heap[0], &heap[i - 1]);
+        siftDownPairs(order, heap, i - 1, 0);
+    }
+}
+
+/**
+ * @brief Sort pairs by insertion.
+ * @param order the order.
+ * @param pairs the pairs.
+ * @param n the number of pairs.
+ */
+static void insertionSortPairs(const SelectOrder *order, SortKeyPair *pairs, unsigned long n)
+{
+    for (unsigned long i = 1; i < n; i++)
+    {
+        SortKeyPair pair = pairs[i];
+        unsigned long j = i;
+        for (; j > 0 && isPairBefore(order, pair, pairs[j - 1]); j--)
+        {
+            pairs[j] = pairs[j - 1];
+        }
+        pairs[j] = pair;
+    }
+}
+
+/**
+ * @brief Partition a range of pairs around the median of its first, middle and last.
+ * Pairs equal to the median stop both scans, so ranges of equal strings split evenly.
+ * @param order the order.
+ * @param pairs the pairs.
+ * @param low the first index of the range.
+ * @param high the index after the range, at least low + 3.
+ * @return the index the median ends at, with no bigger pair before and no smaller after.
+ */
+static unsigned long partitionPairs(const SelectOrder *order, SortKeyPair *pairs,
+                                    unsigned long low, unsigned long high)
+{
+    unsigned long middle = low + (high - low) / 2;
+    if (isPairBefore(order, pairs[middle], pairs[low]))
+    {
+        swapPairs(&pairs[middle], &pairs[low]);
+    }
+    if (isPairBefore(order, pairs[high - 1], pairs[middle]))
+    {
+        swapPairs(&pairs[high - 1], &pairs[middle]);
+        if (isPairBefore(order, pairs[middle], pairs[low]))
+        {
+            swapPairs(&pairs[middle], &pairs[low]);
+        }
+    }
+    // The median waits at low, and the last pair, which isn't smaller, stops the scan up.
+    swapPairs(&pairs[low], &pairs[middle]);
+    SortKeyPair pivot = pairs[low];
+    unsigned long i = low;
+    unsigned long j = high;
+    while (true)
+    {
+        do
+        {
+            i++;
+        } while (isPairBefore(order, pairs[i], pivot));
+        do
+        {
+            j--;
+        } while (isPairBefore(order, pivot, pairs[j]));
+        if (i >= j)
+        {
+            break;
+        }
+        swapPairs(&pairs[i], &pairs[j]);
+    }
+    swapPairs(&pairs[low], &pairs[j]);
+    return j;
+}
+
+/**
+ * @brief Put the pair which would be at an index of the sorted pairs there, by
+ * introselect: quickselect, which falls back to a heap if partitioning goes badly for
+ * twice the depth a balanced one would take.
+ * @param order the order.
+ * @param pairs the pairs.
+ * @param n the number of pairs.
+ * @param nth the index, smaller than n.
+ */
+static void introSelectPairs(const SelectOrder *order, SortKeyPair *pairs, unsigned long n,
+                             unsigned long nth)
+{
+    unsigned long low = 0;
+    unsigned long high = n;
+    unsigned int depth = 0;
+    for (unsigned long m = n; m > 1; m >>= 1)
+    {
+        depth += 2;
+    }
+    while (high - low > SELECT_INSERTION_SIZE)
+    {
+        if (depth == 0)
+        {
+            heapSelectPairs(order, pairs + low, high - low, nth - low + 1);
+            swapPairs(&pairs[low], &pairs[nth]);
+            return;
+        }
+        depth--;
+        unsigned long middle = partitionPairs(order, pairs, low, high);
+        if (middle == nth)
+        {
+            return;
+        }
+        if (nth < middle)
+        {
+            high = middle;
+        }
+        else
+        {
+            low = middle + 1;
+        }
+    }
+    insertionSortPairs(order, pairs + low, high - low);
+}
+
+/**
+ * @brief Compare two strings whose prefix keys are equal, so their chars are equal up
+ * to the shorter of them and WORD_SIZE, and only the chars after those are compared.
+ * @param str1
+ * @param str2
+ * @return negative if str1 is smaller, positive if it's bigger, 0 if they're equal.
+ */
+static int compareAfterPrefixKey(const MyString *str1, const MyString *str2)
+{
+    unsigned long shorter = str1 -> _length < str2 -> _length ? str1 -> _length : str2 -> _length;
+    unsigned long shared = shorter < WORD_SIZE ? shorter : WORD_SIZE;
+    int result = memcmp(str1 -> _chars + shared, str2 -> _chars + shared, shorter - shared);
+    if (result != 0 || str1 -> _length == str2 -> _length)
+    {
+        return result;
+    }
+    return str1 -> _length < str2 -> _length ? STR2_BIGGER : STR1_BIGGER;
+}
+
+/**
+ * @brief Sort entries of strings with equal prefix keys by merge sort, merging equal
+ * strings into the first of them as they meet. Both halves are distinct after they're
+ * sorted, so a string meets at most one equal string of the other half.
+ * @param entries the entries, each of count 1 or more.
+ * @param n the number of entries.
+ * @param temp room for n entries.
+ * @param duplicates the array to put the merged strings in, before index *duplicateIndex.
+ * @param duplicateIndex pointer to the index, decreased for every merged string.
+ * @return the number of distinct entries, which are left sorted at the start.
+ */
+static unsigned long sortUniqueEntries(UniqueEntry *entries, unsigned long n, UniqueEntry *temp,
+                                       MyString *duplicates[], unsigned long *duplicateIndex)
+{
+    if (n <= 1)
+    {
+        return n;
+    }
+    unsigned long half = n / 2;
+    unsigned long end1 = sortUniqueEntries(entries, half, temp, duplicates, duplicateIndex);
+    unsigned long end2 = half + sortUniqueEntries(entries + half, n - half, temp, duplicates,
+                                                  duplicateIndex);
+    unsigned long i = 0;
+    unsigned long j = half;
+    unsigned long out = 0;
+    while (i < end1 && j < end2)
+    {
+        int result = compareAfterPrefixKey(entries[i]._str, entries[j]._str);
+        if (result < 0)
+        {
+            temp[out++] = entries[i++];
+        }
+        else if (result > 0)
+        {
+            temp[out++] = entries[j++];
+        }
+        else
+        {
+            // The first half holds the earlier occurrences, so the one of j is dropped.
+            entries[i]._count += entries[j]._count;
+            duplicates[--*duplicateIndex] = entries[j++]._str;
+        }
+    }
+    while (i < end1)
+    {
+        temp[out++] = entries[i++];
+    }
+    while (j < end2)
+    {
+        temp[out++] = entries[j++];
+    }
+    memcpy(entries, temp, out * sizeof(UniqueEntry));
+    return out;
+}
+
+/**
+ * @brief Parse a glob pattern to its states, after a first state. Every token of the
+ * pattern is a state, and adjacent stars are one.
+ * @param glob the glob to set the masks of, or NULL to only count the states.
+ * @param pattern the pattern.
+ * @param start the first state.
+ * @param states pointer to set to the number of states, with the first.
+ * @param prefix room for the literal chars the pattern starts with, or NULL.
+ * @param prefixLength pointer to set to their number.
+ * @return true if the pattern is valid, false otherwise.
+ */
+static bool compileGlobPattern(MyStringGlob *glob, MyStringView pattern, unsigned long start,
+                               unsigned long *states, char *prefix, unsigned long *prefixLength)
+{
+    bool members[GLOB_CHARS];
+    unsigned long state = start;
+    unsigned long i = 0;
+    // Whether all the tokens so far are literal chars.
+    bool isLiteral = true;
+    // Whether the next token starts a part of a path.
+    bool isPartStart = true;
+    bool isLastStar = false;
+    bool isLastSkip = false;
+    *prefixLength = 0;
+    while (i < pattern._length)
+    {
+        char c = pattern._chars[i];
+        if (c == GLOB_STAR)
+        {
+            unsigned long stars = 0;
+            for (; i < pattern._length && pattern._chars[i] == GLOB_STAR; i++)
+            {
+                stars++;
+            }
+            bool isSkip = stars > 1 && isPartStart && i < pattern._length &&
+                          pattern._chars[i] == GLOB_SEPARATOR;
+            isLiteral = false;
+            // Two "**" parts in a row match what one does.
+            if (isSkip && isLastSkip)
+            {
+                i++;
+                continue;
+            }
+            // Adjacent stars are one star, which matches separators if any of them does.
+            if (!isLastStar)
+            {
+                state++;
+            }
+            for (unsigned int j = 0; j < GLOB_CHARS; j++)
+            {
+                members[j] = stars > 1 || j != GLOB_SEPARATOR;
+            }
+            if (glob != NULL)
+            {
+                setGlobBit(glob -> _stars, state);
+                setGlobTransitions(glob, glob -> _loops, state, members);
+            }
+            isLastStar = true;
+            isLastSkip = false;
+            isPartStart = false;
+            if (isSkip)
+            {
+                i++;
+                state++;
+                if (glob != NULL)
+                {
+                    setGlobBit(glob -> _moves + GLOB_SEPARATOR * glob -> _words, state);
+                    setGlobBit(glob -> _skips, state);
+                }
+                isLastStar = false;
+                isLastSkip = true;
+                isPartStart = true;
+            }
+            continue;
+        }
+        state++;
+        isLastStar = false;
+        isLastSkip = false;
+        isPartStart = false;
+        if (c == GLOB_ANY)
+        {
+            for (unsigned int j = 0; j < GLOB_CHARS; j++)
+            {
+                members[j] = j != GLOB_SEPARATOR;
+            }
+            isLiteral = false;
+            i++;
+        }
+        else if (c == GLOB_CLASS_START)
+        {
+            if (!parseGlobClass(pattern, &i, members))
+            {
+                return false;
+            }
+            isLiteral = false;
+        }
+        else
+        {
+            if (c == GLOB_ESCAPE && i + 1 < pattern._length)
+            {
+                i++;
+                c = pattern._chars[i];
+            }
+            i++;
+            memset(members, false, sizeof(members));
+            members[(unsigned char) c] = true;
+            isPartStart = c == GLOB_SEPARATOR;
+            if (isLiteral)
+            {
+                if (prefix != NULL)
+                {
+                    prefix[*prefixLength] = c;
+                }
+                (*prefixLength)++;
+            }
+        }
+        if (glob != NULL)
+        {
+            setGlobTransitions(glob, glob -> _moves, state, members);
+        }
+    }
+    *states = state - start + 1;
+    return true;
+}
+
+/**
+ * @brief Parse a class of a glob pattern. A ']' right after the '[' (or after the '!')
+ * is a member rather than the end.
+ * @param pattern the pattern.
+ * @param i pointer to the index of the '[', set to the index after the class.
+ * @param members set to whether every char is matched by the class.
+ * @return true if the class is closed, false otherwise.
+ */
+static bool parseGlobClass(MyStringView pattern, unsigned long *i, bool members[])
+{
+    const char *chars = pattern._chars;
+    unsigned long j = *i + 1;
+    bool isNegated = j < pattern._length &&
+                     (chars[j] == GLOB_CLASS_NOT || chars[j] == GLOB_CLASS_CARET);
+    if (isNegated)
+    {
+        j++;
+    }
+    bool inClass[GLOB_CHARS] = {false};
+    bool isFirst = true;
+    while (j < pattern._length && (chars[j] != GLOB_CLASS_END || isFirst))
+    {
+        if (chars[j] == GLOB_ESCAPE && j + 1 < pattern._length)
+        {
+            j++;
+        }
+        unsigned char low = (unsigned char) chars[j];
+        unsigned char high = low;
+        j++;
+        if (j + 1 < pattern._length && chars[j] == GLOB_CLASS_RANGE &&
+            chars[j + 1] != GLOB_CLASS_END)
+        {
+            j++;
+            if (chars[j] == GLOB_ESCAPE && j + 1 < pattern._length)
+            {
+                j++;
+            }
+            high = (unsigned char) chars[j];
+            j++;
+        }
+        for (unsigned int c = low; c <= high; c++)
+        {
+            inClass[c] = true;
+        }
+        isFirst = false;
+    }
+    if (j >= pattern._length)
+    {
+        return false;
+    }
+    *i = j + 1;
+    for (unsigned int c = 0; c < GLOB_CHARS; c++)
+    {
+        members[c] = inClass[c] != isNegated && c != GLOB_SEPARATOR;
+    }
+    return true;
+}
+
+/**
+ * @brief Set the bit of a state in the masks of the chars of a token.
+ * @param glob the glob.
+ * @param masks the masks of every char.
+ * @param state the state.
+ * @param members whether every char is matched by the token.
+ */
+static void setGlobTransitions(const MyStringGlob *glob, unsigned long long *masks,
+                               unsigned long state, const bool members[])
+{
+    for (unsigned int c = 0; c < GLOB_CHARS; c++)
+    {
+        if (members[c])
+        {
+            setGlobBit(masks + c * glob -> _words, state);
+        }
+    }
+}
+
+/**
+ * @brief Set the bit of a state.
+ * @param bits the bit vector.
+ * @param state the state.
+ */
+static void setGlobBit(unsigned long long *bits, unsigned long state)
+{
+    bits[state / GLOB_WORD_BITS] |= 1ULL << (state % GLOB_WORD_BITS);
+}
+
+/**
+ * @brief Check the bit of a state.
+ * @param bits the bit vector.
+ * @param state the state.
+ * @return true if it's set, false otherwise.
+ */
+static bool isGlobBitSet(const unsigned long long *bits, unsigned long state)
+{
+    return (bits[state / GLOB_WORD_BITS] >> (state % GLOB_WORD_BITS)) & 1ULL;
+}
+
+/**
+ * @brief Enter a state of a glob, and the states which follow it without a char: the
+ * separator of a "**" part which follows it, and then a star after either.
+ * @param glob the glob.
+ * @param states the states.
+ * @param state the state.
+ */
+static void enterGlobState(const MyStringGlob *glob, unsigned long long *states,
+                           unsigned long state)
+{
+    setGlobBit(states, state);
+    if (isGlobBitSet(glob -> _stars, state + 1))
+    {
+        setGlobBit(states, state + 1);
+    }
+    if (isGlobBitSet(glob -> _skips, state + 2))
+    {
+        setGlobBit(states, state + 2);
+        if (isGlobBitSet(glob -> _stars, state + 3))
+        {
+            setGlobBit(states, state + 3);
+        }
+    }
+}
+
+/**
+ * @brief Run the states of all the patterns of a glob over chars, as a bit parallel NFA
+ * in the way of shift-and: a char moves every state to the next one if the next token
+ * matches it, and keeps the states of the stars which match it. The states which follow
+ * without a char are then entered, first the separators of "**" parts from 2 states
+ * back and then the stars from 1 state back.
+ * A pattern is started only after its literal prefix, if the chars start with it, and
+ * only the words of live states are run, so a char costs as much as the patterns it may
+ * still match. The run stops early once no state is left and no pattern is left to start.
+ * @param glob the glob.
+ * @param str the chars.
+ * @param states room for the states.
+ * @param matches room for a result for every pattern, or NULL.
+ * @return true if any pattern matches, false otherwise.
+ */
+static bool runGlob(const MyStringGlob *glob, MyStringView str, unsigned long long *states,
+                    bool matches[])
+{
+    unsigned long words = glob -> _words;
+    const unsigned char *chars = (const unsigned char *) str._chars;
+    memset(states, 0, words * sizeof(unsigned long long));
+    // States move at most 2 states a char, so only the words from low to high, and the
+    // word after them, may be live. low > high when none is.
+    unsigned long low = words;
+    unsigned long high = 0;
+    unsigned long nextPattern = 0;
+    for (unsigned long i = 0; i <= str._length; i++)
+    {
+        for (; nextPattern < glob -> _count &&
+               glob -> _patterns[nextPattern]._prefixLength == i; nextPattern++)
+        {
+            const GlobPattern *pattern = &glob -> _patterns[nextPattern];
+            if (memcmp(str._chars, pattern -> _prefix, i) == 0)
+            {
+                unsigned long state = pattern -> _start + i;
+                enterGlobState(glob, states, state);
+                unsigned long last = (state + 3) / GLOB_WORD_BITS;
+                low = state / GLOB_WORD_BITS < low ? state / GLOB_WORD_BITS : low;
+                high = last > high ? (last < words ? last : words - 1) : high;
+            }
+        }
+        bool isPatternLeft = nextPattern < glob -> _count &&
+                             glob -> _patterns[nextPattern]._prefixLength <= str._length;
+        if (i == str._length || (low > high && !isPatternLeft))
+        {
+            break;
+        }
+        if (low > high)
+        {
+            continue;
+        }
+        const unsigned long long *moves = glob -> _moves + chars[i] * words;
+        const unsigned long long *loops = glob -> _loops + chars[i] * words;
+        unsigned long long moveCarry = 0;
+        unsigned long long skipCarry = 0;
+        unsigned long long starCarry = 0;
+        unsigned long end = high + 1 < words ? high + 1 : high;
+        unsigned long newLow = words;
+        unsigned long newHigh = 0;
+        for (unsigned long w = low; w <= end; w++)
+        {
+            unsigned long long old = states[w];
+            unsigned long long next = (((old << 1) | moveCarry) & moves[w]) | (old & loops[w]);
+            moveCarry = old >> (GLOB_WORD_BITS - 1);
+            unsigned long long skipped = ((next << 2) | skipCarry) & glob -> _skips[w];
+            skipCarry = next >> (GLOB_WORD_BITS - 2);
+            next |= skipped;
+            unsigned long long starred = ((next << 1) | starCarry) & glob -> _stars[w];
+            starCarry = next >> (GLOB_WORD_BITS - 1);
+            states[w] = next | starred;
+            if (states[w] != 0)
+            {
+                newLow = newLow < w ? newLow : w;
+                newHigh = w;
+            }
+        }
+        low = newLow;
+        high = newHigh;
+    }
+    bool isMatch = false;
+    for (unsigned long p = 0; p < glob -> _count; p++)
+    {
+        bool isPatternMatch = isGlobBitSet(states, glob -> _patterns[p]._accept);
+        if (matches != NULL)
+        {
+            matches[glob -> _patterns[p]._index] = isPatternMatch;
+        }
+        isMatch = isMatch || isPatternMatch;
+    }
+    return isMatch;
+}
+
+/**
+ * @brief Comparator of glob patterns by the length of their literal prefix.
+ */
+static int globPrefixComparator(const void *pattern1, const void *pattern2)
+{
+    unsigned long length1 = ((const GlobPattern *) pattern1) -> _prefixLength;
+    unsigned long length2 = ((const GlobPattern *) pattern2) -> _prefixLength;
+    return (length1 > length2) - (length1 < length2);
+}
+
+/**
+ * @brief Fill the tables of the Gear hash, by the avalanche of the hash of the library.
+ */
+static void createGearTables()
+{
+    for (unsigned int i = 0; i < GEAR_TABLE_SIZE; i++)
+    {
+        gearTable[i] = avalancheHash(HASH_PRIME5 + i * HASH_PRIME1);
+        gearShiftedTable[i] = gearTable[i] << 1;
+    }
+}
+
+/**
+ * @brief Avalanche the bits of a hash, as the end of xxHash64 does.
+ * @param hash the hash.
+ * @return the mixed hash.
+ */
+static unsigned long long avalancheHash(unsigned long long hash)
+{
+    hash ^= hash >> 33;
+    hash *= HASH_PRIME2;
+    hash ^= hash >> 29;
+    hash *= HASH_PRIME3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+/**
+ * @brief Rolls the Gear hash over chars, two at a time, until its masked bits are all 0.
+ * The hash after two chars is its shift by two plus a sum which doesn't depend on it,
+ * so the chain of the hash is a shift and an add for two chars, and the hash after the
+ * first of them is checked aside of it.
+ * @param chars the chars.
+ * @param i pointer to the index of the first char to roll in, set to the index after
+ * the cut or to end.
+ * @param end the index to stop at.
+ * @param mask the mask.
+ * @param hash pointer to the hash, which is rolled.
+ * @return true if a cut was found, false otherwise.
+ */
+static bool findChunkCut(const unsigned char *chars, unsigned long *i, unsigned long end,
+                         unsigned long long mask, unsigned long long *hash)
+{
+    unsigned long long current = *hash;
+    unsigned long j = *i;
+    for (; j + 2 <= end; j += 2)
+    {
+        unsigned long long first = (current << 1) + gearTable[chars[j]];
+        current = (current << 2) + (gearShiftedTable[chars[j]] + gearTable[chars[j + 1]]);
+        if ((first & mask) == 0)
+        {
+            *i = j + 1;
+            return true;
+        }
+        if ((current & mask) == 0)
+        {
+            *i = j + 2;
+            return true;
+        }
+    }
+    if (j < end)
+    {
+        current = (current << 1) + gearTable[chars[j]];
+        j++;
+        if ((current & mask) == 0)
+        {
+            *i = j;
+            return true;
+        }
+    }
+    *hash = current;
+    *i = end;
+    return false;
+}
+
+/**
+ * @brief Add a fingerprint to those found by winnowing, if there is room for it.
+ * @param fingerprints the room for the fingerprints.
+ * @param capacity its size.
+ * @param count pointer to the number of fingerprints found so far, which is incremented.
+ * @param hash the hash of the k-gram.
+ * @param offset the offset of the k-gram.
+ */
+static void addFingerprint(MyStringFingerprint fingerprints[], unsigned long capacity,
+                           unsigned long *count, unsigned long long hash, unsigned long offset)
+{
+    if (*count < capacity)
+    {
+        fingerprints[*count]._hash = hash;
+        fingerprints[*count]._offset = offset;
+    }
+    (*count)++;
+}
+
+/**
+ * @brief Allocate the block of an array of n strings and point its pointers to its
+ * strings, which are left for the caller to set.
+ * @param n the number of strings.
+ * @param charsSize the number of chars to keep room for after the strings.
+ * @return the pointers, or NULL on failure.
+ */
+static MyString ** allocMyStringArray(unsigned long n, unsigned long charsSize)
+{
+    unsigned long stringSize = sizeof(MyString *) + sizeof(MyString);
+    if (n > (ULONG_MAX - sizeof(MyStringArrayHeader) - charsSize) / stringSize)
+    {
+        return NULL;
+    }
+    unsigned long size = sizeof(MyStringArrayHeader) + n * stringSize + charsSize;
+    MyStringArrayHeader *header = (MyStringArrayHeader *) allocateBlock(&size);
+    if (header == NULL)
+    {
+        return NULL;
+    }
+    STATS_ALLOCATION(false);
+    header -> _size = size;
+    header -> _count = n;
+    MyString **arr = (MyString **) (header + 1);
+    MyString *strs = (MyString *) (arr + n);
+    for (unsigned long i = 0; i < n; i++)
+    {
+        arr[i] = strs + i;
+    }
+    STATS_ADD(libraryStats._liveStrings, n);
+    return arr;
+}
+
+/**
+ * @brief Count the '\n' of chars, 16 at a time in byte lanes.
+ * @param chars the chars.
+ * @param length the number of chars.
+ * @return the number of '\n'.
+ */
+static unsigned long countLineEnds(const char *chars, unsigned long length)
+{
+    unsigned long count = 0;
+    unsigned long i = 0;
+#ifdef __SSE2__
+    const __m128i lineEnd = _mm_set1_epi8(RECORD_LINE_END);
+    while (i + SSE2_BLOCK_SIZE <= length)
+    {
+        // Every lane counts the '\n' it saw, as a match is -1.
+        __m128i counts = _mm_setzero_si128();
+        for (unsigned int j = 0; j < LINE_COUNT_MAX_BLOCKS && i + SSE2_BLOCK_SIZE <= length;
+             j++, i += SSE2_BLOCK_SIZE)
+        {
+            __m128i block = _mm_loadu_si128((const __m128i *) (chars + i));
+            counts = _mm_sub_epi8(counts, _mm_cmpeq_epi8(block, lineEnd));
+        }
+        __m128i sums = _mm_sad_epu8(counts, _mm_setzero_si128());
+        count += (unsigned long) _mm_cvtsi128_si32(sums) +
+                 (unsigned long) _mm_cvtsi128_si32(_mm_srli_si128(sums, SSE2_HALF_SIZE));
+    }
+#endif
+    for (; i < length; i++)
+    {
+        count += chars[i] == RECORD_LINE_END;
+    }
+    return count;
+}
+
+/**
+ * @brief Set a string of myStringArrayFromLines to a line, replacing the '\n' after it by
+ * '\0'. The string borrows the chars of the array until it's changed, as mapped strings
+ * borrow theirs, and an empty line has none.
+ * @param str the string.
+ * @param start the first char of the line.
+ * @param end the char after the line.
+ */
+static void setLineChars(MyString *str, char *start, char *end)
+{
+    *end = END_OF_C_STRING;
+    str -> _chars = end == start ? noChars : start;
+    str -> _length = end - start;
+    str -> _capacity = 0;
+    str -> _mappedSize = 0;
+}
+
+/**
+ * @brief Compute the prefix XOR of a mask: every bit of it is the XOR of the bits of the
+ * mask up to it, so the bits from a quote to the next one are set. With PCLMUL it's a
+ * carry-less multiply by all ones.
+ * @param mask the mask.
+ * @return the prefix XOR.
+ */
+static unsigned long long prefixXorMask(unsigned long long mask)
+{
+#ifdef __PCLMUL__
+    __m128i product = _mm_clmulepi64_si128(_mm_set_epi64x(0, (long long) mask),
+                                           _mm_set1_epi8((char) UCHAR_MAX), 0);
+    return (unsigned long long) _mm_cvtsi128_si64(product);
+#else
+    for (unsigned int shift = 1; shift < CSV_BLOCK_SIZE; shift *= 2)
+    {
+        mask ^= mask << shift;
+    }
+    return mask;
+#endif
+}
+
+/**
+ * @brief Classify a block of CSV_BLOCK_SIZE chars into masks of its quotes, delimiters
+ * and newlines, with a bit for every char, from the lowest one.
+ * @param chars the chars.
+ * @param delimiter the delimiter.
+ * @param quotes pointer to set to the mask of the quotes.
+ * @param delimiters pointer to set to the mask of the delimiters.
+ * @param newlines pointer to set to the mask of the newlines.
+ */
+static void classifyCsvBlock(const char *chars, char delimiter, unsigned long long *quotes,
+                             unsigned long long *delimiters, unsigned long long *newlines)
+{
+    unsigned long long quoteBits = 0;
+    unsigned long long delimiterBits = 0;
+    unsigned long long newlineBits = 0;
+#ifdef __SSE2__
+    const __m128i quote = _mm_set1_epi8(CSV_QUOTE);
+    const __m128i separator = _mm_set1_epi8(delimiter);
+    const __m128i newline = _mm_set1_epi8(RECORD_LINE_END);
+    for (int i = CSV_BLOCK_SIZE - SSE2_BLOCK_SIZE; i >= 0; i -= SSE2_BLOCK_SIZE)
+    {
+        __m128i block = _mm_loadu_si128((const __m128i *) (chars + i));
+        quoteBits = (quoteBits << SSE2_BLOCK_SIZE) |
+                    (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(block, quote));
+        delimiterBits = (delimiterBits << SSE2_BLOCK_SIZE) |
+                        (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(block, separator));
+        newlineBits = (newlineBits << SSE2_BLOCK_SIZE) |
+                      (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(block, newline));
+    }
+#else
+    for (int i = CSV_BLOCK_SIZE - 1; i >= 0; i--)
+    {
+        quoteBits = (quoteBits << 1) | (chars[i] == CSV_QUOTE);
+        delimiterBits = (delimiterBits << 1) | (chars[i] == delimiter);
+        newlineBits = (newlineBits << 1) | (chars[i] == RECORD_LINE_END);
+    }
+#endif
+    *quotes = quoteBits;
+    *delimiters = delimiterBits;
+    *newlines = newlineBits;
+}
+
+/**
+ * @brief Scan the next block of the data of a reader for the delimiters and newlines
+ * out of quotes. The block at the end of the data is copied and padded first.
+ * @param reader the reader.
+ */
+static void scanCsvBlock(MyStringCsvReader *reader)
+{
+    const char *chars = reader -> _data._chars + reader -> _nextBlock;
+    unsigned long left = reader -> _data._length - reader -> _nextBlock;
+    char padded[CSV_BLOCK_SIZE];
+    if (left < CSV_BLOCK_SIZE)
+    {
+        // The padding is never a quote, a delimiter or a newline.
+        memset(padded, CSV_PADDING, CSV_BLOCK_SIZE);
+        memcpy(padded, chars, left);
+        chars = padded;
+    }
+    unsigned long long quotes = 0;
+    unsigned long long delimiters = 0;
+    unsigned long long newlines = 0;
+    classifyCsvBlock(chars, reader -> _delimiter, &quotes, &delimiters, &newlines);
+    unsigned long long inQuotes = prefixXorMask(quotes) ^ reader -> _inQuotes;
+    reader -> _inQuotes = 0ULL - (inQuotes >> (CSV_BLOCK_SIZE - 1));
+    reader -> _separators = (delimiters | newlines) & ~inQuotes;
+    reader -> _rowEnds = newlines & ~inQuotes;
+    reader -> _block = reader -> _nextBlock;
+    reader -> _nextBlock += CSV_BLOCK_SIZE;
+}
+
+/**
+ * @brief Remove the quotes of the quoted fields of a row. A field whose only quotes
+ * are the opening and the closing ones stays a view of the data, and the others are
+ * unescaped into an arena.
+ * @param arena the arena, whose value is replaced.
+ * @param fields the fields.
+ * @param n the number of fields.
+ * @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+static MyStringRetVal unquoteCsvFields(MyString *arena, MyStringView fields[], unsigned long n)
+{
+    unsigned long size = 0;
+    for (unsigned long i = 0; i < n; i++)
+    {
+        const char *chars = fields[i]._chars;
+        unsigned long length = fields[i]._length;
+        if (length == 0 || chars[0] != CSV_QUOTE)
+        {
+            continue;
+        }
+        const char *quote = memchr(chars + 1, CSV_QUOTE, length - 1);
+        if (quote == NULL || quote == chars + length - 1)
+        {
+            fields[i]._chars = chars + 1;
+            fields[i]._length = quote == NULL ? length - 1 : length - 2;
+        }
+        else
+        {
+            size += length;
+        }
+    }
+    if (size == 0)
+    {
+        return MYSTRING_SUCCESS;
+    }
+    if (adjustMyStringLength(arena, size) == MYSTRING_ERROR)
+    {
+        return MYSTRING_ERROR;
+    }
+    char *out = arena -> _chars;
+    for (unsigned long i = 0; i < n; i++)
+    {
+        const char *chars = fields[i]._chars;
+        const char *end = chars + fields[i]._length;
+        // Only the fields with quotes in them are still quoted.
+        if (fields[i]._length == 0 || chars[0] != CSV_QUOTE)
+        {
+            continue;
+        }
+        char *start = out;
+        chars++;
+        const char *quote = memchr(chars, CSV_QUOTE, end - chars);
+        while (quote != NULL && quote + 1 < end && quote[1] == CSV_QUOTE)
+        {
+            // Keep the first quote of the "".
+            memcpy(out, chars, quote + 1 - chars);
+            out += quote + 1 - chars;
+            chars = quote + 2;
+            quote = memchr(chars, CSV_QUOTE, end - chars);
+        }
+        // The closing quote, after which the chars are kept as they are.
+        if (quote != NULL)
+        {
+            memcpy(out, chars, quote - chars);
+            out += quote - chars;
+            chars = quote + 1;
+        }
+        memcpy(out, chars, end - chars);
+        out += end - chars;
+        fields[i]._chars = start;
+        fields[i]._length = (unsigned long) (out - start);
+    }
+    setMyStringLength(arena, (unsigned long) (out - arena -> _chars));
+    return MYSTRING_SUCCESS;
+}
+
+#ifndef NDEBUG
+
+static void exitBad(char* testName);
+/**
+ * @brief Comparator of the reversed order of the default comparator.
+ * @param str1
+ * @param str2
+ * @return 1 if comparator returned -1 and the opposite,
+ * 		 0 if it returned 0.
+ *
+ */
+static int reverseMyStringCompare(const MyString *str1, const MyString *str2)
+{
+	 if (str1 == NULL || str2 == NULL)
+	 {
+		 return MYSTR_ERROR_CODE;
+	 }
+	 int result = myStringCompare(str1, str2);
+	 if (result > EQUAL_STRINGS)
+	 {
+		 return STR2_BIGGER;
+	 }
+	 if (result < EQUAL_STRINGS)
+	 {
+		 return STR1_BIGGER;
+	 }
+	 return EQUAL_STRINGS;
+}
+
+/**
+ * @brief Wrapper function of a reversed comparator for the qsort function.
+ * @param str1
+ * @param str2
+ * @return 1 if comparator returned -1 and the opposite,
+ * 		 0 if it returned 0.
+ *
+ */
+static int myStringCustomComparator(const void *str1, const void *str2)
+{
+	MyString** temp1 = (MyString **) str1;
+	MyString** temp2 = (MyString **) str2;
+	return reverseMyStringCompare(*temp1, *temp2);
+}
+
+// ------------------------------ Unit Tests -----------------------------
+
+// ------------------------------ myStringAlloc -----------------------------
+
+static void myStringAllocNormalAllocation()
+	{
+		MyString* result = myStringAlloc();
+		if (result == NULL)
+		{
+			printf("Expected result : MyString*\n");
+			printf("Actual result : NULL\n");
+			myStringFree(result);
+			exitBad("myStringAllocNormalAllocation");
+		}
+		printf("PASS\n");
+		myStringFree(result);
+	}
+
+// ------------------------------ myStringFree -----------------------------
+
+static void myStringFreeNormalFree()
+	{
+		char *testName = "myStringFreeNormalFree";
+		printf("Running %s\n", testName);
+		MyString* result = myStringAlloc();
+		myStringFree(result);
+		result = NULL;
+		if (result != NULL)
+		{
+			printf("Expected result : NULL\n");
+			printf("Actual result : MyString*\n");
+			exitBad(testName);
+		}
+		printf("PASS\n");
+	}
+
+static void myStringFreeNullFree()
+	{
+		char *testName = "myStringFreeNullFree";
+		printf("Running %s\n", testName);
+		MyString* result = NULL;
+		myStringFree(result);
+		printf("PASS\n");
+	}
+
+
+
+
+
+// ------------------------------ myStringCompare -----------------------------
+
+static void myStringCompareNullCheck()
+{
+	char *testName = "myStringCompareNullCheck";
+	printf("Running %s\n", testName);
+	MyString *str1 = myStringAlloc();
+	MyString *str2 = myStringAlloc();
+	int result = myStringCompare(NULL, NULL);
+	if (result != MYSTR_ERROR_CODE)
+	{
+		printf("Expected result : -999\n");
+		printf("Actual result : %d\n", result);
+		myStringFree(str1);
+		myStringFree(str2);
+		exitBad(testName);
+	}
+	result = myStringCompare(NULL, str2);
+	if (result != MYSTR_ERROR_CODE)
+	{
+		printf("Expected result : -999\n");
+		printf("Actual result : %d\n", result);
+		myStringFree(str1);
+		myStringFree(str2);
+		exitBad(testName);
+	}
+	result = myStringCompare(str1, NULL);
+	if (result != MYSTR_ERROR_CODE)
+	{
+		printf("Expected result : -999\n");
+		printf("Actual result : %d\n", result);
+		myStringFree(str1);
+		myStringFree(str2);
+		exitBad(testName);
+	}
+	printf("PASS\n");
+	myStringFree(str1);
+	myStringFree(str2);
+}
+
+static void myStringCompareEmptyCheck()
+{
+	char *testName = "myStringCompareEmptyCheck";
+	printf("Running %s\n", testName);
+	MyString *str1 = myStringAlloc();
+	MyString *str2 = myStringAlloc();
+	int result = myStringCompare(str1, str2);
+	if (result != 0)
+	{
+		printf("Expected result : 0\n");
+		printf("Actual result : %d\n", result);
+		myStringFree(str1);
+		myStringFree(str2);
+		exitBad("myStringCompareEmptyCheck");
+	}
+	myStringSetFromCString(str1, "Some String");
+	result = myStringCompare(str1, str2);
+	if (result != 1)
+	{
+		printf("Expected result : 1\n");
+		printf("Actual result : %d\n", result);
+		myStringFree(str1);
+		myStringFree(str2);
+		exitBad("myStringCompareEmptyCheck");
+	}
+	printf("PASS\n");
+	myStringFree(str1);
+	myStringFree(str2);
+}
+
+static void myStringCompareNormalCheck()
+{
+	char *testName = "myStringCompareNormalCheck";
+	printf("Running %s\n", testName);
+	MyString *str1 = myStringAlloc();
+	MyString *str2 = myStringAlloc();
+	myStringSetFromCString(str1, "Some String");
+	myStringSetFromCString(str2, "Some String");
+	int result = myStringCompare(str1, str2);
+	if (result != 0)
+	{
+		printf("Expected result : 0\n");
+		printf("Actual result : %d\n", result);
+		myStringFree(str1);
+		myStringFree(str2);
+		exitBad("myStringCompareEmptyCheck");
+	}
+
+	myStringSetFromCString(str2, "Some");
+	result = myStringCompare(str1, str2);
+	if (result != 1)
+	{
+		printf("Expected result : 1\n");
+		printf("Actual result : %d\n", result);
+		myStringFree(str1);
+		myStringFree(str2);
+		exitBad("myStringCompareEmptyCheck");
+	}
+	myStringSetFromCString(str1, "Som");
+	result = myStringCompare(str1, str2);
+	if (result != -1)
+	{
+		printf("Expected result : -1\n");
+		printf("Actual result : %d\n", result);
+		myStringFree(str1);
+		myStringFree(str2);
+		exitBad("myStringCompareEmptyCheck");
+	}
+	printf("PASS\n");
+	myStringFree(str1);
+	myStringFree(str2);
+}
+
+// ------------------------------ myStringSort -----------------------------
+
+static void myStringSortThreeSort()
+{
+	char *testName = "myStringSortThreeSort";
+	printf("Running %s\n", testName);
+	MyString *str1 = myStringAlloc();
+	MyString *str2 = myStringAlloc();
+	MyString *str3 = myStringAlloc();
+	myStringSetFromCString(str1, "bbc");
+	myStringSetFromCString(str2, "cds");
+	myStringSetFromCString(str3, "abc");
+	MyString *arr[3] = {str1, str2, str3};
+    myStringSort(arr, 3);
+    char* cStr1 = myStringToCString(arr[0]);
+    char* cStr2 = myStringToCString(arr[1]);
+    char* cStr3 = myStringToCString(arr[2]);
+    int retVal1 = strcmp(cStr1, "abc");
+    int retVal2 = strcmp(cStr2, "bbc");
+    int retVal3 = strcmp(cStr3, "cds");
+    if (retVal1 != 0 || retVal2 != 0 || retVal3 != 0)
+    {
+    	printf("Expected result : abc bbc cds\n");
+    	printf("Actual result : %s %s %s\n", cStr1, cStr2, cStr3);
+    	myStringFree(str1);
+    	myStringFree(str2);
+    	myStringFree(str3);
+    	exitBad(testName);
+    }
+    printf("PASS\n");
+    free(cStr1);
+    free(cStr2);
+    free(cStr3);
+    cStr1 = NULL;
+    cStr2 = NULL;
+    cStr3 = NULL;
+    myStringFree(str1);
+    myStringFree(str2);
+    myStringFree(str3);
+}
+
+// ------------------------------ myStringCustomSort -----------------------------
+
+static void myStringCustomSortThreeSort()
+{
+	char *testName = "myStringCustomSortThreeSort";
+	printf("Running %s\n", testName);
+	MyString *str1 = myStringAlloc();
+	MyString *str2 = myStringAlloc();
+	MyString *str3 = myStringAlloc();
+	myStringSetFromCString(str1, "bbc");
+	myStringSetFromCString(str2, "cds");
+	myStringSetFromCString(str3, "abc");
+	MyString *arr[3] = {str1, str2, str3};
+    myStringCustomSort(arr, 3, myStringCustomComparator);
+    char* cStr1 = myStringToCString(arr[0]);
+    char* cStr2 = myStringToCString(arr[1]);
+    char* cStr3 = myStringToCString(arr[2]);
+    int retVal1 = strcmp(cStr1, "cds");
+    int retVal2 = strcmp(cStr2, "bbc");
+    int retVal3 = strcmp(cStr3, "abc");
+    if (retVal1 != 0 || retVal2 != 0 || retVal3 != 0)
+    {
+    	printf("Expected result : cds bbc abc\n");
+    	printf("Actual result : %s %s %s\n", cStr1, cStr2, cStr3);
+    	myStringFree(str1);
+    	myStringFree(str2);
+    	myStringFree(str3);
+    	exitBad(testName);
+    }
+    printf("PASS\n");
+    free(cStr1);
+    free(cStr2);
+    free(cStr3);
+    cStr1 = NULL;
+    cStr2 = NULL;
+    cStr3 = NULL;
+    myStringFree(str1);
+    myStringFree(str2);
+    myStringFree(str3);
+}
+
+// ------------------------------ myStringWrite -----------------------------
+
+static void myStringWriteNormal()
+{
+	char *testName = "myStringWriteNormal";
+	printf("Running %s\n", testName);
+	FILE *stream = fopen("/cs/stud/orib/Desktop/test", "w");
+	if (stream == NULL)
+	{
+		exit(MYSTR_ERROR_CODE);
+	}
+	MyString *str = myStringAlloc();
+	myStringSetFromCString(str, "abcdefghijklmnop");
+	MyStringRetVal retVal = myStringWrite(str, stream);
+	if (retVal == MYSTRING_ERROR)
+	{
+		printf("Expected result : 0\n");
+		printf("Actual result : -1\n");
+		fclose(stream);
+		myStringFree(str);
+		exitBad(testName);
+	}
+
+    printf("PASS\n");
+    myStringFree(str);
+}
+
+// ------------------------------ myStringClone -----------------------------
+
+static void myStringCloneNormal()
+{
+	char *testName = "myStringCloneNormal";
+	printf("Running %s\n", testName);
+	MyString *str = myStringAlloc();
+	myStringSetFromCString(str, "Hey there");
+	MyString *clonedStr = myStringClone(str);
+	char *clonedChars = myStringToCString(clonedStr);
+	char *oldChars = myStringToCString(str);
+	int result = strcmp(clonedChars, oldChars);
+	if (result != 0)
+	{
+		printf("Expected result : 0\n");
+		printf("Actual result : %d\n", result);
+		myStringFree(str);
+		myStringFree(clonedStr);
+		exitBad(testName);
+	}
+	printf("PASS\n");
+	free(clonedChars);
+	free(oldChars);
+	clonedChars = NULL;
+	oldChars = NULL;
+	myStringFree(str);
+	myStringFree(clonedStr);
+}
+
+// ------------------------------ myStringSetFromMyString -----------------------------
+static void myStringSetFromMyStringEmpty()
+{
+	char *testName = "myStringSetFromMyStringEmpty";
+	printf("Running %s\n", testName);
+	MyString *str1 = myStringAlloc();
+	MyString *str2 = myStringAlloc();
+	myStringSetFromCString(str2, "Hey there");
+	myStringSetFromMyString(str1, str2);
+	char *newChars = myStringToCString(str1);
+	char *oldChars = myStringToCString(str2);
+	int result = strcmp(newChars, oldChars);
+	if (result != 0)
+	{
+		printf("Expected result : 0\n");
+		printf("Actual result : -1\n");
+		myStringFree(str1);
+		myStringFree(str2);
+		exitBad(testName);
+	}
+	printf("PASS\n");
+	free(newChars);
+	free(oldChars);
+	newChars = NULL;
+	oldChars = NULL;
+	myStringFree(str1);
+	myStringFree(str2);
+}
+
+static void myStringSetFromMyStringNormal()
+{
+	char *testName = "myStringSetFromMyStringNormal";
+	printf("Running %s\n", testName);
+	MyString *str1 = myStringAlloc();
+	MyString *str2 = myStringAlloc();
+
+	int retVal = myStringSetFromMyString(str1, str2);
+	if (retVal != MYSTRING_SUCCESS)
+	{
+		printf("Expected result : 0\n");
+		printf("Actual result : -1\n");
+		exitBad(testName);
+	}
+	printf("PASS\n");
+
+	myStringFree(str1);
+	myStringFree(str2);
+}
+
+// ------------------------------ myStringFilter -----------------------------
+
+static bool filt(const char *c)
+{
+	if (*c < 'g' && 'a' < *c)
+	{
+		return true;
+	}
+	return false;
+}
+
+static void myStringFilterNormal()
+{
+	char *testName = "myStringFilterNormal";
+	printf("Running %s\n", testName);
+	MyString *str = myStringAlloc();
+	myStringSetFromCString(str, "abcz");
+	myStringFilter(str, filt);
+	char *newChars = myStringToCString(str);
+	int result = strcmp(newChars, "bc");
+	if (result != 0)
+	{
+		printf("Expected result : bc\n");
+		printf("Actual result : %s\n", newChars);
+		myStringFree(str);
+		exitBad(testName);
+	}
+	printf("PASS\n");
+	free(newChars);
+	newChars = NULL;
+	myStringFree(str);
+}
+// ------------------------------ myStringSetFromCString -----------------------------
+
+static void myStringSetFromCStringNormal()
+{
+	char *testName = "myStringSetFromCStringNormal";
+	printf("Running %s\n", testName);
+	MyString *str = myStringAlloc();
+	myStringSetFromCString(str, "abcde");
+	char *newChars = myStringToCString(str);
+	int result = strcmp(newChars, "abcde");
+	if (result != 0)
+	{
+		printf("Expected result : abcde\n");
+		printf("Actual result : %s\n", newChars);
+		exitBad(testName);
+	}
+	printf("PASS\n");
+	free(newChars);
+	newChars = NULL;
+	myStringFree(str);
+}
+
+static void myStringSetFromViewInner()
+{
+	char *testName = "myStringSetFromViewInner";
+	printf("Running %s\n", testName);
+	MyString *str = myStringAlloc();
+	myStringSetFromView(str, (MyStringView) {"hello world", 11});
+	// A view into the string itself overlaps the chars it's copied to.
+	MyStringView world = myStringGetView(str);
+	world._chars += 6;
+	world._length -= 6;
+	myStringSetFromView(str, world);
+	bool isSet = strcmp(myStringCStr(str), "world") == 0;
+	// A view into mapped chars is copied before the mapping is released.
+	char *path = "myStringSetFromViewTest.txt";
+	FILE *file = fopen(path, "w");
+	fputs("mapped text", file);
+	fclose(file);
+	MyString *mapped = myStringMapFile(path);
+	isSet = isSet && mapped != NULL;
+	if (isSet)
+	{
+		MyStringView text = myStringGetView(mapped);
+		text._chars += 7;
+		text._length -= 7;
+		isSet = myStringSetFromView(mapped, text) == MYSTRING_SUCCESS &&
+				strcmp(myStringCStr(mapped), "text") == 0;
+	}
+	isSet = isSet && myStringSetFromView(str, (MyStringView) {NULL, 0}) == MYSTRING_SUCCESS &&
+			myStringLen(str) == 0;
+	if (!isSet)
+	{
+		printf("Expected result : world, text and empty\n");
+		printf("Actual result : other\n");
+		exitBad(testName);
+	}
+	printf("PASS\n");
+	remove(path);
+	myStringFree(mapped);
+	myStringFree(str);
+}
+
+// ------------------------------ myStringSetFromInt -----------------------------
+static void myStringSetFromIntNormal()
+{
+	char *testName = "myStringSetFromIntNormal";
+	printf("Running %s\n", testName);
+	MyString *str = myStringAlloc();
+	myStringSetFromInt(str, 123456789);
+	char *chars = myStringToCString(str);
+	int result = strcmp(chars, "123456789");
+	if (result != 0)
+	{
+		printf("Expected result : 123456789\n");
+		printf("Actual result : %s\n", chars);
+		exitBad(testName);
+	}
+	free(chars);
+	myStringSetFromInt(str, -123456789);
+	chars = myStringToCString(str);
+	result = strcmp(chars, "-123456789");
+	if (result != 0)
+	{
+		printf("Expected result : -123456789\n");
+		printf("Actual result : %s\n", chars);
+		myStringFree(str);
+		exitBad(testName);
+	}
+	printf("PASS\n");
+	free(chars);
+	chars = NULL;
+	myStringFree(str);
+}
+
+// ------------------------------ myStringToInt -----------------------------
+static void myStringToIntNormal()
+{
+	char *testName = "myStringToIntNormal";
+	printf("Running %s\n", testName);
+	MyString *str = myStringAlloc();
+	myStringSetFromCString(str, "123456");
+	int num = myStringToInt(str);
+	if (num != 123456)
+	{
+		printf("Expected result : 123456\n");
+		printf("Actual result : %d\n", num);
+		exitBad(testName);
+	}
+	myStringSetFromCString(str, "-123456");
+	num = myStringToInt(str);
+	if (num != -123456)
+	{
+		printf("Expected result : -123456\n");
+		printf("Actual result : %d\n", num);
+		exitBad(testName);
+	}
+	printf("PASS\n");
+	myStringFree(str);
+}
+
+// ------------------------------ myStringToCString -----------------------------
+
+static void myStringToCStringNormal()
+{
+	char *testName = "myStringToCStringNormal";
+	printf("Running %s\n", testName);
+	MyString *str = myStringAlloc();
+	myStringSetFromCString(str, "Hey there");
+	char* cStr = myStringToCString(str);
+	int result = strcmp(cStr, "Hey there");
+	if (result != 0)
+	{
+		printf("Expected result : 0\n");
+		printf("Actual result : %d\n", result);
+		exitBad(testName);
+	}
+	printf("PASS\n");
+	free(cStr);
+	cStr = NULL;
+	myStringFree(str);
+}
+
+// ------------------------------ myStringCat -----------------------------
+
+static void myStringCatNormal()
+{
+	char *testName = "myStringCatNormal";
+	printf("Running %s\n", testName);
+	MyString *dest = myStringAlloc();
+	myStringSetFromCString(dest, "Hey there");
+	MyString *src = myStringAlloc();
+	myStringSetFromCString(src, " Delilah don't you worry about the distance");
+	int result = myStringCat(dest, src);
+	if (result != 0)
+	{
+		printf("Expected result : 0\n");
+		printf("Actual result : %d\n", result);
+		exitBad(testName);
+	}
+	printf("PASS\n");
+
+	myStringFree(dest);
+	myStringFree(src);
+}
+
+// ------------------------------ myStringCatTo -----------------------------
+
+static void myStringCatToNormal()
+{
+	char *testName = "myStringCatToNormal";
+	printf("Running %s\n", testName);
+	MyString *str1 = myStringAlloc();
+	myStringSetFromCString(str1, "Hey there");
+	MyString *str2 = myStringAlloc();
+	myStringSetFromCString(str2, " Delilah don't you worry about the distance");
+	MyString *str3 = myStringAlloc();
+	int result = myStringCatTo(str1, str2, str3);
+	if (result != 0)
+	{
+		printf("Expected result : 0\n");
+		printf("Actual result : %d\n", result);
+		exitBad(testName);
+	}
+	printf("PASS\n");
+
+	myStringFree(str1);
+	myStringFree(str2);
+	myStringFree(str3);
+}
+// ------------------------------ myStringCompare -----------------------------
+static void myStringCompareNormal()
+{
+	char *testName = "myStringCompare";
+	printf("Running %s\n", testName);
+	MyString *str1 = myStringAlloc();
+	myStringSetFromCString(str1, "abc");
+	MyString *str2 = myStringAlloc();
+	myStringSetFromCString(str2, "abcd");
+	int result = myStringCompare(str1, str2);
+	if (result != STR2_BIGGER)
+	{
+		printf("Expected result : -1\n");
+		printf("Actual result : %d\n", result);
+		exitBad(testName);
+	}
+	myStringSetFromCString(str2, "ab");
+	result = myStringCompare(str1, str2);
+	if (result != STR1_BIGGER)
+	{
+		printf("Expected result : 1\n");
+		printf("Actual result : %d\n", result);
+		exitBad(testName);
+	}
+	myStringSetFromCString(str2, "abc");
+	result = myStringCompare(str1, str2);
+	if (result != EQUAL_STRINGS)
+	{
+		printf("Expected result : 0\n");
+		printf("Actual result : %d\n", result);
+		exitBad(testName);
+	}
+	printf("PASS\n");
+	myStringFree(str1);
+	myStringFree(str2);
+}
+// ------------------------------ myStringCustomCompare -----------------------------
+
+static void myStringCustomCompareNormal()
+{
+	char *testName = "myStringCustomCompareNormal";
+	printf("Running %s\n", testName);
+	MyString *str1 = myStringAlloc();
+	myStringSetFromCString(str1, "abc");
+	MyString *str2 = myStringAlloc();
+	myStringSetFromCString(str2, "abcd");
+	int result = myStringCustomCompare(str1, str2, reverseMyStringCompare);
+	if (result != STR1_BIGGER)
+	{
+		printf("Expected result : 1\n");
+		printf("Actual result : %d\n", result);
+		exitBad(testName);
+	}
+	myStringSetFromCString(str2, "ab");
+	result = myStringCustomCompare(str1, str2, reverseMyStringCompare);
+	if (result != STR2_BIGGER)
+	{
+		printf("Expected result : -1\n");
+		printf("Actual result : %d\n", result);
+		exitBad(testName);
+	}
+	myStringSetFromCString(str2, "abc");
+	result = myStringCustomCompare(str1, str2, reverseMyStringCompare);
+	if (result != EQUAL_STRINGS)
+	{
+		printf("Expected result : 0\n");
+		printf("Actual result : %d\n", result);
+		exitBad(testName);
+	}
+	printf("PASS\n");
+	myStringFree(str1);
+	myStringFree(str2);
+}
+// ------------------------------ myStringEqual -----------------------------
+
+static void myStringEqualNormal()
+{
+	char *testName = "myStringEqualNormal";
+	printf("Running %s\n", testName);
+	MyString *str1 = myStringAlloc();
+	myStringSetFromCString(str1, "abc");
+	MyString *str2 = myStringAlloc();
+	myStringSetFromCString(str2, "abcd");
+	int result = myStringEqual(str1, str2);
+	if (result != 0)
+	{
+		printf("Expected result : 0\n");
+		printf("Actual result : %d\n", result);
+		exitBad(testName);
+	}
+	myStringSetFromCString(str2, "ab");
+	result = myStringEqual(str1, str2);
+	if (result != 0)
+	{
+		printf("Expected result : 0\n");
+		printf("Actual result : %d\n", result);
+		exitBad(testName);
+	}
+	myStringSetFromCString(str2, "abc");
+	result = myStringEqual(str1, str2);
+	if (result != 1)
+	{
+		printf("Expected result : 1\n");
+		printf("Actual result : %d\n", result);
+		exitBad(testName);
+	}
+	printf("PASS\n");
+	myStringFree(str1);
+	myStringFree(str2);
+}
+
+// ------------------------------ myStringCustomEqual -----------------------------
+
+static void myStringCustomEqualNormal()
+{
+	char *testName = "myStringCustomEqualNormal";
+	printf("Running %s\n", testName);
+	MyString *str1 = myStringAlloc();
+	myStringSetFromCString(str1, "abc");
+	MyString *str2 = myStringAlloc();
+	myStringSetFromCString(str2, "abcd");
+	int result = myStringCustomEqual(str1, str2, reverseMyStringCompare);
+	if (result != 0)
+	{
+		printf("Expected result : 0\n");
+		printf("Actual result : %d\n", result);
+		exitBad(testName);
+	}
+	myStringSetFromCString(str2, "ab");
+	result = myStringCustomEqual(str1, str2, reverseMyStringCompare);
+	if (result != 0)
+	{
+		printf("Expected result : 0\n");
+		printf("Actual result : %d\n", result);
+		exitBad(testName);
+	}
+	myStringSetFromCString(str2, "abc");
+	result = myStringCustomEqual(str1, str2, reverseMyStringCompare);
+	if (result != 1)
+	{
+		printf("Expected result : 1\n");
+		printf("Actual result : %d\n", result);
+		exitBad(testName);
+	}
+	printf("PASS\n");
+	myStringFree(str1);
+	myStringFree(str2);
+}
+// ------------------------------ myStringMemUsage -----------------------------
+
+static void myStringMemUsageNormal()
 {
-	if (str == NULL || filt == NULL)
+	char *testName = "myStringMemUsageNormal";
+	printf("Running %s\n", testName);
+	MyString *str = myStringAlloc();
+	myStringSetFromCString(str, "abcde");
+	unsigned long result = myStringMemUsage(str);
+	// The chars and their '\0' fit the smallest block.
+	if (result != sizeof(MyString) + BLOCK_CACHE_MIN_SIZE)
 	{
-		return MYSTRING_ERROR;
+		printf("Expected result : %lu\n", (unsigned long) sizeof(MyString) + BLOCK_CACHE_MIN_SIZE);
+		printf("Actual result : %lu\n", result);
+		exitBad(testName);
 	}
-	if (str -> _length == EMPTY_STRING_LENGTH)
+	printf("PASS\n");
+	myStringFree(str);
+}
+
+// ------------------------------ myStringLen -----------------------------
+
+static void myStringLenNormal()
+{
+	char *testName = "myStringLenNormal";
+	printf("Running %s\n", testName);
+	MyString *str = myStringAlloc();
+	myStringSetFromCString(str, "abcde");
+	unsigned long length = myStringLen(str);
+	if (length != 5)
 	{
-		return MYSTRING_SUCCESS;
+		printf("Expected result : 5\n");
+		printf("Actual result : %lu\n", length);
+		exitBad(testName);
 	}
-    unsigned long filteredStringLength = getFilteredStringLength(str -> _chars, filt);
-    // Allocate a new block of memory heap for the filtering procedure.
-    MyString *filteredString = myStringAlloc();
-    // Allocate size of the filtered string length in the heap.
-    MyStringRetVal adjustLengthRetVal = adjustMyStringLength(&filteredString -> _chars,
-    		&filteredString -> _length, filteredStringLength);
-    if (adjustLengthRetVal == MYSTRING_ERROR)
-    {
-        return MYSTRING_ERROR;
-    }
-    // Create the new filtered string.
-    createFilteredString(filteredString -> _chars, str -> _chars, filt);
-    // Update the original string to be the filtered one.
-    str -> _chars = filteredString ->_chars;
-    str -> _length = filteredString ->_length;
-    myStringFree(filteredString);
-    return MYSTRING_SUCCESS;
+	printf("PASS\n");
+	myStringFree(str);
 }
 
+// ------------------------------ myStringCollation -----------------------------
 
 /**
- * @brief Sets the value of str to the value of the given C string.
- * 			The given C string must be terminated by the null character.
- * 			Checking will not use a string without the null character.
- * @param str the MyString to set.
- * @param cString the C string to set from.
- * RETURN VALUE:
- *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
- *
- *   Complexity: O(n) since we allocate memory of the length of the
- *   cString.
+ * @brief Create a case insensitive collation which ignores '-', where lower case
+ * chars are bigger than upper case chars at the second level.
  */
-MyStringRetVal myStringSetFromCString(MyString *str, const char * cString)
+static MyStringCollation* caseInsensitiveCollationAlloc()
 {
-	if (str == NULL || cString == NULL)
+	unsigned char primary[MYSTRING_COLLATION_TABLE_SIZE];
+	unsigned char secondary[MYSTRING_COLLATION_TABLE_SIZE];
+	int c = 0;
+	for (c = 0; c < MYSTRING_COLLATION_TABLE_SIZE; c++)
 	{
-		return MYSTRING_ERROR;
+		primary[c] = (unsigned char) ((c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c);
+		secondary[c] = (unsigned char) c;
 	}
-    unsigned long cStringLength = getCStringLength(cString);
-    // Checking that the cString is legal.
-    if (*(cString + cStringLength) != END_OF_C_STRING)
-    {
-    	return MYSTRING_ERROR;
-    }
-
-    // Empty string case.
-    if (cStringLength == 0)
-    {
-        if( emptyStringAlloc(str) == NULL)
-        {
-        	return MYSTRING_ERROR;
-        }
-    }
-    // Change the size of the string to the size of the cString.
-    MyStringRetVal adjustLengthRetVal = adjustMyStringLength(&str -> _chars,
-    		&str -> _length, cStringLength);
-    if (adjustLengthRetVal == MYSTRING_ERROR)
-    {
-        return MYSTRING_ERROR;
-    }
-    memcpy(str -> _chars, cString, cStringLength);
-    return MYSTRING_SUCCESS;
+	primary['-'] = MYSTRING_COLLATION_IGNORABLE;
+	secondary['-'] = MYSTRING_COLLATION_IGNORABLE;
+	const unsigned char *weights[2] = {primary, secondary};
+	return myStringCollationAlloc(weights, 2);
 }
 
+static void myStringCollationCompareNormal()
+{
+	char *testName = "myStringCollationCompareNormal";
+	printf("Running %s\n", testName);
+	MyStringCollation *collation = caseInsensitiveCollationAlloc();
+	MyString *str1 = myStringAlloc();
+	MyString *str2 = myStringAlloc();
+	myStringSetFromCString(str1, "abc");
+	myStringSetFromCString(str2, "ABC");
+	int result = myStringCollationCompare(str1, str2, collation);
+	if (result != STR1_BIGGER)
+	{
+		printf("Expected result : 1\n");
+		printf("Actual result : %d\n", result);
+		exitBad(testName);
+	}
+	myStringSetFromCString(str2, "ABD");
+	result = myStringCollationCompare(str1, str2, collation);
+	if (result != STR2_BIGGER)
+	{
+		printf("Expected result : -1\n");
+		printf("Actual result : %d\n", result);
+		exitBad(testName);
+	}
+	myStringSetFromCString(str2, "a-b-c");
+	result = myStringCollationEqual(str1, str2, collation);
+	if (result != TRUE)
+	{
+		printf("Expected result : 1\n");
+		printf("Actual result : %d\n", result);
+		exitBad(testName);
+	}
+	printf("PASS\n");
+	myStringCollationFree(collation);
+	myStringFree(str1);
+	myStringFree(str2);
+}
 
-/**
- * @brief Sets the value of str to the value of the integer n.
- *	(i.e. if n=7 than str should contain �7�)
- * 	You are not allowed to use itoa (or a similar functions) here but
- * 	 must code your own conversion function.
- * @param str the MyString to set.
- * @param n the int to set from.
- * RETURN VALUE:
- *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
- *
- *   Complexity: O(k) where k is the number of digits since we allocate
- *   a block of the length of the number.
- */
-MyStringRetVal myStringSetFromInt(MyString *str, int n)
+static void myStringCollationSortFourSort()
 {
-	if (str == NULL)
+	char *testName = "myStringCollationSortFourSort";
+	printf("Running %s\n", testName);
+	MyStringCollation *collation = caseInsensitiveCollationAlloc();
+	MyString *arr[4];
+	const char *values[4] = {"bbc", "ABD", "abc", "Abc"};
+	const char *expected[4] = {"Abc", "abc", "ABD", "bbc"};
+	int i = 0;
+	for (i = 0; i < 4; i++)
 	{
-		return MYSTRING_ERROR;
+		arr[i] = myStringAlloc();
+		myStringSetFromCString(arr[i], values[i]);
 	}
-    unsigned long numOfDigits = (unsigned long) getNumOfDigits(n);
-    // Indicator for the success of the action.
-    int setIndicator = 0;
-    // Change the size of the string to the number of digits.
-    MyStringRetVal adjustLengthRetVal = adjustMyStringLength(&str -> _chars,
-    		                                                 &str -> _length, numOfDigits);
-    if (adjustLengthRetVal == MYSTRING_ERROR)
-    {
-        return MYSTRING_ERROR;
-    }
-    // Attempt to write the number to the string.
-    setIndicator = sprintf(str -> _chars, "%d", n);
-    if (setIndicator < 0)
-    {
-        return MYSTRING_ERROR;
-    }
-    return MYSTRING_SUCCESS;
+	MyStringRetVal retVal = myStringCollationSort(arr, 4, collation);
+	for (i = 0; i < 4; i++)
+	{
+		MyString *expectedStr = myStringAlloc();
+		myStringSetFromCString(expectedStr, expected[i]);
+		if (retVal != MYSTRING_SUCCESS || myStringEqual(arr[i], expectedStr) != TRUE)
+		{
+			printf("Expected result : Abc abc ABD bbc\n");
+			printf("Actual result : mismatch at %d\n", i);
+			exitBad(testName);
+		}
+		myStringFree(expectedStr);
+	}
+	printf("PASS\n");
+	for (i = 0; i < 4; i++)
+	{
+		myStringFree(arr[i]);
+	}
+	myStringCollationFree(collation);
 }
 
+// ------------------------------ myStringSortByKey -----------------------------
+
+static unsigned long long lengthKey(const MyString *str)
+{
+	return myStringLen(str);
+}
 
 /**
- * @brief Returns the value of str as an integer.
- * 	If str cannot be parsed as an integer,
- * 	the return value should be MYSTR_ERROR_CODE
- * 	NOTE: positive and negative integers should be supported.
- * @param str the MyString
- * @return an integer
- *
- *  Complexity: O(k) where k is the length of the number since we iterate
- *   over the digits of the number.
+ * @brief Set key to the reverse of str.
  */
-int myStringToInt(const MyString *str)
+static MyStringRetVal reverseKey(const MyString *str, MyString *key)
 {
-	if (str == NULL)
+	char *chars = myStringToCString(str);
+	if (chars == NULL)
 	{
 		return MYSTRING_ERROR;
 	}
-    int value = 0;
-    int numberOfDigits = 0;
-    // Attempt to parse the string as an integer.
-    numberOfDigits = sscanf(str -> _chars, "%d", &value);
-    printf("%d\n", numberOfDigits);
-    if(numberOfDigits <= 0)
-    {
-        return MYSTR_ERROR_CODE;
-    }
-    return value;
+	unsigned long length = myStringLen(str);
+	unsigned long i = 0;
+	for (i = 0; i < length / 2; i++)
+	{
+		char temp = chars[i];
+		chars[i] = chars[length - 1 - i];
+		chars[length - 1 - i] = temp;
+	}
+	MyStringRetVal retVal = myStringSetFromCString(key, chars);
+	free(chars);
+	return retVal;
 }
 
-
 /**
- * @brief Returns the value of str as a C string, terminated with the
- * 	null character. It is the caller's responsibility to free the returned
- * 	string by calling free().
- * @param str the MyString
- * RETURN VALUE:
- *  @return the new string, or NULL if the allocation failed.
- *
- *   Complexity: O(n) since we allocate a new block of memory as the length
- *   of the string.
+ * @brief Check that arr holds the C strings of expected, in order.
  */
-char * myStringToCString(const MyString *str)
+static bool myStringArrayEquals(MyString *arr[], const char *expected[], int len)
 {
-	if (str == NULL)
+	int i = 0;
+	for (i = 0; i < len; i++)
 	{
-		return NULL;
+		char *cStr = myStringToCString(arr[i]);
+		int result = strcmp(cStr, expected[i]);
+		free(cStr);
+		if (result != 0)
+		{
+			return false;
+		}
 	}
-	// Get the length of the string before change.
-    unsigned long oldLength = myStringLen(str);
-    // Allocate memory for the string along with '\0'.
-    char *newString = (char *) malloc(oldLength + 1);
-    if (newString == NULL)
-    {
-        return NULL;
-    }
-    // Create the new CString.
-    memcpy(newString, str -> _chars, oldLength);
-    newString[oldLength] = END_OF_C_STRING;
-    return newString;
+	return true;
 }
 
-
-/**
- * @brief Appends a copy of the source MyString src to the destination MyString dst.
- * @param dest the destination
- * @param src the MyString to append
- * RETURN VALUE:
- *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
- *   Complexity: O(m) where m  is the size of src
- *   since we cat the src string and the dest is already allocated.
- *   n bytes as chars.
- */
-MyStringRetVal myStringCat(MyString * dest, const MyString * src)
+static void myStringSortByKeyStable()
 {
-	if (dest == NULL || src == NULL)
+	char *testName = "myStringSortByKeyStable";
+	printf("Running %s\n", testName);
+	const char *values[5] = {"ccc", "b", "aaa", "dd", "a"};
+	const char *expected[5] = {"b", "a", "dd", "ccc", "aaa"};
+	MyString *arr[5];
+	int i = 0;
+	for (i = 0; i < 5; i++)
 	{
-		return MYSTRING_ERROR;
+		arr[i] = myStringAlloc();
+		myStringSetFromCString(arr[i], values[i]);
 	}
-	// Empty string, nothing to cat.
-	if (src -> _length == EMPTY_STRING_LENGTH)
+	MyStringRetVal retVal = myStringSortByKey(arr, 5, lengthKey);
+	if (retVal != MYSTRING_SUCCESS || !myStringArrayEquals(arr, expected, 5))
 	{
-		return MYSTRING_SUCCESS;
+		printf("Expected result : b a dd ccc aaa\n");
+		printf("Actual result : different order\n");
+		exitBad(testName);
 	}
-    unsigned long srcLength = myStringLen(src);
-    unsigned long destLength = myStringLen(dest);
-    // Allocate memory of the summed length of the strings.
-    MyStringRetVal adjustLengthRetVal = adjustMyStringLength(&dest -> _chars,
-    														 &dest -> _length,
-    														 srcLength + destLength);
-    if (adjustLengthRetVal == MYSTRING_ERROR)
-    {
-        return MYSTRING_ERROR;
-    }
-    // Cat the strings.
-    memcpy(dest -> _chars + destLength, src -> _chars, srcLength);
-    return MYSTRING_SUCCESS;
+	printf("PASS\n");
+	for (i = 0; i < 5; i++)
+	{
+		myStringFree(arr[i]);
+	}
+}
 
+static void myStringSortByStringKeyReverse()
+{
+	char *testName = "myStringSortByStringKeyReverse";
+	printf("Running %s\n", testName);
+	// The first three share a long suffix so their keys share the radix prefix.
+	const char *values[5] = {"b_common_suffix", "xyz", "a_common_suffix", "", "c_common_suffix"};
+	const char *expected[5] = {"", "a_common_suffix", "b_common_suffix", "c_common_suffix", "xyz"};
+	MyString *arr[5];
+	int i = 0;
+	for (i = 0; i < 5; i++)
+	{
+		arr[i] = myStringAlloc();
+		myStringSetFromCString(arr[i], values[i]);
+	}
+	MyStringRetVal retVal = myStringSortByStringKey(arr, 5, reverseKey);
+	if (retVal != MYSTRING_SUCCESS || !myStringArrayEquals(arr, expected, 5))
+	{
+		printf("Expected result : by reversed strings\n");
+		printf("Actual result : different order\n");
+		exitBad(testName);
+	}
+	printf("PASS\n");
+	for (i = 0; i < 5; i++)
+	{
+		myStringFree(arr[i]);
+	}
 }
 
-/**
- * @brief Sets result to be the concatenation of str1 and str2.
- * 	result should be initially allocated by the caller.
- * 	result shouldn't be the same struct as str1 or str2.
- * @param str1
- * @param str2
- * @param result
- * RETURN VALUE:
- *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
- *
- *   Complexity: O(n+m) since we copy both of the strings to a new location
- *   so we iterate over the sum of their lengths.
- */
-MyStringRetVal myStringCatTo(const MyString *str1, const MyString *str2, MyString *result)
+// ------------------------------ myStringValidateUTF8 -----------------------------
+
+static void myStringValidateUTF8Normal()
 {
-	if (str1 == NULL || str2 == NULL || result == NULL)
+	char *testName = "myStringValidateUTF8Normal";
+	printf("Running %s\n", testName);
+	const char *valid[3] = {"plain ascii which is longer than a block of sixteen",
+							"caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80 and some more ascii",
+							""};
+	// Overlong, surrogate, above U+10FFFF, truncated and a stray continuation char.
+	const char *invalid[5] = {"ab\xc0\x80", "\xed\xa0\x80", "\xf4\x90\x80\x80",
+							  "long enough ascii prefix \xe2\x82", "\x80"};
+	MyString *str = myStringAlloc();
+	int i = 0;
+	for (i = 0; i < 3; i++)
 	{
-		return MYSTRING_ERROR;
+		myStringSetFromCString(str, valid[i]);
+		int result = myStringValidateUTF8(str);
+		if (result != TRUE)
+		{
+			printf("Expected result : 1 for valid string %d\n", i);
+			printf("Actual result : %d\n", result);
+			exitBad(testName);
+		}
 	}
-	// Empty string cat case.
-	if (str1 -> _length == EMPTY_STRING_LENGTH && str2 -> _length == EMPTY_STRING_LENGTH)
+	for (i = 0; i < 5; i++)
 	{
-		if(emptyStringAlloc(result) != NULL)
+		myStringSetFromCString(str, invalid[i]);
+		int result = myStringValidateUTF8(str);
+		if (result != FALSE)
 		{
-			return MYSTRING_SUCCESS;
+			printf("Expected result : 0 for invalid string %d\n", i);
+			printf("Actual result : %d\n", result);
+			exitBad(testName);
 		}
-		return MYSTRING_ERROR;
 	}
-    unsigned long strLength1 = myStringLen(str1);
-    unsigned long strLength2 = myStringLen(str2);
-    // Allocate memory of the summed length of the strings.
-    MyStringRetVal adjustLengthRetVal = adjustMyStringLength(&result -> _chars,
-    														 &result -> _length,
-    														 strLength1 + strLength2);
-    if (adjustLengthRetVal == MYSTRING_ERROR)
-    {
-        return MYSTRING_ERROR;
-    }
-    // Create the first string in the new memory address.
-    memcpy(result -> _chars, str1 -> _chars, strLength1);
-    // Cat the second string to the first string in the new address.
-    memcpy(result -> _chars + strLength1, str2 -> _chars, strLength2);
-    return MYSTRING_SUCCESS;
+	printf("PASS\n");
+	myStringFree(str);
 }
 
-/**
- * @brief Compare str1 and str2.
- * @param str1
- * @param str2
- *
- * RETURN VALUE:
- * @return an integral value indicating the relationship between the strings:
- * 	A zero value indicates that the strings are equal.
- * 	A value greater than zero indicates that the first character that does not match
- * 	 has a greater ASCII value in str1 than in str2;
- * 	And a value less than zero indicates the opposite.
- * 	If strings cannot be compared, the return value should be MYSTR_ERROR_CODE
- *
- * 	 Complexity: O(n) where n is the length of the shorter string since at the worst
- * 	 case we will reach the end of the shorter string and then the longer is bigger.
- *
- */
-int myStringCompare(const MyString *str1, const MyString *str2)
-{
-    if (str1 == NULL || str2 == NULL)
-    {
-        return MYSTR_ERROR_CODE;
-    }
+// ------------------------------ myStringCodePointLen -----------------------------
 
-    unsigned long strLength1 = myStringLen(str1);
-    unsigned long strLength2 = myStringLen(str2);
-    // str1 has a greater ascii value.
-    if (strLength1 > strLength2)
-    {
-        int equalUntilLength2 = memcmp(str1 -> _chars, str2 -> _chars, strLength2);
-        return equalUntilLength2 >= EQUAL_STRINGS ? STR1_BIGGER : STR2_BIGGER;
-    }
-      // str2 has a greater ascii value.
-    else if (strLength1 < strLength2)
-    {
-        int equalUntilLength1 = memcmp(str1 -> _chars, str2 -> _chars, strLength1);
-        return equalUntilLength1 <= EQUAL_STRINGS ? STR2_BIGGER : STR1_BIGGER;
-    }
-        // The strings have equal lengths.
-    else
-    {
-        return memcmp(str1 -> _chars, str2 -> _chars, strLength1);
-    }
+static void myStringCodePointLenNormal()
+{
+	char *testName = "myStringCodePointLenNormal";
+	printf("Running %s\n", testName);
+	MyString *str = myStringAlloc();
+	// 4 + 1 + 5 + 1 + 1 + 1 + 1 + 16 code points.
+	myStringSetFromCString(str, "caf\xc3\xa9 cr\xc3\xa8me \xe2\x82\xac \xf0\x9f\x98\x80 more ascii here");
+	unsigned long length = myStringCodePointLen(str);
+	if (length != 30)
+	{
+		printf("Expected result : 30\n");
+		printf("Actual result : %lu\n", length);
+		exitBad(testName);
+	}
+	printf("PASS\n");
+	myStringFree(str);
 }
 
+// ------------------------------ myStringCodePointSlice -----------------------------
 
-/**
- * @brief Compares str1 and str2.
- * @param str1
- * @param str2
- * @param comparator
- * RETURN VALUE:
- * @return an integral value indicating the relationship between the strings:
- * 	A zero value indicates that the strings are equal according to the
- * 	 custom comparator (3rd parameter).
- * 	A value greater than zero indicates that the first
- * 	 MyString is bigger according to the comparator.
- * 	And a value less than zero indicates the opposite.
- * 	If strings cannot be compared, the return value should be MYSTR_ERROR_CODE
- *
- * 	 Complexity: O(n) where n is the length of the shorter string since at the worst
- * 	 case we will reach the end of the shorter string and then the longer is bigger.
- */
-
-int myStringCustomCompare(const MyString *str1, const MyString *str2,
-						  int (*comparator) (const MyString *, const MyString *))
+static void myStringCodePointSliceNormal()
 {
-    if (str1 == NULL || str2 == NULL || comparator == NULL)
-    {
-        return MYSTR_ERROR_CODE;
-    }
-    // The length of the strings.
-    unsigned long strLength1 = myStringLen(str1);
-    unsigned long strLength2 = myStringLen(str2);
-    unsigned long i = 0;
-    // The substrings we iterate are in the same length.
-    while (i < strLength1 && i < strLength2)
-    {
-        // The first char is bigger than the second char compared by the comparator.
-        if (comparator(str1, str2) > EQUAL_STRINGS)
-        {
-            return STR1_BIGGER;
-        }
-        // The second char is bigger than the first char compared by the comparator.
-        if (comparator(str1, str2) < EQUAL_STRINGS)
-        {
-            return STR2_BIGGER;
-        }
-        i++;
-    }
-    // The strings are of different lengths and the common substrings are equal.
-    if (strLength1 > strLength2)
-    {
-        return STR1_BIGGER;
-    }
-    if (strLength1 < strLength2)
-    {
-        return STR2_BIGGER;
-    }
-    // The strings are truly identical.
-    return EQUAL_STRINGS;
+	char *testName = "myStringCodePointSliceNormal";
+	printf("Running %s\n", testName);
+	MyString *str = myStringAlloc();
+	myStringSetFromCString(str, "caf\xc3\xa9 cr\xc3\xa8me \xe2\x82\xac \xf0\x9f\x98\x80 more ascii here");
+	MyStringView view;
+	MyStringRetVal retVal = myStringCodePointSlice(str, 3, 7, &view);
+	if (retVal != MYSTRING_SUCCESS || view._length != 9 ||
+		memcmp(view._chars, "\xc3\xa9 cr\xc3\xa8me", 9) != 0)
+	{
+		printf("Expected result : \xc3\xa9 cr\xc3\xa8me\n");
+		printf("Actual result : %.*s\n", (int) view._length, view._chars);
+		exitBad(testName);
+	}
+	retVal = myStringCodePointSlice(str, 13, 100, &view);
+	if (retVal != MYSTRING_SUCCESS || view._length != 20 ||
+		memcmp(view._chars, "\xf0\x9f\x98\x80 more ascii here", 20) != 0)
+	{
+		printf("Expected result : \xf0\x9f\x98\x80 more ascii here\n");
+		printf("Actual result : %.*s\n", (int) view._length, view._chars);
+		exitBad(testName);
+	}
+	retVal = myStringCodePointSlice(str, 30, 1, &view);
+	if (retVal != MYSTRING_SUCCESS || view._length != 0)
+	{
+		printf("Expected result : empty view\n");
+		printf("Actual result : %lu chars\n", view._length);
+		exitBad(testName);
+	}
+	retVal = myStringCodePointSlice(str, 31, 1, &view);
+	if (retVal != MYSTRING_ERROR)
+	{
+		printf("Expected result : -1\n");
+		printf("Actual result : %d\n", retVal);
+		exitBad(testName);
+	}
+	printf("PASS\n");
+	myStringFree(str);
 }
 
-
+// ------------------------------ myStringAppendf -----------------------------
 
 /**
- * @brief Check if str1 is equal to str2.
- * @param str1
- * @param str2
- *
- * RETURN VALUE:
- * @return an integral value indicating the equality of the strings (logical equality -
- *  that they are composed of the very same characters):
- * 	A zero value indicates that the strings are not equal.
- * 	A greater than zero value indicates that the strings are equal.
- * 	If strings cannot be compared, the return value should be MYSTR_ERROR_CODE
- *
- * 	 Complexity: O(n) where n is the length of the shorter string since at the worst
- * 	 case we will reach the end of the shorter string and then we will know if the strings
- * 	 are equal or not.
- *
-  */
-int myStringEqual(const MyString *str1, const MyString *str2)
+ * @brief Check that str holds exactly the chars of expected.
+ */
+static bool myStringEqualsCString(const MyString *str, const char *expected)
 {
-    // The strings cannot be compared.
-    if (str1 == NULL || str2 == NULL)
-    {
-        return MYSTR_ERROR_CODE;
-    }
-    // Compare the strings to see if they're equal.
-    int areEqual = myStringCompare(str1, str2);
-    return areEqual == EQUAL_STRINGS ? TRUE : FALSE;
+	MyStringView view = myStringGetView(str);
+	return view._length == strlen(expected) && memcmp(view._chars, expected, view._length) == 0;
 }
 
-/**
- * @brief Check if str1 is equal to str2.
- * @param str1
- * @param str2
- * @param comparator
- *
- * RETURN VALUE:
- * @return an integral value indicating the equality of the strings using a
- * custom comparator (3rd parameter):
- * 	A zero value indicates that the strings are not equal.
- * 	A greater than zero value indicates that the strings are equal.
- * 	If string cannot be compared, the return value should be MYSTR_ERROR_CODE
- *
- * 	 Complexity: O(n) where n is the length of the shorter string since at the worst
- * 	 case we will reach the end of the shorter string and then we will know if the strings
- * 	 are equal or not.
- */
-int myStringCustomEqual(const MyString *str1, const MyString *str2,
-						int (*comparator) (const MyString *, const MyString *))
+static void myStringAppendfNormal()
 {
-    // The strings cannot be compared.
-    if (str1 == NULL || str2 == NULL)
-    {
-        return MYSTR_ERROR_CODE;
-    }
-    // Compare the strings to see if they're equal by the comparator.
-    int areEqual = myStringCustomCompare(str1, str2, comparator);
-    return areEqual == EQUAL_STRINGS ? TRUE : FALSE;
+	char *testName = "myStringAppendfNormal";
+	printf("Running %s\n", testName);
+	MyString *str = myStringAlloc();
+	myStringSetFromCString(str, "row");
+	// Long enough to outgrow the capacity and format a second time.
+	MyStringRetVal retVal = myStringAppendf(str, " %d: %s|%5.2f", 42, "a rather long field value", 3.14159);
+	if (retVal != MYSTRING_SUCCESS ||
+		!myStringEqualsCString(str, "row 42: a rather long field value| 3.14"))
+	{
+		printf("Expected result : row 42: a rather long field value| 3.14\n");
+		printf("Actual result : %.*s\n", (int) myStringLen(str), myStringGetView(str)._chars);
+		exitBad(testName);
+	}
+	retVal = myStringAppendf(str, "%c", '!');
+	if (retVal != MYSTRING_SUCCESS ||
+		!myStringEqualsCString(str, "row 42: a rather long field value| 3.14!"))
+	{
+		printf("Expected result : row 42: a rather long field value| 3.14!\n");
+		printf("Actual result : %.*s\n", (int) myStringLen(str), myStringGetView(str)._chars);
+		exitBad(testName);
+	}
+	retVal = myStringSetf(str, "%s=%x", "key", 255);
+	if (retVal != MYSTRING_SUCCESS || !myStringEqualsCString(str, "key=ff"))
+	{
+		printf("Expected result : key=ff\n");
+		printf("Actual result : %.*s\n", (int) myStringLen(str), myStringGetView(str)._chars);
+		exitBad(testName);
+	}
+	printf("PASS\n");
+	myStringFree(str);
 }
 
-
-/**
- * @return the amount of memory (all the memory that used by the MyString object
- *  itself and its allocations), in bytes, allocated to str1.
- *
- *  Complexity: O(1) because the length is kept in the structure .
- */
-unsigned long myStringMemUsage(const MyString *str1)
+static void myStringAppendTypedNormal()
 {
-	if (str1 == NULL)
+	char *testName = "myStringAppendTypedNormal";
+	printf("Running %s\n", testName);
+	MyString *str = myStringAlloc();
+	myStringAppendInt(str, -9223372036854775807LL - 1);
+	myStringAppendInt(str, 0);
+	myStringAppendDouble(str, 0.5, 3);
+	// Append the string to itself through a view.
+	myStringAppendView(str, myStringGetView(str));
+	const char *expected = "-922337203685477580800.5-922337203685477580800.5";
+	if (!myStringEqualsCString(str, expected))
 	{
-		return NO_MEMORY_USAGE;
+		printf("Expected result : %s\n", expected);
+		printf("Actual result : %.*s\n", (int) myStringLen(str), myStringGetView(str)._chars);
+		exitBad(testName);
 	}
-	return (sizeof(MyString) + str1 -> _length);
+	printf("PASS\n");
+	myStringFree(str);
 }
 
-/**
- * @return the length of the string in str1.
- *
- * Complexity: O(1) because the length is kept in the structure .
- */
-unsigned long myStringLen(const MyString *str1)
+// ------------------------------ myStringJoin -----------------------------
+
+static void myStringConcatManyNormal()
 {
-	if (str1 == NULL)
+	char *testName = "myStringConcatManyNormal";
+	printf("Running %s\n", testName);
+	MyString *dst = myStringAlloc();
+	MyString *str1 = myStringAlloc();
+	MyString *str2 = myStringAlloc();
+	myStringSetFromCString(dst, "old");
+	myStringSetFromCString(str1, "Hey ");
+	myStringSetFromCString(str2, "there");
+	const MyString *parts[4] = {str1, str2, dst, str2};
+	// dst is one of the parts, so its old value must survive until copied.
+	MyStringRetVal retVal = myStringConcatMany(dst, parts, 4);
+	if (retVal != MYSTRING_SUCCESS || !myStringEqualsCString(dst, "Hey thereoldthere"))
 	{
-		return MYSTRING_ERROR;
+		printf("Expected result : Hey thereoldthere\n");
+		printf("Actual result : %.*s\n", (int) myStringLen(dst), myStringGetView(dst)._chars);
+		exitBad(testName);
 	}
-    return str1 -> _length;
+	retVal = myStringConcatMany(dst, parts, 0);
+	if (retVal != MYSTRING_SUCCESS || myStringLen(dst) != 0)
+	{
+		printf("Expected result : empty string\n");
+		printf("Actual result : %lu chars\n", myStringLen(dst));
+		exitBad(testName);
+	}
+	printf("PASS\n");
+	myStringFree(dst);
+	myStringFree(str1);
+	myStringFree(str2);
 }
 
-/**
- * Writes the content of str to stream. (like fputs())
- *
- * RETURNS:
- *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
- *
- *  Complexity: O(n) because we iterate over the C String until '\0'
- *  is reached - as done by fprintf.
- */
-MyStringRetVal myStringWrite(const MyString *str, FILE *stream)
+static void myStringJoinNormal()
 {
-    if (stream == NULL || str == NULL)
-    {
-        return MYSTRING_ERROR;
-    }
-    char * cStr = myStringToCString(str);
-    // Write to the file.
-    int writingIndicator = fprintf(stream, "%s", cStr);
-    // Checks if the writing process was successful.
-	if (writingIndicator < 0)
+	char *testName = "myStringJoinNormal";
+	printf("Running %s\n", testName);
+	MyString *dst = myStringAlloc();
+	MyString *sep = myStringAlloc();
+	MyString *fields[3];
+	const char *values[3] = {"id", "", "name"};
+	int i = 0;
+	for (i = 0; i < 3; i++)
+	{
+		fields[i] = myStringAlloc();
+		myStringSetFromCString(fields[i], values[i]);
+	}
+	myStringSetFromCString(sep, ",");
+	const MyString *parts[3] = {fields[0], fields[1], fields[2]};
+	MyStringRetVal retVal = myStringJoin(dst, parts, 3, sep);
+	if (retVal != MYSTRING_SUCCESS || !myStringEqualsCString(dst, "id,,name"))
 	{
-		return MYSTRING_ERROR;
+		printf("Expected result : id,,name\n");
+		printf("Actual result : %.*s\n", (int) myStringLen(dst), myStringGetView(dst)._chars);
+		exitBad(testName);
 	}
-	free(cStr);
-	cStr = NULL;
-	fclose(stream);
-    return MYSTRING_SUCCESS;
+	printf("PASS\n");
+	for (i = 0; i < 3; i++)
+	{
+		myStringFree(fields[i]);
+	}
+	myStringFree(sep);
+	myStringFree(dst);
 }
 
-/**
- * @brief sort an array of MyString pointers
- * @param arr
- * @param len
- * @param comparator custom comparator
- *
- * RETURN VALUE:none
- *
- *  Complexity: O(n^2) because quick sort performs this way at the worst case.
- *  On average we will acheive O(nlogn)
-  */
+// ------------------------------ myStringMove -----------------------------
 
-void myStringCustomSort(MyString *arr[], unsigned long len,
-						int (*comparator) (const void *, const void *))
+static void myStringMoveNormal()
 {
-	if (arr == NULL || comparator == NULL)
+	char *testName = "myStringMoveNormal";
+	printf("Running %s\n", testName);
+	MyString *src = myStringAlloc();
+	MyString *dst = myStringAlloc();
+	myStringSetFromCString(src, "moved value");
+	myStringSetFromCString(dst, "old value");
+	const char *srcChars = myStringGetView(src)._chars;
+	MyStringRetVal retVal = myStringMove(dst, src);
+	if (retVal != MYSTRING_SUCCESS || myStringGetView(dst)._chars != srcChars ||
+		!myStringEqualsCString(dst, "moved value") || myStringLen(src) != 0)
 	{
-		return;
+		printf("Expected result : the block of src moved to dst\n");
+		printf("Actual result : %.*s\n", (int) myStringLen(dst), myStringGetView(dst)._chars);
+		exitBad(testName);
 	}
-    qsort(arr, len, sizeof(MyString*), comparator);
+	// The emptied string is still a normal string.
+	myStringSetFromCString(src, "reused");
+	if (!myStringEqualsCString(src, "reused"))
+	{
+		printf("Expected result : reused\n");
+		printf("Actual result : %.*s\n", (int) myStringLen(src), myStringGetView(src)._chars);
+		exitBad(testName);
+	}
+	printf("PASS\n");
+	myStringFree(src);
+	myStringFree(dst);
 }
 
-/**
- * @brief sorts an array of MyString pointers according to the default comparison
- *  (like in myStringCompare)
- * @param arr
- * @param len
- *
- * RETURN VALUE: none
- *
- * *  Complexity: O(n^2) because quick sort performs this way at the worst case.
- *  On average we will acheive O(nlogn)
-  */
+static void myStringSwapNormal()
+{
+	char *testName = "myStringSwapNormal";
+	printf("Running %s\n", testName);
+	MyString *str1 = myStringAlloc();
+	MyString *str2 = myStringAlloc();
+	myStringSetFromCString(str1, "first");
+	myStringSetFromCString(str2, "second");
+	MyStringRetVal retVal = myStringSwap(str1, str2);
+	if (retVal != MYSTRING_SUCCESS || !myStringEqualsCString(str1, "second") ||
+		!myStringEqualsCString(str2, "first"))
+	{
+		printf("Expected result : second first\n");
+		printf("Actual result : %.*s %.*s\n", (int) myStringLen(str1), myStringGetView(str1)._chars,
+			   (int) myStringLen(str2), myStringGetView(str2)._chars);
+		exitBad(testName);
+	}
+	printf("PASS\n");
+	myStringFree(str1);
+	myStringFree(str2);
+}
 
-void myStringSort(MyString *arr[], unsigned long len)
+static void myStringDetachNormal()
 {
-	if (arr == NULL)
+	char *testName = "myStringDetachNormal";
+	printf("Running %s\n", testName);
+	MyString *str = myStringAlloc();
+	myStringSetFromCString(str, "detached");
+	unsigned long length = 0;
+	char *chars = myStringDetach(str, &length);
+	if (chars == NULL || length != 8 || memcmp(chars, "detached", 8) != 0 || myStringLen(str) != 0)
 	{
-		return;
+		printf("Expected result : detached\n");
+		printf("Actual result : %.*s\n", (int) length, chars);
+		exitBad(testName);
 	}
-    qsort(arr, len, sizeof(MyString*), myStringComparator);
+	free(chars);
+	// Detaching a string without a block still gives a block to free.
+	chars = myStringDetach(str, &length);
+	if (chars == NULL || length != 0)
+	{
+		printf("Expected result : empty block\n");
+		printf("Actual result : %lu chars\n", length);
+		exitBad(testName);
+	}
+	printf("PASS\n");
+	free(chars);
+	myStringFree(str);
 }
 
-/**
- * @brief Calculate the length of a cString.
- * @param str the string to calculate the length of.
- *
- * @return the length of the string.
- *
-  */
 
-static unsigned long getCStringLength(const char *str)
+static void myStringCStrNormal()
 {
-    unsigned long length = 0;
-    while (str[length] != END_OF_C_STRING)
-    {
-        length++;
-    }
-    return length;
+	char *testName = "myStringCStrNormal";
+	printf("Running %s\n", testName);
+	MyString *str = myStringAlloc();
+	MyString *other = myStringAlloc();
+	myStringSetFromCString(str, "abcabc");
+	myStringSetFromCString(other, "xyz");
+	int isTerminated = strcmp(myStringCStr(str), "abcabc") == 0;
+	myStringCat(str, other);
+	isTerminated = isTerminated && strcmp(myStringCStr(str), "abcabcxyz") == 0;
+	myStringFilter(str, filt);
+	isTerminated = isTerminated && strcmp(myStringCStr(str), "bcbc") == 0;
+	myStringAppendf(str, "-%d", 42);
+	isTerminated = isTerminated && strcmp(myStringCStr(str), "bcbc-42") == 0;
+	const MyString *parts[] = {other, other};
+	myStringJoin(str, parts, 2, other);
+	isTerminated = isTerminated && strcmp(myStringCStr(str), "xyzxyzxyz") == 0;
+	myStringMove(str, other);
+	isTerminated = isTerminated && strcmp(myStringCStr(str), "xyz") == 0
+				   && strcmp(myStringCStr(other), "") == 0;
+	unsigned long length = 0;
+	char *chars = myStringDetach(str, &length);
+	isTerminated = isTerminated && strcmp(chars, "xyz") == 0 && strcmp(myStringCStr(str), "") == 0;
+	if (!isTerminated || myStringCStr(NULL) != NULL)
+	{
+		printf("Expected result : terminated chars after every change\n");
+		printf("Actual result : %s\n", myStringCStr(str));
+		exitBad(testName);
+	}
+	printf("PASS\n");
+	free(chars);
+	myStringFree(str);
+	myStringFree(other);
 }
 
-/**
- * @brief Change the length of the string in the heap.
- * We use realloc to reuse the same address in the heap each time we change
- * the size of the string. This way we save lots of memory.
- * @param chars the string we change the length of.
- * @param length pointer to the length we will change in the struct.
- * @param newSize the new length to assign to the string.
- *
- * @return MYSTRING_ERROR if the reallocation failed,
- * 			MYSTRING_SUCCESS if the reallocation succeeded.
- */
-static MyStringRetVal adjustMyStringLength(char **chars, unsigned long *length,
-										   unsigned long newSize)
+static void myStringToCStringsNormal()
 {
-    // Resize the string and check if a problem occurred.
-    *chars = (char *) realloc(*chars, newSize);
-    if (*chars == NULL)
-    {
-        return MYSTRING_ERROR;
-    }
-    // Update the size of the string in the struct.
-    *length = newSize;
-    return MYSTRING_SUCCESS;
+	char *testName = "myStringToCStringsNormal";
+	printf("Running %s\n", testName);
+	MyString *str1 = myStringAlloc();
+	MyString *str2 = myStringAlloc();
+	MyString *str3 = myStringAlloc();
+	myStringSetFromCString(str1, "first");
+	myStringSetFromCString(str3, "third");
+	const MyString *strs[] = {str1, str2, str3};
+	char **cStrings = myStringToCStrings(strs, 3);
+	if (cStrings == NULL || strcmp(cStrings[0], "first") != 0 || strcmp(cStrings[1], "") != 0
+		|| strcmp(cStrings[2], "third") != 0)
+	{
+		printf("Expected result : first,,third\n");
+		printf("Actual result : %s\n", cStrings == NULL ? "NULL" : cStrings[0]);
+		exitBad(testName);
+	}
+	printf("PASS\n");
+	free(cStrings);
+	myStringFree(str1);
+	myStringFree(str2);
+	myStringFree(str3);
 }
 
-/**
- * @brief Get the number of digits of a given integer number.
- * @param n the number we get the digits of.
- *
- * @return the number of digits.
- */
-static int getNumOfDigits(int n)
+
+static void myStringMapFileNormal()
 {
-    int numOfDigits = 0;
-    // Minus sign or zero cases.
-    if (n <= 0)
-    {
-        numOfDigits++;
-    }
-    // The number is zero with 1 digit.
-    if (n == 0)
-    {
-        return numOfDigits;
-    }
-    // Go over the number's digits by division to calculate them.
-    while (n != 0)
-    {
-        n = n / DIGIT_DIVIDER;
-        numOfDigits++;
-    }
-    return numOfDigits;
+	char *testName = "myStringMapFileNormal";
+	printf("Running %s\n", testName);
+	char *path = "myStringMapFileTest.txt";
+	FILE *file = fopen(path, "w");
+	fputs("mapped text", file);
+	fclose(file);
+	MyString *mapped = myStringMapFile(path);
+	MyString *expected = myStringAlloc();
+	myStringSetFromCString(expected, "mapped text");
+	int isMapped = mapped != NULL && myStringEqual(mapped, expected) == TRUE &&
+				   strcmp(myStringCStr(mapped), "mapped text") == 0;
+	// Changing the string copies it, and the file stays as it was.
+	myStringSetFromCString(expected, "!");
+	myStringCat(mapped, expected);
+	isMapped = isMapped && strcmp(myStringCStr(mapped), "mapped text!") == 0;
+	MyString *again = myStringMapFile(path);
+	isMapped = isMapped && again != NULL && strcmp(myStringCStr(again), "mapped text") == 0;
+	if (!isMapped || myStringMapFile("noSuchFile.txt") != NULL)
+	{
+		printf("Expected result : mapped text!\n");
+		printf("Actual result : %s\n", mapped == NULL ? "NULL" : myStringCStr(mapped));
+		exitBad(testName);
+	}
+	printf("PASS\n");
+	remove(path);
+	myStringFree(mapped);
+	myStringFree(again);
+	myStringFree(expected);
 }
-/**
- * @brief Wrapper function of a comparator for the qsort function.
- * @param str1
- * @param str2
- * @return The value the default comparator returned (1/0/-1).
- *
- */
-static int myStringComparator(const void *str1, const void *str2)
+
+static void myStringMapFilePageSize()
 {
-	MyString** temp1 = (MyString **) str1;
-	MyString** temp2 = (MyString **) str2;
-	return myStringCompare(*temp1, *temp2);
+	char *testName = "myStringMapFilePageSize";
+	printf("Running %s\n", testName);
+	char *path = "myStringMapFileTest.txt";
+	// A file which fills its last page still ends with '\0' when mapped.
+	long pageSize = sysconf(_SC_PAGESIZE);
+	FILE *file = fopen(path, "w");
+	for (long i = 0; i < pageSize; i++)
+	{
+		fputc('x', file);
+	}
+	fclose(file);
+	MyString *mapped = myStringMapFile(path);
+	unsigned long length = 0;
+	char *chars = NULL;
+	if (mapped != NULL && myStringLen(mapped) == (unsigned long) pageSize &&
+		myStringCStr(mapped)[pageSize] == END_OF_C_STRING)
+	{
+		myStringFilter(mapped, filt);
+		chars = myStringDetach(mapped, &length);
+	}
+	if (chars == NULL || length != 0 || *chars != END_OF_C_STRING)
+	{
+		printf("Expected result : %ld chars and '\\0'\n", pageSize);
+		printf("Actual result : %lu chars\n", mapped == NULL ? 0 : myStringLen(mapped));
+		exitBad(testName);
+	}
+	printf("PASS\n");
+	remove(path);
+	free(chars);
+	myStringFree(mapped);
 }
 
-/**
- * @brief Filter the chars of a string according to a filter and create a new string.
- * @param filteredString the new filtered string.
- * @param unfilteredString the source string we would like to filter.
- * @param filt pointer to a function that filters in some manner.
- *
- */
 
-static void createFilteredString(char *filteredString, const char *unfilteredString,
-								 bool (*filt)(const char *))
+static void myStringBlockCacheReuse()
 {
-
-    unsigned long unfilteredStringLength = getCStringLength(unfilteredString);
-    unsigned long i = 0;
-    for (i = 0; i < unfilteredStringLength; i++)
-    {
-        if (filt(unfilteredString))
-        {
-            *filteredString = *unfilteredString;
-            filteredString++;
-        }
-        unfilteredString++;
-    }
-
+	char *testName = "myStringBlockCacheReuse";
+	printf("Running %s\n", testName);
+	MyString *str = myStringAlloc();
+	myStringSetFromCString(str, "short string");
+	MyString *freed = str;
+	myStringFree(str);
+	// The freed struct is the first to be reused by the same thread.
+	str = myStringAlloc();
+	if (str != freed || myStringLen(str) != 0 || strcmp(myStringCStr(str), "") != 0)
+	{
+		printf("Expected result : %p\n", (void *) freed);
+		printf("Actual result : %p\n", (void *) str);
+		exitBad(testName);
+	}
+	printf("PASS\n");
+	myStringFree(str);
 }
 
-/**
- * @brief Calculate the length of the filtered string to be created. we do this
- * in order to pre-determine the size we need for the string in the heap.
- * @param str the source string we would like to filter.
- * @param filt pointer to a function that filters in some manner.
- * @return the length of the filtered string.
- *
+/*
+ * Allocates strings which the main thread frees.
  */
-static unsigned long getFilteredStringLength(const char *str, bool (*filt)(const char *))
+static void * allocateStrings(void *strs)
 {
-    unsigned long i = 0;
-    unsigned long unfilteredLength = getCStringLength(str);
-    unsigned long filteredLength = 0;
-    for (i = 0; i < unfilteredLength; i++)
-    {
-        // The char remained after the filtering.
-        if (filt(str))
-        {
-            filteredLength++;
-        }
-        str++;
-    }
-
-    return filteredLength;
-
+	MyString **threadStrs = (MyString **) strs;
+	for (int i = 0; i < 100; i++)
+	{
+		threadStrs[i] = myStringAlloc();
+		myStringSetFromInt(threadStrs[i], i);
+		// The blocks this thread frees stay in its cache until it exits.
+		MyString *temp = myStringClone(threadStrs[i]);
+		myStringFree(temp);
+	}
+	return NULL;
 }
 
-/**
- * @brief Creates an empty string with length 0 in the heap.
- * @param p_myString The string we alloc.
- * @return Pointer to the chars of the string if we succeeded, NULL otherwise.
- *
- */
-static char* emptyStringAlloc(MyString *p_myString)
+static void myStringBlockCacheThreads()
 {
-    p_myString -> _chars = (char *) malloc(sizeof(char));
-    if (p_myString -> _chars == NULL)
-    {
-    	return NULL;
-    }
-    // Assign empty string.
-    *(p_myString -> _chars) = END_OF_C_STRING;
-    p_myString -> _length = EMPTY_STRING_LENGTH;
-    return p_myString -> _chars;
+	char *testName = "myStringBlockCacheThreads";
+	printf("Running %s\n", testName);
+	MyString *strs[100];
+	pthread_t thread;
+	pthread_create(&thread, NULL, allocateStrings, strs);
+	pthread_join(thread, NULL);
+	MyString *expected = myStringAlloc();
+	myStringSetFromInt(expected, 99);
+	if (myStringEqual(strs[99], expected) != TRUE)
+	{
+		printf("Expected result : 99\n");
+		printf("Actual result : %s\n", myStringCStr(strs[99]));
+		exitBad(testName);
+	}
+	printf("PASS\n");
+	// Freeing the strings of another thread.
+	for (int i = 0; i < 100; i++)
+	{
+		myStringFree(strs[i]);
+	}
+	myStringFree(expected);
 }
 
-
-
-
-
-
-#ifndef NDEBUG
-
-static void exitBad(char* testName);
-/**
- * @brief Comparator of the reversed order of the default comparator.
- * @param str1
- * @param str2
- * @return 1 if comparator returned -1 and the opposite,
- * 		 0 if it returned 0.
- *
- */
-static int reverseMyStringCompare(const MyString *str1, const MyString *str2)
+static void myStringReleaseThreadCacheNormal()
 {
-	 if (str1 == NULL || str2 == NULL)
-	 {
-		 return MYSTR_ERROR_CODE;
-	 }
-	 int result = myStringCompare(str1, str2);
-	 if (result == STR1_BIGGER)
-	 {
-		 return STR2_BIGGER;
-	 }
-	 if (result == STR2_BIGGER)
-	 {
-		 return STR1_BIGGER;
-	 }
-	 return EQUAL_STRINGS;
+	char *testName = "myStringReleaseThreadCacheNormal";
+	printf("Running %s\n", testName);
+	MyString *str = myStringAlloc();
+	myStringSetFromCString(str, "short string");
+	myStringFree(str);
+	myStringReleaseThreadCache();
+	bool isReleased = true;
+#ifdef MYSTRING_STATS
+	// The other threads exited already, so no blocks are cached at all.
+	MyStringStats stats;
+	isReleased = myStringStats(&stats) == MYSTRING_SUCCESS && stats._cachedBytes == 0;
+#endif
+	// The cache fills up again after it's released.
+	str = myStringAlloc();
+	isReleased = isReleased && str != NULL &&
+				 myStringSetFromCString(str, "short string") == MYSTRING_SUCCESS;
+	myStringFree(str);
+	if (!isReleased)
+	{
+		printf("Expected result : no cached blocks\n");
+		printf("Actual result : other\n");
+		exitBad(testName);
+	}
+	printf("PASS\n");
+}
+
+
+static void myStringStatsNormal()
+{
+	char *testName = "myStringStatsNormal";
+	printf("Running %s\n", testName);
+	MyStringStats before;
+	MyStringStats after;
+#ifdef MYSTRING_STATS
+	myStringStats(&before);
+	MyString *str = myStringAlloc();
+	myStringSetFromCString(str, "a string which outgrows the smallest block");
+	MyString *clone = myStringClone(str);
+	myStringStats(&after);
+	// A struct and a block each, and the block of str outgrown once.
+	int isCounted = after._liveStrings == before._liveStrings + 2 &&
+					after._allocations[MYSTRING_SITE_ALLOC] == before._allocations[MYSTRING_SITE_ALLOC] + 2 &&
+					after._allocations[MYSTRING_SITE_CLONE] == before._allocations[MYSTRING_SITE_CLONE] + 2 &&
+					after._reallocations[MYSTRING_SITE_SET] == before._reallocations[MYSTRING_SITE_SET] + 1 &&
+					after._liveBytes > before._liveBytes && after._peakBytes >= after._liveBytes &&
+					after._slackBytes > before._slackBytes;
+	myStringFree(str);
+	myStringFree(clone);
+	myStringStats(&after);
+	isCounted = isCounted && after._liveStrings == before._liveStrings &&
+				after._liveBytes == before._liveBytes && after._slackBytes == before._slackBytes;
+	if (!isCounted || myStringStatsDump(stdout) == MYSTRING_ERROR)
+	{
+		printf("Expected result : %lu strings\n", before._liveStrings);
+		printf("Actual result : %lu strings\n", after._liveStrings);
+		exitBad(testName);
+	}
+#else
+	if (myStringStats(&before) != MYSTRING_ERROR || myStringStatsDump(stdout) != MYSTRING_ERROR)
+	{
+		printf("Expected result : no stats\n");
+		printf("Actual result : stats\n");
+		exitBad(testName);
+	}
+	(void) after;
+#endif
+	printf("PASS\n");
 }
 
+// ------------------------------ myStringExternalSort -----------------------------
+
 /**
- * @brief Wrapper function of a reversed comparator for the qsort function.
- * @param str1
- * @param str2
- * @return 1 if comparator returned -1 and the opposite,
- * 		 0 if it returned 0.
- *
+ * @brief Sort input by myStringExternalSort and check the output.
+ * @return true if the output is expected.
  */
-static int myStringCustomComparator(const void *str1, const void *str2)
+static bool externalSortEquals(const char *input, unsigned long inputLength,
+							   const MyStringExternalSortOptions *options,
+							   const char *expected, unsigned long expectedLength)
 {
-	MyString** temp1 = (MyString **) str1;
-	MyString** temp2 = (MyString **) str2;
-	return reverseMyStringCompare(*temp1, *temp2);
+	FILE *in = tmpfile();
+	FILE *out = tmpfile();
+	char output[BUFSIZ];
+	unsigned long outputLength = 0;
+	bool isSorted = in != NULL && out != NULL &&
+					fwrite(input, sizeof(char), inputLength, in) == inputLength;
+	if (isSorted)
+	{
+		rewind(in);
+		isSorted = myStringExternalSort(in, out, options) == MYSTRING_SUCCESS;
+		rewind(out);
+		outputLength = fread(output, sizeof(char), sizeof(output), out);
+	}
+	if (in != NULL)
+	{
+		fclose(in);
+	}
+	if (out != NULL)
+	{
+		fclose(out);
+	}
+	return isSorted && outputLength == expectedLength &&
+		   memcmp(output, expected, expectedLength) == 0;
 }
 
-// ------------------------------ Unit Tests -----------------------------
+static void myStringExternalSortLines()
+{
+	char *testName = "myStringExternalSortLines";
+	printf("Running %s\n", testName);
+	char *input = "pear\napple\nfig\napple\n\nkiwi\nfig\napple";
+	MyStringExternalSortOptions options;
+	myStringExternalSortDefaults(&options);
+	char *sorted = "\napple\napple\napple\nfig\nfig\nkiwi\npear\n";
+	bool isSorted = externalSortEquals(input, strlen(input), &options, sorted, strlen(sorted));
+	// A tiny budget makes a run of every string, and tiny buffers merge them in passes.
+	options._memoryBudget = 1;
+	options._bufferSize = 3;
+	isSorted = isSorted &&
+			   externalSortEquals(input, strlen(input), &options, sorted, strlen(sorted));
+	char *unique = "\napple\nfig\nkiwi\npear\n";
+	options._mode = MYSTRING_MERGE_UNIQUE;
+	isSorted = isSorted &&
+			   externalSortEquals(input, strlen(input), &options, unique, strlen(unique));
+	char *counted = "1\t\n3\tapple\n2\tfig\n1\tkiwi\n1\tpear\n";
+	options._mode = MYSTRING_MERGE_COUNT;
+	options._tempDir = ".";
+	isSorted = isSorted &&
+			   externalSortEquals(input, strlen(input), &options, counted, strlen(counted));
+	isSorted = isSorted && externalSortEquals("", 0, &options, "", 0);
+	if (!isSorted)
+	{
+		printf("Expected result : %s\n", counted);
+		printf("Actual result : other\n");
+		exitBad(testName);
+	}
+	printf("PASS\n");
+}
 
-// ------------------------------ myStringAlloc -----------------------------
+static void myStringExternalSortLengthPrefixed()
+{
+	char *testName = "myStringExternalSortLengthPrefixed";
+	printf("Running %s\n", testName);
+	// Length-prefixed strings may hold '\n' and '\0'.
+	char input[] = "\2\0\0\0b\n" "\3\0\0\0a\0z" "\2\0\0\0b\n";
+	char counted[] = "\1\0\0\0\0\0\0\0" "\3\0\0\0a\0z" "\2\0\0\0\0\0\0\0" "\2\0\0\0b\n";
+	MyStringExternalSortOptions options;
+	myStringExternalSortDefaults(&options);
+	options._format = MYSTRING_RECORDS_LENGTH_PREFIXED;
+	options._mode = MYSTRING_MERGE_COUNT;
+	options._memoryBudget = 1;
+	options._bufferSize = 2;
+	bool isSorted = externalSortEquals(input, sizeof(input) - 1, &options,
+									   counted, sizeof(counted) - 1);
+	// A string cut in the middle fails the sort.
+	isSorted = isSorted && !externalSortEquals(input, sizeof(input) - 2, &options,
+											   counted, sizeof(counted) - 1);
+	if (!isSorted || myStringExternalSort(NULL, stdout, &options) != MYSTRING_ERROR)
+	{
+		printf("Expected result : 1 a\\0z, 2 b\\n\n");
+		printf("Actual result : other\n");
+		exitBad(testName);
+	}
+	printf("PASS\n");
+}
 
-static void myStringAllocNormalAllocation()
+static void myStringExternalSortManyRuns()
+{
+	char *testName = "myStringExternalSortManyRuns";
+	printf("Running %s\n", testName);
+	// More runs than the files the process may open, which all share a file per pass.
+	const int count = 1500;
+	const rlim_t fileLimit = 64;
+	char input[BUFSIZ];
+	char sorted[BUFSIZ];
+	for (int i = 0; i < count; i++)
 	{
-		MyString* result = myStringAlloc();
-		if (result == NULL)
-		{
-			printf("Expected result : MyString*\n");
-			printf("Actual result : NULL\n");
-			myStringFree(result);
-			exitBad("myStringAllocNormalAllocation");
-		}
-		printf("PASS\n");
-		myStringFree(result);
+		sprintf(input + 5 * i, "%04d\n", count - 1 - i);
+		sprintf(sorted + 5 * i, "%04d\n", i);
+	}
+	MyStringExternalSortOptions options;
+	myStringExternalSortDefaults(&options);
+	options._memoryBudget = 1;
+	options._bufferSize = 16;
+	struct rlimit limit;
+	bool isSorted = getrlimit(RLIMIT_NOFILE, &limit) == 0;
+	struct rlimit lowered = limit;
+	lowered.rlim_cur = fileLimit < limit.rlim_cur ? fileLimit : limit.rlim_cur;
+	isSorted = isSorted && setrlimit(RLIMIT_NOFILE, &lowered) == 0;
+	isSorted = isSorted && externalSortEquals(input, 5 * count, &options, sorted, 5 * count);
+	options._tempDir = ".";
+	isSorted = isSorted && externalSortEquals(input, 5 * count, &options, sorted, 5 * count);
+	setrlimit(RLIMIT_NOFILE, &limit);
+	if (!isSorted)
+	{
+		printf("Expected result : 0000 to %04d\n", count - 1);
+		printf("Actual result : other\n");
+		exitBad(testName);
 	}
+	printf("PASS\n");
+}
 
-// ------------------------------ myStringFree -----------------------------
+// ------------------------------ myStringEditDistance -----------------------------
 
-static void myStringFreeNormalFree()
+/**
+ * @brief The edit distance by the plain dynamic programming, to check against.
+ */
+static unsigned long naiveEditDistance(const char *chars1, unsigned long length1,
+									   const char *chars2, unsigned long length2)
+{
+	unsigned long *row = (unsigned long *) malloc((length2 + 1) * sizeof(unsigned long));
+	for (unsigned long j = 0; j <= length2; j++)
 	{
-		char *testName = "myStringFreeNormalFree";
-		printf("Running %s\n", testName);
-		MyString* result = myStringAlloc();
-		myStringFree(result);
-		result = NULL;
-		if (result != NULL)
+		row[j] = j;
+	}
+	for (unsigned long i = 1; i <= length1; i++)
+	{
+		unsigned long diagonal = row[0];
+		row[0] = i;
+		for (unsigned long j = 1; j <= length2; j++)
 		{
-			printf("Expected result : NULL\n");
-			printf("Actual result : MyString*\n");
-			exitBad(testName);
+			unsigned long above = row[j];
+			unsigned long best = diagonal + (chars1[i - 1] != chars2[j - 1]);
+			best = above + 1 < best ? above + 1 : best;
+			best = row[j - 1] + 1 < best ? row[j - 1] + 1 : best;
+			row[j] = best;
+			diagonal = above;
 		}
-		printf("PASS\n");
 	}
+	unsigned long distance = row[length2];
+	free(row);
+	return distance;
+}
 
-static void myStringFreeNullFree()
+/**
+ * @brief Set a string to random chars out of a few, so they match often.
+ */
+static void setRandomChars(MyString *str, unsigned long length, unsigned long *seed)
+{
+	myStringSetFromCString(str, "");
+	for (unsigned long i = 0; i < length; i++)
 	{
-		char *testName = "myStringFreeNullFree";
-		printf("Running %s\n", testName);
-		MyString* result = NULL;
-		myStringFree(result);
-		printf("PASS\n");
+		*seed = *seed * 6364136223846793005UL + 1442695040888963407UL;
+		char c = (char) ('a' + (*seed >> 33) % 4);
+		myStringAppendView(str, (MyStringView) {&c, 1});
 	}
+}
 
-
-
-
-
-// ------------------------------ myStringCompare -----------------------------
-
-static void myStringCompareNullCheck()
+static void myStringEditDistanceNormal()
 {
-	char *testName = "myStringCompareNullCheck";
+	char *testName = "myStringEditDistanceNormal";
 	printf("Running %s\n", testName);
 	MyString *str1 = myStringAlloc();
 	MyString *str2 = myStringAlloc();
-	int result = myStringCompare(NULL, NULL);
-	if (result != MYSTR_ERROR_CODE)
-	{
-		printf("Expected result : -999\n");
-		printf("Actual result : %d\n", result);
-		myStringFree(str1);
-		myStringFree(str2);
-		exitBad(testName);
-	}
-	result = myStringCompare(NULL, str2);
-	if (result != MYSTR_ERROR_CODE)
+	myStringSetFromCString(str1, "kitten");
+	myStringSetFromCString(str2, "sitting");
+	unsigned long distance = 0;
+	bool isRight = myStringEditDistance(str1, str2, &distance) == MYSTRING_SUCCESS &&
+				   distance == 3;
+	// Random strings over a few chars, of one word, a few words, and across words.
+	unsigned long seed = 1;
+	for (int i = 0; i < 300 && isRight; i++)
 	{
-		printf("Expected result : -999\n");
-		printf("Actual result : %d\n", result);
-		myStringFree(str1);
-		myStringFree(str2);
-		exitBad(testName);
+		setRandomChars(str1, (unsigned long) (i * 7) % 200, &seed);
+		setRandomChars(str2, (unsigned long) (i * 13) % 170, &seed);
+		unsigned long expected = naiveEditDistance(myStringCStr(str1), myStringLen(str1),
+												   myStringCStr(str2), myStringLen(str2));
+		isRight = myStringEditDistance(str1, str2, &distance) == MYSTRING_SUCCESS &&
+				  distance == expected;
 	}
-	result = myStringCompare(str1, NULL);
-	if (result != MYSTR_ERROR_CODE)
+	if (!isRight || myStringEditDistance(str1, NULL, &distance) != MYSTRING_ERROR)
 	{
-		printf("Expected result : -999\n");
-		printf("Actual result : %d\n", result);
-		myStringFree(str1);
-		myStringFree(str2);
+		printf("Expected result : %lu\n", naiveEditDistance(myStringCStr(str1), myStringLen(str1),
+															myStringCStr(str2), myStringLen(str2)));
+		printf("Actual result : %lu\n", distance);
 		exitBad(testName);
 	}
 	printf("PASS\n");
@@ -1060,635 +12097,1404 @@ static void myStringCompareNullCheck()
 	myStringFree(str2);
 }
 
-static void myStringCompareEmptyCheck()
+static void myStringEditDistanceAtMostNormal()
 {
-	char *testName = "myStringCompareEmptyCheck";
+	char *testName = "myStringEditDistanceAtMostNormal";
 	printf("Running %s\n", testName);
 	MyString *str1 = myStringAlloc();
 	MyString *str2 = myStringAlloc();
-	int result = myStringCompare(str1, str2);
-	if (result != 0)
+	myStringSetFromCString(str1, "flaw");
+	myStringSetFromCString(str2, "lawn");
+	bool isRight = myStringEditDistanceAtMost(str1, str2, 2) == TRUE &&
+				   myStringEditDistanceAtMost(str1, str2, 1) == FALSE &&
+				   myStringEditDistanceAtMost(str1, NULL, 1) == MYSTR_ERROR_CODE;
+	unsigned long seed = 2;
+	for (int i = 0; i < 200 && isRight; i++)
 	{
-		printf("Expected result : 0\n");
-		printf("Actual result : %d\n", result);
-		myStringFree(str1);
-		myStringFree(str2);
-		exitBad("myStringCompareEmptyCheck");
+		setRandomChars(str1, 60 + (unsigned long) i % 90, &seed);
+		setRandomChars(str2, 60 + (unsigned long) (i * 3) % 90, &seed);
+		unsigned long k = (unsigned long) i % 80;
+		unsigned long expected = naiveEditDistance(myStringCStr(str1), myStringLen(str1),
+												   myStringCStr(str2), myStringLen(str2));
+		isRight = myStringEditDistanceAtMost(str1, str2, k) == (expected <= k ? TRUE : FALSE);
 	}
-	myStringSetFromCString(str1, "Some String");
-	result = myStringCompare(str1, str2);
-	if (result != 1)
+	if (!isRight)
 	{
-		printf("Expected result : 1\n");
-		printf("Actual result : %d\n", result);
-		myStringFree(str1);
-		myStringFree(str2);
-		exitBad("myStringCompareEmptyCheck");
+		printf("Expected result : TRUE then FALSE\n");
+		printf("Actual result : other\n");
+		exitBad(testName);
 	}
 	printf("PASS\n");
 	myStringFree(str1);
 	myStringFree(str2);
 }
 
-static void myStringCompareNormalCheck()
+static void myStringEditPatternNormal()
 {
-	char *testName = "myStringCompareNormalCheck";
+	char *testName = "myStringEditPatternNormal";
 	printf("Running %s\n", testName);
-	MyString *str1 = myStringAlloc();
-	MyString *str2 = myStringAlloc();
-	myStringSetFromCString(str1, "Some String");
-	myStringSetFromCString(str2, "Some String");
-	int result = myStringCompare(str1, str2);
-	if (result != 0)
+	MyString *str = myStringAlloc();
+	const char *values[4] = {"sitting", "kitten", "", "mitten"};
+	MyString *strs[4];
+	for (int i = 0; i < 4; i++)
 	{
-		printf("Expected result : 0\n");
-		printf("Actual result : %d\n", result);
-		myStringFree(str1);
-		myStringFree(str2);
-		exitBad("myStringCompareEmptyCheck");
+		strs[i] = myStringAlloc();
+		myStringSetFromCString(strs[i], values[i]);
 	}
+	myStringSetFromCString(str, "kitten");
+	MyStringEditPattern *pattern = myStringEditPatternAlloc(str);
+	// The pattern is a copy, so the string may change.
+	myStringSetFromCString(str, "");
+	unsigned long distances[4] = {0};
+	unsigned long bounded[4] = {0};
+	bool isRight = pattern != NULL &&
+				   myStringEditPatternDistances(pattern, (const MyString **) strs, 4, ULONG_MAX,
+												distances) == MYSTRING_SUCCESS &&
+				   myStringEditPatternDistances(pattern, (const MyString **) strs, 4, 2,
+												bounded) == MYSTRING_SUCCESS;
+	unsigned long expected[4] = {3, 0, 6, 1};
+	unsigned long expectedBounded[4] = {3, 0, 3, 1};
+	for (int i = 0; i < 4 && isRight; i++)
+	{
+		isRight = distances[i] == expected[i] && bounded[i] == expectedBounded[i];
+	}
+	if (!isRight)
+	{
+		printf("Expected result : 3 0 6 1\n");
+		printf("Actual result : %lu %lu %lu %lu\n", distances[0], distances[1], distances[2],
+			   distances[3]);
+		exitBad(testName);
+	}
+	printf("PASS\n");
+	myStringEditPatternFree(pattern);
+	myStringFree(str);
+	for (int i = 0; i < 4; i++)
+	{
+		myStringFree(strs[i]);
+	}
+}
 
-	myStringSetFromCString(str2, "Some");
-	result = myStringCompare(str1, str2);
-	if (result != 1)
+// ------------------------------ myStringHex -----------------------------
+
+static void myStringHexNormal()
+{
+	char *testName = "myStringHexNormal";
+	printf("Running %s\n", testName);
+	MyString *str = myStringAlloc();
+	MyString *decoded = myStringAlloc();
+	unsigned char bytes[UCHAR_MAX + 1];
+	for (int i = 0; i <= UCHAR_MAX; i++)
 	{
-		printf("Expected result : 1\n");
-		printf("Actual result : %d\n", result);
-		myStringFree(str1);
-		myStringFree(str2);
-		exitBad("myStringCompareEmptyCheck");
+		bytes[i] = (unsigned char) (UCHAR_MAX - i);
 	}
-	myStringSetFromCString(str1, "Som");
-	result = myStringCompare(str1, str2);
-	if (result != -1)
+	MyStringView view = {(const char *) bytes, UCHAR_MAX + 1};
+	MyStringView small = {"\x01\xAB", 2};
+	bool isRight = myStringAppendHex(str, small) == MYSTRING_SUCCESS &&
+				   strcmp(myStringCStr(str), "01ab") == 0;
+	myStringSetFromCString(str, "");
+	isRight = isRight && myStringAppendHex(str, view) == MYSTRING_SUCCESS &&
+			  strncmp(myStringCStr(str), "fffefdfc", 8) == 0 &&
+			  myStringAppendFromHex(decoded, myStringGetView(str)) == MYSTRING_SUCCESS &&
+			  myStringLen(decoded) == UCHAR_MAX + 1 &&
+			  memcmp(myStringCStr(decoded), bytes, UCHAR_MAX + 1) == 0;
+	// Uppercase digits are read too, and invalid hex leaves the string as it was.
+	myStringSetFromCString(decoded, "x");
+	MyStringView upper = {"0123456789ABCDEFabcdef0123456789ABCDEF", 38};
+	MyStringView bad = {"0123456789abcdef0123456789abcdeg", 32};
+	MyStringView odd = {"abc", 3};
+	isRight = isRight && myStringAppendFromHex(decoded, upper) == MYSTRING_SUCCESS &&
+			  memcmp(myStringCStr(decoded), "x\x01\x23\x45\x67\x89\xAB\xCD\xEF\xAB\xCD\xEF", 12) == 0 &&
+			  myStringLen(decoded) == 20 &&
+			  myStringAppendFromHex(decoded, bad) == MYSTRING_ERROR &&
+			  myStringAppendFromHex(decoded, odd) == MYSTRING_ERROR &&
+			  myStringLen(decoded) == 20;
+	if (!isRight)
 	{
-		printf("Expected result : -1\n");
-		printf("Actual result : %d\n", result);
-		myStringFree(str1);
-		myStringFree(str2);
-		exitBad("myStringCompareEmptyCheck");
+		printf("Expected result : 01ab, and the bytes back from their hex\n");
+		printf("Actual result : %s\n", myStringCStr(str));
+		exitBad(testName);
 	}
 	printf("PASS\n");
-	myStringFree(str1);
-	myStringFree(str2);
+	myStringFree(str);
+	myStringFree(decoded);
 }
 
-// ------------------------------ myStringSort -----------------------------
+static void myStringBase64Normal()
+{
+	char *testName = "myStringBase64Normal";
+	printf("Running %s\n", testName);
+	// The test vectors of RFC 4648.
+	const char *plains[7] = {"", "f", "fo", "foo", "foob", "fooba", "foobar"};
+	const char *encodings[7] = {"", "Zg==", "Zm8=", "Zm9v", "Zm9vYg==", "Zm9vYmE=", "Zm9vYmFy"};
+	MyString *str = myStringAlloc();
+	MyString *decoded = myStringAlloc();
+	bool isRight = true;
+	for (int i = 0; i < 7 && isRight; i++)
+	{
+		MyStringView plain = {plains[i], strlen(plains[i])};
+		MyStringView encoding = {encodings[i], strlen(encodings[i])};
+		myStringSetFromCString(str, "");
+		myStringSetFromCString(decoded, "");
+		isRight = myStringAppendBase64(str, plain) == MYSTRING_SUCCESS &&
+				  strcmp(myStringCStr(str), encodings[i]) == 0 &&
+				  myStringAppendFromBase64(decoded, encoding) == MYSTRING_SUCCESS &&
+				  strcmp(myStringCStr(decoded), plains[i]) == 0;
+	}
+	// Long enough for the vector blocks, with every byte value and every tail length.
+	unsigned char bytes[3 * (UCHAR_MAX + 1)];
+	for (int i = 0; i < 3 * (UCHAR_MAX + 1); i++)
+	{
+		bytes[i] = (unsigned char) (i * 7);
+	}
+	for (unsigned long length = 100; length < 103 && isRight; length++)
+	{
+		MyStringView view = {(const char *) bytes, length};
+		myStringSetFromCString(str, "");
+		myStringSetFromCString(decoded, "");
+		isRight = myStringAppendBase64(str, view) == MYSTRING_SUCCESS &&
+				  myStringLen(str) == (length + 2) / 3 * 4 &&
+				  myStringAppendFromBase64(decoded, myStringGetView(str)) == MYSTRING_SUCCESS &&
+				  myStringLen(decoded) == length &&
+				  memcmp(myStringCStr(decoded), bytes, length) == 0;
+	}
+	// Invalid chars, in the vector blocks or not, and misplaced padding are rejected.
+	MyStringView badBlock = {"QUJDR*VGR0hJSktMTU5PUFFSU1RVVldYWVpbXF1eX2BhYmNkZWZnaGlqa2xtbm9w",
+						  64};
+	MyStringView badTail = {"Zm9v!g==", 8};
+	MyStringView earlyPadding = {"Zg==Zm9v", 8};
+	MyStringView partial = {"Zm9vY", 5};
+	// The bits past the last byte of a padded group are zero.
+	MyStringView looseTwo = {"QR==", 4};
+	MyStringView looseOne = {"QUJ=", 4};
+	myStringSetFromCString(decoded, "x");
+	isRight = isRight && myStringAppendFromBase64(decoded, badBlock) == MYSTRING_ERROR &&
+			  myStringAppendFromBase64(decoded, badTail) == MYSTRING_ERROR &&
+			  myStringAppendFromBase64(decoded, earlyPadding) == MYSTRING_ERROR &&
+			  myStringAppendFromBase64(decoded, partial) == MYSTRING_ERROR &&
+			  myStringAppendFromBase64(decoded, looseTwo) == MYSTRING_ERROR &&
+			  myStringAppendFromBase64(decoded, looseOne) == MYSTRING_ERROR &&
+			  strcmp(myStringCStr(decoded), "x") == 0;
+	if (!isRight)
+	{
+		printf("Expected result : the RFC 4648 vectors, and long payloads back from base64\n");
+		printf("Actual result : %s\n", myStringCStr(str));
+		exitBad(testName);
+	}
+	printf("PASS\n");
+	myStringFree(str);
+	myStringFree(decoded);
+}
 
-static void myStringSortThreeSort()
+static void myStringCodecStreamNormal()
 {
-	char *testName = "myStringSortThreeSort";
+	char *testName = "myStringCodecStreamNormal";
 	printf("Running %s\n", testName);
-	MyString *str1 = myStringAlloc();
-	MyString *str2 = myStringAlloc();
-	MyString *str3 = myStringAlloc();
-	myStringSetFromCString(str1, "bbc");
-	myStringSetFromCString(str2, "cds");
-	myStringSetFromCString(str3, "abc");
-	MyString *arr[3] = {str1, str2, str3};
-    myStringSort(arr, 3);
-    char* cStr1 = myStringToCString(arr[0]);
-    char* cStr2 = myStringToCString(arr[1]);
-    char* cStr3 = myStringToCString(arr[2]);
-    int retVal1 = strcmp(cStr1, "abc");
-    int retVal2 = strcmp(cStr2, "bbc");
-    int retVal3 = strcmp(cStr3, "cds");
-    if (retVal1 != 0 || retVal2 != 0 || retVal3 != 0)
-    {
-    	printf("Expected result : abc bbc cds\n");
-    	printf("Actual result : %s %s %s\n", cStr1, cStr2, cStr3);
-    	myStringFree(str1);
-    	myStringFree(str2);
-    	myStringFree(str3);
-    	exitBad(testName);
-    }
-    printf("PASS\n");
-    free(cStr1);
-    free(cStr2);
-    free(cStr3);
-    cStr1 = NULL;
-    cStr2 = NULL;
-    cStr3 = NULL;
-    myStringFree(str1);
-    myStringFree(str2);
-    myStringFree(str3);
+	unsigned char bytes[200];
+	for (int i = 0; i < 200; i++)
+	{
+		bytes[i] = (unsigned char) (i * 13 + 5);
+	}
+	MyStringView whole = {(const char *) bytes, 200};
+	MyString *expected = myStringAlloc();
+	MyString *hex = myStringAlloc();
+	myStringAppendBase64(expected, whole);
+	myStringAppendHex(hex, whole);
+	MyString *base64 = myStringAlloc();
+	MyString *decoded = myStringAlloc();
+	MyString *fromHex = myStringAlloc();
+	MyStringCodecStream encoder;
+	MyStringCodecStream decoder;
+	MyStringCodecStream hexDecoder;
+	myStringCodecStreamInit(&encoder);
+	myStringCodecStreamInit(&decoder);
+	myStringCodecStreamInit(&hexDecoder);
+	bool isRight = true;
+	// Chunks of every size from 1 up, so the groups are split at every point.
+	for (unsigned long start = 0, size = 1; start < 200 && isRight; start += size, size++)
+	{
+		unsigned long length = start + size > 200 ? 200 - start : size;
+		bool isLast = start + length == 200;
+		MyStringView chunk = {(const char *) bytes + start, length};
+		isRight = myStringAppendBase64Stream(base64, chunk, &encoder, isLast) == MYSTRING_SUCCESS;
+	}
+	for (unsigned long start = 0, size = 1; start < myStringLen(expected) && isRight;
+		 start += size, size++)
+	{
+		unsigned long length = start + size > myStringLen(expected) ?
+							   myStringLen(expected) - start : size;
+		bool isLast = start + length == myStringLen(expected);
+		MyStringView chunk = {myStringCStr(expected) + start, length};
+		MyStringView hexChunk = {myStringCStr(hex) + start, length};
+		isRight = myStringAppendFromBase64Stream(decoded, chunk, &decoder,
+												 isLast) == MYSTRING_SUCCESS &&
+				  myStringAppendFromHexStream(fromHex, hexChunk, &hexDecoder,
+											  false) == MYSTRING_SUCCESS;
+	}
+	MyStringView hexRest = {myStringCStr(hex) + myStringLen(expected),
+							myStringLen(hex) - myStringLen(expected)};
+	isRight = isRight && myStringEqual(base64, expected) == TRUE &&
+			  myStringAppendFromHexStream(fromHex, hexRest, &hexDecoder, true) == MYSTRING_SUCCESS &&
+			  myStringLen(decoded) == 200 && memcmp(myStringCStr(decoded), bytes, 200) == 0 &&
+			  myStringLen(fromHex) == 200 && memcmp(myStringCStr(fromHex), bytes, 200) == 0;
+	if (!isRight)
+	{
+		printf("Expected result : %s\n", myStringCStr(expected));
+		printf("Actual result : %s\n", myStringCStr(base64));
+		exitBad(testName);
+	}
+	printf("PASS\n");
+	myStringFree(expected);
+	myStringFree(hex);
+	myStringFree(base64);
+	myStringFree(decoded);
+	myStringFree(fromHex);
 }
 
-// ------------------------------ myStringCustomSort -----------------------------
 
-static void myStringCustomSortThreeSort()
+// ------------------------------ myStringSymbolTable -----------------------------
+
+static void myStringSymbolTableNormal()
 {
-	char *testName = "myStringCustomSortThreeSort";
+	char *testName = "myStringSymbolTableNormal";
 	printf("Running %s\n", testName);
-	MyString *str1 = myStringAlloc();
-	MyString *str2 = myStringAlloc();
-	MyString *str3 = myStringAlloc();
-	myStringSetFromCString(str1, "bbc");
-	myStringSetFromCString(str2, "cds");
-	myStringSetFromCString(str3, "abc");
-	MyString *arr[3] = {str1, str2, str3};
-    myStringCustomSort(arr, 3, myStringCustomComparator);
-    char* cStr1 = myStringToCString(arr[0]);
-    char* cStr2 = myStringToCString(arr[1]);
-    char* cStr3 = myStringToCString(arr[2]);
-    int retVal1 = strcmp(cStr1, "cds");
-    int retVal2 = strcmp(cStr2, "bbc");
-    int retVal3 = strcmp(cStr3, "abc");
-    if (retVal1 != 0 || retVal2 != 0 || retVal3 != 0)
-    {
-    	printf("Expected result : cds bbc abc\n");
-    	printf("Actual result : %s %s %s\n", cStr1, cStr2, cStr3);
-    	myStringFree(str1);
-    	myStringFree(str2);
-    	myStringFree(str3);
-    	exitBad(testName);
-    }
-    printf("PASS\n");
-    free(cStr1);
-    free(cStr2);
-    free(cStr3);
-    cStr1 = NULL;
-    cStr2 = NULL;
-    cStr3 = NULL;
-    myStringFree(str1);
-    myStringFree(str2);
-    myStringFree(str3);
+	MyString *strs[200];
+	unsigned long rawLength = 0;
+	for (int i = 0; i < 200; i++)
+	{
+		strs[i] = myStringAlloc();
+		myStringAppendf(strs[i], "https://www.example.com/products/%s/item-%d?ref=home",
+						i % 3 == 0 ? "books" : "garden", i * 7);
+		rawLength += myStringLen(strs[i]);
+	}
+	MyStringSymbolTable *table = myStringSymbolTableTrain((const MyString **) strs, 200);
+	MyString *compressed[200];
+	unsigned long compressedLength = 0;
+	bool isRight = table != NULL;
+	for (int i = 0; i < 200 && isRight; i++)
+	{
+		compressed[i] = myStringAlloc();
+		isRight = myStringAppendCompressed(table, compressed[i],
+										   myStringGetView(strs[i])) == MYSTRING_SUCCESS;
+		compressedLength += myStringLen(compressed[i]);
+	}
+	// Every string decompresses alone, to a string or to a buffer.
+	MyString *decompressed = myStringAlloc();
+	char buffer[100];
+	MyStringView view = {NULL, EMPTY_STRING_LENGTH};
+	for (int i = 0; i < 200 && isRight; i++)
+	{
+		myStringSetFromCString(decompressed, "");
+		isRight = myStringAppendDecompressed(table, decompressed,
+											 myStringGetView(compressed[i])) == MYSTRING_SUCCESS &&
+				  myStringEqual(decompressed, strs[i]) == TRUE &&
+				  myStringDecompressInto(table, myStringGetView(compressed[i]), buffer, 100,
+										 &view) == MYSTRING_SUCCESS &&
+				  view._length == myStringLen(strs[i]) &&
+				  memcmp(view._chars, myStringCStr(strs[i]), view._length) == 0 &&
+				  myStringEqual(compressed[i], compressed[(i + 3) % 200]) == FALSE;
+	}
+	if (!isRight || compressedLength * 2 > rawLength)
+	{
+		printf("Expected result : at most %lu compressed chars, decompressing back\n",
+			   rawLength / 2);
+		printf("Actual result : %lu compressed chars\n", compressedLength);
+		exitBad(testName);
+	}
+	printf("PASS\n");
+	for (int i = 0; i < 200; i++)
+	{
+		myStringFree(strs[i]);
+		myStringFree(compressed[i]);
+	}
+	myStringFree(decompressed);
+	myStringSymbolTableFree(table);
 }
 
-// ------------------------------ myStringWrite -----------------------------
-
-static void myStringWriteNormal()
+static void myStringSymbolTableEscapes()
 {
-	char *testName = "myStringWriteNormal";
+	char *testName = "myStringSymbolTableEscapes";
 	printf("Running %s\n", testName);
-	FILE *stream = fopen("/cs/stud/orib/Desktop/test", "w");
-	if (stream == NULL)
-	{
-		exit(MYSTR_ERROR_CODE);
-	}
 	MyString *str = myStringAlloc();
-	myStringSetFromCString(str, "abcdefghijklmnop");
-	MyStringRetVal retVal = myStringWrite(str, stream);
-	if (retVal == MYSTRING_ERROR)
+	myStringSetFromCString(str, "abcabcabcabc");
+	const MyString *sample[1] = {str};
+	MyStringSymbolTable *table = myStringSymbolTableTrain(sample, 1);
+	MyStringSymbolTable *empty = myStringSymbolTableTrain(NULL, 0);
+	// Chars which the sample never had, zeros among them, are escaped.
+	MyStringView unseen = {"\x01\0xyzabc\xFF", 9};
+	MyString *compressed = myStringAlloc();
+	MyString *decompressed = myStringAlloc();
+	bool isRight = table != NULL && empty != NULL &&
+				   myStringAppendCompressed(table, compressed, unseen) == MYSTRING_SUCCESS &&
+				   myStringAppendDecompressed(table, decompressed,
+											  myStringGetView(compressed)) == MYSTRING_SUCCESS &&
+				   myStringLen(decompressed) == 9 &&
+				   memcmp(myStringCStr(decompressed), unseen._chars, 9) == 0;
+	// An empty table escapes everything, and an empty string compresses to nothing.
+	myStringSetFromCString(compressed, "");
+	myStringSetFromCString(decompressed, "");
+	MyStringView nothing = {"", EMPTY_STRING_LENGTH};
+	isRight = isRight && myStringAppendCompressed(empty, compressed, unseen) == MYSTRING_SUCCESS &&
+			  myStringLen(compressed) == 18 &&
+			  myStringAppendCompressed(table, decompressed, nothing) == MYSTRING_SUCCESS &&
+			  myStringLen(decompressed) == EMPTY_STRING_LENGTH;
+	// A lone escape, an unknown code and a small buffer are rejected.
+	char buffer[4];
+	MyStringView view = {NULL, EMPTY_STRING_LENGTH};
+	MyStringView loneEscape = {"\xFF", 1};
+	MyStringView unknown = {"\xF0", 1};
+	myStringSetFromCString(decompressed, "x");
+	isRight = isRight &&
+			  myStringAppendDecompressed(table, decompressed, loneEscape) == MYSTRING_ERROR &&
+			  myStringAppendDecompressed(table, decompressed, unknown) == MYSTRING_ERROR &&
+			  strcmp(myStringCStr(decompressed), "x") == 0 &&
+			  myStringDecompressInto(empty, myStringGetView(compressed), buffer, 4,
+									 &view) == MYSTRING_ERROR;
+	if (!isRight)
 	{
-		printf("Expected result : 0\n");
-		printf("Actual result : -1\n");
-		fclose(stream);
-		myStringFree(str);
+		printf("Expected result : the unseen chars back, and invalid input rejected\n");
+		printf("Actual result : %lu chars back\n", myStringLen(decompressed));
 		exitBad(testName);
 	}
-
-    printf("PASS\n");
-    myStringFree(str);
+	printf("PASS\n");
+	myStringFree(str);
+	myStringFree(compressed);
+	myStringFree(decompressed);
+	myStringSymbolTableFree(table);
+	myStringSymbolTableFree(empty);
 }
 
-// ------------------------------ myStringClone -----------------------------
 
-static void myStringCloneNormal()
+// ------------------------------ myStringHash -----------------------------
+
+static void myStringHashNormal()
 {
-	char *testName = "myStringCloneNormal";
+	char *testName = "myStringHashNormal";
 	printf("Running %s\n", testName);
 	MyString *str = myStringAlloc();
-	myStringSetFromCString(str, "Hey there");
-	MyString *clonedStr = myStringClone(str);
-	char *clonedChars = myStringToCString(clonedStr);
-	char *oldChars = myStringToCString(str);
-	int result = strcmp(clonedChars, oldChars);
-	if (result != 0)
+	myStringSetFromCString(str, "a string longer than a word");
+	MyStringView same = {"a string longer than a word!", 27};
+	MyStringView other = {"a string longer than a worD", 27};
+	MyStringView empty = {NULL, EMPTY_STRING_LENGTH};
+	MyStringView zero = {"\0", 1};
+	const unsigned long long expected = 0x64FD35CD7CFCE57FULL;
+	// The hash is kept in files, so it must not change.
+	bool isRight = myStringHash(str) == myStringHashView(same) &&
+				   myStringHash(str) != myStringHashView(other) &&
+				   myStringHash(NULL) == myStringHashView(empty) &&
+				   myStringHashView(empty) != myStringHashView(zero) &&
+				   myStringHash(str) == expected;
+	if (!isRight)
 	{
-		printf("Expected result : 0\n");
-		printf("Actual result : %d\n", result);
-		myStringFree(str);
-		myStringFree(clonedStr);
+		printf("Expected result : %llu\n", expected);
+		printf("Actual result : %llu\n", myStringHash(str));
 		exitBad(testName);
 	}
 	printf("PASS\n");
-	free(clonedChars);
-	free(oldChars);
-	clonedChars = NULL;
-	oldChars = NULL;
 	myStringFree(str);
-	myStringFree(clonedStr);
 }
 
-// ------------------------------ myStringSetFromMyString -----------------------------
-static void myStringSetFromMyStringEmpty()
+// ------------------------------ myStringBloomFilter -----------------------------
+
+static void myStringBloomFilterNormal()
 {
-	char *testName = "myStringSetFromMyStringEmpty";
+	char *testName = "myStringBloomFilterNormal";
 	printf("Running %s\n", testName);
-	MyString *str1 = myStringAlloc();
-	MyString *str2 = myStringAlloc();
-	myStringSetFromCString(str2, "Hey there");
-	myStringSetFromMyString(str1, str2);
-	char *newChars = myStringToCString(str1);
-	char *oldChars = myStringToCString(str2);
-	int result = strcmp(newChars, oldChars);
-	if (result != 0)
+	MyString *strs[2000];
+	MyStringView keys[2000];
+	for (int i = 0; i < 2000; i++)
 	{
-		printf("Expected result : 0\n");
-		printf("Actual result : -1\n");
-		myStringFree(str1);
-		myStringFree(str2);
+		strs[i] = myStringAlloc();
+		myStringSetFromInt(strs[i], i * 7919);
+		keys[i] = myStringGetView(strs[i]);
+	}
+	MyStringBloomFilter *filter = myStringBloomFilterAlloc(1000, 10);
+	bool results[2000];
+	bool isRight = filter != NULL &&
+				   myStringBloomFilterAddBatch(filter, keys, 999) == MYSTRING_SUCCESS &&
+				   myStringBloomFilterAdd(filter, keys[999]) == MYSTRING_SUCCESS &&
+				   myStringBloomFilterContainsBatch(filter, keys, 2000, results) == MYSTRING_SUCCESS;
+	int falsePositives = 0;
+	for (int i = 0; i < 2000 && isRight; i++)
+	{
+		isRight = i >= 1000 || results[i];
+		falsePositives += i >= 1000 && results[i];
+		isRight = isRight && myStringBloomFilterContains(filter, keys[i]) == (results[i] ? TRUE : FALSE);
+	}
+	// A filter read back answers the same.
+	FILE *file = tmpfile();
+	MyStringBloomFilter *read = NULL;
+	bool readResults[2000];
+	isRight = isRight && file != NULL && myStringBloomFilterWrite(filter, file) == MYSTRING_SUCCESS;
+	if (isRight)
+	{
+		rewind(file);
+		read = myStringBloomFilterRead(file);
+		isRight = read != NULL &&
+				  myStringBloomFilterContainsBatch(read, keys, 2000, readResults) == MYSTRING_SUCCESS &&
+				  memcmp(results, readResults, sizeof(results)) == 0;
+		// Which isn't a cuckoo filter.
+		rewind(file);
+		isRight = isRight && myStringCuckooFilterRead(file) == NULL;
+	}
+	if (!isRight || falsePositives > 30)
+	{
+		printf("Expected result : all the keys added, at most 30 false positives\n");
+		printf("Actual result : %d false positives\n", falsePositives);
 		exitBad(testName);
 	}
 	printf("PASS\n");
-	free(newChars);
-	free(oldChars);
-	newChars = NULL;
-	oldChars = NULL;
-	myStringFree(str1);
-	myStringFree(str2);
+	if (file != NULL)
+	{
+		fclose(file);
+	}
+	myStringBloomFilterFree(filter);
+	myStringBloomFilterFree(read);
+	for (int i = 0; i < 2000; i++)
+	{
+		myStringFree(strs[i]);
+	}
 }
 
-static void myStringSetFromMyStringNormal()
+// ------------------------------ myStringCuckooFilter -----------------------------
+
+static void myStringCuckooFilterNormal()
 {
-	char *testName = "myStringSetFromMyStringNormal";
+	char *testName = "myStringCuckooFilterNormal";
 	printf("Running %s\n", testName);
-	MyString *str1 = myStringAlloc();
-	MyString *str2 = myStringAlloc();
-
-	int retVal = myStringSetFromMyString(str1, str2);
-	if (retVal != MYSTRING_SUCCESS)
+	MyString *strs[2000];
+	MyStringView keys[2000];
+	for (int i = 0; i < 2000; i++)
 	{
-		printf("Expected result : 0\n");
-		printf("Actual result : -1\n");
+		strs[i] = myStringAlloc();
+		myStringSetFromInt(strs[i], i * 7919);
+		keys[i] = myStringGetView(strs[i]);
+	}
+	MyStringCuckooFilter *filter = myStringCuckooFilterAlloc(1000);
+	bool results[2000];
+	bool isRight = filter != NULL &&
+				   myStringCuckooFilterAddBatch(filter, keys, 1000) == MYSTRING_SUCCESS &&
+				   myStringCuckooFilterContainsBatch(filter, keys, 2000, results) == MYSTRING_SUCCESS;
+	int falsePositives = 0;
+	for (int i = 0; i < 2000 && isRight; i++)
+	{
+		isRight = i >= 1000 || results[i];
+		falsePositives += i >= 1000 && results[i];
+	}
+	// Removed keys are gone, and the others are still there.
+	for (int i = 0; i < 500 && isRight; i++)
+	{
+		isRight = myStringCuckooFilterRemove(filter, keys[i]) == TRUE;
+	}
+	int removedLeft = 0;
+	for (int i = 0; i < 1000 && isRight; i++)
+	{
+		int contains = myStringCuckooFilterContains(filter, keys[i]);
+		isRight = i < 500 || contains == TRUE;
+		removedLeft += i < 500 && contains == TRUE;
+	}
+	FILE *file = tmpfile();
+	MyStringCuckooFilter *read = NULL;
+	isRight = isRight && file != NULL && myStringCuckooFilterWrite(filter, file) == MYSTRING_SUCCESS;
+	if (isRight)
+	{
+		rewind(file);
+		read = myStringCuckooFilterRead(file);
+		for (int i = 500; i < 1000 && isRight; i++)
+		{
+			isRight = read != NULL && myStringCuckooFilterContains(read, keys[i]) == TRUE;
+		}
+	}
+	// Adding more keys than it has room for fills it, and then keys aren't added.
+	isRight = isRight && myStringCuckooFilterAddBatch(read, keys, 2000) == MYSTRING_ERROR &&
+			  myStringCuckooFilterAdd(read, keys[0]) == MYSTRING_ERROR;
+	if (!isRight || falsePositives > 2 || removedLeft > 2)
+	{
+		printf("Expected result : all the keys, at most 2 false positives\n");
+		printf("Actual result : %d false positives, %d removed keys left\n", falsePositives,
+			   removedLeft);
 		exitBad(testName);
 	}
 	printf("PASS\n");
-
-	myStringFree(str1);
-	myStringFree(str2);
+	if (file != NULL)
+	{
+		fclose(file);
+	}
+	myStringCuckooFilterFree(filter);
+	myStringCuckooFilterFree(read);
+	for (int i = 0; i < 2000; i++)
+	{
+		myStringFree(strs[i]);
+	}
 }
 
-// ------------------------------ myStringFilter -----------------------------
+// ------------------------------ myStringReplaceAll -----------------------------
 
-static bool filt(const char *c)
+static void myStringReplaceAllNormal()
 {
-	if (*c < 'g' && 'a' < *c)
+	char *testName = "myStringReplaceAllNormal";
+	printf("Running %s\n", testName);
+	MyString *str = myStringAlloc();
+	MyString *empty = myStringAlloc();
+	MyStringView dash = {"-", 1};
+	MyStringView colons = {"::", 2};
+	MyStringView nothing = {"", EMPTY_STRING_LENGTH};
+	MyStringView missing = {"abcde", 5};
+	MyStringView needle = {"needle", 6};
+	MyStringView n = {"n", 1};
+	// Longer replacements, shorter ones and no occurrences.
+	myStringSetFromCString(str, "a-b-c-d-");
+	bool isRight = myStringReplaceAll(str, dash, colons) == MYSTRING_SUCCESS &&
+				   strcmp(myStringCStr(str), "a::b::c::d::") == 0 &&
+				   myStringReplaceAll(str, colons, nothing) == MYSTRING_SUCCESS &&
+				   strcmp(myStringCStr(str), "abcd") == 0 &&
+				   myStringReplaceAll(str, missing, dash) == MYSTRING_SUCCESS &&
+				   strcmp(myStringCStr(str), "abcd") == 0 &&
+				   myStringReplaceAll(str, nothing, dash) == MYSTRING_ERROR &&
+				   strcmp(myStringCStr(str), "abcd") == 0 &&
+				   myStringReplaceAll(empty, dash, colons) == MYSTRING_SUCCESS &&
+				   myStringLen(empty) == EMPTY_STRING_LENGTH;
+	// Enough chars for whole blocks, with occurrences across them.
+	myStringSetFromCString(str, "");
+	for (int i = 0; i < 100; i++)
 	{
-		return true;
+		myStringAppendView(str, needle);
+		myStringAppendView(str, dash);
 	}
-	return false;
+	isRight = isRight && myStringReplaceAll(str, needle, n) == MYSTRING_SUCCESS &&
+			  myStringLen(str) == 200;
+	for (int i = 0; i < 200 && isRight; i++)
+	{
+		isRight = myStringCStr(str)[i] == (i % 2 == 0 ? 'n' : '-');
+	}
+	// Views of the string itself.
+	myStringSetFromCString(str, "abXab");
+	MyStringView ab = {myStringCStr(str), 2};
+	MyStringView b = {myStringCStr(str) + 1, 1};
+	isRight = isRight && myStringReplaceAll(str, ab, b) == MYSTRING_SUCCESS &&
+			  strcmp(myStringCStr(str), "bXb") == 0;
+	if (!isRight)
+	{
+		printf("Expected result : bXb\n");
+		printf("Actual result : %s\n", myStringCStr(str));
+		exitBad(testName);
+	}
+	printf("PASS\n");
+	myStringFree(str);
+	myStringFree(empty);
 }
 
-static void myStringFilterNormal()
+static void myStringReplaceAllMatchesNormal()
 {
-	char *testName = "myStringFilterNormal";
+	char *testName = "myStringReplaceAllMatchesNormal";
 	printf("Running %s\n", testName);
+	MyStringView needles[] = {{"he", 2}, {"she", 3}, {"his", 3}, {"hers", 4}, {"he", 2}};
+	MyStringView replacements[] = {{"1", 1}, {"2", 1}, {"3", 1}, {"4", 1}, {"5", 1}};
+	MyStringView prefixes[] = {{"ab", 2}, {"abcd", 4}};
+	MyStringView prefixReplacements[] = {{"X", 1}, {"", EMPTY_STRING_LENGTH}};
+	MyStringView emptyNeedles[] = {{"a", 1}, {"", EMPTY_STRING_LENGTH}};
+	MyStringMatcher *matcher = myStringMatcherAlloc(needles, 5);
+	MyStringMatcher *prefixMatcher = myStringMatcherAlloc(prefixes, 2);
+	MyStringMatcher *noMatcher = myStringMatcherAlloc(NULL, 0);
 	MyString *str = myStringAlloc();
-	myStringSetFromCString(str, "abcz");
-	myStringFilter(str, filt);
-	char *newChars = myStringToCString(str);
-	int result = strcmp(newChars, "bc");
-	if (result != 0)
+	// The first occurrence wins, and then the longest at the same place.
+	myStringSetFromCString(str, "ushers ahishe hers");
+	bool isRight = matcher != NULL && prefixMatcher != NULL && noMatcher != NULL &&
+				   myStringReplaceAllMatches(str, matcher, replacements) == MYSTRING_SUCCESS &&
+				   strcmp(myStringCStr(str), "u2rs a31 4") == 0 &&
+				   myStringSetFromCString(str, "abcdabcab") == MYSTRING_SUCCESS &&
+				   myStringReplaceAllMatches(str, prefixMatcher, prefixReplacements) ==
+				   MYSTRING_SUCCESS &&
+				   strcmp(myStringCStr(str), "XcX") == 0 &&
+				   myStringReplaceAllMatches(str, noMatcher, NULL) == MYSTRING_SUCCESS &&
+				   strcmp(myStringCStr(str), "XcX") == 0 &&
+				   myStringMatcherAlloc(emptyNeedles, 2) == NULL;
+	if (!isRight)
 	{
-		printf("Expected result : bc\n");
-		printf("Actual result : %s\n", newChars);
-		myStringFree(str);
+		printf("Expected result : XcX\n");
+		printf("Actual result : %s\n", myStringCStr(str));
 		exitBad(testName);
 	}
 	printf("PASS\n");
-	free(newChars);
-	newChars = NULL;
 	myStringFree(str);
+	myStringMatcherFree(matcher);
+	myStringMatcherFree(prefixMatcher);
+	myStringMatcherFree(noMatcher);
 }
-// ------------------------------ myStringSetFromCString -----------------------------
 
-static void myStringSetFromCStringNormal()
+// ------------------------------ myStringTopK -----------------------------
+
+static void myStringTopKNormal()
 {
-	char *testName = "myStringSetFromCStringNormal";
+	char *testName = "myStringTopKNormal";
+	printf("Running %s\n", testName);
+	const int count = 1000;
+	const int shared = 40;
+	MyString *strs[1000];
+	MyString *arr[1000];
+	MyString *sorted[1000];
+	for (int i = 0; i < count; i++)
+	{
+		strs[i] = myStringAlloc();
+		// Some of the strings share their prefix keys, and some are equal.
+		if (i < shared)
+		{
+			myStringSetFromCString(strs[i], "a long shared prefix ");
+		}
+		myStringAppendInt(strs[i], (i * 7919) % 997);
+		sorted[i] = strs[i];
+	}
+	myStringSort(sorted, count);
+	bool isRight = true;
+	const unsigned long ks[] = {0, 1, 10, 500, 999, 1000, 2000};
+	for (int comparison = 0; comparison < 2 && isRight; comparison++)
+	{
+		int (*comparator) (const void *, const void *) =
+			comparison == 0 ? NULL : myStringCustomComparator;
+		for (int j = 0; j < 7 && isRight; j++)
+		{
+			memcpy(arr, strs, sizeof(arr));
+			isRight = myStringTopK(arr, count, ks[j], comparator) == MYSTRING_SUCCESS;
+			for (unsigned long i = 0; i < ks[j] && i < (unsigned long) count && isRight; i++)
+			{
+				MyString *expected = comparison == 0 ? sorted[i] : sorted[count - 1 - i];
+				isRight = myStringEqual(arr[i], expected) == TRUE;
+			}
+		}
+	}
+	// The nth string, with no bigger one before it and no smaller one after it.
+	for (int nth = 0; nth < count && isRight; nth += 111)
+	{
+		memcpy(arr, strs, sizeof(arr));
+		isRight = myStringNthElement(arr, count, nth, NULL) == MYSTRING_SUCCESS &&
+				  myStringEqual(arr[nth], sorted[nth]) == TRUE;
+		for (int i = 0; i < count && isRight; i++)
+		{
+			int compared = myStringCompare(arr[i], arr[nth]);
+			isRight = i < nth ? compared <= EQUAL_STRINGS : compared >= EQUAL_STRINGS;
+		}
+	}
+	isRight = isRight && myStringNthElement(arr, count, count, NULL) == MYSTRING_ERROR;
+	if (!isRight)
+	{
+		printf("Expected result : the strings of myStringSort\n");
+		printf("Actual result : different strings\n");
+		exitBad(testName);
+	}
+	printf("PASS\n");
+	for (int i = 0; i < count; i++)
+	{
+		myStringFree(strs[i]);
+	}
+}
+
+static void myStringTopKStreamNormal()
+{
+	char *testName = "myStringTopKStreamNormal";
 	printf("Running %s\n", testName);
+	const unsigned long k = 20;
+	MyStringTopKStream *stream = myStringTopKStreamAlloc(k, NULL);
 	MyString *str = myStringAlloc();
-	myStringSetFromCString(str, "abcde");
-	char *newChars = myStringToCString(str);
-	int result = strcmp(newChars, "abcde");
-	if (result != 0)
+	MyString *arr[20];
+	unsigned long n = 0;
+	bool isRight = stream != NULL &&
+				   myStringTopKStreamTake(stream, arr, &n) == MYSTRING_SUCCESS && n == 0;
+	// The numbers from 0 to 9999 in a shuffled order, whose first 20 are 0 to 19 as
+	// strings: 0, 1, 10, 100, 1000, 1001, ...
+	for (int i = 0; i < 10000 && isRight; i++)
 	{
-		printf("Expected result : abcde\n");
-		printf("Actual result : %s\n", newChars);
+		myStringSetFromInt(str, (i * 7919) % 10000);
+		isRight = myStringTopKStreamPush(stream, str) == MYSTRING_SUCCESS;
+	}
+	const char *expected[] = {"0", "1", "10", "100", "1000", "1001", "1002", "1003"};
+	isRight = isRight && myStringTopKStreamTake(stream, arr, &n) == MYSTRING_SUCCESS && n == k;
+	for (unsigned long i = 0; i < 8 && isRight; i++)
+	{
+		isRight = strcmp(myStringCStr(arr[i]), expected[i]) == 0;
+	}
+	for (unsigned long i = 1; i < n && isRight; i++)
+	{
+		isRight = myStringCompare(arr[i - 1], arr[i]) < EQUAL_STRINGS;
+	}
+	for (unsigned long i = 0; i < n; i++)
+	{
+		myStringFree(arr[i]);
+	}
+	// The stream starts over after its strings are taken.
+	myStringSetFromCString(str, "again");
+	isRight = isRight && myStringTopKStreamPush(stream, str) == MYSTRING_SUCCESS &&
+			  myStringTopKStreamTake(stream, arr, &n) == MYSTRING_SUCCESS && n == 1 &&
+			  strcmp(myStringCStr(arr[0]), "again") == 0;
+	if (isRight)
+	{
+		myStringFree(arr[0]);
+	}
+	if (!isRight)
+	{
+		printf("Expected result : 0, 1, 10, 100, 1000, ...\n");
+		printf("Actual result : %lu strings\n", n);
 		exitBad(testName);
 	}
 	printf("PASS\n");
-	free(newChars);
-	newChars = NULL;
+	myStringTopKStreamFree(stream);
 	myStringFree(str);
 }
 
-// ------------------------------ myStringSetFromInt -----------------------------
-static void myStringSetFromIntNormal()
+// ------------------------------ myStringSortUnique -----------------------------
+
+static void myStringSortUniqueNormal()
+{
+	char *testName = "myStringSortUniqueNormal";
+	printf("Running %s\n", testName);
+	// Strings which share their prefix keys, with an embedded '\0', and duplicates.
+	const char *cStrings[] = {"b", "a long string", "a", "a long string too", "b",
+							  "a long string", "", "a", "b", "a long string too"};
+	const int count = 12;
+	const char *expected[] = {"", "a", "a\0", "a long string", "a long string too", "b"};
+	const unsigned long expectedLengths[] = {0, 1, 2, 13, 17, 1};
+	const unsigned long expectedCounts[] = {1, 2, 2, 2, 2, 3};
+	MyString *strs[12];
+	MyString *arr[12];
+	unsigned long counts[12];
+	for (int i = 0; i < 10; i++)
+	{
+		strs[i] = myStringAlloc();
+		myStringSetFromCString(strs[i], cStrings[i]);
+	}
+	MyStringView zeroEnded = {"a\0", 2};
+	for (int i = 10; i < count; i++)
+	{
+		strs[i] = myStringAlloc();
+		myStringAppendView(strs[i], zeroEnded);
+	}
+	unsigned long uniqueLen = 0;
+	bool isRight = true;
+	for (int variant = 0; variant < 2 && isRight; variant++)
+	{
+		memcpy(arr, strs, sizeof(arr));
+		isRight = variant == 0 ?
+				  myStringSortUnique(arr, count, &uniqueLen, counts) == MYSTRING_SUCCESS :
+				  myStringCountDistinct(arr, count, &uniqueLen, counts) == MYSTRING_SUCCESS;
+		isRight = isRight && uniqueLen == 6;
+		// The hash keeps the order the strings first occur in: b, a long string, a, ...
+		const int distinctOrder[] = {5, 3, 1, 4, 0, 2};
+		for (int i = 0; i < 6 && isRight; i++)
+		{
+			int j = variant == 0 ? i : distinctOrder[i];
+			isRight = myStringLen(arr[i]) == expectedLengths[j] &&
+					  memcmp(myStringCStr(arr[i]), expected[j], expectedLengths[j]) == 0 &&
+					  counts[i] == expectedCounts[j];
+		}
+		// The first occurrences are kept, and every string is still there once.
+		isRight = isRight && arr[variant == 0 ? 1 : 2] == strs[2] &&
+				  arr[variant == 0 ? 5 : 0] == strs[0];
+		for (int i = 0; i < count && isRight; i++)
+		{
+			int occurrences = 0;
+			for (int j = 0; j < count; j++)
+			{
+				occurrences += arr[j] == strs[i];
+			}
+			isRight = occurrences == 1;
+		}
+	}
+	isRight = isRight && myStringSortUnique(arr, 0, &uniqueLen, NULL) == MYSTRING_SUCCESS &&
+			  uniqueLen == 0;
+	if (!isRight)
+	{
+		printf("Expected result : 6 distinct strings\n");
+		printf("Actual result : %lu distinct strings\n", uniqueLen);
+		exitBad(testName);
+	}
+	printf("PASS\n");
+	for (int i = 0; i < count; i++)
+	{
+		myStringFree(strs[i]);
+	}
+}
+
+static void myStringSortUniqueMany()
+{
+	char *testName = "myStringSortUniqueMany";
+	printf("Running %s\n", testName);
+	const int count = 3000;
+	MyString *strs[3000];
+	MyString *arr[3000];
+	MyString *hashed[3000];
+	unsigned long counts[3000];
+	unsigned long hashedCounts[3000];
+	for (int i = 0; i < count; i++)
+	{
+		strs[i] = myStringAlloc();
+		myStringSetFromCString(strs[i], "shared prefix ");
+		myStringAppendInt(strs[i], (i * 7919) % 1000);
+		arr[i] = strs[i];
+		hashed[i] = strs[i];
+	}
+	unsigned long uniqueLen = 0;
+	unsigned long distinctLen = 0;
+	bool isRight = myStringSortUnique(arr, count, &uniqueLen, counts) == MYSTRING_SUCCESS &&
+				   myStringCountDistinct(hashed, count, &distinctLen, hashedCounts) ==
+				   MYSTRING_SUCCESS &&
+				   uniqueLen == 1000 && distinctLen == 1000;
+	for (unsigned long i = 0; i < uniqueLen && isRight; i++)
+	{
+		isRight = counts[i] == 3 && hashedCounts[i] == 3 &&
+				  (i == 0 || myStringCompare(arr[i - 1], arr[i]) < EQUAL_STRINGS);
+	}
+	if (!isRight)
+	{
+		printf("Expected result : 1000 distinct strings, 3 of each\n");
+		printf("Actual result : %lu and %lu distinct strings\n", uniqueLen, distinctLen);
+		exitBad(testName);
+	}
+	printf("PASS\n");
+	for (int i = 0; i < count; i++)
+	{
+		myStringFree(strs[i]);
+	}
+}
+
+// ------------------------------ myStringGlob -----------------------------
+
+static void myStringGlobNormal()
 {
-	char *testName = "myStringSetFromIntNormal";
+	char *testName = "myStringGlobNormal";
 	printf("Running %s\n", testName);
-	MyString *str = myStringAlloc();
-	myStringSetFromInt(str, 123456789);
-	char *chars = myStringToCString(str);
-	int result = strcmp(chars, "123456789");
-	if (result != 0)
+	const char *cases[][2] = {
+		{"*.c", "main.c"}, {"**.c", "src/main.c"}, {"src/**/*.c", "src/main.c"},
+		{"src/**/*.c", "src/a/b/main.c"}, {"**/x", "x"}, {"**/x", "a/b/x"}, {"?at", "cat"},
+		{"[a-c]at", "bat"}, {"[!a-c]at", "rat"}, {"[]]", "]"}, {"a\\*b", "a*b"}, {"", ""},
+		{"*", ""}, {"a*b*c", "abbbc"}, {"/api/v1/users/*", "/api/v1/users/42"},
+		{"a/**/**/b", "a/b"}, {"a/**", "a/b/c"}, {"a**b", "a/x/b"},
+		{"*.c", "src/main.c"}, {"src/**/*.c", "src/a/main.h"}, {"?at", "at"},
+		{"[!a-c]at", "bat"}, {"a\\*b", "axb"}, {"", "a"}, {"a*b*c", "acb"},
+		{"/api/v1/users/*", "/api/v1/users/42/posts"}, {"a?b", "a/b"}, {"[!x]", "/"},
+		{"a/**/b", "ab"}, {"src/**/*.c", "source/main.c"}};
+	const int matching = 18;
+	const int count = 30;
+	bool isRight = true;
+	int i = 0;
+	for (i = 0; i < count && isRight; i++)
 	{
-		printf("Expected result : 123456789\n");
-		printf("Actual result : %s\n", chars);
-		exitBad(testName);
+		MyStringView pattern = {cases[i][0], strlen(cases[i][0])};
+		MyStringView str = {cases[i][1], strlen(cases[i][1])};
+		MyStringGlob *glob = myStringGlobCompile(&pattern, 1);
+		isRight = glob != NULL && myStringGlobMatch(glob, str) == (i < matching ? TRUE : FALSE);
+		myStringGlobFree(glob);
 	}
-	free(chars);
-	myStringSetFromInt(str, -123456789);
-	chars = myStringToCString(str);
-	result = strcmp(chars, "-123456789");
-	if (result != 0)
+	MyStringView unclosed = {"a[bc", 4};
+	isRight = isRight && myStringGlobCompile(&unclosed, 1) == NULL;
+	if (!isRight)
 	{
-		printf("Expected result : -123456789\n");
-		printf("Actual result : %s\n", chars);
-		myStringFree(str);
+		printf("Expected result : %s\n", i <= matching ? "a match" : "no match");
+		printf("Actual result : the opposite for %s and %s\n", cases[i - 1][0], cases[i - 1][1]);
 		exitBad(testName);
 	}
 	printf("PASS\n");
-	free(chars);
-	chars = NULL;
-	myStringFree(str);
 }
 
-// ------------------------------ myStringToInt -----------------------------
-static void myStringToIntNormal()
+static void myStringGlobSet()
 {
-	char *testName = "myStringToIntNormal";
+	char *testName = "myStringGlobSet";
 	printf("Running %s\n", testName);
-	MyString *str = myStringAlloc();
-	myStringSetFromCString(str, "123456");
-	int num = myStringToInt(str);
-	if (num != 123456)
+	// Long patterns, whose states cross words, with literal prefixes of all lengths.
+	const int count = 60;
+	MyString *patternStrs[60];
+	MyStringView patterns[60];
+	for (int i = 0; i < count; i++)
 	{
-		printf("Expected result : 123456\n");
-		printf("Actual result : %d\n", num);
-		exitBad(testName);
+		patternStrs[i] = myStringAlloc();
+		myStringSetf(patternStrs[i], i % 3 == 0 ? "/service/%d/**/resource/*/detail" :
+					 (i % 3 == 1 ? "*/service/%d/[a-m]*" : "/service/%d/exact/path/of/it"), i);
+		patterns[i] = myStringGetView(patternStrs[i]);
 	}
-	myStringSetFromCString(str, "-123456");
-	num = myStringToInt(str);
-	if (num != -123456)
+	MyStringGlob *glob = myStringGlobCompile(patterns, count);
+	MyString *path = myStringAlloc();
+	bool matches[60];
+	bool isRight = glob != NULL;
+	for (int i = 0; i < count && isRight; i++)
 	{
-		printf("Expected result : -123456\n");
-		printf("Actual result : %d\n", num);
+		myStringSetf(path, i % 3 == 0 ? "/service/%d/a/b/resource/7/detail" :
+					 (i % 3 == 1 ? "x/service/%d/long" : "/service/%d/exact/path/of/it"), i);
+		isRight = myStringGlobMatchAll(glob, myStringGetView(path), matches) ==
+				  MYSTRING_SUCCESS && myStringGlobMatch(glob, myStringGetView(path)) == TRUE;
+		// Every pattern matches alone as it does in the set.
+		for (int j = 0; j < count && isRight; j++)
+		{
+			MyStringGlob *single = myStringGlobCompile(&patterns[j], 1);
+			isRight = single != NULL && matches[j] == (i == j) &&
+					  myStringGlobMatch(single, myStringGetView(path)) == (i == j ? TRUE : FALSE);
+			myStringGlobFree(single);
+		}
+	}
+	myStringSetFromCString(path, "/service/1/nothing");
+	isRight = isRight && myStringGlobMatch(glob, myStringGetView(path)) == FALSE;
+	if (!isRight)
+	{
+		printf("Expected result : every path matches its pattern only\n");
+		printf("Actual result : %s doesn't\n", myStringCStr(path));
 		exitBad(testName);
 	}
 	printf("PASS\n");
-	myStringFree(str);
+	myStringGlobFree(glob);
+	myStringFree(path);
+	for (int i = 0; i < count; i++)
+	{
+		myStringFree(patternStrs[i]);
+	}
 }
 
-// ------------------------------ myStringToCString -----------------------------
 
-static void myStringToCStringNormal()
+// ------------------------------ myStringChunker -----------------------------
+
+/**
+ * @brief Cuts a view into chunks of a chunker with the given sizes.
+ * @return the number of chunks, and -1 if they don't cover the view in order or their
+ * sizes are out of bounds.
+ */
+static int cutChunks(MyStringView data, MyStringView chunks[], int maxChunks)
 {
-	char *testName = "myStringToCStringNormal";
+	MyStringChunker chunker;
+	if (myStringChunkerInit(&chunker, data, 256, 1024, 4096) != MYSTRING_SUCCESS)
+	{
+		return -1;
+	}
+	int n = 0;
+	unsigned long offset = 0;
+	MyStringView chunk;
+	while (n < maxChunks && myStringChunkerNext(&chunker, &chunk) == TRUE)
+	{
+		if (chunk._chars != data._chars + offset || chunk._length > 4096 ||
+			(chunk._length < 256 && offset + chunk._length != data._length))
+		{
+			return -1;
+		}
+		offset += chunk._length;
+		chunks[n++] = chunk;
+	}
+	return offset == data._length ? n : -1;
+}
+
+static void myStringChunkerNormal()
+{
+	char *testName = "myStringChunkerNormal";
 	printf("Running %s\n", testName);
-	MyString *str = myStringAlloc();
-	myStringSetFromCString(str, "Hey there");
-	char* cStr = myStringToCString(str);
-	int result = strcmp(cStr, "Hey there");
-	if (result != 0)
+	MyString *data = myStringAlloc();
+	MyString *edited = myStringAlloc();
+	unsigned long long state = 1;
+	for (int i = 0; i < 64 * 1024; i++)
 	{
-		printf("Expected result : 0\n");
-		printf("Actual result : %d\n", result);
+		state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+		char c = (char) ('a' + (state >> 33) % 26);
+		myStringAppendView(data, (MyStringView) {&c, 1});
+	}
+	// The same data with chars inserted in its middle.
+	myStringAppendView(edited, (MyStringView) {myStringCStr(data), 30000});
+	myStringAppendView(edited, (MyStringView) {"inserted", 8});
+	myStringAppendView(edited, (MyStringView) {myStringCStr(data) + 30000, 64 * 1024 - 30000});
+	MyStringView chunks[256];
+	MyStringView editedChunks[256];
+	int n = cutChunks(myStringGetView(data), chunks, 256);
+	int editedN = cutChunks(myStringGetView(edited), editedChunks, 256);
+	// The chunks other than those around the insertion are the same.
+	int same = 0;
+	for (int i = 0; i < n; i++)
+	{
+		for (int j = 0; j < editedN; j++)
+		{
+			same += chunks[i]._length == editedChunks[j]._length &&
+					memcmp(chunks[i]._chars, editedChunks[j]._chars, chunks[i]._length) == 0;
+		}
+	}
+	MyStringChunker chunker;
+	MyStringView chunk;
+	bool isRight = n > 16 && editedN > 16 && same >= n - 2 &&
+				   myStringChunkerInit(&chunker, (MyStringView) {"", 0}, 1, 8, 8) ==
+				   MYSTRING_SUCCESS && myStringChunkerNext(&chunker, &chunk) == FALSE &&
+				   myStringChunkerInit(&chunker, myStringGetView(data), 9, 8, 16) ==
+				   MYSTRING_ERROR && myStringChunkerInit(&chunker, myStringGetView(data), 1, 4, 16) ==
+				   MYSTRING_ERROR && myStringChunkerNext(NULL, &chunk) == MYSTR_ERROR_CODE;
+	if (!isRight)
+	{
+		printf("Expected result : chunks which cover the data and survive an insertion\n");
+		printf("Actual result : %d chunks, %d chunks after it, %d the same\n", n, editedN, same);
 		exitBad(testName);
 	}
 	printf("PASS\n");
-	free(cStr);
-	cStr = NULL;
-	myStringFree(str);
+	myStringFree(data);
+	myStringFree(edited);
 }
 
-// ------------------------------ myStringCat -----------------------------
+// ------------------------------ myStringWinnow -----------------------------
 
-static void myStringCatNormal()
+static void myStringWinnowNormal()
 {
-	char *testName = "myStringCatNormal";
+	char *testName = "myStringWinnowNormal";
 	printf("Running %s\n", testName);
-	MyString *dest = myStringAlloc();
-	myStringSetFromCString(dest, "Hey there");
-	MyString *src = myStringAlloc();
-	myStringSetFromCString(src, " Delilah don't you worry about the distance");
-	int result = myStringCat(dest, src);
-	if (result != 0)
+	const char *shared = "the quick brown fox jumps over the lazy dog";
+	MyString *text1 = myStringAlloc();
+	MyString *text2 = myStringAlloc();
+	myStringSetf(text1, "some text before it, %s, and some after it", shared);
+	myStringSetf(text2, "a different start: %s! and end", shared);
+	MyStringFingerprint fingerprints1[64];
+	MyStringFingerprint fingerprints2[64];
+	unsigned long count1 = 0;
+	unsigned long count2 = 0;
+	bool isRight = myStringWinnow(myStringGetView(text1), 5, 4, fingerprints1, 64, &count1) ==
+				   MYSTRING_SUCCESS &&
+				   myStringWinnow(myStringGetView(text2), 5, 4, fingerprints2, 64, &count2) ==
+				   MYSTRING_SUCCESS && count1 <= 64 && count2 <= 64;
+	// A fingerprint in every window, in order, and one of the shared text in both.
+	bool isShared = false;
+	for (unsigned long i = 0; i < count1 && isRight; i++)
 	{
-		printf("Expected result : 0\n");
-		printf("Actual result : %d\n", result);
+		isRight = (i == 0 ? fingerprints1[i]._offset < 4 :
+				   fingerprints1[i]._offset > fingerprints1[i - 1]._offset &&
+				   fingerprints1[i]._offset - fingerprints1[i - 1]._offset <= 4);
+		for (unsigned long j = 0; j < count2; j++)
+		{
+			isShared = isShared || fingerprints1[i]._hash == fingerprints2[j]._hash;
+		}
+	}
+	unsigned long count = 0;
+	isRight = isRight && isShared &&
+			  myStringWinnow(myStringGetView(text1), 5, 4, fingerprints2, 1, &count) ==
+			  MYSTRING_SUCCESS && count == count1 && fingerprints2[0]._hash == fingerprints1[0]._hash &&
+			  myStringWinnow((MyStringView) {"abc", 3}, 2, 8, NULL, 0, &count) ==
+			  MYSTRING_SUCCESS && count == 1 &&
+			  myStringWinnow((MyStringView) {"abc", 3}, 4, 8, NULL, 0, &count) ==
+			  MYSTRING_SUCCESS && count == 0 &&
+			  myStringWinnow((MyStringView) {"abc", 3}, 1, 0, NULL, 0, &count) == MYSTRING_ERROR;
+	if (!isRight)
+	{
+		printf("Expected result : fingerprints in every window, some of the shared text\n");
+		printf("Actual result : %lu and %lu fingerprints, shared: %d\n", count1, count2, isShared);
 		exitBad(testName);
 	}
 	printf("PASS\n");
-
-	myStringFree(dest);
-	myStringFree(src);
+	myStringFree(text1);
+	myStringFree(text2);
 }
 
-// ------------------------------ myStringCatTo -----------------------------
+// ------------------------------ myStringArray -----------------------------
 
-static void myStringCatToNormal()
+static void myStringAllocArrayNormal()
 {
-	char *testName = "myStringCatToNormal";
+	char *testName = "myStringAllocArrayNormal";
 	printf("Running %s\n", testName);
-	MyString *str1 = myStringAlloc();
-	myStringSetFromCString(str1, "Hey there");
-	MyString *str2 = myStringAlloc();
-	myStringSetFromCString(str2, " Delilah don't you worry about the distance");
-	MyString *str3 = myStringAlloc();
-	int result = myStringCatTo(str1, str2, str3);
-	if (result != 0)
+	MyString **arr = myStringAllocArray(100);
+	bool isRight = arr != NULL;
+	for (int i = 0; i < 100 && isRight; i++)
 	{
-		printf("Expected result : 0\n");
-		printf("Actual result : %d\n", result);
+		isRight = myStringLen(arr[i]) == 0 && strcmp(myStringCStr(arr[i]), "") == 0 &&
+				  myStringSetFromInt(arr[i], 99 - i) == MYSTRING_SUCCESS;
+	}
+	myStringSort(arr, 100);
+	// Sorted as strings, "0" < "1" < "10" < ...
+	isRight = isRight && strcmp(myStringCStr(arr[0]), "0") == 0 &&
+			  strcmp(myStringCStr(arr[2]), "10") == 0 && strcmp(myStringCStr(arr[99]), "99") == 0;
+	MyString **empty = myStringAllocArray(0);
+	isRight = isRight && empty != NULL;
+	if (!isRight)
+	{
+		printf("Expected result : 100 strings which can be set and sorted\n");
+		printf("Actual result : they can't\n");
 		exitBad(testName);
 	}
 	printf("PASS\n");
-
-	myStringFree(str1);
-	myStringFree(str2);
-	myStringFree(str3);
+	myStringFreeArray(arr);
+	myStringFreeArray(empty);
+	myStringFreeArray(NULL);
 }
-// ------------------------------ myStringCompare -----------------------------
-static void myStringCompareNormal()
+
+static void myStringArrayFromLinesNormal()
 {
-	char *testName = "myStringCompare";
+	char *testName = "myStringArrayFromLinesNormal";
 	printf("Running %s\n", testName);
-	MyString *str1 = myStringAlloc();
-	myStringSetFromCString(str1, "abc");
-	MyString *str2 = myStringAlloc();
-	myStringSetFromCString(str2, "abcd");
-	int result = myStringCompare(str1, str2);
-	if (result != STR2_BIGGER)
-	{
-		printf("Expected result : -1\n");
-		printf("Actual result : %d\n", result);
-		exitBad(testName);
-	}
-	myStringSetFromCString(str2, "ab");
-	result = myStringCompare(str1, str2);
-	if (result != STR1_BIGGER)
+	const char *text = "first\n\nthird\r\nlast";
+	unsigned long n = 0;
+	MyString **arr = myStringArrayFromLines((MyStringView) {text, strlen(text)}, &n);
+	bool isRight = arr != NULL && n == 4 && strcmp(myStringCStr(arr[0]), "first") == 0 &&
+				   myStringLen(arr[1]) == 0 && strcmp(myStringCStr(arr[2]), "third\r") == 0 &&
+				   strcmp(myStringCStr(arr[3]), "last") == 0;
+	// A change gives a string chars of its own, and leaves its neighbours alone.
+	isRight = isRight && myStringAppendView(arr[0], (MyStringView) {" line", 5}) ==
+			  MYSTRING_SUCCESS && strcmp(myStringCStr(arr[0]), "first line") == 0 &&
+			  myStringSetFromCString(arr[2], "") == MYSTRING_SUCCESS &&
+			  strcmp(myStringCStr(arr[2]), "") == 0 && strcmp(myStringCStr(arr[3]), "last") == 0;
+	myStringFreeArray(arr);
+	arr = myStringArrayFromLines((MyStringView) {"a\nb\n", 4}, &n);
+	isRight = isRight && arr != NULL && n == 2 && strcmp(myStringCStr(arr[1]), "b") == 0;
+	myStringFreeArray(arr);
+	// Enough lines for the counts of the '\n' to be summed up more than once.
+	MyString *manyLines = myStringAlloc();
+	for (int i = 0; i < 1000; i++)
 	{
-		printf("Expected result : 1\n");
-		printf("Actual result : %d\n", result);
-		exitBad(testName);
+		myStringAppendf(manyLines, "line %d\n", i);
 	}
-	myStringSetFromCString(str2, "abc");
-	result = myStringCompare(str1, str2);
-	if (result != EQUAL_STRINGS)
+	arr = myStringArrayFromLines(myStringGetView(manyLines), &n);
+	isRight = isRight && arr != NULL && n == 1000 &&
+			  strcmp(myStringCStr(arr[999]), "line 999") == 0;
+	myStringFreeArray(arr);
+	myStringFree(manyLines);
+	arr = myStringArrayFromLines((MyStringView) {NULL, 0}, &n);
+	isRight = isRight && arr != NULL && n == 0 &&
+			  myStringArrayFromLines((MyStringView) {NULL, 1}, &n) == NULL;
+	if (!isRight)
 	{
-		printf("Expected result : 0\n");
-		printf("Actual result : %d\n", result);
+		printf("Expected result : a string for every line\n");
+		printf("Actual result : %lu strings\n", n);
 		exitBad(testName);
 	}
 	printf("PASS\n");
-	myStringFree(str1);
-	myStringFree(str2);
+	myStringFreeArray(arr);
 }
-// ------------------------------ myStringCustomCompare -----------------------------
 
-static void myStringCustomCompareNormal()
+static void myStringRegexNormal()
 {
-	char *testName = "myStringCustomCompareNormal";
+	char *testName = "myStringRegexNormal";
 	printf("Running %s\n", testName);
-	MyString *str1 = myStringAlloc();
-	myStringSetFromCString(str1, "abc");
-	MyString *str2 = myStringAlloc();
-	myStringSetFromCString(str2, "abcd");
-	int result = myStringCustomCompare(str1, str2, reverseMyStringCompare);
-	if (result != STR1_BIGGER)
+	// The pattern, the text and the match, or NULL if there's none.
+	const char *cases[][3] = {
+		{"abc", "xxabcxx", "abc"}, {"a.c", "axc", "axc"}, {"a.c", "a\nc", NULL}, {"^ab", "abab", "ab"},
+		{"ab$", "abab", "ab"}, {"a|ab", "ab", "a"}, {"ab|a", "ab", "ab"},
+		{"a*", "baaa", ""}, {"a+", "baaa", "aaa"}, {"a+?", "baaa", "a"},
+		{"a{2,3}", "aaaa", "aaa"}, {"a{2,3}?", "aaaa", "aa"}, {"a{2}", "a aa", "aa"},
+		{"a{2,}", "aaaaa", "aaaaa"}, {"colou?r", "the color", "color"},
+		{"[a-c]+", "xxcabd", "cab"}, {"[^a-c]+", "abxyc", "xy"}, {"\\d+", "ab 123 c", "123"},
+		{"\\w+@\\w+\\.com", "mail bob@site.com now", "bob@site.com"},
+		{"\\s\\S", "a  b", " b"}, {"\\.\\*", "a.*b", ".*"}, {"x*$", "abxx", "xx"},
+		{"(a|b)*c", "zababcz", "ababc"}, {"(?:ab)+", "xababa", "abab"}, {"<.+>", "<a><b>", "<a><b>"},
+		{"<.+?>", "<a><b>", "<a>"}, {"", "abc", ""}, {"^$", "", ""}, {"[]a]+", "x]a]", "]a]"},
+		{"[a\\-z]+", "b-az", "-az"}, {"\\t", "a\tb", "\t"}, {"(a|ab)(c|bcd)", "abcd", "abcd"},
+		{"abc", "ababd", NULL}, {"^b", "ab", NULL}, {"a$", "ab", NULL}, {"a{3}", "aab", NULL},
+		{"[^a]", "aaa", NULL}, {"\\d", "abc", NULL}, {"x+", "", NULL},
+		// Unlike Perl's, '$' matches only at the end of the text, not before a last '\n',
+		// and a repetition whose body matches empty may take one more iteration.
+		{"x$", "x\n", NULL}, {"\\w*[^a]\\w?\?(|\\w)*", "cc1 a ", "cc1 a"}};
+	const int count = 41;
+	bool isRight = true;
+	int i = 0;
+	for (i = 0; i < count && isRight; i++)
 	{
-		printf("Expected result : 1\n");
-		printf("Actual result : %d\n", result);
-		exitBad(testName);
+		MyStringView pattern = {cases[i][0], strlen(cases[i][0])};
+		MyStringView text = {cases[i][1], strlen(cases[i][1])};
+		MyStringRegex *regex = myStringRegexCompile(pattern, 0);
+		MyStringView match = {NULL, 0};
+		int found = regex == NULL ? MYSTR_ERROR_CODE : myStringRegexSearch(regex, text, &match);
+		isRight = cases[i][2] == NULL ? found == FALSE :
+				  found == TRUE && match._length == strlen(cases[i][2]) &&
+				  memcmp(match._chars, cases[i][2], match._length) == 0;
+		myStringRegexFree(regex);
 	}
-	myStringSetFromCString(str2, "ab");
-	result = myStringCustomCompare(str1, str2, reverseMyStringCompare);
-	if (result != STR2_BIGGER)
+	// Whole matches, and patterns which aren't valid.
+	MyStringRegex *regex = myStringRegexCompile((MyStringView) {"[a-z]+\\d?", 9}, 0);
+	isRight = isRight && regex != NULL &&
+			  myStringRegexMatch(regex, (MyStringView) {"abc1", 4}) == TRUE &&
+			  myStringRegexMatch(regex, (MyStringView) {"abc", 3}) == TRUE &&
+			  myStringRegexMatch(regex, (MyStringView) {"abc12", 5}) == FALSE &&
+			  myStringRegexMatch(regex, (MyStringView) {"", 0}) == FALSE;
+	myStringRegexFree(regex);
+	const char *invalid[] = {"(ab", "ab)", "[ab", "[z-a]", "*a", "a{2,1}", "\\q", "a|*", "a{1001}",
+							 "a**", "a++", "a*+", "a{2}{3}", "a+??"};
+	for (int j = 0; j < 14 && isRight; j++)
 	{
-		printf("Expected result : -1\n");
-		printf("Actual result : %d\n", result);
-		exitBad(testName);
+		isRight = myStringRegexCompile((MyStringView) {invalid[j], strlen(invalid[j])}, 0) == NULL;
 	}
-	myStringSetFromCString(str2, "abc");
-	result = myStringCustomCompare(str1, str2, reverseMyStringCompare);
-	if (result != EQUAL_STRINGS)
+	if (!isRight)
 	{
-		printf("Expected result : 0\n");
-		printf("Actual result : %d\n", result);
+		printf("Expected result : the match of each pattern, and no invalid pattern compiled\n");
+		printf("Actual result : a different one for %s and %s\n", cases[i - 1][0], cases[i - 1][1]);
 		exitBad(testName);
 	}
 	printf("PASS\n");
-	myStringFree(str1);
-	myStringFree(str2);
 }
-// ------------------------------ myStringEqual -----------------------------
 
-static void myStringEqualNormal()
+static void myStringRegexGroupsNormal()
 {
-	char *testName = "myStringEqualNormal";
+	char *testName = "myStringRegexGroupsNormal";
 	printf("Running %s\n", testName);
-	MyString *str1 = myStringAlloc();
-	myStringSetFromCString(str1, "abc");
-	MyString *str2 = myStringAlloc();
-	myStringSetFromCString(str2, "abcd");
-	int result = myStringEqual(str1, str2);
-	if (result != 0)
-	{
-		printf("Expected result : 0\n");
-		printf("Actual result : %d\n", result);
-		exitBad(testName);
-	}
-	myStringSetFromCString(str2, "ab");
-	result = myStringEqual(str1, str2);
-	if (result != 0)
+	const char *pattern = "(\\w+)@(\\w+)(\\.(com|org))?|(\\d+)";
+	const char *text = "write to bob@site.org";
+	MyStringRegex *regex = myStringRegexCompile((MyStringView) {pattern, strlen(pattern)}, 0);
+	MyStringView groups[6];
+	bool isRight = regex != NULL && myStringRegexGroups(regex) == 5 &&
+				   myStringRegexCaptures(regex, (MyStringView) {text, strlen(text)}, groups) == TRUE;
+	const char *expected[] = {"bob@site.org", "bob", "site", ".org", "org"};
+	for (int i = 0; i < 5 && isRight; i++)
 	{
-		printf("Expected result : 0\n");
-		printf("Actual result : %d\n", result);
-		exitBad(testName);
+		isRight = groups[i]._length == strlen(expected[i]) &&
+				  memcmp(groups[i]._chars, expected[i], groups[i]._length) == 0;
 	}
-	myStringSetFromCString(str2, "abc");
-	result = myStringEqual(str1, str2);
-	if (result != 1)
+	isRight = isRight && groups[5]._chars == NULL;
+	// The last iteration of a repeated group, and a group of the other alternative.
+	isRight = isRight && myStringRegexCaptures(regex, (MyStringView) {"id 42", 5}, groups) == TRUE &&
+			  groups[1]._chars == NULL && groups[5]._length == 2 &&
+			  memcmp(groups[5]._chars, "42", 2) == 0;
+	myStringRegexFree(regex);
+	regex = myStringRegexCompile((MyStringView) {"(?:(a|b)c)+", 11}, 0);
+	isRight = isRight && regex != NULL && myStringRegexGroups(regex) == 1 &&
+			  myStringRegexCaptures(regex, (MyStringView) {"xacbcd", 6}, groups) == TRUE &&
+			  groups[0]._length == 4 && groups[1]._length == 1 && groups[1]._chars[0] == 'b';
+	myStringRegexFree(regex);
+	if (!isRight)
 	{
-		printf("Expected result : 1\n");
-		printf("Actual result : %d\n", result);
+		printf("Expected result : the groups of the match\n");
+		printf("Actual result : different groups\n");
 		exitBad(testName);
 	}
 	printf("PASS\n");
-	myStringFree(str1);
-	myStringFree(str2);
 }
 
-// ------------------------------ myStringCustomEqual -----------------------------
-
-static void myStringCustomEqualNormal()
+static void myStringRegexSmallCache()
 {
-	char *testName = "myStringCustomEqualNormal";
+	char *testName = "myStringRegexSmallCache";
 	printf("Running %s\n", testName);
-	MyString *str1 = myStringAlloc();
-	myStringSetFromCString(str1, "abc");
-	MyString *str2 = myStringAlloc();
-	myStringSetFromCString(str2, "abcd");
-	int result = myStringCustomEqual(str1, str2, reverseMyStringCompare);
-	if (result != 0)
+	// The DFA of this pattern has 2^7 states, far more than a tiny cache keeps.
+	const char *pattern = "(a|b)*a(a|b){6}c";
+	MyStringView view = {pattern, strlen(pattern)};
+	MyStringRegex *regex = myStringRegexCompile(view, 0);
+	MyStringRegex *tiny = myStringRegexCompile(view, 1);
+	char text[4096];
+	unsigned int random = 1;
+	for (int i = 0; i < 4096; i++)
 	{
-		printf("Expected result : 0\n");
-		printf("Actual result : %d\n", result);
-		exitBad(testName);
+		random = random * 1103515245 + 12345;
+		text[i] = (random >> 16) % 64 == 0 ? 'c' : ((random >> 16) % 2 == 0 ? 'a' : 'b');
 	}
-	myStringSetFromCString(str2, "ab");
-	result = myStringCustomEqual(str1, str2, reverseMyStringCompare);
-	if (result != 0)
+	bool isRight = regex != NULL && tiny != NULL;
+	for (unsigned long start = 0; start < 4096 && isRight; start += 97)
 	{
-		printf("Expected result : 0\n");
-		printf("Actual result : %d\n", result);
-		exitBad(testName);
+		MyStringView rest = {text + start, 4096 - start};
+		MyStringView match = {NULL, 0};
+		MyStringView tinyMatch = {NULL, 0};
+		int found = myStringRegexSearch(regex, rest, &match);
+		isRight = found == myStringRegexSearch(tiny, rest, &tinyMatch) && found != MYSTR_ERROR_CODE &&
+				  match._chars == tinyMatch._chars && match._length == tinyMatch._length &&
+				  myStringRegexMatch(regex, rest) == myStringRegexMatch(tiny, rest);
 	}
-	myStringSetFromCString(str2, "abc");
-	result = myStringCustomEqual(str1, str2, reverseMyStringCompare);
-	if (result != 1)
+	myStringRegexFree(regex);
+	myStringRegexFree(tiny);
+	if (!isRight)
 	{
-		printf("Expected result : 1\n");
-		printf("Actual result : %d\n", result);
+		printf("Expected result : the same matches with a tiny cache\n");
+		printf("Actual result : different ones\n");
 		exitBad(testName);
 	}
 	printf("PASS\n");
-	myStringFree(str1);
-	myStringFree(str2);
 }
-// ------------------------------ myStringMemUsage -----------------------------
 
-static void myStringMemUsageNormal()
+/**
+ * @brief Read all the rows of text into "field|field|...\n" lines.
+ * @return the lines, or NULL on failure.
+ */
+static MyString * readCsvRows(const char *text, unsigned long length, char delimiter)
 {
-	char *testName = "myStringMemUsageNormal";
+	MyStringCsvReader reader;
+	MyString *arena = myStringAlloc();
+	MyString *rows = myStringAlloc();
+	MyStringView fields[8];
+	unsigned long count = 0;
+	int retVal = myStringCsvReaderInit(&reader, (MyStringView) {text, length}, delimiter) ==
+				 MYSTRING_SUCCESS ? TRUE : MYSTR_ERROR_CODE;
+	while (retVal == TRUE && (retVal = myStringCsvNextRow(&reader, arena, fields, 8, &count)) == TRUE)
+	{
+		for (unsigned long i = 0; i < count && i < 8; i++)
+		{
+			myStringAppendView(rows, fields[i]);
+			myStringAppendView(rows, (MyStringView) {i + 1 == count ? "\n" : "|", 1});
+		}
+	}
+	myStringFree(arena);
+	if (retVal != FALSE)
+	{
+		myStringFree(rows);
+		return NULL;
+	}
+	return rows;
+}
+
+static void myStringCsvNormal()
+{
+	char *testName = "myStringCsvNormal";
 	printf("Running %s\n", testName);
-	MyString *str = myStringAlloc();
-	myStringSetFromCString(str, "abcde");
-	unsigned long result = myStringMemUsage(str);
-	if (result != 21)
+	// The text, the delimiter and the rows it has.
+	const char *cases[][3] = {
+		{"a,b,c\n1,2,3\n", ",", "a|b|c\n1|2|3\n"}, {"a,b\r\nc,d", ",", "a|b\nc|d\n"},
+		{"a,,\n,\n", ",", "a||\n|\n"}, {"\n\nx\n", ",", "\n\nx\n"}, {"", ",", ""},
+		{"\"a,b\",\"c\nd\"\n", ",", "a,b|c\nd\n"}, {"\"say \"\"hi\"\"\",x", ",", "say \"hi\"|x\n"},
+		{"\"\",\"\"\"\"\n", ",", "|\"\n"}, {"a\"b,\"c,d\n", ",", "a\"b,\"c|d\n"},
+		{"\"ab\"cd,e", ",", "abcd|e\n"}, {"a\tb,c\td\n", "\t", "a|b,c|d\n"},
+		{"\"open,\nrow", ",", "open,\nrow\n"}, {"\"a\r\n\"\r\n", ",", "a\r\n\n"}};
+	const int count = 13;
+	bool isRight = true;
+	int i = 0;
+	for (i = 0; i < count && isRight; i++)
 	{
-		printf("Expected result : 21\n");
-		printf("Actual result : %lu\n", result);
+		MyString *rows = readCsvRows(cases[i][0], strlen(cases[i][0]), cases[i][1][0]);
+		isRight = rows != NULL && strcmp(myStringCStr(rows), cases[i][2]) == 0;
+		myStringFree(rows);
+	}
+	// A row longer than the fields is counted, and a delimiter which can't be one fails.
+	MyStringCsvReader reader;
+	MyString *arena = myStringAlloc();
+	MyStringView fields[2];
+	unsigned long fieldCount = 0;
+	isRight = isRight &&
+			  myStringCsvReaderInit(&reader, (MyStringView) {"a,b,c,d\ne", 9}, ',') == MYSTRING_SUCCESS &&
+			  myStringCsvNextRow(&reader, arena, fields, 2, &fieldCount) == TRUE && fieldCount == 4 &&
+			  fields[1]._length == 1 && fields[1]._chars[0] == 'b' &&
+			  myStringCsvNextRow(&reader, arena, fields, 2, &fieldCount) == TRUE && fieldCount == 1 &&
+			  myStringCsvNextRow(&reader, arena, fields, 2, &fieldCount) == FALSE &&
+			  myStringCsvReaderInit(&reader, (MyStringView) {"a", 1}, '"') == MYSTRING_ERROR;
+	myStringFree(arena);
+	if (!isRight)
+	{
+		printf("Expected result : the fields of every row\n");
+		printf("Actual result : different ones for case %d\n", i - 1);
 		exitBad(testName);
 	}
 	printf("PASS\n");
-	myStringFree(str);
 }
 
-// ------------------------------ myStringLen -----------------------------
-
-static void myStringLenNormal()
+static void myStringCsvLong()
 {
-	char *testName = "myStringLenNormal";
+	char *testName = "myStringCsvLong";
 	printf("Running %s\n", testName);
-	MyString *str = myStringAlloc();
-	myStringSetFromCString(str, "abcde");
-	unsigned long length = myStringLen(str);
-	if (length != 5)
+	// Rows of fields of all kinds, whose quotes and rows cross the blocks.
+	MyString *text = myStringAlloc();
+	MyString *expected = myStringAlloc();
+	for (int i = 0; i < 500; i++)
 	{
-		printf("Expected result : 5\n");
-		printf("Actual result : %lu\n", length);
+		for (int j = 0; j < 5; j++)
+		{
+			const char *separator = j == 4 ? "\n" : ",";
+			if ((i + j) % 3 == 0)
+			{
+				myStringAppendf(text, "\"q%d,\n\"\"%d\"\"\"%s", i, j, separator);
+				myStringAppendf(expected, "q%d,\n\"%d\"%s", i, j, j == 4 ? "\n" : "|");
+			}
+			else
+			{
+				myStringAppendf(text, "field%d_%d%s", i * j, j, separator);
+				myStringAppendf(expected, "field%d_%d%s", i * j, j, j == 4 ? "\n" : "|");
+			}
+		}
+	}
+	MyString *rows = readCsvRows(myStringCStr(text), myStringLen(text), ',');
+	bool isRight = rows != NULL && myStringEqual(rows, expected) == TRUE;
+	myStringFree(text);
+	myStringFree(expected);
+	myStringFree(rows);
+	if (!isRight)
+	{
+		printf("Expected result : the fields of every row\n");
+		printf("Actual result : different ones\n");
 		exitBad(testName);
 	}
 	printf("PASS\n");
-	myStringFree(str);
 }
 
-
-
 int main()
 {
 
@@ -1699,6 +13505,7 @@ int main()
 	myStringFreeNullFree();
 	printf("Testing myStringSetFromCString:\n");
 	myStringSetFromCStringNormal();
+	myStringSetFromViewInner();
 	printf("Testing myStringClone:\n");
 	myStringCloneNormal();
 	printf("Testing myStringSetFromMyString:\n");
@@ -1739,7 +13546,90 @@ int main()
 	myStringSortThreeSort();
 	printf("Testing myStringCustomSort:\n");
 	myStringCustomSortThreeSort();
-
+	printf("Testing myStringCollation:\n");
+	myStringCollationCompareNormal();
+	myStringCollationSortFourSort();
+	printf("Testing myStringSortByKey:\n");
+	myStringSortByKeyStable();
+	myStringSortByStringKeyReverse();
+	printf("Testing myStringValidateUTF8:\n");
+	myStringValidateUTF8Normal();
+	printf("Testing myStringCodePointLen:\n");
+	myStringCodePointLenNormal();
+	printf("Testing myStringCodePointSlice:\n");
+	myStringCodePointSliceNormal();
+	printf("Testing myStringAppendf:\n");
+	myStringAppendfNormal();
+	myStringAppendTypedNormal();
+	printf("Testing myStringJoin:\n");
+	myStringConcatManyNormal();
+	myStringJoinNormal();
+	printf("Testing myStringMove:\n");
+	myStringMoveNormal();
+	myStringSwapNormal();
+	myStringDetachNormal();
+	printf("Testing myStringCStr:\n");
+	myStringCStrNormal();
+	myStringToCStringsNormal();
+	printf("Testing myStringMapFile:\n");
+	myStringMapFileNormal();
+	myStringMapFilePageSize();
+	printf("Testing block cache:\n");
+	myStringBlockCacheReuse();
+	myStringBlockCacheThreads();
+	myStringReleaseThreadCacheNormal();
+	printf("Testing myStringStats:\n");
+	myStringStatsNormal();
+	printf("Testing myStringExternalSort:\n");
+	myStringExternalSortLines();
+	myStringExternalSortLengthPrefixed();
+	myStringExternalSortManyRuns();
+	printf("Testing myStringEditDistance:\n");
+	myStringEditDistanceNormal();
+	myStringEditDistanceAtMostNormal();
+	myStringEditPatternNormal();
+	printf("Testing myStringHex:\n");
+	myStringHexNormal();
+	printf("Testing myStringBase64:\n");
+	myStringBase64Normal();
+	myStringCodecStreamNormal();
+	printf("Testing myStringSymbolTable:\n");
+	myStringSymbolTableNormal();
+	myStringSymbolTableEscapes();
+	printf("Testing myStringHash:\n");
+	myStringHashNormal();
+	printf("Testing myStringBloomFilter:\n");
+	myStringBloomFilterNormal();
+	printf("Testing myStringCuckooFilter:\n");
+	myStringCuckooFilterNormal();
+	printf("Testing myStringReplaceAll:\n");
+	myStringReplaceAllNormal();
+	myStringReplaceAllMatchesNormal();
+	printf("Testing myStringTopK:\n");
+	myStringTopKNormal();
+	myStringTopKStreamNormal();
+	printf("Testing myStringSortUnique:\n");
+	myStringSortUniqueNormal();
+	myStringSortUniqueMany();
+	printf("Testing myStringGlob:\n");
+	myStringGlobNormal();
+	myStringGlobSet();
+	printf("Testing myStringChunker:\n");
+	myStringChunkerNormal();
+	printf("Testing myStringWinnow:\n");
+	myStringWinnowNormal();
+	printf("Testing myStringArray:\n");
+	myStringAllocArrayNormal();
+	myStringArrayFromLinesNormal();
+	printf("Testing myStringRegex:\n");
+	myStringRegexNormal();
+	myStringRegexGroupsNormal();
+	myStringRegexSmallCache();
+	printf("Testing myStringCsv:\n");
+	myStringCsvNormal();
+	myStringCsvLong();
+
+	myStringReleaseThreadCache();
 	return 0;
 
 }
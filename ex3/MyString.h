@@ -36,6 +36,15 @@
 #include <stdlib.h>
 // For memcpy and memcmp.
 #include <string.h>
+// For CHAR_BIT.
+#include <limits.h>
+// For va_list.
+#include <stdarg.h>
+
+#ifdef __cplusplus
+// The library is C, so C++ code links to its functions by their C names.
+extern "C" {
+#endif
 
 // -------------------------- const definitions -------------------------
 
@@ -89,12 +98,263 @@
 */
 #define END_OF_C_STRING '\0'
 
+/*
+* The number of entries in a collation weight table (one for every char value).
+*/
+#define MYSTRING_COLLATION_TABLE_SIZE 256
+
+/*
+* The maximal number of levels a collation may have.
+*/
+#define MYSTRING_COLLATION_MAX_LEVELS 4
+
+/*
+* A collation weight for chars which are skipped at a level.
+*/
+#define MYSTRING_COLLATION_IGNORABLE 0
+
+/*
+* The number of bits of a key handled by every pass of the radix sort.
+*/
+#define MYSTRING_RADIX_BITS 8
+
+/*
+* The number of buckets of every pass of the radix sort.
+*/
+#define MYSTRING_RADIX_BUCKETS 256
+
+/*
+* The number of passes of the radix sort over an integer key.
+*/
+#define MYSTRING_RADIX_PASSES (sizeof(unsigned long long) * CHAR_BIT / MYSTRING_RADIX_BITS)
+
 /*
  * MyString represents a manipulable string.
  */
 struct _MyString;
 typedef struct _MyString MyString;
 
+/*
+ * MyStringCollation represents a compiled per-character ordering of strings.
+ */
+struct _MyStringCollation;
+typedef struct _MyStringCollation MyStringCollation;
+
+/*
+ * MyStringEditPattern represents a string compiled for computing its edit distance
+ * to many strings.
+ */
+struct _MyStringEditPattern;
+typedef struct _MyStringEditPattern MyStringEditPattern;
+
+/*
+ * MyStringSymbolTable represents the symbols a collection of strings is compressed
+ * by: up to 255 substrings of up to 8 chars, each written as a single byte.
+ */
+struct _MyStringSymbolTable;
+typedef struct _MyStringSymbolTable MyStringSymbolTable;
+
+/*
+ * MyStringBloomFilter represents a blocked Bloom filter of strings: every string sets
+ * its bits in a single cache line, so a lookup reads one line.
+ */
+struct _MyStringBloomFilter;
+typedef struct _MyStringBloomFilter MyStringBloomFilter;
+
+/*
+ * MyStringCuckooFilter represents a cuckoo filter of strings: a fingerprint of every
+ * string is kept in one of two buckets, so strings can be removed too.
+ */
+struct _MyStringCuckooFilter;
+typedef struct _MyStringCuckooFilter MyStringCuckooFilter;
+
+/*
+ * MyStringMatcher represents a set of needles compiled for finding all of them in a
+ * single pass over a string.
+ */
+struct _MyStringMatcher;
+typedef struct _MyStringMatcher MyStringMatcher;
+
+/*
+ * MyStringTopKStream keeps the smallest K of the strings pushed to it, one at a time.
+ */
+struct _MyStringTopKStream;
+typedef struct _MyStringTopKStream MyStringTopKStream;
+
+/*
+ * MyStringGlob represents a set of glob patterns compiled for matching strings against
+ * all of them at once.
+ */
+struct _MyStringGlob;
+typedef struct _MyStringGlob MyStringGlob;
+
+/*
+ * MyStringRegex represents a regex compiled for matching in linear time, by DFAs whose
+ * states are built when they are first needed.
+ */
+struct _MyStringRegex;
+typedef struct _MyStringRegex MyStringRegex;
+
+/*
+ * MyStringView is a read only window into the chars of a string which it doesn't
+ * own. A view of a MyString is valid until the MyString is changed or freed.
+ */
+typedef struct _MyStringView
+{
+    const char *_chars;
+    unsigned long _length;
+} MyStringView;
+
+/*
+ * The call sites by which allocations are counted. An allocation is counted by the
+ * outermost of them, e.g. the allocations of myStringAlloc within myStringClone are
+ * counted by MYSTRING_SITE_CLONE.
+ */
+typedef enum
+{
+    MYSTRING_SITE_OTHER = 0,
+    MYSTRING_SITE_ALLOC,
+    MYSTRING_SITE_SET,
+    MYSTRING_SITE_CAT,
+    MYSTRING_SITE_FILTER,
+    MYSTRING_SITE_CLONE,
+    MYSTRING_SITES
+} MyStringSite;
+
+/*
+ * Library-wide memory counters, collected only when the library is compiled with
+ * MYSTRING_STATS defined (which needs the GCC atomic builtins). Bytes are counted
+ * as allocated, after rounding to the block sizes.
+ */
+typedef struct _MyStringStats
+{
+    // The number of strings which weren't freed yet.
+    unsigned long _liveStrings;
+    // The bytes of the structs and blocks of the live strings.
+    unsigned long _liveBytes;
+    // The maximal number of live bytes so far.
+    unsigned long _peakBytes;
+    // The bytes of the blocks of live strings not used by their chars or '\0'.
+    unsigned long _slackBytes;
+    // The free blocks kept for reuse by the block caches of the threads.
+    unsigned long _cachedBytes;
+    // The bytes of files mapped by live strings.
+    unsigned long _mappedBytes;
+    // New blocks and structs, by call site.
+    unsigned long _allocations[MYSTRING_SITES];
+    // Blocks replaced by bigger ones, by call site.
+    unsigned long _reallocations[MYSTRING_SITES];
+} MyStringStats;
+
+/*
+ * The formats of the strings read and written by myStringExternalSort.
+ */
+typedef enum
+{
+    // Every string ends with '\n' (the last one may end with the file instead).
+    MYSTRING_RECORDS_LINES = 0,
+    // Every string follows its length, 4 bytes little endian.
+    MYSTRING_RECORDS_LENGTH_PREFIXED
+} MyStringRecordFormat;
+
+/*
+ * What myStringExternalSort writes of equal strings.
+ */
+typedef enum
+{
+    // Every string, as many times as it was read.
+    MYSTRING_MERGE_ALL = 0,
+    // Every distinct string once.
+    MYSTRING_MERGE_UNIQUE,
+    // Every distinct string once, after the number of times it was read: a decimal
+    // number and '\t' for lines, 8 bytes little endian for length-prefixed strings.
+    MYSTRING_MERGE_COUNT
+} MyStringMergeMode;
+
+/*
+ * The options of myStringExternalSort, set to their defaults by
+ * myStringExternalSortDefaults.
+ */
+typedef struct _MyStringExternalSortOptions
+{
+    MyStringRecordFormat _format;
+    MyStringMergeMode _mode;
+    // The bytes of strings sorted in memory at once, which also bound the buffers
+    // of the runs merged at once.
+    unsigned long _memoryBudget;
+    // The size of the buffer of every file read or written.
+    unsigned long _bufferSize;
+    // The directory of the temporary files of the runs, NULL for that of tmpfile().
+    // The runs share a file, so at most two temporary files are open at once.
+    const char *_tempDir;
+} MyStringExternalSortOptions;
+
+
+/*
+ * The state of a conversion to or from hex or base64 of a payload given in chunks:
+ * the bytes or chars of an unfinished group, kept for the next chunk. It is set up by
+ * myStringCodecStreamInit.
+ */
+typedef struct _MyStringCodecStream
+{
+    char _carry[4];
+    unsigned int _carryLength;
+    // Whether base64 padding was decoded, which only the end of the payload may have.
+    bool _isPadded;
+} MyStringCodecStream;
+
+/*
+ * Cuts data into content defined chunks, FastCDC style: a chunk ends where a Gear hash
+ * of the bytes before it has a pattern, so an edit moves the boundaries near it only.
+ * The chunks are views of the data, which has to outlive the chunker. It is set up by
+ * myStringChunkerInit.
+ */
+typedef struct _MyStringChunker
+{
+    MyStringView _data;
+    // The offset of the next chunk in the data.
+    unsigned long _offset;
+    unsigned long _minSize;
+    unsigned long _averageSize;
+    unsigned long _maxSize;
+    // The masks of the hash before and after the average size.
+    unsigned long long _smallMask;
+    unsigned long long _largeMask;
+} MyStringChunker;
+
+/*
+ * A fingerprint found by winnowing: the hash of a k-gram and its offset in the text.
+ */
+typedef struct _MyStringFingerprint
+{
+    unsigned long long _hash;
+    unsigned long _offset;
+} MyStringFingerprint;
+
+/*
+ * Splits delimited text, such as CSV or TSV, into rows of fields, simdcsv style: the
+ * text is scanned 64 bytes at a time into bitmasks of its quotes, delimiters and
+ * newlines, and the bytes in quotes are found by a prefix XOR of the mask of the quotes.
+ * The fields are views of the text, which has to outlive the reader. It is set up by
+ * myStringCsvReaderInit.
+ */
+typedef struct _MyStringCsvReader
+{
+    MyStringView _data;
+    char _delimiter;
+    // The offset of the block scanned last, and of the next one.
+    unsigned long _block;
+    unsigned long _nextBlock;
+    // The delimiters and newlines out of quotes in the block scanned last which weren't
+    // read yet, and which of them are newlines.
+    unsigned long long _separators;
+    unsigned long long _rowEnds;
+    // All ones if the block scanned last ends in quotes, 0 otherwise.
+    unsigned long long _inQuotes;
+    // The offset of the next field, past the end of the data after the last one.
+    unsigned long _fieldStart;
+} MyStringCsvReader;
+
 /* Return values */
 typedef enum 
 {
@@ -122,6 +382,15 @@ MyString * myStringAlloc();
  */
 void myStringFree(MyString *str);
 
+/**
+ * @brief Frees the blocks which the calling thread keeps for reuse. The blocks of
+ * 	other threads are freed when they exit, but those of the main thread would be
+ * 	held until the process exits, so a program calls it at the end of main (leak
+ * 	checkers such as valgrind report them otherwise). The library may still be used
+ * 	afterwards.
+ */
+void myStringReleaseThreadCache();
+
 
 /**
  * @brief Allocates a new MyString with the same value as str. It is the caller's
@@ -164,6 +433,16 @@ MyStringRetVal myStringFilter(MyString *str, bool (*filt)(const char *));
  */
 MyStringRetVal myStringSetFromCString(MyString *str, const char * cString);
 
+/**
+ * @brief Sets the value of str to the chars of view. The view may point into str
+ * 	itself, even if its chars are mapped.
+ * @param str the MyString to set.
+ * @param view the view to set from.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringSetFromView(MyString *str, MyStringView view);
+
 
 /**
  * @brief Sets the value of str to the value of the integer n.
@@ -330,7 +609,1140 @@ void myStringCustomSort(MyString *arr[], unsigned long len,
 
 void myStringSort(MyString *arr[], unsigned long len);
 
- 
+/**
+ * @brief Allocates a new collation out of weight tables. Every table has
+ *  MYSTRING_COLLATION_TABLE_SIZE entries, the weight of a char at a level is
+ *  weights[level][(unsigned char) c]. Strings are compared by the weights of the
+ *  first level, and only when those are equal by the weights of the next level
+ *  and so on. A weight of MYSTRING_COLLATION_IGNORABLE skips the char at that level.
+ * 	The tables are copied, so the caller may free them afterwards.
+ * 	It is the caller's responsibility to free the returned collation.
+ * @param weights array of levels weight tables.
+ * @param levels the number of levels, between 1 and MYSTRING_COLLATION_MAX_LEVELS.
+ * RETURN VALUE:
+ *  @return a pointer to the new collation, or NULL on failure.
+ */
+MyStringCollation * myStringCollationAlloc(const unsigned char *weights[], unsigned int levels);
+
+/**
+ * @brief Frees the memory allocated to collation.
+ * @param collation the collation to free.
+ * If collation is NULL, no operation is performed.
+ */
+void myStringCollationFree(MyStringCollation *collation);
+
+/**
+ * @brief Compares str1 and str2 according to collation.
+ * @param str1
+ * @param str2
+ * @param collation
+ * RETURN VALUE:
+ * @return STR1_BIGGER, STR2_BIGGER or EQUAL_STRINGS.
+ * 	If strings cannot be compared, the return value should be MYSTR_ERROR_CODE
+ */
+int myStringCollationCompare(const MyString *str1, const MyString *str2,
+							 const MyStringCollation *collation);
+
+/**
+ * @brief Check if str1 is equal to str2 according to collation.
+ * @param str1
+ * @param str2
+ * @param collation
+ * RETURN VALUE:
+ * @return TRUE if the strings are equal, FALSE otherwise.
+ * 	If strings cannot be compared, the return value should be MYSTR_ERROR_CODE
+ */
+int myStringCollationEqual(const MyString *str1, const MyString *str2,
+						   const MyStringCollation *collation);
+
+/**
+ * @brief sorts an array of MyString pointers according to collation.
+ * 	The collation key of every string is computed once before sorting.
+ * @param arr
+ * @param len
+ * @param collation
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (arr is
+ *   left unchanged).
+ */
+MyStringRetVal myStringCollationSort(MyString *arr[], unsigned long len,
+									 const MyStringCollation *collation);
+
+/**
+ * @brief sorts an array of MyString pointers by integer keys in ascending order.
+ * 	keyExtractor is called exactly once for every string, and the strings are then
+ * 	sorted by a radix sort of their keys, so no comparator is called at all.
+ * 	Strings with equal keys keep their relative order.
+ * @param arr
+ * @param len
+ * @param keyExtractor returns the key of a string.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (arr is
+ *   left unchanged).
+ */
+MyStringRetVal myStringSortByKey(MyString *arr[], unsigned long len,
+								 unsigned long long (*keyExtractor) (const MyString *));
+
+/**
+ * @brief sorts an array of MyString pointers by string keys, in the order of
+ * 	myStringCompare of the keys.
+ * 	keyExtractor is called exactly once for every string and sets key (an
+ * 	allocated MyString) to the key of str. The strings are radix sorted by the
+ * 	first chars of their keys, and only strings sharing those are compared.
+ * @param arr
+ * @param len
+ * @param keyExtractor sets key to the key of str, returns MYSTRING_SUCCESS on
+ *  success and MYSTRING_ERROR on failure.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (arr is
+ *   left unchanged).
+ */
+MyStringRetVal myStringSortByStringKey(MyString *arr[], unsigned long len,
+									   MyStringRetVal (*keyExtractor) (const MyString *str,
+																	   MyString *key));
+
+/**
+ * @brief Get a view of all the chars of str.
+ * @param str
+ * RETURN VALUE:
+ *  @return the view, an empty view if str is NULL.
+ */
+MyStringView myStringGetView(const MyString *str);
+
+/**
+ * @brief Check if the chars of str are valid UTF-8: no overlong encodings, no
+ * 	surrogates, no code points above U+10FFFF and no truncated sequences.
+ * @param str
+ * RETURN VALUE:
+ * @return TRUE if str is valid UTF-8, FALSE otherwise.
+ * 	If str is NULL, the return value should be MYSTR_ERROR_CODE
+ */
+int myStringValidateUTF8(const MyString *str);
+
+/**
+ * @brief Count the code points of str, which should be valid UTF-8
+ * 	(see myStringValidateUTF8).
+ * @param str
+ * RETURN VALUE:
+ * @return the number of code points in str, 0 if str is NULL.
+ */
+unsigned long myStringCodePointLen(const MyString *str);
+
+/**
+ * @brief Get a view of count code points of str starting at code point start.
+ * 	str should be valid UTF-8 (see myStringValidateUTF8).
+ * 	If less than count code points follow start, the view ends with str.
+ * @param str
+ * @param start the index of the first code point of the view.
+ * @param count the maximal number of code points in the view.
+ * @param view the view to set.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR if start is beyond the
+ *   last code point of str.
+ */
+MyStringRetVal myStringCodePointSlice(const MyString *str, unsigned long start,
+									  unsigned long count, MyStringView *view);
+
+/**
+ * @brief Make sure str has room for at least capacity chars, so that it can grow
+ * 	up to that length without reallocating.
+ * @param str
+ * @param capacity
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringReserve(MyString *str, unsigned long capacity);
+
+/**
+ * @brief Appends to str the text formatted by format and the following
+ * 	arguments, like printf(). The text is formatted right into the spare
+ * 	capacity of str. The arguments shouldn't point into the chars of str.
+ * @param str
+ * @param format
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (str is
+ *   left unchanged).
+ */
+MyStringRetVal myStringAppendf(MyString *str, const char *format, ...);
+
+/**
+ * @brief Like myStringAppendf, with the arguments given as a va_list.
+ * @param str
+ * @param format
+ * @param args
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringVAppendf(MyString *str, const char *format, va_list args);
+
+/**
+ * @brief Sets the value of str to the text formatted by format and the following
+ * 	arguments, like printf(). The arguments shouldn't point into the chars of str.
+ * @param str
+ * @param format
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringSetf(MyString *str, const char *format, ...);
+
+/**
+ * @brief Appends the decimal value of n to str, without parsing a format.
+ * @param str
+ * @param n
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringAppendInt(MyString *str, long long n);
+
+/**
+ * @brief Appends d to str with precision significant digits (like "%.*g").
+ * @param str
+ * @param d
+ * @param precision the number of significant digits.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringAppendDouble(MyString *str, double d, int precision);
+
+/**
+ * @brief Appends the chars of view to str. The view may point into str itself.
+ * @param str
+ * @param view
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringAppendView(MyString *str, MyStringView view);
+
+/**
+ * @brief Sets dst to be the concatenation of the n strings of parts.
+ * 	The length of the result is computed first, so dst is allocated at most
+ * 	once and every part is copied exactly once. dst may be one of the parts.
+ * @param dst
+ * @param parts
+ * @param n
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringConcatMany(MyString *dst, const MyString *parts[], unsigned long n);
+
+/**
+ * @brief Sets dst to be the n strings of parts with sep between every two of them.
+ * 	Like myStringConcatMany, dst is allocated at most once. dst may be one of the
+ * 	parts or the separator.
+ * @param dst
+ * @param parts
+ * @param n
+ * @param sep
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringJoin(MyString *dst, const MyString *parts[], unsigned long n,
+							const MyString *sep);
+
+/**
+ * @brief Moves the value of src to dst without copying it: dst takes over the
+ * 	chars of src (its old chars are freed), and src is left as an empty string.
+ * 	Nothing is allocated.
+ * @param dst
+ * @param src
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringMove(MyString *dst, MyString *src);
+
+/**
+ * @brief Swaps the values of str1 and str2 without copying them.
+ * @param str1
+ * @param str2
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringSwap(MyString *str1, MyString *str2);
+
+/**
+ * @brief Hands the chars of str over to the caller, leaving str as an empty
+ * 	string. The chars are terminated by the null character. It is the
+ * 	caller's responsibility to free the returned chars by calling free().
+ * @param str
+ * @param length pointer to set to the number of chars.
+ * RETURN VALUE:
+ *  @return the chars, or NULL on failure.
+ */
+char * myStringDetach(MyString *str, unsigned long *length);
+
+/**
+ * @brief Returns the value of str as a C string, terminated with the null
+ * 	character, without copying it. The C string belongs to str and is valid until
+ * 	str is changed or freed.
+ * @param str the MyString
+ * RETURN VALUE:
+ *  @return the C string, or NULL if str is NULL.
+ */
+const char * myStringCStr(const MyString *str);
+
+/**
+ * @brief Returns the values of n strings as C strings, all packed in a single
+ * 	allocation: an array of n pointers followed by the C strings. It is the
+ * 	caller's responsibility to free the returned array (and with it all the C
+ * 	strings) by a single call to free().
+ * @param strs
+ * @param n
+ * RETURN VALUE:
+ *  @return the array of C strings, or NULL on failure.
+ */
+char ** myStringToCStrings(const MyString *strs[], unsigned long n);
+
+/**
+ * @brief Allocates a new MyString whose value is the content of the file at path.
+ * 	The file is mapped to memory read only instead of being read, so it opens at
+ * 	once whatever its size, and its chars are copied to a block of their own
+ * 	only when the string is first changed. The file must not be changed while it is
+ * 	mapped. The mapped chars are not counted by myStringMemUsage. It is the
+ * 	caller's responsibility to free the returned MyString.
+ * @param path
+ * RETURN VALUE:
+ *  @return the new MyString, or NULL on failure.
+ */
+MyString * myStringMapFile(const char *path);
+
+/**
+ * @brief Gets the library-wide memory counters.
+ * @param stats the counters to set.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR if stats is NULL or the
+ *  	library was compiled without MYSTRING_STATS.
+ */
+MyStringRetVal myStringStats(MyStringStats *stats);
+
+/**
+ * @brief Writes the library-wide memory counters to stream, one line for the
+ * 	totals and one for every call site.
+ * @param stream
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (or if the library
+ *  	was compiled without MYSTRING_STATS).
+ */
+MyStringRetVal myStringStatsDump(FILE *stream);
+
+/**
+ * @brief Dumps the counters to stream every period allocations and reallocations.
+ * 	A period of 0, or a NULL stream, stops the dumps.
+ * @param stream
+ * @param period
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR if the library was compiled
+ *  	without MYSTRING_STATS.
+ */
+MyStringRetVal myStringStatsSetDump(FILE *stream, unsigned long period);
+
+/**
+ * @brief Sets the options of myStringExternalSort to their defaults: lines, all the
+ * 	strings, a budget of 64MB and buffers of 1MB in the directory of tmpfile().
+ * @param options
+ */
+void myStringExternalSortDefaults(MyStringExternalSortOptions *options);
+
+/**
+ * @brief Sorts the strings of in to out by myStringCompare, even if they don't fit in
+ * 	memory: strings are read and sorted in runs which fit in the memory budget, the
+ * 	runs are written one after another to a temporary file, and then merged, in
+ * 	passes through a new temporary file if there are too many of them to merge at
+ * 	once. Equal strings are aggregated by the merge mode while merging.
+ * @param in
+ * @param out
+ * @param options
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (including reading
+ *  	a truncated length-prefixed string, or writing a string longer than a length
+ *  	prefix can tell). On failure out may hold part of the output.
+ */
+MyStringRetVal myStringExternalSort(FILE *in, FILE *out, const MyStringExternalSortOptions *options);
+
+/**
+ * @brief Computes the edit (Levenshtein) distance between two strings: the minimal
+ * 	number of chars to insert, delete or replace to turn one into the other.
+ * @param str1
+ * @param str2
+ * @param distance pointer to set to the distance.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringEditDistance(const MyString *str1, const MyString *str2,
+                                    unsigned long *distance);
+
+/**
+ * @brief Checks if the edit distance between two strings is at most k. It stops as
+ * 	soon as the distance must be bigger, so it's faster than myStringEditDistance for
+ * 	filtering candidates.
+ * @param str1
+ * @param str2
+ * @param k
+ * RETURN VALUE:
+ *  @return TRUE if the distance is at most k, FALSE if it's bigger, and
+ *  	MYSTR_ERROR_CODE on failure.
+ */
+int myStringEditDistanceAtMost(const MyString *str1, const MyString *str2, unsigned long k);
+
+/**
+ * @brief Compiles a string for computing its edit distance to many strings by
+ * 	myStringEditPatternDistances. The pattern is a copy, so str may be changed or
+ * 	freed afterwards. It is the caller's responsibility to free the pattern.
+ * @param str
+ * RETURN VALUE:
+ *  @return the pattern, or NULL on failure.
+ */
+MyStringEditPattern * myStringEditPatternAlloc(const MyString *str);
+
+/**
+ * @brief Frees a pattern.
+ * @param pattern
+ */
+void myStringEditPatternFree(MyStringEditPattern *pattern);
+
+/**
+ * @brief Computes the edit distances between a pattern and n strings, up to a bound:
+ * 	a distance bigger than maxDistance is set to maxDistance + 1, as soon as it's
+ * 	known to be bigger. ULONG_MAX computes all the distances.
+ * @param pattern
+ * @param strs
+ * @param n
+ * @param maxDistance
+ * @param distances the array of n distances to set.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringEditPatternDistances(const MyStringEditPattern *pattern,
+                                            const MyString *strs[], unsigned long n,
+                                            unsigned long maxDistance, unsigned long distances[]);
+
+
+/**
+ * @brief Appends the bytes of a view to str as hex, two lowercase digits a byte.
+ * 	Appending chunk by chunk gives the same hex as appending them at once.
+ * @param str
+ * @param bytes
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringAppendHex(MyString *str, MyStringView bytes);
+
+/**
+ * @brief Appends to str the bytes whose hex is the chars of a view, in either case.
+ * @param str
+ * @param hex
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure or if hex isn't
+ *  	valid (str is left unchanged).
+ */
+MyStringRetVal myStringAppendFromHex(MyString *str, MyStringView hex);
+
+/**
+ * @brief Appends the bytes of a view to str as base64 (RFC 4648, padded with '=').
+ * @param str
+ * @param bytes
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringAppendBase64(MyString *str, MyStringView bytes);
+
+/**
+ * @brief Appends to str the bytes whose base64 is the chars of a view. The base64 must
+ * 	be padded, and without line breaks, and the bits of its last group past the last
+ * 	byte must be zero (so "QR==" isn't valid, though it would decode as "QQ==").
+ * @param str
+ * @param base64
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure or if base64 isn't
+ *  	valid (str is left unchanged).
+ */
+MyStringRetVal myStringAppendFromBase64(MyString *str, MyStringView base64);
+
+/**
+ * @brief Sets up a stream for converting a payload in chunks.
+ * @param stream
+ */
+void myStringCodecStreamInit(MyStringCodecStream *stream);
+
+/**
+ * @brief Appends to str the bytes of the hex of a chunk of a payload, whose chunks may
+ * 	split a byte. After a failure the stream can't be used anymore.
+ * @param str
+ * @param chunk
+ * @param stream
+ * @param isLast whether the chunk is the last one of the payload.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure or if the hex isn't
+ *  	valid (str is left unchanged).
+ */
+MyStringRetVal myStringAppendFromHexStream(MyString *str, MyStringView chunk,
+                                           MyStringCodecStream *stream, bool isLast);
+
+/**
+ * @brief Appends to str the base64 of a chunk of a payload, whose chunks may split a
+ * 	group. The bytes of an unfinished group are kept in the stream until the next
+ * 	chunk, and the last chunk pads them.
+ * @param str
+ * @param chunk
+ * @param stream
+ * @param isLast whether the chunk is the last one of the payload.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringAppendBase64Stream(MyString *str, MyStringView chunk,
+                                          MyStringCodecStream *stream, bool isLast);
+
+/**
+ * @brief Appends to str the bytes of the base64 of a chunk of a payload, whose chunks
+ * 	may split a group. After a failure the stream can't be used anymore.
+ * @param str
+ * @param chunk
+ * @param stream
+ * @param isLast whether the chunk is the last one of the payload.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure or if the base64
+ *  	isn't valid (str is left unchanged).
+ */
+MyStringRetVal myStringAppendFromBase64Stream(MyString *str, MyStringView chunk,
+                                              MyStringCodecStream *stream, bool isLast);
+
+/**
+ * @brief Builds a symbol table for compressing strings like the given ones, from the
+ * 	substrings which save the most in a sample of them. Strings compressed by the
+ * 	table are independent of each other, so any of them can be decompressed alone.
+ * 	It is the caller's responsibility to free the table.
+ * @param strs
+ * @param n
+ * RETURN VALUE:
+ *  @return the table, or NULL on failure.
+ */
+MyStringSymbolTable * myStringSymbolTableTrain(const MyString *strs[], unsigned long n);
+
+/**
+ * @brief Frees a symbol table.
+ * @param table
+ */
+void myStringSymbolTableFree(MyStringSymbolTable *table);
+
+/**
+ * @brief Appends the compressed chars of a view to str. Every symbol of the table
+ * 	takes one char, and every other char takes two. Equal strings are compressed to
+ * 	equal chars, so strings compressed by the same table can be compared for
+ * 	equality without decompressing them.
+ * @param table
+ * @param str
+ * @param view
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringAppendCompressed(const MyStringSymbolTable *table, MyString *str,
+                                        MyStringView view);
+
+/**
+ * @brief Appends to str the chars of a view compressed by the table.
+ * @param table
+ * @param str
+ * @param compressed
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure or if compressed
+ *  	isn't the output of the table (str is left unchanged).
+ */
+MyStringRetVal myStringAppendDecompressed(const MyStringSymbolTable *table, MyString *str,
+                                          MyStringView compressed);
+
+/**
+ * @brief Decompresses the chars of a view compressed by the table into a buffer,
+ * 	without allocating.
+ * @param table
+ * @param compressed
+ * @param buffer
+ * @param size the size of the buffer.
+ * @param decompressed pointer to set to the view of the chars in the buffer.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure, if the buffer is
+ *  	too small or if compressed isn't the output of the table.
+ */
+MyStringRetVal myStringDecompressInto(const MyStringSymbolTable *table, MyStringView compressed,
+                                      char *buffer, unsigned long size,
+                                      MyStringView *decompressed);
+
+/**
+ * @brief Hashes the chars of a view to 64 bits. Equal chars have equal hashes on every
+ * 	machine, so hashes may be kept in files.
+ * @param view
+ * RETURN VALUE:
+ *  @return the hash.
+ */
+unsigned long long myStringHashView(MyStringView view);
+
+/**
+ * @brief Hashes a string as myStringHashView hashes its chars.
+ * @param str
+ * RETURN VALUE:
+ *  @return the hash, or the hash of an empty string if str is NULL.
+ */
+unsigned long long myStringHash(const MyString *str);
+
+/**
+ * @brief Allocates an empty Bloom filter for the given number of strings, with
+ * 	bitsPerKey bits for every string: 10 bits give about 1% false positives, and
+ * 	every 5 more bits divide them by about 10. It is the caller's responsibility to
+ * 	free the filter.
+ * @param expected
+ * @param bitsPerKey
+ * RETURN VALUE:
+ *  @return the filter, or NULL on failure.
+ */
+MyStringBloomFilter * myStringBloomFilterAlloc(unsigned long expected, unsigned int bitsPerKey);
+
+/**
+ * @brief Frees a Bloom filter.
+ * @param filter
+ */
+void myStringBloomFilterFree(MyStringBloomFilter *filter);
+
+/**
+ * @brief Adds the chars of a view to a Bloom filter.
+ * @param filter
+ * @param key
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringBloomFilterAdd(MyStringBloomFilter *filter, MyStringView key);
+
+/**
+ * @brief Checks if the chars of a view may have been added to a Bloom filter.
+ * @param filter
+ * @param key
+ * RETURN VALUE:
+ *  @return FALSE if they were surely not added, TRUE if they may have been, and
+ *  	MYSTR_ERROR_CODE on failure.
+ */
+int myStringBloomFilterContains(const MyStringBloomFilter *filter, MyStringView key);
+
+/**
+ * @brief Adds n keys to a Bloom filter. The cache lines of the next keys are
+ * 	prefetched while the current ones are added.
+ * @param filter
+ * @param keys
+ * @param n
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringBloomFilterAddBatch(MyStringBloomFilter *filter, const MyStringView keys[],
+                                           unsigned long n);
+
+/**
+ * @brief Checks n keys against a Bloom filter, as myStringBloomFilterContains does.
+ * 	The cache lines of the next keys are prefetched while the current ones are
+ * 	checked.
+ * @param filter
+ * @param keys
+ * @param n
+ * @param results the array of n results to set, true for keys which may have been
+ * 	added.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringBloomFilterContainsBatch(const MyStringBloomFilter *filter,
+                                                const MyStringView keys[], unsigned long n,
+                                                bool results[]);
+
+/**
+ * @brief Writes a Bloom filter to a stream, in a format which is the same on every
+ * 	machine.
+ * @param filter
+ * @param stream
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringBloomFilterWrite(const MyStringBloomFilter *filter, FILE *stream);
+
+/**
+ * @brief Reads a Bloom filter written by myStringBloomFilterWrite. It is the caller's
+ * 	responsibility to free the filter.
+ * @param stream
+ * RETURN VALUE:
+ *  @return the filter, or NULL on failure or if the stream doesn't hold one.
+ */
+MyStringBloomFilter * myStringBloomFilterRead(FILE *stream);
+
+/**
+ * @brief Allocates an empty cuckoo filter with room for at least capacity strings.
+ * 	It has about 0.01% false positives. It is the caller's responsibility to free the
+ * 	filter.
+ * @param capacity
+ * RETURN VALUE:
+ *  @return the filter, or NULL on failure.
+ */
+MyStringCuckooFilter * myStringCuckooFilterAlloc(unsigned long capacity);
+
+/**
+ * @brief Frees a cuckoo filter.
+ * @param filter
+ */
+void myStringCuckooFilterFree(MyStringCuckooFilter *filter);
+
+/**
+ * @brief Adds the chars of a view to a cuckoo filter. The same chars may be added a
+ * 	few times, and are then removed as many times.
+ * @param filter
+ * @param key
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure or if the filter is
+ *  	full (the key is not added).
+ */
+MyStringRetVal myStringCuckooFilterAdd(MyStringCuckooFilter *filter, MyStringView key);
+
+/**
+ * @brief Checks if the chars of a view may be in a cuckoo filter.
+ * @param filter
+ * @param key
+ * RETURN VALUE:
+ *  @return FALSE if they are surely not in it, TRUE if they may be, and
+ *  	MYSTR_ERROR_CODE on failure.
+ */
+int myStringCuckooFilterContains(const MyStringCuckooFilter *filter, MyStringView key);
+
+/**
+ * @brief Removes the chars of a view from a cuckoo filter. Only chars which were added
+ * 	may be removed, or else other keys may be removed instead.
+ * @param filter
+ * @param key
+ * RETURN VALUE:
+ *  @return TRUE if they were removed, FALSE if they are not in the filter, and
+ *  	MYSTR_ERROR_CODE on failure.
+ */
+int myStringCuckooFilterRemove(MyStringCuckooFilter *filter, MyStringView key);
+
+/**
+ * @brief Adds n keys to a cuckoo filter. The buckets of the next keys are prefetched
+ * 	while the current ones are added.
+ * @param filter
+ * @param keys
+ * @param n
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure or if the filter
+ *  	got full (the keys before the one which didn't fit are added).
+ */
+MyStringRetVal myStringCuckooFilterAddBatch(MyStringCuckooFilter *filter, const MyStringView keys[],
+                                            unsigned long n);
+
+/**
+ * @brief Checks n keys against a cuckoo filter, as myStringCuckooFilterContains does.
+ * 	The buckets of the next keys are prefetched while the current ones are checked.
+ * @param filter
+ * @param keys
+ * @param n
+ * @param results the array of n results to set, true for keys which may be in the
+ * 	filter.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringCuckooFilterContainsBatch(const MyStringCuckooFilter *filter,
+                                                 const MyStringView keys[], unsigned long n,
+                                                 bool results[]);
+
+/**
+ * @brief Writes a cuckoo filter to a stream, in a format which is the same on every
+ * 	machine.
+ * @param filter
+ * @param stream
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringCuckooFilterWrite(const MyStringCuckooFilter *filter, FILE *stream);
+
+/**
+ * @brief Reads a cuckoo filter written by myStringCuckooFilterWrite. It is the caller's
+ * 	responsibility to free the filter.
+ * @param stream
+ * RETURN VALUE:
+ *  @return the filter, or NULL on failure or if the stream doesn't hold one.
+ */
+MyStringCuckooFilter * myStringCuckooFilterRead(FILE *stream);
+
+/**
+ * @brief Replaces every occurrence of needle in str by replacement, from left to
+ * 	right without overlaps. The new chars are built in a single pass: in place when
+ * 	replacement is not longer than needle, and otherwise in a block allocated once at
+ * 	their final size. needle and replacement may be views of str.
+ * @param str
+ * @param needle
+ * @param replacement
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure or if needle is
+ *  	empty (str is left unchanged).
+ */
+MyStringRetVal myStringReplaceAll(MyString *str, MyStringView needle, MyStringView replacement);
+
+/**
+ * @brief Compiles n needles for myStringReplaceAllMatches. The needles are copied, so
+ * 	they may be changed or freed afterwards. It is the caller's responsibility to free
+ * 	the matcher.
+ * @param needles
+ * @param n
+ * RETURN VALUE:
+ *  @return the matcher, or NULL on failure or if a needle is empty.
+ */
+MyStringMatcher * myStringMatcherAlloc(const MyStringView needles[], unsigned long n);
+
+/**
+ * @brief Frees a matcher.
+ * @param matcher
+ */
+void myStringMatcherFree(MyStringMatcher *matcher);
+
+/**
+ * @brief Replaces every occurrence of the needles of a matcher in str by the
+ * 	replacement of the same index. Occurrences are taken from left to right without
+ * 	overlaps, the one which starts first and then the longest of those.
+ * @param str
+ * @param matcher
+ * @param replacements the array of replacements, one for every needle.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (str is left
+ *  	unchanged).
+ */
+MyStringRetVal myStringReplaceAllMatches(MyString *str, const MyStringMatcher *matcher,
+                                         const MyStringView replacements[]);
+
+/**
+ * @brief Puts the smallest k strings of arr, in ascending order, at its start. The
+ * 	other strings follow them in no particular order.
+ * 	With a NULL comparator the order is that of myStringCompare, and the first chars of
+ * 	every string are kept next to it, so most comparisons don't read the strings.
+ * @param arr
+ * @param len
+ * @param k the number of strings, all of them if it's bigger than len.
+ * @param comparator custom comparator of MyString pointers (as in myStringCustomSort),
+ * 	or NULL.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (arr is left
+ *  	unchanged).
+ */
+MyStringRetVal myStringTopK(MyString *arr[], unsigned long len, unsigned long k,
+							int (*comparator) (const void *, const void *));
+
+/**
+ * @brief Puts the string which would be at index n of the sorted arr there, with no
+ * 	bigger string before it and no smaller string after it.
+ * 	comparator is as in myStringTopK.
+ * @param arr
+ * @param len
+ * @param n the index, smaller than len.
+ * @param comparator custom comparator of MyString pointers, or NULL.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (arr is left
+ *  	unchanged).
+ */
+MyStringRetVal myStringNthElement(MyString *arr[], unsigned long len, unsigned long n,
+								  int (*comparator) (const void *, const void *));
+
+/**
+ * @brief Allocates a stream which keeps the smallest k of the strings pushed to it, in
+ * 	O(k) memory whatever their number. comparator is as in myStringTopK.
+ * 	It is the caller's responsibility to free the stream.
+ * @param k
+ * @param comparator custom comparator of MyString pointers, or NULL.
+ * RETURN VALUE:
+ *  @return the stream, or NULL on failure.
+ */
+MyStringTopKStream * myStringTopKStreamAlloc(unsigned long k,
+											 int (*comparator) (const void *, const void *));
+
+/**
+ * @brief Frees a stream with the strings it keeps.
+ * @param stream
+ */
+void myStringTopKStreamFree(MyStringTopKStream *stream);
+
+/**
+ * @brief Pushes a string to a stream, which keeps a copy of it if it's among the
+ * 	smallest k so far. A copy which drops out is reused by the next one kept.
+ * @param stream
+ * @param str
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringTopKStreamPush(MyStringTopKStream *stream, const MyString *str);
+
+/**
+ * @brief Hands the strings a stream keeps over to the caller, in ascending order, and
+ * 	empties the stream. It is the caller's responsibility to free the strings.
+ * @param stream
+ * @param arr room for k strings.
+ * @param n pointer to set to the number of strings.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringTopKStreamTake(MyStringTopKStream *stream, MyString *arr[],
+									  unsigned long *n);
+
+/**
+ * @brief Sorts arr as myStringSort does and moves the first occurrence of every distinct
+ * 	string to its start, in order. The other occurrences are moved after them, in no
+ * 	particular order, for the caller to free or keep. Equal strings are found while
+ * 	sorting, so no string is compared twice.
+ * @param arr
+ * @param len
+ * @param uniqueLen pointer to set to the number of distinct strings.
+ * @param counts room for len numbers, set to the number of occurrences of every
+ * 	distinct string, or NULL.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (arr is left
+ *  	unchanged).
+ */
+MyStringRetVal myStringSortUnique(MyString *arr[], unsigned long len, unsigned long *uniqueLen,
+								  unsigned long counts[]);
+
+/**
+ * @brief Moves the first occurrence of every distinct string of arr to its start, in
+ * 	the order they first occur, by hashing rather than sorting. The other occurrences
+ * 	are moved after them as in myStringSortUnique.
+ * @param arr
+ * @param len
+ * @param distinctLen pointer to set to the number of distinct strings.
+ * @param counts room for len numbers, set to the number of occurrences of every
+ * 	distinct string, or NULL.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure (arr is left
+ *  	unchanged).
+ */
+MyStringRetVal myStringCountDistinct(MyString *arr[], unsigned long len,
+									 unsigned long *distinctLen, unsigned long counts[]);
+
+/**
+ * @brief Compiles n glob patterns, which match whole strings:
+ * 	'?' matches a char and '*' matches any chars, but neither matches '/'.
+ * 	'**' matches any chars. When it is a whole part of a path and a '/' follows it,
+ * 	both may also match nothing, so the pattern "src/", "**", "/x" matches "src/x".
+ * 	"[...]" matches a char of the class, which may hold ranges such as a-z, and "[!...]"
+ * 	or "[^...]" a char which isn't. A class never matches '/'.
+ * 	'\' makes the next char literal.
+ * 	It is the caller's responsibility to free the glob.
+ * @param patterns
+ * @param n the number of patterns, at least 1.
+ * RETURN VALUE:
+ *  @return the glob, or NULL on failure or if a class isn't closed.
+ */
+MyStringGlob * myStringGlobCompile(const MyStringView patterns[], unsigned long n);
+
+/**
+ * @brief Frees a glob.
+ * @param glob
+ */
+void myStringGlobFree(MyStringGlob *glob);
+
+/**
+ * @brief Checks if str matches any pattern of a glob. The chars are read once, for
+ * 	all the patterns together, in time linear in their number.
+ * @param glob
+ * @param str
+ * RETURN VALUE:
+ *  @return TRUE if it does, FALSE otherwise, MYSTR_ERROR_CODE on failure.
+ */
+int myStringGlobMatch(const MyStringGlob *glob, MyStringView str);
+
+/**
+ * @brief Checks which patterns of a glob str matches, in a single pass over its chars.
+ * @param glob
+ * @param str
+ * @param matches room for a result for every pattern, set to whether str matches it.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringGlobMatchAll(const MyStringGlob *glob, MyStringView str, bool matches[]);
+
+/**
+ * @brief Sets up a chunker, which cuts data into content defined chunks: the same
+ * 	content is cut the same wherever it is, so after an insertion or a deletion only the
+ * 	chunks around it change. The chunks are views of data and nothing is allocated.
+ * @param chunker
+ * @param data the data, which has to outlive the chunker.
+ * @param minSize the min size of a chunk, at least 1. The last chunk may be smaller.
+ * @param averageSize the size the chunks are cut around, at least 8 and at least minSize.
+ * @param maxSize the max size of a chunk, at least averageSize.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringChunkerInit(MyStringChunker *chunker, MyStringView data,
+                                   unsigned long minSize, unsigned long averageSize,
+                                   unsigned long maxSize);
+
+/**
+ * @brief Sets chunk to the next chunk of the data of a chunker.
+ * @param chunker
+ * @param chunk
+ * RETURN VALUE:
+ *  @return TRUE if there was a chunk, FALSE at the end of the data, MYSTR_ERROR_CODE on
+ *  	failure.
+ */
+int myStringChunkerNext(MyStringChunker *chunker, MyStringView *chunk);
+
+/**
+ * @brief Winnows the k-grams of text, for finding near duplicates: every k-gram is
+ * 	hashed and the smallest hash of every window of window k-grams is kept, the
+ * 	rightmost one on ties, once. Texts which share a substring of at least
+ * 	window + k - 1 chars share a fingerprint of it.
+ * 	A text shorter than window k-grams has one fingerprint, and one shorter than k none.
+ * @param text
+ * @param k the length of the k-grams, at least 1.
+ * @param window the number of k-grams in a window, between 1 and 256.
+ * @param fingerprints room for capacity fingerprints, set to the first of them in the
+ * 	order of their offsets.
+ * @param capacity
+ * @param count pointer to set to the number of fingerprints, which may be more than
+ * 	capacity, and at most n - k + 1 for a text of n chars.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringWinnow(MyStringView text, unsigned long k, unsigned long window,
+                              MyStringFingerprint fingerprints[], unsigned long capacity,
+                              unsigned long *count);
+
+/**
+ * @brief Allocates an array of n empty strings, laid out in a single block, which is
+ * 	freed by myStringFreeArray. The strings have no chars of their own until they are
+ * 	set, and then get them from the heap as any string does.
+ * 	The strings are freed with the array only, not by myStringFree, but the pointers
+ * 	may be reordered, for example by sorting them.
+ * @param n the number of strings.
+ * RETURN VALUE:
+ *  @return the array, or NULL on failure.
+ */
+MyString ** myStringAllocArray(unsigned long n);
+
+/**
+ * @brief Allocates an array of a string for every line of buffer, without its '\n'.
+ * 	Every line ends with '\n', except the last which may end with the buffer. The
+ * 	strings, their pointers and the chars of all the lines are laid out in a single
+ * 	block, and a string gets chars of its own from the heap only when it is changed.
+ * 	The array is freed by myStringFreeArray, as that of myStringAllocArray. Until a
+ * 	string of it is changed its chars are the array's, so moving or swapping them to a
+ * 	string out of the array is valid only while the array lives.
+ * @param buffer
+ * @param n pointer to set to the number of lines.
+ * RETURN VALUE:
+ *  @return the array, or NULL on failure.
+ */
+MyString ** myStringArrayFromLines(MyStringView buffer, unsigned long *n);
+
+/**
+ * @brief Frees an array of myStringAllocArray or myStringArrayFromLines with all its
+ * 	strings. If arr is NULL, no operation is performed.
+ * @param arr
+ */
+void myStringFreeArray(MyString **arr);
+
+/**
+ * @brief Compiles a regex. The syntax is a subset of that of Perl, without
+ * 	backreferences or lookaround, which can't be matched in linear time:
+ * 	.  ^  $  |  (...)  (?:...)  *  +  ?  {m}  {m,}  {m,n}, each repetition followed by
+ * 	an optional ? to be lazy but not by another repetition (Perl reads a++ as
+ * 	possessive), classes such as [a-z] and [^0-9], the escapes \d \w \s \D \W \S \n
+ * 	\t \r \f \v, and '\' before any other char which isn't a letter or a digit to take
+ * 	it literally. The chars are bytes, and '.' matches any of them but '\n'.
+ * 	'^' matches only at the start of the text and '$' only at its end: unlike Perl's,
+ * 	'$' doesn't match before a '\n' which ends the text.
+ * 	A regex caches the states of its DFAs, so it can't be used by several threads at
+ * 	once.
+ * @param pattern
+ * @param cacheBytes the bound of the memory of the states, 0 for a default of 1MB. When
+ * 	it is reached, the states are forgotten and built again, so matching stays linear.
+ * RETURN VALUE:
+ *  @return the regex, or NULL on failure or if the pattern isn't valid.
+ */
+MyStringRegex * myStringRegexCompile(MyStringView pattern, unsigned long cacheBytes);
+
+/**
+ * @brief Frees a regex. If regex is NULL, no operation is performed.
+ * @param regex
+ */
+void myStringRegexFree(MyStringRegex *regex);
+
+/**
+ * @brief Returns the number of the capturing groups of a regex.
+ * @param regex
+ * RETURN VALUE:
+ *  @return the number of groups, 0 if regex is NULL.
+ */
+unsigned long myStringRegexGroups(const MyStringRegex *regex);
+
+/**
+ * @brief Checks if the whole of text matches a regex.
+ * @param regex
+ * @param text
+ * RETURN VALUE:
+ *  @return TRUE if it does, FALSE otherwise, MYSTR_ERROR_CODE on failure.
+ */
+int myStringRegexMatch(MyStringRegex *regex, MyStringView text);
+
+/**
+ * @brief Finds the leftmost match of a regex in text. Of the matches which start there,
+ * 	it's the one a backtracking engine such as Perl's would find, which prefers the
+ * 	first alternative and the longer repetition, or the shorter one if it's lazy.
+ * 	Two cases differ from Perl: '$' matches only at the end of the text (see
+ * 	myStringRegexCompile), and a repetition whose body can match empty, such as
+ * 	(|\w)* or (a?)*, may match more or less than Perl's, which stops it at the first
+ * 	iteration which matches empty, so the end of the match may differ too.
+ * @param regex
+ * @param text
+ * @param match pointer to set to the match, a view of text.
+ * RETURN VALUE:
+ *  @return TRUE if there is a match, FALSE otherwise, MYSTR_ERROR_CODE on failure.
+ */
+int myStringRegexSearch(MyStringRegex *regex, MyStringView text, MyStringView *match);
+
+/**
+ * @brief Finds the match of a regex in text as myStringRegexSearch does, and the chars
+ * 	of its groups.
+ * @param regex
+ * @param text
+ * @param groups the views to set: the match and then every group, by the order of its
+ * 	'(', myStringRegexGroups(regex) + 1 in all. A group which didn't match is set to a
+ * 	NULL view.
+ * RETURN VALUE:
+ *  @return TRUE if there is a match, FALSE otherwise, MYSTR_ERROR_CODE on failure.
+ */
+int myStringRegexCaptures(MyStringRegex *regex, MyStringView text, MyStringView groups[]);
+
+/**
+ * @brief Sets up a reader of delimited text, as RFC 4180 describes: the rows end with
+ * 	'\n' (or "\r\n"), and a field which starts with '"' is quoted, so it may have
+ * 	delimiters and newlines, and "" in it stands for a '"'. Nothing is allocated.
+ * @param reader
+ * @param data the text, which has to outlive the reader.
+ * @param delimiter the delimiter of the fields, such as ',' or '\t'. It can't be '\0',
+ * 	'"', '\r' or '\n'.
+ * RETURN VALUE:
+ *  @return MYSTRING_SUCCESS on success, MYSTRING_ERROR on failure.
+ */
+MyStringRetVal myStringCsvReaderInit(MyStringCsvReader *reader, MyStringView data,
+                                     char delimiter);
+
+/**
+ * @brief Reads the next row of a reader. The fields are views of the data, without the
+ * 	quotes of quoted fields. The quoted fields which have "" in them are unescaped
+ * 	into arena, whose value is replaced, so their views are valid until arena is
+ * 	changed. The chars after the closing quote of a field are kept, and so is a field
+ * 	which doesn't start with '"', quotes and all, though its quotes have to come in
+ * 	pairs, as they hide the delimiters and newlines between them.
+ * @param reader
+ * @param arena the string to unescape fields into.
+ * @param fields the views to set to the fields.
+ * @param capacity the number of views in fields. The fields of a longer row after them
+ * 	are counted but not set.
+ * @param count pointer to set to the number of fields of the row.
+ * RETURN VALUE:
+ *  @return TRUE if there was a row, FALSE at the end of the data, MYSTR_ERROR_CODE on
+ *  	failure.
+ */
+int myStringCsvNextRow(MyStringCsvReader *reader, MyString *arena, MyStringView fields[],
+                       unsigned long capacity, unsigned long *count);
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif // _MYSTRING_H
 
@@ -0,0 +1,278 @@
+#ifndef _MYSTRING_HPP
+#define _MYSTRING_HPP
+
+/********************************************************************************
+ * @file MyString.hpp
+ * @author  orib
+ *
+ * @brief A header-only C++ owner of a MyString.
+ *
+ * @section DESCRIPTION
+ * UniqueMyString owns a MyString the way std::unique_ptr owns an object: it frees
+ * the string when it goes out of scope, it can be moved but not copied, and a copy
+ * is made only by an explicit clone(). An empty UniqueMyString holds no MyString at
+ * all, so default constructed and moved from objects (and so temporaries) never
+ * allocate; the MyString is allocated by the first change.
+ * The chars of a MyString are contiguous and always followed by '\0', so a
+ * UniqueMyString converts to std::string_view and to a C string without copying.
+ *
+ * Error handling
+ * ~~~~~~~~~~~~~~
+ * Functions which fail to allocate throw std::bad_alloc.
+ ********************************************************************************/
+
+#if __cplusplus < 201703L
+#error "MyString.hpp needs C++17 (for std::string_view)."
+#endif
+
+// ------------------------------ includes ------------------------------
+
+#include "MyString.h"
+#include <new>
+#include <string_view>
+#include <utility>
+#if __cplusplus >= 202002L
+#include <compare>
+#endif
+
+// ------------------------------ class ------------------------------
+
+class UniqueMyString
+{
+public:
+	/**
+	 * @brief Constructs an empty string, without allocating.
+	 */
+	UniqueMyString() noexcept = default;
+
+	/**
+	 * @brief Takes the ownership of str, which may be NULL.
+	 */
+	explicit UniqueMyString(MyString *str) noexcept : _str(str)
+	{
+	}
+
+	/**
+	 * @brief Constructs a string with the value of view.
+	 */
+	explicit UniqueMyString(std::string_view view) : UniqueMyString()
+	{
+		assign(view);
+	}
+
+	UniqueMyString(const UniqueMyString &) = delete;
+	UniqueMyString & operator=(const UniqueMyString &) = delete;
+
+	/**
+	 * @brief Takes the MyString of other, leaving other empty.
+	 */
+	UniqueMyString(UniqueMyString &&other) noexcept : _str(other.release())
+	{
+	}
+
+	/**
+	 * @brief Frees the MyString of this string and takes the one of other, leaving
+	 * other empty.
+	 */
+	UniqueMyString & operator=(UniqueMyString &&other) noexcept
+	{
+		reset(other.release());
+		return *this;
+	}
+
+	~UniqueMyString()
+	{
+		myStringFree(_str);
+	}
+
+	/**
+	 * @return a new string with the same value.
+	 */
+	UniqueMyString clone() const
+	{
+		if (_str == nullptr)
+		{
+			return UniqueMyString();
+		}
+		MyString *cloned = myStringClone(_str);
+		if (cloned == nullptr)
+		{
+			throw std::bad_alloc();
+		}
+		return UniqueMyString(cloned);
+	}
+
+	/**
+	 * @return the MyString, still owned by this string (NULL if it's empty without one).
+	 */
+	MyString * get() const noexcept
+	{
+		return _str;
+	}
+
+	/**
+	 * @return the MyString, which the caller now owns and has to free.
+	 */
+	MyString * release() noexcept
+	{
+		return std::exchange(_str, nullptr);
+	}
+
+	/**
+	 * @brief Frees the MyString of this string and takes the ownership of str.
+	 */
+	void reset(MyString *str = nullptr) noexcept
+	{
+		myStringFree(std::exchange(_str, str));
+	}
+
+	void swap(UniqueMyString &other) noexcept
+	{
+		std::swap(_str, other._str);
+	}
+
+	/**
+	 * @brief Sets the value of this string to the value of view.
+	 */
+	UniqueMyString & assign(std::string_view view)
+	{
+		// The view may point into this string itself.
+		if (myStringSetFromView(ensureAllocated(), toMyStringView(view)) == MYSTRING_ERROR)
+		{
+			throw std::bad_alloc();
+		}
+		return *this;
+	}
+
+	/**
+	 * @brief Appends view to this string.
+	 */
+	UniqueMyString & append(std::string_view view)
+	{
+		if (myStringAppendView(ensureAllocated(), toMyStringView(view)) == MYSTRING_ERROR)
+		{
+			throw std::bad_alloc();
+		}
+		return *this;
+	}
+
+	UniqueMyString & operator+=(std::string_view view)
+	{
+		return append(view);
+	}
+
+	unsigned long size() const noexcept
+	{
+		return _str == nullptr ? EMPTY_STRING_LENGTH : myStringLen(_str);
+	}
+
+	bool empty() const noexcept
+	{
+		return size() == EMPTY_STRING_LENGTH;
+	}
+
+	/**
+	 * @return the chars as a C string, valid until this string is changed.
+	 */
+	const char * c_str() const noexcept
+	{
+		return _str == nullptr ? "" : myStringCStr(_str);
+	}
+
+	/**
+	 * @return a view of the chars, valid until this string is changed.
+	 */
+	std::string_view view() const noexcept
+	{
+		return std::string_view(c_str(), size());
+	}
+
+	operator std::string_view() const noexcept
+	{
+		return view();
+	}
+
+	friend bool operator==(const UniqueMyString &str1, const UniqueMyString &str2) noexcept
+	{
+		return compare(str1, str2) == EQUAL_STRINGS;
+	}
+
+#if __cplusplus >= 202002L
+	friend std::strong_ordering operator<=>(const UniqueMyString &str1,
+											const UniqueMyString &str2) noexcept
+	{
+		return compare(str1, str2) <=> EQUAL_STRINGS;
+	}
+#else
+	friend bool operator!=(const UniqueMyString &str1, const UniqueMyString &str2) noexcept
+	{
+		return compare(str1, str2) != EQUAL_STRINGS;
+	}
+
+	friend bool operator<(const UniqueMyString &str1, const UniqueMyString &str2) noexcept
+	{
+		return compare(str1, str2) < EQUAL_STRINGS;
+	}
+
+	friend bool operator>(const UniqueMyString &str1, const UniqueMyString &str2) noexcept
+	{
+		return compare(str1, str2) > EQUAL_STRINGS;
+	}
+
+	friend bool operator<=(const UniqueMyString &str1, const UniqueMyString &str2) noexcept
+	{
+		return compare(str1, str2) <= EQUAL_STRINGS;
+	}
+
+	friend bool operator>=(const UniqueMyString &str1, const UniqueMyString &str2) noexcept
+	{
+		return compare(str1, str2) >= EQUAL_STRINGS;
+	}
+#endif
+
+private:
+	/**
+	 * @brief Compares two strings by myStringCompare. A string without a MyString is
+	 * empty, so it's compared by its view rather than allocating one.
+	 * @return STR1_BIGGER, STR2_BIGGER or EQUAL_STRINGS.
+	 */
+	static int compare(const UniqueMyString &str1, const UniqueMyString &str2) noexcept
+	{
+		if (str1._str == nullptr || str2._str == nullptr)
+		{
+			int result = str1.view().compare(str2.view());
+			return result == 0 ? EQUAL_STRINGS : (result > 0 ? STR1_BIGGER : STR2_BIGGER);
+		}
+		return myStringCompare(str1._str, str2._str);
+	}
+
+	/**
+	 * @return the MyString of this string, allocated if it has none yet.
+	 */
+	MyString * ensureAllocated()
+	{
+		if (_str == nullptr)
+		{
+			_str = myStringAlloc();
+			if (_str == nullptr)
+			{
+				throw std::bad_alloc();
+			}
+		}
+		return _str;
+	}
+
+	static MyStringView toMyStringView(std::string_view view) noexcept
+	{
+		return MyStringView{view.data(), view.size()};
+	}
+
+	MyString *_str = nullptr;
+};
+
+inline void swap(UniqueMyString &str1, UniqueMyString &str2) noexcept
+{
+	str1.swap(str2);
+}
+
+#endif // _MYSTRING_HPP
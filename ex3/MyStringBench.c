@@ -0,0 +1,1340 @@
+/**
+ * @file MyStringBench.c
+ * @author  orib
+ *
+ * @brief Microbenchmarks of the MyString library, next to the libc code which does
+ * the same work. The std::string counterparts are in MyStringBenchStd.cpp, and both
+ * print their results in the same format.
+ *
+ * @section DESCRIPTION
+ * Every benchmark runs its operation a doubling number of times until the run takes
+ * at least MIN_RUN_TIME_NS, and reports the last run: the time, the bytes allocated
+ * and the allocations, per operation. Allocations are counted where they reach
+ * malloc and realloc, which the program wraps, so it must be linked with
+ * -Wl,--wrap=malloc,--wrap=realloc (as the bench target of the Makefile does).
+ * Blocks reused from the MyString block cache are therefore not counted.
+ * With --csv the results are printed as comma separated values instead of a table.
+ */
+
+// For clock_gettime, which c99 alone doesn't declare.
+#define _POSIX_C_SOURCE 200112L
+#include "MyString.h"
+#include <fnmatch.h>
+#include <regex.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MIN_RUN_TIME_NS 100000000ULL
+#define NS_PER_SECOND 1000000000ULL
+#define MAX_ITERATIONS (1UL << 30)
+
+#define SORT_STRINGS 10000
+#define SHORT_LENGTH_MIN 4
+#define SHORT_LENGTH_MAX 64
+#define LONG_LENGTH 1024
+#define CAT_PIECES 1000
+#define CAT_PIECE "0123456789abcdef"
+#define SHARED_PREFIX "/common/prefix/shared/by/all/of/the/strings/"
+#define NULL_DEVICE "/dev/null"
+#define RANDOM_SEED 88172645463325252ULL
+#define EDIT_MAX_DISTANCE 8
+#define BLOOM_BITS_PER_KEY 10
+#define REPLACE_NEEDLE "ab"
+#define REPLACE_REPLACEMENT "xyz"
+#define TOP_K 100
+#define GLOB_PATTERNS 300
+#define GLOB_PATHS 100
+#define GLOB_PATTERN "/api/v%d/users/*/posts/*"
+#define GLOB_PATH "/api/v%d/users/%d/posts/latest"
+#define CDC_DATA_BYTES (1UL << 20)
+#define CDC_MIN_SIZE 2048
+#define CDC_AVERAGE_SIZE 8192
+#define CDC_MAX_SIZE 65536
+#define CDC_GEAR_TABLE_SIZE 256
+#define CDC_LCG_MULTIPLIER 6364136223846793005ULL
+#define CDC_LCG_INCREMENT 1442695040888963407ULL
+#define REGEX_PATTERN "(qu|zz)[a-z]{0,8}ck"
+#define CSV_FIELDS 8
+#define CSV_QUOTED_EVERY 16
+
+#define CSV_OPTION "--csv"
+#define CSV_HEADER "impl,benchmark,iterations,ns_per_op,bytes_per_op,allocs_per_op\n"
+#define CSV_ROW "%s,%s,%lu,%.1f,%.1f,%.2f\n"
+#define TABLE_HEADER "%-9s %-18s %12s %12s %10s %10s\n"
+#define TABLE_ROW "%-9s %-18s %12lu %12.1f %10.1f %10.2f\n"
+
+/*
+ * A benchmark: its name, the implementation it measures and the operation, which
+ * runs the given number of times.
+ */
+typedef struct _Benchmark
+{
+	const char *_impl;
+	const char *_name;
+	void (*_run)(unsigned long iterations);
+} Benchmark;
+
+/*
+ * The input of the benchmarks, created once.
+ */
+static char *shortCString;
+static char *otherShortCString;
+static char *longCString;
+static char *randomCStrings[SORT_STRINGS];
+static char *prefixCStrings[SORT_STRINGS];
+static MyString *shortMyString;
+static MyString *otherShortMyString;
+static MyString *longMyString;
+static MyString *catPiece;
+static MyString *randomMyStrings[SORT_STRINGS];
+static MyString *prefixMyStrings[SORT_STRINGS];
+
+/*
+ * The allocations so far, counted by the wrappers of malloc and realloc.
+ */
+static unsigned long allocations = 0;
+static unsigned long allocatedBytes = 0;
+
+/*
+ * Keep the results of the operations alive, so the compiler doesn't drop them.
+ */
+static volatile long sink;
+static void * volatile pointerSink;
+
+/*
+ * The functions wrapped by the linker.
+ */
+void * __real_malloc(size_t size);
+void * __real_realloc(void *block, size_t size);
+
+/**
+ * @brief Counts an allocation and passes it on to malloc.
+ */
+void * __wrap_malloc(size_t size)
+{
+	allocations++;
+	allocatedBytes += size;
+	return __real_malloc(size);
+}
+
+/**
+ * @brief Counts a reallocation and passes it on to realloc.
+ */
+void * __wrap_realloc(void *block, size_t size)
+{
+	allocations++;
+	allocatedBytes += size;
+	return __real_realloc(block, size);
+}
+
+/**
+ * @brief The next number of a xorshift generator, so every run gets the same input.
+ * @return a pseudo random number.
+ */
+static unsigned long long nextRandom()
+{
+	static unsigned long long state = RANDOM_SEED;
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return state;
+}
+
+/**
+ * @brief Allocates a C string of random lowercase letters after a prefix.
+ * @param prefix
+ * @param length the number of random letters.
+ * @return the C string.
+ */
+static char * randomCString(const char *prefix, unsigned long length)
+{
+	unsigned long prefixLength = strlen(prefix);
+	char *cString = (char *) malloc(prefixLength + length + 1);
+	if (cString == NULL)
+	{
+		exit(EXIT_FAILURE);
+	}
+	memcpy(cString, prefix, prefixLength);
+	for (unsigned long i = 0; i < length; i++)
+	{
+		cString[prefixLength + i] = (char) ('a' + nextRandom() % 26);
+	}
+	cString[prefixLength + length] = '\0';
+	return cString;
+}
+
+/**
+ * @brief Allocates a MyString with the value of a C string.
+ * @param cString
+ * @return the MyString.
+ */
+static MyString * newMyString(const char *cString)
+{
+	MyString *str = myStringAlloc();
+	if (str == NULL || myStringSetFromCString(str, cString) == MYSTRING_ERROR)
+	{
+		exit(EXIT_FAILURE);
+	}
+	return str;
+}
+
+/**
+ * @brief Creates the input of the benchmarks.
+ */
+static void createInput()
+{
+	shortCString = randomCString("", SHORT_LENGTH_MAX / 2);
+	// An equal string in another buffer, so the comparison reads both.
+	otherShortCString = randomCString(shortCString, 0);
+	longCString = randomCString("", LONG_LENGTH);
+	for (int i = 0; i < SORT_STRINGS; i++)
+	{
+		unsigned long length = SHORT_LENGTH_MIN +
+							   nextRandom() % (SHORT_LENGTH_MAX - SHORT_LENGTH_MIN);
+		randomCStrings[i] = randomCString("", length);
+		prefixCStrings[i] = randomCString(SHARED_PREFIX, SHORT_LENGTH_MIN);
+		randomMyStrings[i] = newMyString(randomCStrings[i]);
+		prefixMyStrings[i] = newMyString(prefixCStrings[i]);
+	}
+	shortMyString = newMyString(shortCString);
+	otherShortMyString = newMyString(shortCString);
+	longMyString = newMyString(longCString);
+	catPiece = newMyString(CAT_PIECE);
+}
+
+/**
+ * @brief Frees the input of the benchmarks.
+ */
+static void freeInput()
+{
+	for (int i = 0; i < SORT_STRINGS; i++)
+	{
+		free(randomCStrings[i]);
+		free(prefixCStrings[i]);
+		myStringFree(randomMyStrings[i]);
+		myStringFree(prefixMyStrings[i]);
+	}
+	free(shortCString);
+	free(otherShortCString);
+	free(longCString);
+	myStringFree(shortMyString);
+	myStringFree(otherShortMyString);
+	myStringFree(longMyString);
+	myStringFree(catPiece);
+}
+
+/**
+ * @brief Compares C strings for qsort.
+ */
+static int cStringComparator(const void *str1, const void *str2)
+{
+	return strcmp(*(char * const *) str1, *(char * const *) str2);
+}
+
+/**
+ * @brief The filter of the filter benchmarks, keeps the letters up to 'm'.
+ */
+static bool isFirstHalf(const char *c)
+{
+	return *c <= 'm';
+}
+
+/**
+ * @brief The edit distance by the plain dynamic programming over a whole matrix, as
+ * the edit benchmarks compute it without the library.
+ */
+static unsigned long naiveEditDistance(const char *str1, const char *str2)
+{
+	size_t length1 = strlen(str1);
+	size_t length2 = strlen(str2);
+	size_t columns = length2 + 1;
+	unsigned long *matrix = (unsigned long *) malloc((length1 + 1) * columns * sizeof(unsigned long));
+	for (size_t i = 0; i <= length1; i++)
+	{
+		for (size_t j = 0; j <= length2; j++)
+		{
+			// The first row and column are the distances to "".
+			unsigned long best = i + j;
+			if (i > 0 && j > 0)
+			{
+				best = matrix[(i - 1) * columns + j - 1] + (str1[i - 1] != str2[j - 1]);
+				unsigned long above = matrix[(i - 1) * columns + j] + 1;
+				unsigned long left = matrix[i * columns + j - 1] + 1;
+				best = above < best ? above : best;
+				best = left < best ? left : best;
+			}
+			matrix[i * columns + j] = best;
+		}
+	}
+	unsigned long distance = matrix[length1 * columns + length2];
+	free(matrix);
+	return distance;
+}
+
+/**
+ * @brief The base64 of length bytes by a char at a time, as the base64 benchmark
+ * encodes without the library. out has room for the padded chars.
+ */
+static void naiveBase64Encode(char *out, const unsigned char *bytes, size_t length)
+{
+	static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	for (size_t i = 0; i < length; i += 3)
+	{
+		unsigned long bits = (unsigned long) bytes[i] << 16;
+		bits |= i + 1 < length ? (unsigned long) bytes[i + 1] << 8 : 0;
+		bits |= i + 2 < length ? bytes[i + 2] : 0;
+		*out++ = alphabet[bits >> 18];
+		*out++ = alphabet[(bits >> 12) & 0x3F];
+		*out++ = i + 1 < length ? alphabet[(bits >> 6) & 0x3F] : '=';
+		*out++ = i + 2 < length ? alphabet[bits & 0x3F] : '=';
+	}
+	*out = '\0';
+}
+
+/**
+ * @brief The bytes of base64 by a char at a time, with strchr for the value of every
+ * char. Returns the number of bytes.
+ */
+static size_t naiveBase64Decode(unsigned char *out, const char *base64)
+{
+	static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	size_t length = 0;
+	for (size_t i = 0; base64[i] != '\0' && base64[i] != '='; i++)
+	{
+		unsigned long value = (unsigned long) (strchr(alphabet, base64[i]) - alphabet);
+		switch (i % 4)
+		{
+			case 0:
+				out[length] = (unsigned char) (value << 2);
+				break;
+			case 1:
+				out[length++] |= (unsigned char) (value >> 4);
+				out[length] = (unsigned char) (value << 4);
+				break;
+			case 2:
+				out[length++] |= (unsigned char) (value >> 2);
+				out[length] = (unsigned char) (value << 6);
+				break;
+			default:
+				out[length++] |= (unsigned char) value;
+		}
+	}
+	return length;
+}
+
+// ------------------------------ MyString benchmarks ------------------------------
+
+static void myStringAllocFree(unsigned long iterations)
+{
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		MyString *str = myStringAlloc();
+		pointerSink = str;
+		myStringFree(str);
+	}
+}
+
+static void myStringSetShort(unsigned long iterations)
+{
+	MyString *str = myStringAlloc();
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		myStringSetFromCString(str, shortCString);
+	}
+	myStringFree(str);
+}
+
+static void myStringSetLong(unsigned long iterations)
+{
+	MyString *str = myStringAlloc();
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		myStringSetFromCString(str, longCString);
+	}
+	myStringFree(str);
+}
+
+static void myStringCatChain(unsigned long iterations)
+{
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		MyString *str = myStringAlloc();
+		for (int j = 0; j < CAT_PIECES; j++)
+		{
+			myStringCat(str, catPiece);
+		}
+		sink += myStringLen(str);
+		myStringFree(str);
+	}
+}
+
+static void myStringCompareShort(unsigned long iterations)
+{
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		sink += myStringCompare(randomMyStrings[i % SORT_STRINGS],
+								randomMyStrings[(i + 1) % SORT_STRINGS]);
+	}
+}
+
+static void myStringEqualShort(unsigned long iterations)
+{
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		sink += myStringEqual(shortMyString, otherShortMyString);
+	}
+}
+
+/**
+ * @brief Sorts a copy of strs, iterations times.
+ */
+static void sortMyStrings(MyString *strs[], unsigned long iterations)
+{
+	MyString **arr = (MyString **) malloc(SORT_STRINGS * sizeof(MyString *));
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		memcpy(arr, strs, SORT_STRINGS * sizeof(MyString *));
+		myStringSort(arr, SORT_STRINGS);
+	}
+	free(arr);
+}
+
+static void myStringSortRandom(unsigned long iterations)
+{
+	sortMyStrings(randomMyStrings, iterations);
+}
+
+static void myStringSortPrefix(unsigned long iterations)
+{
+	sortMyStrings(prefixMyStrings, iterations);
+}
+
+static void myStringFilterLong(unsigned long iterations)
+{
+	MyString *str = myStringAlloc();
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		myStringSetFromMyString(str, longMyString);
+		myStringFilter(str, isFirstHalf);
+	}
+	myStringFree(str);
+}
+
+static void myStringIntRoundTrip(unsigned long iterations)
+{
+	MyString *str = myStringAlloc();
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		myStringSetFromInt(str, (int) i);
+		sink += myStringToInt(str);
+	}
+	myStringFree(str);
+}
+
+static void myStringWriteLong(unsigned long iterations)
+{
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		// myStringWrite closes the stream.
+		myStringWrite(longMyString, fopen(NULL_DEVICE, "w"));
+	}
+}
+
+static void myStringEditDistanceShort(unsigned long iterations)
+{
+	unsigned long distance = 0;
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		myStringEditDistance(randomMyStrings[i % SORT_STRINGS],
+							 randomMyStrings[(i + 1) % SORT_STRINGS], &distance);
+		sink += (long) distance;
+	}
+}
+
+/**
+ * @brief Finds the strings within EDIT_MAX_DISTANCE of the first one, iterations times.
+ */
+static void myStringEditFilter(unsigned long iterations)
+{
+	unsigned long *distances = (unsigned long *) malloc(SORT_STRINGS * sizeof(unsigned long));
+	MyStringEditPattern *pattern = myStringEditPatternAlloc(randomMyStrings[0]);
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		myStringEditPatternDistances(pattern, (const MyString **) randomMyStrings, SORT_STRINGS,
+									 EDIT_MAX_DISTANCE, distances);
+		sink += (long) distances[i % SORT_STRINGS];
+	}
+	myStringEditPatternFree(pattern);
+	free(distances);
+}
+
+/**
+ * @brief Encodes the long string to base64 and decodes it back, iterations times.
+ */
+static void myStringBase64RoundTrip(unsigned long iterations)
+{
+	MyString *base64 = myStringAlloc();
+	MyString *decoded = myStringAlloc();
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		myStringSetFromCString(base64, "");
+		myStringSetFromCString(decoded, "");
+		myStringAppendBase64(base64, myStringGetView(longMyString));
+		myStringAppendFromBase64(decoded, myStringGetView(base64));
+	}
+	sink += (long) myStringLen(decoded);
+	myStringFree(base64);
+	myStringFree(decoded);
+}
+
+/**
+ * @brief Looks the prefixed strings, none of which are there, up in a filter of the
+ * random ones, iterations times.
+ */
+static void myStringBloomMiss(unsigned long iterations)
+{
+	MyStringView *keys = (MyStringView *) malloc(SORT_STRINGS * sizeof(MyStringView));
+	bool *results = (bool *) malloc(SORT_STRINGS * sizeof(bool));
+	MyStringBloomFilter *filter = myStringBloomFilterAlloc(SORT_STRINGS, BLOOM_BITS_PER_KEY);
+	for (int i = 0; i < SORT_STRINGS; i++)
+	{
+		keys[i] = myStringGetView(randomMyStrings[i]);
+	}
+	myStringBloomFilterAddBatch(filter, keys, SORT_STRINGS);
+	for (int i = 0; i < SORT_STRINGS; i++)
+	{
+		keys[i] = myStringGetView(prefixMyStrings[i]);
+	}
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		myStringBloomFilterContainsBatch(filter, keys, SORT_STRINGS, results);
+		sink += results[i % SORT_STRINGS];
+	}
+	myStringBloomFilterFree(filter);
+	free(keys);
+	free(results);
+}
+
+/**
+ * @brief Replaces REPLACE_NEEDLE in a copy of the long string, iterations times.
+ */
+static void myStringReplaceAllLong(unsigned long iterations)
+{
+	MyString *str = myStringAlloc();
+	MyStringView needle = {REPLACE_NEEDLE, strlen(REPLACE_NEEDLE)};
+	MyStringView replacement = {REPLACE_REPLACEMENT, strlen(REPLACE_REPLACEMENT)};
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		myStringSetFromMyString(str, longMyString);
+		myStringReplaceAll(str, needle, replacement);
+	}
+	sink += (long) myStringLen(str);
+	myStringFree(str);
+}
+
+/**
+ * @brief Selects the smallest TOP_K of the random strings, iterations times.
+ */
+static void myStringTopKRandom(unsigned long iterations)
+{
+	MyString **arr = (MyString **) malloc(SORT_STRINGS * sizeof(MyString *));
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		memcpy(arr, randomMyStrings, SORT_STRINGS * sizeof(MyString *));
+		myStringTopK(arr, SORT_STRINGS, TOP_K, NULL);
+	}
+	sink += (long) myStringLen(arr[0]);
+	free(arr);
+}
+
+/**
+ * @brief Sorts the random strings and their copies and drops the copies, iterations
+ * times.
+ */
+static void myStringSortUniqueRandom(unsigned long iterations)
+{
+	MyString **arr = (MyString **) malloc(2 * SORT_STRINGS * sizeof(MyString *));
+	unsigned long uniqueLen = 0;
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		memcpy(arr, randomMyStrings, SORT_STRINGS * sizeof(MyString *));
+		memcpy(arr + SORT_STRINGS, randomMyStrings, SORT_STRINGS * sizeof(MyString *));
+		myStringSortUnique(arr, 2 * SORT_STRINGS, &uniqueLen, NULL);
+	}
+	sink += (long) uniqueLen;
+	free(arr);
+}
+
+/**
+ * @brief Matches GLOB_PATHS paths against all of GLOB_PATTERNS patterns at once,
+ * iterations times.
+ */
+static void myStringGlobRoutes(unsigned long iterations)
+{
+	MyString *patternStrs[GLOB_PATTERNS];
+	MyStringView patterns[GLOB_PATTERNS];
+	MyString *paths[GLOB_PATHS];
+	bool matches[GLOB_PATTERNS];
+	for (int i = 0; i < GLOB_PATTERNS; i++)
+	{
+		patternStrs[i] = myStringAlloc();
+		myStringSetf(patternStrs[i], GLOB_PATTERN, i);
+		patterns[i] = myStringGetView(patternStrs[i]);
+	}
+	for (int i = 0; i < GLOB_PATHS; i++)
+	{
+		paths[i] = myStringAlloc();
+		myStringSetf(paths[i], GLOB_PATH, i * 3, i);
+	}
+	MyStringGlob *glob = myStringGlobCompile(patterns, GLOB_PATTERNS);
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		for (int j = 0; j < GLOB_PATHS; j++)
+		{
+			myStringGlobMatchAll(glob, myStringGetView(paths[j]), matches);
+			sink += matches[j];
+		}
+	}
+	myStringGlobFree(glob);
+	for (int i = 0; i < GLOB_PATTERNS; i++)
+	{
+		myStringFree(patternStrs[i]);
+	}
+	for (int i = 0; i < GLOB_PATHS; i++)
+	{
+		myStringFree(paths[i]);
+	}
+}
+
+/**
+ * @brief Allocates CDC_DATA_BYTES random bytes, from a generator of their own so the
+ * 	input of the other benchmarks doesn't depend on which ran before.
+ * @return the bytes.
+ */
+static char * createChunkData()
+{
+	char *data = malloc(CDC_DATA_BYTES);
+	unsigned long long state = RANDOM_SEED;
+	for (unsigned long i = 0; i < CDC_DATA_BYTES; i++)
+	{
+		state = state * CDC_LCG_MULTIPLIER + CDC_LCG_INCREMENT;
+		data[i] = (char) (state >> 56);
+	}
+	return data;
+}
+
+static void myStringChunkData(unsigned long iterations)
+{
+	char *data = createChunkData();
+	MyStringChunker chunker;
+	MyStringView chunk;
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		myStringChunkerInit(&chunker, (MyStringView) {data, CDC_DATA_BYTES}, CDC_MIN_SIZE,
+							CDC_AVERAGE_SIZE, CDC_MAX_SIZE);
+		while (myStringChunkerNext(&chunker, &chunk) == TRUE)
+		{
+			sink += (long) chunk._length;
+		}
+	}
+	free(data);
+}
+
+/**
+ * @brief Joins the random strings into lines, one after another.
+ * @param length pointer to set to the number of chars.
+ * @return the lines.
+ */
+static char * createLines(unsigned long *length)
+{
+	*length = 0;
+	for (int i = 0; i < SORT_STRINGS; i++)
+	{
+		*length += strlen(randomCStrings[i]) + 1;
+	}
+	char *lines = malloc(*length);
+	char *end = lines;
+	for (int i = 0; i < SORT_STRINGS; i++)
+	{
+		unsigned long lineLength = strlen(randomCStrings[i]);
+		memcpy(end, randomCStrings[i], lineLength);
+		end[lineLength] = '\n';
+		end += lineLength + 1;
+	}
+	return lines;
+}
+
+static void myStringLinesRandom(unsigned long iterations)
+{
+	unsigned long length = 0;
+	char *lines = createLines(&length);
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		unsigned long n = 0;
+		MyString **arr = myStringArrayFromLines((MyStringView) {lines, length}, &n);
+		sink += (long) n;
+		myStringFreeArray(arr);
+	}
+	free(lines);
+}
+
+/**
+ * @brief Finds all the matches of REGEX_PATTERN in the lines of the random strings.
+ */
+static void myStringRegexLines(unsigned long iterations)
+{
+	unsigned long length = 0;
+	char *lines = createLines(&length);
+	MyStringRegex *regex = myStringRegexCompile((MyStringView) {REGEX_PATTERN,
+																strlen(REGEX_PATTERN)}, 0);
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		MyStringView rest = {lines, length};
+		MyStringView match = {NULL, 0};
+		while (myStringRegexSearch(regex, rest, &match) == TRUE)
+		{
+			sink++;
+			unsigned long end = match._chars - rest._chars + match._length;
+			rest._chars += end;
+			rest._length -= end;
+		}
+	}
+	myStringRegexFree(regex);
+	free(lines);
+}
+
+/**
+ * @brief Joins the random strings into CSV rows of CSV_FIELDS fields, of which every
+ * CSV_QUOTED_EVERY one is quoted, with a delimiter and a "" in it.
+ * @param length pointer to set to the number of chars.
+ * @return the rows.
+ */
+static char * createCsv(unsigned long *length)
+{
+	MyString *csv = myStringAlloc();
+	for (int i = 0; i < SORT_STRINGS; i++)
+	{
+		char separator = i % CSV_FIELDS == CSV_FIELDS - 1 ? '\n' : ',';
+		myStringAppendf(csv, i % CSV_QUOTED_EVERY == 0 ? "\"%s,\"\"x\"\"\"%c" : "%s%c",
+						randomCStrings[i], separator);
+	}
+	*length = myStringLen(csv);
+	char *rows = myStringToCString(csv);
+	myStringFree(csv);
+	return rows;
+}
+
+static void myStringCsvRows(unsigned long iterations)
+{
+	unsigned long length = 0;
+	char *rows = createCsv(&length);
+	MyString *arena = myStringAlloc();
+	MyStringView fields[CSV_FIELDS];
+	MyStringCsvReader reader;
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		unsigned long count = 0;
+		myStringCsvReaderInit(&reader, (MyStringView) {rows, length}, ',');
+		while (myStringCsvNextRow(&reader, arena, fields, CSV_FIELDS, &count) == TRUE)
+		{
+			sink += (long) fields[count - 1]._length;
+		}
+	}
+	myStringFree(arena);
+	free(rows);
+}
+
+// ------------------------------ libc benchmarks ------------------------------
+
+static void libcAllocFree(unsigned long iterations)
+{
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		char *str = (char *) malloc(1);
+		*str = '\0';
+		pointerSink = str;
+		free(str);
+	}
+}
+
+/**
+ * @brief Copies a C string into a buffer grown by realloc, iterations times.
+ */
+static void libcSet(const char *cString, unsigned long iterations)
+{
+	char *str = NULL;
+	size_t capacity = 0;
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		size_t length = strlen(cString);
+		if (length + 1 > capacity)
+		{
+			capacity = length + 1;
+			str = (char *) realloc(str, capacity);
+		}
+		memcpy(str, cString, length + 1);
+	}
+	free(str);
+}
+
+static void libcSetShort(unsigned long iterations)
+{
+	libcSet(shortCString, iterations);
+}
+
+static void libcSetLong(unsigned long iterations)
+{
+	libcSet(longCString, iterations);
+}
+
+static void libcCatChain(unsigned long iterations)
+{
+	size_t pieceLength = strlen(CAT_PIECE);
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		char *str = (char *) malloc(1);
+		size_t length = 0;
+		for (int j = 0; j < CAT_PIECES; j++)
+		{
+			str = (char *) realloc(str, length + pieceLength + 1);
+			memcpy(str + length, CAT_PIECE, pieceLength + 1);
+			length += pieceLength;
+		}
+		sink += (long) strlen(str);
+		free(str);
+	}
+}
+
+static void libcCompareShort(unsigned long iterations)
+{
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		sink += strcmp(randomCStrings[i % SORT_STRINGS], randomCStrings[(i + 1) % SORT_STRINGS]);
+	}
+}
+
+static void libcEqualShort(unsigned long iterations)
+{
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		sink += strcmp(shortCString, otherShortCString) == 0;
+	}
+}
+
+/**
+ * @brief Sorts a copy of cStrings, iterations times.
+ */
+static void sortCStrings(char *cStrings[], unsigned long iterations)
+{
+	char **arr = (char **) malloc(SORT_STRINGS * sizeof(char *));
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		memcpy(arr, cStrings, SORT_STRINGS * sizeof(char *));
+		qsort(arr, SORT_STRINGS, sizeof(char *), cStringComparator);
+	}
+	free(arr);
+}
+
+static void libcSortRandom(unsigned long iterations)
+{
+	sortCStrings(randomCStrings, iterations);
+}
+
+static void libcSortPrefix(unsigned long iterations)
+{
+	sortCStrings(prefixCStrings, iterations);
+}
+
+static void libcFilterLong(unsigned long iterations)
+{
+	char *str = (char *) malloc(LONG_LENGTH + 1);
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		memcpy(str, longCString, LONG_LENGTH + 1);
+		size_t filteredLength = 0;
+		for (size_t j = 0; str[j] != '\0'; j++)
+		{
+			if (isFirstHalf(str + j))
+			{
+				str[filteredLength++] = str[j];
+			}
+		}
+		str[filteredLength] = '\0';
+	}
+	free(str);
+}
+
+static void libcIntRoundTrip(unsigned long iterations)
+{
+	char str[SHORT_LENGTH_MAX];
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		snprintf(str, sizeof(str), "%d", (int) i);
+		sink += atoi(str);
+	}
+}
+
+static void libcWriteLong(unsigned long iterations)
+{
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		FILE *stream = fopen(NULL_DEVICE, "w");
+		fputs(longCString, stream);
+		fclose(stream);
+	}
+}
+
+static void libcEditDistanceShort(unsigned long iterations)
+{
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		sink += (long) naiveEditDistance(randomCStrings[i % SORT_STRINGS],
+										 randomCStrings[(i + 1) % SORT_STRINGS]);
+	}
+}
+
+static void libcEditFilter(unsigned long iterations)
+{
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		for (int j = 0; j < SORT_STRINGS; j++)
+		{
+			sink += naiveEditDistance(randomCStrings[0], randomCStrings[j]) <= EDIT_MAX_DISTANCE;
+		}
+	}
+}
+
+static void libcBase64RoundTrip(unsigned long iterations)
+{
+	char *base64 = (char *) malloc((LONG_LENGTH + 2) / 3 * 4 + 1);
+	unsigned char *decoded = (unsigned char *) malloc(LONG_LENGTH);
+	size_t length = 0;
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		naiveBase64Encode(base64, (const unsigned char *) longCString, LONG_LENGTH);
+		length = naiveBase64Decode(decoded, base64);
+	}
+	sink += (long) length;
+	free(base64);
+	free(decoded);
+}
+
+/**
+ * @brief Looks the prefixed strings up in the sorted random ones by binary search.
+ */
+static void libcBloomMiss(unsigned long iterations)
+{
+	char **sorted = (char **) malloc(SORT_STRINGS * sizeof(char *));
+	memcpy(sorted, randomCStrings, SORT_STRINGS * sizeof(char *));
+	qsort(sorted, SORT_STRINGS, sizeof(char *), cStringComparator);
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		for (int j = 0; j < SORT_STRINGS; j++)
+		{
+			sink += bsearch(&prefixCStrings[j], sorted, SORT_STRINGS, sizeof(char *),
+							cStringComparator) != NULL;
+		}
+	}
+	free(sorted);
+}
+
+/**
+ * @brief Replaces REPLACE_NEEDLE in a copy of the long string by strstr, counting the
+ * occurrences first to allocate once.
+ */
+static void libcReplaceAllLong(unsigned long iterations)
+{
+	size_t needleLength = strlen(REPLACE_NEEDLE);
+	size_t replacementLength = strlen(REPLACE_REPLACEMENT);
+	char *result = NULL;
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		size_t count = 0;
+		for (const char *match = strstr(longCString, REPLACE_NEEDLE); match != NULL;
+			 match = strstr(match + needleLength, REPLACE_NEEDLE))
+		{
+			count++;
+		}
+		free(result);
+		result = (char *) malloc(LONG_LENGTH + count * replacementLength + 1);
+		char *out = result;
+		const char *next = longCString;
+		for (const char *match = strstr(next, REPLACE_NEEDLE); match != NULL;
+			 match = strstr(next, REPLACE_NEEDLE))
+		{
+			memcpy(out, next, (size_t) (match - next));
+			out += match - next;
+			memcpy(out, REPLACE_REPLACEMENT, replacementLength);
+			out += replacementLength;
+			next = match + needleLength;
+		}
+		strcpy(out, next);
+	}
+	sink += (long) strlen(result);
+	free(result);
+}
+
+/**
+ * @brief Selects the smallest TOP_K of the random strings by sorting all of them.
+ */
+static void libcTopKRandom(unsigned long iterations)
+{
+	sortCStrings(randomCStrings, iterations);
+}
+
+/**
+ * @brief Sorts the random strings and their copies, and drops the copies by a scan.
+ */
+static void libcSortUniqueRandom(unsigned long iterations)
+{
+	char **arr = (char **) malloc(2 * SORT_STRINGS * sizeof(char *));
+	unsigned long uniqueLen = 0;
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		memcpy(arr, randomCStrings, SORT_STRINGS * sizeof(char *));
+		memcpy(arr + SORT_STRINGS, randomCStrings, SORT_STRINGS * sizeof(char *));
+		qsort(arr, 2 * SORT_STRINGS, sizeof(char *), cStringComparator);
+		uniqueLen = 1;
+		for (unsigned long j = 1; j < 2 * SORT_STRINGS; j++)
+		{
+			if (strcmp(arr[j], arr[uniqueLen - 1]) != 0)
+			{
+				arr[uniqueLen++] = arr[j];
+			}
+		}
+	}
+	sink += (long) uniqueLen;
+	free(arr);
+}
+
+/**
+ * @brief Matches GLOB_PATHS paths against every one of GLOB_PATTERNS patterns by
+ * fnmatch.
+ */
+static void libcGlobRoutes(unsigned long iterations)
+{
+	char patterns[GLOB_PATTERNS][64];
+	char paths[GLOB_PATHS][64];
+	for (int i = 0; i < GLOB_PATTERNS; i++)
+	{
+		snprintf(patterns[i], sizeof(patterns[i]), GLOB_PATTERN, i);
+	}
+	for (int i = 0; i < GLOB_PATHS; i++)
+	{
+		snprintf(paths[i], sizeof(paths[i]), GLOB_PATH, i * 3, i);
+	}
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		for (int j = 0; j < GLOB_PATHS; j++)
+		{
+			for (int k = 0; k < GLOB_PATTERNS; k++)
+			{
+				sink += fnmatch(patterns[k], paths[j], FNM_PATHNAME) == 0;
+			}
+		}
+	}
+}
+
+/**
+ * @brief The textbook FastCDC loop: a Gear hash rolled a byte at a time.
+ */
+static void libcChunkData(unsigned long iterations)
+{
+	char *data = createChunkData();
+	unsigned long long gear[CDC_GEAR_TABLE_SIZE];
+	unsigned long long state = RANDOM_SEED;
+	for (int i = 0; i < CDC_GEAR_TABLE_SIZE; i++)
+	{
+		state = state * CDC_LCG_MULTIPLIER + CDC_LCG_INCREMENT;
+		gear[i] = state;
+	}
+	// The masks for an average of 8192 bytes, with 2 bits of normalization.
+	const unsigned long long smallMask = ~0ULL << (64 - 15);
+	const unsigned long long largeMask = ~0ULL << (64 - 11);
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		unsigned long offset = 0;
+		while (offset < CDC_DATA_BYTES)
+		{
+			const unsigned char *chars = (const unsigned char *) data + offset;
+			unsigned long remaining = CDC_DATA_BYTES - offset;
+			unsigned long end = remaining < CDC_MAX_SIZE ? remaining : CDC_MAX_SIZE;
+			unsigned long normalEnd = end < CDC_AVERAGE_SIZE ? end : CDC_AVERAGE_SIZE;
+			unsigned long size = remaining <= CDC_MIN_SIZE ? remaining : CDC_MIN_SIZE;
+			unsigned long long hash = 0;
+			for (; size < normalEnd; size++)
+			{
+				hash = (hash << 1) + gear[chars[size]];
+				if ((hash & smallMask) == 0)
+				{
+					break;
+				}
+			}
+			if (size < normalEnd)
+			{
+				size++;
+			}
+			else
+			{
+				for (; size < end; size++)
+				{
+					hash = (hash << 1) + gear[chars[size]];
+					if ((hash & largeMask) == 0)
+					{
+						size++;
+						break;
+					}
+				}
+			}
+			sink += (long) size;
+			offset += size;
+		}
+	}
+	free(data);
+}
+
+static void libcLinesRandom(unsigned long iterations)
+{
+	unsigned long length = 0;
+	char *lines = createLines(&length);
+	char *arr[SORT_STRINGS];
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		char *lineStart = lines;
+		unsigned long n = 0;
+		for (; n < SORT_STRINGS; n++)
+		{
+			char *lineEnd = memchr(lineStart, '\n', lines + length - lineStart);
+			arr[n] = malloc(lineEnd - lineStart + 1);
+			memcpy(arr[n], lineStart, lineEnd - lineStart);
+			arr[n][lineEnd - lineStart] = '\0';
+			lineStart = lineEnd + 1;
+		}
+		sink += (long) n;
+		for (unsigned long j = 0; j < n; j++)
+		{
+			free(arr[j]);
+		}
+	}
+	free(lines);
+}
+
+/**
+ * @brief Finds all the matches of REGEX_PATTERN in the lines by POSIX regexec.
+ */
+static void libcRegexLines(unsigned long iterations)
+{
+	unsigned long length = 0;
+	char *lines = createLines(&length);
+	lines[length - 1] = '\0';
+	regex_t regex;
+	regcomp(&regex, REGEX_PATTERN, REG_EXTENDED);
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		const char *rest = lines;
+		regmatch_t match;
+		while (regexec(&regex, rest, 1, &match, 0) == 0)
+		{
+			sink++;
+			rest += match.rm_eo;
+		}
+	}
+	regfree(&regex);
+	free(lines);
+}
+
+/**
+ * @brief Parses the CSV rows a char at a time, copying every field to a block of its own.
+ */
+static void libcCsvRows(unsigned long iterations)
+{
+	unsigned long length = 0;
+	char *rows = createCsv(&length);
+	char *fields[CSV_FIELDS];
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		unsigned long j = 0;
+		while (j < length)
+		{
+			int count = 0;
+			bool isRowEnd = false;
+			while (!isRowEnd)
+			{
+				unsigned long fieldCapacity = SHORT_LENGTH_MAX;
+				char *field = malloc(fieldCapacity);
+				unsigned long fieldLength = 0;
+				bool isQuoted = rows[j] == '"';
+				j += isQuoted;
+				for (; j < length; j++)
+				{
+					if (isQuoted && rows[j] == '"')
+					{
+						isQuoted = j + 1 < length && rows[j + 1] == '"';
+						j += isQuoted;
+						if (!isQuoted)
+						{
+							continue;
+						}
+					}
+					else if (!isQuoted && (rows[j] == ',' || rows[j] == '\n'))
+					{
+						break;
+					}
+					if (fieldLength + 1 == fieldCapacity)
+					{
+						fieldCapacity *= 2;
+						field = realloc(field, fieldCapacity);
+					}
+					field[fieldLength++] = rows[j];
+				}
+				field[fieldLength] = '\0';
+				isRowEnd = j >= length || rows[j] == '\n';
+				j++;
+				fields[count++] = field;
+			}
+			sink += (long) strlen(fields[count - 1]);
+			for (int k = 0; k < count; k++)
+			{
+				free(fields[k]);
+			}
+		}
+	}
+	free(rows);
+}
+
+// ------------------------------ runner ------------------------------
+
+/*
+ * The benchmarks, every MyString benchmark followed by its libc counterpart.
+ */
+static const Benchmark benchmarks[] =
+{
+	{"mystring", "alloc_free", myStringAllocFree},
+	{"libc", "alloc_free", libcAllocFree},
+	{"mystring", "set_short", myStringSetShort},
+	{"libc", "set_short", libcSetShort},
+	{"mystring", "set_long", myStringSetLong},
+	{"libc", "set_long", libcSetLong},
+	{"mystring", "cat_chain_1000", myStringCatChain},
+	{"libc", "cat_chain_1000", libcCatChain},
+	{"mystring", "compare_short", myStringCompareShort},
+	{"libc", "compare_short", libcCompareShort},
+	{"mystring", "equal_short", myStringEqualShort},
+	{"libc", "equal_short", libcEqualShort},
+	{"mystring", "sort_random_10k", myStringSortRandom},
+	{"libc", "sort_random_10k", libcSortRandom},
+	{"mystring", "sort_prefix_10k", myStringSortPrefix},
+	{"libc", "sort_prefix_10k", libcSortPrefix},
+	{"mystring", "filter_long", myStringFilterLong},
+	{"libc", "filter_long", libcFilterLong},
+	{"mystring", "int_round_trip", myStringIntRoundTrip},
+	{"libc", "int_round_trip", libcIntRoundTrip},
+	{"mystring", "write_long", myStringWriteLong},
+	{"libc", "write_long", libcWriteLong},
+	{"mystring", "edit_distance_short", myStringEditDistanceShort},
+	{"libc", "edit_distance_short", libcEditDistanceShort},
+	{"mystring", "edit_filter_10k", myStringEditFilter},
+	{"libc", "edit_filter_10k", libcEditFilter},
+	{"mystring", "base64_round_trip", myStringBase64RoundTrip},
+	{"libc", "base64_round_trip", libcBase64RoundTrip},
+	{"mystring", "bloom_miss_10k", myStringBloomMiss},
+	{"libc", "bloom_miss_10k", libcBloomMiss},
+	{"mystring", "replace_all_long", myStringReplaceAllLong},
+	{"libc", "replace_all_long", libcReplaceAllLong},
+	{"mystring", "top_100_of_10k", myStringTopKRandom},
+	{"libc", "top_100_of_10k", libcTopKRandom},
+	{"mystring", "sort_unique_2x10k", myStringSortUniqueRandom},
+	{"libc", "sort_unique_2x10k", libcSortUniqueRandom},
+	{"mystring", "glob_routes_300", myStringGlobRoutes},
+	{"libc", "glob_routes_300", libcGlobRoutes},
+	{"mystring", "cdc_chunk_1m", myStringChunkData},
+	{"libc", "cdc_chunk_1m", libcChunkData},
+	{"mystring", "lines_10k", myStringLinesRandom},
+	{"libc", "lines_10k", libcLinesRandom},
+	{"mystring", "regex_lines_10k", myStringRegexLines},
+	{"libc", "regex_lines_10k", libcRegexLines},
+	{"mystring", "csv_rows_10k", myStringCsvRows},
+	{"libc", "csv_rows_10k", libcCsvRows}
+};
+
+/**
+ * @return the time of the monotonic clock, in nanoseconds.
+ */
+static unsigned long long nowNs()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (unsigned long long) now.tv_sec * NS_PER_SECOND + now.tv_nsec;
+}
+
+/**
+ * @brief Runs a benchmark and prints its result.
+ * @param benchmark
+ * @param isCsv whether to print comma separated values.
+ */
+static void runBenchmark(const Benchmark *benchmark, bool isCsv)
+{
+	unsigned long iterations = 1;
+	unsigned long long elapsed = 0;
+	unsigned long allocationsBefore = 0;
+	unsigned long bytesBefore = 0;
+	while (true)
+	{
+		allocationsBefore = allocations;
+		bytesBefore = allocatedBytes;
+		unsigned long long start = nowNs();
+		benchmark -> _run(iterations);
+		elapsed = nowNs() - start;
+		if (elapsed >= MIN_RUN_TIME_NS || iterations >= MAX_ITERATIONS)
+		{
+			break;
+		}
+		iterations *= 2;
+	}
+	double nsPerOp = (double) elapsed / iterations;
+	double allocationsPerOp = (double) (allocations - allocationsBefore) / iterations;
+	double bytesPerOp = (double) (allocatedBytes - bytesBefore) / iterations;
+	printf(isCsv ? CSV_ROW : TABLE_ROW, benchmark -> _impl, benchmark -> _name, iterations,
+		   nsPerOp, bytesPerOp, allocationsPerOp);
+	fflush(stdout);
+}
+
+/**
+ * @brief Runs all the benchmarks, or those whose names are given.
+ * 	Usage: MyStringBench [--csv] [benchmark...]
+ */
+int main(int argc, char *argv[])
+{
+	bool isCsv = false;
+	int firstName = 1;
+	if (argc > 1 && strcmp(argv[1], CSV_OPTION) == 0)
+	{
+		isCsv = true;
+		firstName = 2;
+	}
+	createInput();
+	if (isCsv)
+	{
+		printf(CSV_HEADER);
+	}
+	else
+	{
+		printf(TABLE_HEADER, "impl", "benchmark", "iterations", "ns/op", "B/op", "allocs/op");
+	}
+	for (unsigned long i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); i++)
+	{
+		bool isChosen = firstName == argc;
+		for (int j = firstName; j < argc && !isChosen; j++)
+		{
+			isChosen = strcmp(argv[j], benchmarks[i]._name) == 0;
+		}
+		if (isChosen)
+		{
+			runBenchmark(&benchmarks[i], isCsv);
+		}
+	}
+	freeInput();
+	return 0;
+}
@@ -0,0 +1,347 @@
+/**
+ * @file MyStringBenchStd.cpp
+ * @author  orib
+ *
+ * @brief The std::string counterparts of the benchmarks of MyStringBench.c, with the
+ * same input and the same output format, so their results can be put side by side.
+ * The allocations are counted by replacing the global operator new.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#define MIN_RUN_TIME_NS 100000000ULL
+#define MAX_ITERATIONS (1UL << 30)
+
+#define SORT_STRINGS 10000
+#define SHORT_LENGTH_MIN 4
+#define SHORT_LENGTH_MAX 64
+#define LONG_LENGTH 1024
+#define CAT_PIECES 1000
+#define CAT_PIECE "0123456789abcdef"
+#define SHARED_PREFIX "/common/prefix/shared/by/all/of/the/strings/"
+#define NULL_DEVICE "/dev/null"
+#define RANDOM_SEED 88172645463325252ULL
+
+#define CSV_OPTION "--csv"
+#define CSV_HEADER "impl,benchmark,iterations,ns_per_op,bytes_per_op,allocs_per_op\n"
+#define CSV_ROW "%s,%s,%lu,%.1f,%.1f,%.2f\n"
+#define TABLE_HEADER "%-9s %-18s %12s %12s %10s %10s\n"
+#define TABLE_ROW "%-9s %-18s %12lu %12.1f %10.1f %10.2f\n"
+
+/*
+ * The allocations of the benchmarks.
+ */
+static unsigned long allocations = 0;
+static unsigned long allocatedBytes = 0;
+
+/*
+ * The replacements are kept out of line: inlined, g++ sees the free() of a block from
+ * operator new and warns of a mismatched delete (-Wmismatched-new-delete), though both
+ * sides are these replacements.
+ */
+#define OUT_OF_LINE __attribute__((noinline))
+
+OUT_OF_LINE void * operator new(std::size_t size)
+{
+	allocations++;
+	allocatedBytes += size;
+	void *block = std::malloc(size == 0 ? 1 : size);
+	if (block == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return block;
+}
+
+OUT_OF_LINE void operator delete(void *block) noexcept
+{
+	std::free(block);
+}
+
+OUT_OF_LINE void operator delete(void *block, std::size_t) noexcept
+{
+	std::free(block);
+}
+
+/*
+ * The input of the benchmarks, the same as in MyStringBench.c.
+ */
+static std::string shortString;
+static std::string otherShortString;
+static std::string longString;
+static std::vector<std::string> randomStrings;
+static std::vector<std::string> prefixStrings;
+
+/*
+ * Keep the results of the operations alive, so the compiler doesn't drop them.
+ */
+static volatile long sink;
+static void * volatile pointerSink;
+
+/**
+ * @brief The next number of a xorshift generator, the same as in MyStringBench.c.
+ * @return a pseudo random number.
+ */
+static unsigned long long nextRandom()
+{
+	static unsigned long long state = RANDOM_SEED;
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return state;
+}
+
+/**
+ * @brief Creates a string of random lowercase letters after a prefix.
+ */
+static std::string randomString(const char *prefix, unsigned long length)
+{
+	std::string str(prefix);
+	for (unsigned long i = 0; i < length; i++)
+	{
+		str += (char) ('a' + nextRandom() % 26);
+	}
+	return str;
+}
+
+/**
+ * @brief Creates the input of the benchmarks, drawing the same numbers as
+ * MyStringBench.c.
+ */
+static void createInput()
+{
+	shortString = randomString("", SHORT_LENGTH_MAX / 2);
+	otherShortString = shortString;
+	longString = randomString("", LONG_LENGTH);
+	for (int i = 0; i < SORT_STRINGS; i++)
+	{
+		unsigned long length = SHORT_LENGTH_MIN +
+							   nextRandom() % (SHORT_LENGTH_MAX - SHORT_LENGTH_MIN);
+		randomStrings.push_back(randomString("", length));
+		prefixStrings.push_back(randomString(SHARED_PREFIX, SHORT_LENGTH_MIN));
+	}
+}
+
+static void stdAllocFree(unsigned long iterations)
+{
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		std::string *str = new std::string();
+		pointerSink = str;
+		delete str;
+	}
+}
+
+/**
+ * @brief Assigns a C string to a reused string, iterations times.
+ */
+static void stdSet(const char *cString, unsigned long iterations)
+{
+	std::string str;
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		str = cString;
+	}
+	sink += (long) str.size();
+}
+
+static void stdSetShort(unsigned long iterations)
+{
+	stdSet(shortString.c_str(), iterations);
+}
+
+static void stdSetLong(unsigned long iterations)
+{
+	stdSet(longString.c_str(), iterations);
+}
+
+static void stdCatChain(unsigned long iterations)
+{
+	const std::string piece(CAT_PIECE);
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		std::string str;
+		for (int j = 0; j < CAT_PIECES; j++)
+		{
+			str += piece;
+		}
+		sink += (long) str.size();
+	}
+}
+
+static void stdCompareShort(unsigned long iterations)
+{
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		sink += randomStrings[i % SORT_STRINGS].compare(randomStrings[(i + 1) % SORT_STRINGS]);
+	}
+}
+
+static void stdEqualShort(unsigned long iterations)
+{
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		sink += shortString == otherShortString;
+	}
+}
+
+/**
+ * @brief Sorts a copy of the pointers to strs, iterations times, as the C benchmarks
+ * sort pointers.
+ */
+static void sortStrings(const std::vector<std::string> &strs, unsigned long iterations)
+{
+	std::vector<const std::string *> pointers;
+	for (const std::string &str : strs)
+	{
+		pointers.push_back(&str);
+	}
+	std::vector<const std::string *> arr(pointers.size());
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		std::copy(pointers.begin(), pointers.end(), arr.begin());
+		std::sort(arr.begin(), arr.end(),
+				  [](const std::string *str1, const std::string *str2) { return *str1 < *str2; });
+	}
+}
+
+static void stdSortRandom(unsigned long iterations)
+{
+	sortStrings(randomStrings, iterations);
+}
+
+static void stdSortPrefix(unsigned long iterations)
+{
+	sortStrings(prefixStrings, iterations);
+}
+
+static void stdFilterLong(unsigned long iterations)
+{
+	std::string str;
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		str = longString;
+		str.erase(std::remove_if(str.begin(), str.end(), [](char c) { return c > 'm'; }),
+				  str.end());
+	}
+	sink += (long) str.size();
+}
+
+static void stdIntRoundTrip(unsigned long iterations)
+{
+	std::string str;
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		str = std::to_string((int) i);
+		sink += std::stoi(str);
+	}
+}
+
+static void stdWriteLong(unsigned long iterations)
+{
+	for (unsigned long i = 0; i < iterations; i++)
+	{
+		FILE *stream = std::fopen(NULL_DEVICE, "w");
+		std::fwrite(longString.data(), sizeof(char), longString.size(), stream);
+		std::fclose(stream);
+	}
+}
+
+/*
+ * A benchmark: its name and the operation, which runs the given number of times.
+ */
+struct Benchmark
+{
+	const char *_name;
+	void (*_run)(unsigned long iterations);
+};
+
+static const Benchmark benchmarks[] =
+{
+	{"alloc_free", stdAllocFree},
+	{"set_short", stdSetShort},
+	{"set_long", stdSetLong},
+	{"cat_chain_1000", stdCatChain},
+	{"compare_short", stdCompareShort},
+	{"equal_short", stdEqualShort},
+	{"sort_random_10k", stdSortRandom},
+	{"sort_prefix_10k", stdSortPrefix},
+	{"filter_long", stdFilterLong},
+	{"int_round_trip", stdIntRoundTrip},
+	{"write_long", stdWriteLong}
+};
+
+/**
+ * @brief Runs a benchmark and prints its result, as MyStringBench.c does.
+ */
+static void runBenchmark(const Benchmark &benchmark, bool isCsv)
+{
+	unsigned long iterations = 1;
+	unsigned long long elapsed = 0;
+	unsigned long allocationsBefore = 0;
+	unsigned long bytesBefore = 0;
+	while (true)
+	{
+		allocationsBefore = allocations;
+		bytesBefore = allocatedBytes;
+		auto start = std::chrono::steady_clock::now();
+		benchmark._run(iterations);
+		elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now() - start).count();
+		if (elapsed >= MIN_RUN_TIME_NS || iterations >= MAX_ITERATIONS)
+		{
+			break;
+		}
+		iterations *= 2;
+	}
+	double nsPerOp = (double) elapsed / iterations;
+	double allocationsPerOp = (double) (allocations - allocationsBefore) / iterations;
+	double bytesPerOp = (double) (allocatedBytes - bytesBefore) / iterations;
+	std::printf(isCsv ? CSV_ROW : TABLE_ROW, "std", benchmark._name, iterations, nsPerOp,
+				bytesPerOp, allocationsPerOp);
+	std::fflush(stdout);
+}
+
+/**
+ * @brief Runs all the benchmarks, or those whose names are given.
+ * 	Usage: MyStringBenchStd [--csv] [benchmark...]
+ */
+int main(int argc, char *argv[])
+{
+	bool isCsv = false;
+	int firstName = 1;
+	if (argc > 1 && std::strcmp(argv[1], CSV_OPTION) == 0)
+	{
+		isCsv = true;
+		firstName = 2;
+	}
+	createInput();
+	if (isCsv)
+	{
+		std::printf(CSV_HEADER);
+	}
+	else
+	{
+		std::printf(TABLE_HEADER, "impl", "benchmark", "iterations", "ns/op", "B/op", "allocs/op");
+	}
+	for (const Benchmark &benchmark : benchmarks)
+	{
+		bool isChosen = firstName == argc;
+		for (int j = firstName; j < argc && !isChosen; j++)
+		{
+			isChosen = std::strcmp(argv[j], benchmark._name) == 0;
+		}
+		if (isChosen)
+		{
+			runBenchmark(benchmark, isCsv);
+		}
+	}
+	return 0;
+}
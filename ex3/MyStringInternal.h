@@ -0,0 +1,31 @@
+#ifndef _MYSTRING_INTERNAL_H
+#define _MYSTRING_INTERNAL_H
+
+/********************************************************************************
+ * @file MyStringInternal.h
+ * @author  orib
+ *
+ * @brief The functions which the translation units of the MyString library share,
+ * and which aren't a part of its interface.
+ ********************************************************************************/
+
+// ------------------------------ includes ------------------------------
+
+#include "MyString.h"
+
+// ------------------------------ functions -----------------------------
+
+/**
+ * @brief Finds the first occurrence of a needle in chars, by the same search as the
+ * 	functions of MyString.c.
+ * @param chars
+ * @param length the number of chars.
+ * @param needle at least 1 char.
+ * @param needleLength
+ * RETURN VALUE:
+ *  @return the first occurrence, or NULL if there's none.
+ */
+const char * myStringFindChars(const char *chars, unsigned long length, const char *needle,
+                               unsigned long needleLength);
+
+#endif // _MYSTRING_INTERNAL_H
@@ -99,7 +99,7 @@ int main()
 
 	}
 
-
+	myStringReleaseThreadCache();
 	return 0;
 
 
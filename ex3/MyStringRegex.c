@@ -0,0 +1,2234 @@
+/**
+ * @file MyStringRegex.c
+ * @author  orib
+ *
+ * @brief The regexes of the MyString library.
+ *
+ * @section DESCRIPTION
+ * A regex is parsed to a tree of nodes and compiled to a Thompson NFA, which is never
+ * run directly to find a match: lazily built DFAs run it a byte at a time, a forward
+ * one to find where the leftmost match ends and a reverse one, from there, where it
+ * starts, so matching takes linear time. The groups of a match are found by running
+ * the NFA over the match alone, as a Pike VM does.
+ */
+
+// ------------------------------ includes ------------------------------
+#include "MyString.h"
+#include "MyStringInternal.h"
+
+// -------------------------- const definitions -------------------------
+
+/*
+* A regex is compiled to the instructions of a Thompson NFA, which is run by DFAs built
+* lazily, one state at a time, in caches of bounded size. A state of a DFA is the list of
+* the instructions its threads are at, in the order of their priority.
+*/
+#define REGEX_OP_CLASS 0
+#define REGEX_OP_SPLIT 1
+#define REGEX_OP_SAVE 2
+#define REGEX_OP_BEGIN 3
+#define REGEX_OP_END 4
+#define REGEX_OP_MATCH 5
+#define REGEX_NODE_CLASS 0
+#define REGEX_NODE_BEGIN 1
+#define REGEX_NODE_END 2
+#define REGEX_NODE_GROUP 3
+#define REGEX_NODE_CONCATENATION 4
+#define REGEX_NODE_ALTERNATION 5
+#define REGEX_NODE_REPETITION 6
+#define REGEX_NO_NODE UINT_MAX
+#define REGEX_NO_INST UINT_MAX
+#define REGEX_UNBOUNDED UINT_MAX
+#define REGEX_MAX_INSTS (1U << 16)
+#define REGEX_MAX_DEPTH 1000
+#define REGEX_MAX_REPEAT 1000
+#define REGEX_BYTES (UCHAR_MAX + 1)
+#define REGEX_CLASS_WORDS (REGEX_BYTES / (sizeof(unsigned long long) * CHAR_BIT))
+#define REGEX_WORD_BITS (sizeof(unsigned long long) * CHAR_BIT)
+
+/*
+* The special chars of regexes.
+*/
+#define REGEX_ANY '.'
+#define REGEX_BEGIN '^'
+#define REGEX_END '$'
+#define REGEX_ALTERNATION '|'
+#define REGEX_GROUP_START '('
+#define REGEX_GROUP_END ')'
+#define REGEX_GROUP_FLAG '?'
+#define REGEX_NON_CAPTURING ':'
+#define REGEX_STAR '*'
+#define REGEX_PLUS '+'
+#define REGEX_QUESTION '?'
+#define REGEX_LAZY '?'
+#define REGEX_REPEAT_START '{'
+#define REGEX_REPEAT_END '}'
+#define REGEX_REPEAT_SEPARATOR ','
+#define REGEX_CLASS_START '['
+#define REGEX_CLASS_END ']'
+#define REGEX_CLASS_NOT '^'
+#define REGEX_CLASS_RANGE '-'
+#define REGEX_ESCAPE '\\'
+
+/*
+* The cache of a regex is shared by its DFAs: the one of searches, the one of whole
+* matches and the reverse one, which finds where a match starts. A DFA which fills its
+* share forgets its states, but never with fewer than REGEX_MIN_STATES of them.
+*/
+#define REGEX_DEFAULT_CACHE_BYTES (1UL << 20)
+#define REGEX_DFAS 3
+#define REGEX_MIN_STATES 8
+#define REGEX_START_KINDS 4
+#define REGEX_START_AT_BEGIN 1
+#define REGEX_START_AT_END 2
+#define REGEX_DEAD_STATE (-1)
+#define REGEX_UNKNOWN_STATE (-2)
+#define REGEX_FAILED_STATE (-3)
+#define REGEX_NO_POSITION ULONG_MAX
+#define REGEX_NO_SLOT UINT_MAX
+
+// ------------------------------ structures -----------------------------
+
+/*
+ * An instruction of the NFA of a regex.
+ */
+typedef struct _RegexInst
+{
+    unsigned int _op;
+    unsigned int _next;
+    // The other next instruction of a split, the class of a char or the slot of a save.
+    unsigned int _arg;
+}RegexInst;
+
+/*
+ * The instructions of a regex, which are emitted from the last one backwards.
+ */
+typedef struct _RegexProgram
+{
+    RegexInst *_insts;
+    unsigned int _count;
+    unsigned int _capacity;
+}RegexProgram;
+
+/*
+ * A state of a DFA of a regex.
+ */
+typedef struct _RegexDfaState
+{
+    // The instructions of the threads of the state, in _pcs of the DFA.
+    unsigned long _pcStart;
+    unsigned int _pcCount;
+    bool _isMatch;
+}RegexDfaState;
+
+/*
+ * A DFA of a regex, whose states and transitions are built when they are first needed.
+ */
+typedef struct _RegexDfa
+{
+    const RegexInst *_insts;
+    unsigned int _start;
+    // Whether the threads after a match are dropped, as leftmost first matching does,
+    // rather than kept for longer matches.
+    bool _isFirst;
+    RegexDfaState *_states;
+    // The next state of every state by byte class, and then by the end of the text.
+    int *_next;
+    unsigned int *_pcs;
+    // The states by the hash of their instructions, open addressing, 0 for empty and
+    // the state + 1 otherwise.
+    unsigned int *_slots;
+    unsigned long _count;
+    unsigned long _capacity;
+    unsigned long _pcCount;
+    unsigned long _pcCapacity;
+    unsigned long _slotCount;
+    unsigned long _maxBytes;
+    // The number of times the states were forgotten, after which their ids are invalid.
+    unsigned long _flushes;
+    int _startStates[REGEX_START_KINDS];
+}RegexDfa;
+
+/*
+ * A frame of the stack of adding a thread when finding the groups: an instruction to
+ * visit, or a position to put back in a slot after the visit.
+ */
+typedef struct _RegexFrame
+{
+    unsigned int _pc;
+    // The slot to put the position back in, or REGEX_NO_SLOT for a visit.
+    unsigned int _slot;
+    unsigned long _position;
+}RegexFrame;
+
+typedef struct _MyStringRegex
+{
+    // The program of searches starts with a lazy loop over any byte at 0, before the
+    // program of matches at _anchoredStart.
+    RegexProgram _program;
+    unsigned int _anchoredStart;
+    RegexProgram _reverseProgram;
+    unsigned int _reverseStart;
+    // REGEX_CLASS_WORDS words of the bits of the bytes of every class.
+    unsigned long long *_classes;
+    unsigned int _classCount;
+    unsigned int _classCapacity;
+    // The bytes which every class treats alike share a byte class, of which the DFAs
+    // have transitions.
+    unsigned char _byteMap[REGEX_BYTES];
+    unsigned char _representatives[REGEX_BYTES];
+    unsigned int _byteClasses;
+    // The literal chars every match starts with, which searches skip to.
+    char *_prefix;
+    unsigned long _prefixLength;
+    unsigned int _groups;
+    RegexDfa _searchDfa;
+    RegexDfa _matchDfa;
+    RegexDfa _reverseDfa;
+    // The scratch of building states: the instructions visited, the stack of the visit
+    // and the list of the threads.
+    unsigned int *_visitedDense;
+    unsigned int *_visitedSparse;
+    unsigned int _visitedCount;
+    unsigned int *_stack;
+    unsigned int *_list;
+    // The scratch of finding the groups, with the positions of their slots for every
+    // thread, allocated only for regexes with groups.
+    unsigned int *_threadDense[2];
+    unsigned int *_threadSparse[2];
+    unsigned long *_threadSlots[2];
+    unsigned long *_slots;
+    RegexFrame *_frames;
+}MyStringRegex;
+
+/*
+ * The state of parsing a regex to its nodes, which refer to each other by index.
+ */
+typedef struct _RegexNode
+{
+    unsigned int _type;
+    // The first and last children, of which only groups and repetitions have one.
+    unsigned int _first;
+    unsigned int _last;
+    unsigned int _nextSibling;
+    unsigned int _prevSibling;
+    // The bounds of a repetition.
+    unsigned int _min;
+    unsigned int _max;
+    bool _isGreedy;
+    // The class of a char, or the index of a group.
+    unsigned int _arg;
+}RegexNode;
+
+typedef struct _RegexParser
+{
+    MyStringView _pattern;
+    unsigned long _position;
+    RegexNode *_nodes;
+    unsigned int _count;
+    unsigned int _capacity;
+    unsigned int _depth;
+    MyStringRegex *_regex;
+}RegexParser;
+
+// ------------------------------ functions -----------------------------
+
+/**
+ * @brief Add a node to those of a regex being parsed.
+ * @param parser the parser.
+ * @param type the type of the node.
+ * @return the node, or REGEX_NO_NODE on failure.
+ */
+static unsigned int addRegexNode(RegexParser *parser, unsigned int type);
+
+/**
+ * @brief Add a child to the end of the children of a node.
+ * @param parser the parser.
+ * @param parent the node.
+ * @param child the child.
+ */
+static void appendRegexChild(RegexParser *parser, unsigned int parent, unsigned int child);
+
+/**
+ * @brief Add a class of chars to a regex.
+ * @param regex the regex.
+ * @param members the bits of the chars of the class.
+ * @return the class, or REGEX_NO_NODE on failure.
+ */
+static unsigned int addRegexClass(MyStringRegex *regex, const unsigned long long *members);
+
+/**
+ * @brief Add a class node of the given chars.
+ * @param parser the parser.
+ * @param members the bits of the chars.
+ * @return the node, or REGEX_NO_NODE on failure.
+ */
+static unsigned int addRegexClassNode(RegexParser *parser, const unsigned long long *members);
+
+/**
+ * @brief Set the bit of a char in the bits of a class.
+ * @param members the bits.
+ * @param c the char.
+ */
+static void setRegexBit(unsigned long long *members, unsigned char c);
+
+/**
+ * @brief Check if a char is a member of a class of a regex.
+ * @param regex the regex.
+ * @param classIndex the class.
+ * @param c the char.
+ * @return true if it is, false otherwise.
+ */
+static bool isRegexClassMember(const MyStringRegex *regex, unsigned int classIndex,
+                               unsigned char c);
+
+/**
+ * @brief Set the bits of the chars of an escape: a class such as \d, a control char
+ * such as \n, or any other char but a letter or a digit, which is taken literally.
+ * @param c the char after the '\'.
+ * @param members the bits to set.
+ * @param single pointer to set to the char of an escape of a single char, or to -1.
+ * @return true if the escape is valid, false otherwise.
+ */
+static bool addRegexEscape(char c, unsigned long long *members, int *single);
+
+/**
+ * @brief Parse a class of a regex, from its '['.
+ * @param parser the parser.
+ * @return the node, or REGEX_NO_NODE on failure or if the class isn't valid.
+ */
+static unsigned int parseRegexClass(RegexParser *parser);
+
+/**
+ * @brief Parse an atom of a regex: a char, a class, an anchor or a group.
+ * @param parser the parser.
+ * @return the node, or REGEX_NO_NODE on failure or if the atom isn't valid.
+ */
+static unsigned int parseRegexAtom(RegexParser *parser);
+
+/**
+ * @brief Parse the bounds of a repetition from its '{', if they are valid.
+ * @param parser the parser, whose position is moved after the '}' if they are.
+ * @param min pointer to set to the min.
+ * @param max pointer to set to the max, REGEX_UNBOUNDED for none.
+ * @return true if they are valid, false if the '{' is a literal char.
+ */
+static bool parseRegexBounds(RegexParser *parser, unsigned int *min, unsigned int *max);
+
+/**
+ * @brief Parse a quantifier of a regex: '*', '+', '?' or valid bounds in '{' '}'.
+ * @param parser the parser, whose position is moved after the quantifier if there is one.
+ * @param min pointer to set to the min.
+ * @param max pointer to set to the max, REGEX_UNBOUNDED for none.
+ * @return true if there is a quantifier, false otherwise.
+ */
+static bool parseRegexQuantifier(RegexParser *parser, unsigned int *min, unsigned int *max);
+
+/**
+ * @brief Parse an atom of a regex with the repetition after it, if there is one.
+ * @param parser the parser.
+ * @return the node, or REGEX_NO_NODE on failure or if it isn't valid.
+ */
+static unsigned int parseRegexRepetition(RegexParser *parser);
+
+/**
+ * @brief Parse a concatenation of a regex, up to a '|', a ')' or the end.
+ * @param parser the parser.
+ * @return the node, or REGEX_NO_NODE on failure or if it isn't valid.
+ */
+static unsigned int parseRegexConcatenation(RegexParser *parser);
+
+/**
+ * @brief Parse an alternation of a regex, up to a ')' or the end.
+ * @param parser the parser.
+ * @return the node, or REGEX_NO_NODE on failure or if it isn't valid.
+ */
+static unsigned int parseRegexAlternation(RegexParser *parser);
+
+/**
+ * @brief Emit an instruction to a program of a regex.
+ * @param program the program.
+ * @param op the op of the instruction.
+ * @param next its next instruction.
+ * @param arg its arg.
+ * @return the instruction, or REGEX_NO_INST on failure or if there are too many.
+ */
+static unsigned int emitRegexInst(RegexProgram *program, unsigned int op, unsigned int next,
+                                  unsigned int arg);
+
+/**
+ * @brief Compile a node of a regex to the instructions which match it and then go on to
+ * next. The instructions are emitted backwards, so next is always known.
+ * @param program the program.
+ * @param nodes the nodes.
+ * @param node the node.
+ * @param next the instruction after the node.
+ * @param isReverse whether the program matches the text backwards.
+ * @return the first instruction, or REGEX_NO_INST on failure.
+ */
+static unsigned int compileRegexNode(RegexProgram *program, const RegexNode *nodes,
+                                     unsigned int node, unsigned int next, bool isReverse);
+
+/**
+ * @brief Compile a repetition of a regex, as compileRegexNode does: its min copies, and
+ * then a loop if it's unbounded, or max - min nested optional copies otherwise.
+ * @param program the program.
+ * @param nodes the nodes.
+ * @param node the node of the repetition.
+ * @param next the instruction after the node.
+ * @param isReverse whether the program matches the text backwards.
+ * @return the first instruction, or REGEX_NO_INST on failure.
+ */
+static unsigned int compileRegexRepetition(RegexProgram *program, const RegexNode *nodes,
+                                           unsigned int node, unsigned int next, bool isReverse);
+
+/**
+ * @brief Compile the program of a regex and its reverse program. The program of searches
+ * starts with a lazy loop over any byte, which starts a match at every position.
+ * @param regex the regex.
+ * @param nodes the nodes.
+ * @param root the node of the whole regex.
+ * @return true on success, false on failure.
+ */
+static bool compileRegexPrograms(MyStringRegex *regex, const RegexNode *nodes, unsigned int root);
+
+/**
+ * @brief Add the literal chars a node starts with to the prefix of a regex.
+ * @param regex the regex.
+ * @param nodes the nodes.
+ * @param node the node.
+ * @return true if the node is all literal chars, so the prefix may go on after it.
+ */
+static bool addRegexLiteralPrefix(MyStringRegex *regex, const RegexNode *nodes, unsigned int node);
+
+/**
+ * @brief Split the bytes to the byte classes of a regex: the bytes between two changes of
+ * the membership in any class are treated alike by all of them.
+ * @param regex the regex.
+ */
+static void setRegexByteClasses(MyStringRegex *regex);
+
+/**
+ * @brief Allocate the scratch of a regex, for the larger of its programs.
+ * @param regex the regex.
+ * @return true on success, false on failure.
+ */
+static bool allocRegexScratch(MyStringRegex *regex);
+
+/**
+ * @brief Set up a DFA of a regex, without states.
+ * @param dfa the DFA.
+ * @param insts the instructions it runs.
+ * @param start the instruction its threads start at.
+ * @param isFirst whether the threads after a match are dropped.
+ * @param maxBytes the bound of the memory of its states.
+ */
+static void initRegexDfa(RegexDfa *dfa, const RegexInst *insts, unsigned int start, bool isFirst,
+                         unsigned long maxBytes);
+
+/**
+ * @brief Free the states of a DFA of a regex.
+ * @param dfa the DFA.
+ */
+static void freeRegexDfa(RegexDfa *dfa);
+
+/**
+ * @brief Add the threads which an instruction leads to without a char, in the order of
+ * their priority, to the list of a regex. An instruction already visited since the list
+ * was started was added by a thread of a higher priority.
+ * @param regex the regex.
+ * @param insts the instructions.
+ * @param pc the instruction.
+ * @param atBegin whether the position is the start of the text.
+ * @param atEnd whether the position is the end of the text. Otherwise the assertions of
+ * the end are added as threads, which the end of the text moves on.
+ * @param isFirst whether the threads after a match are dropped.
+ * @param count pointer to the length of the list.
+ * @return true if a match was added and the threads after it are dropped.
+ */
+static bool addRegexDfaThreads(MyStringRegex *regex, const RegexInst *insts, unsigned int pc,
+                               bool atBegin, bool atEnd, bool isFirst, unsigned int *count);
+
+/**
+ * @brief Compute the size of the memory of the states of a DFA of a regex.
+ * @param regex the regex.
+ * @param states the number of states.
+ * @param pcs the number of instructions of all the states.
+ * @return the size in bytes.
+ */
+static unsigned long getRegexDfaBytes(const MyStringRegex *regex, unsigned long states,
+                                      unsigned long pcs);
+
+/**
+ * @brief Make room for a state of count instructions in a DFA of a regex. When its
+ * memory would grow over its bound, and it has at least REGEX_MIN_STATES states, its
+ * states are forgotten instead.
+ * @param regex the regex.
+ * @param dfa the DFA.
+ * @param count the number of instructions of the state.
+ * @return true on success, false on failure.
+ */
+static bool reserveRegexDfaState(MyStringRegex *regex, RegexDfa *dfa, unsigned long count);
+
+/**
+ * @brief Compute the hash of the instructions of a state of a DFA of a regex.
+ * @param pcs the instructions.
+ * @param count their number.
+ * @return the hash.
+ */
+static unsigned long long hashRegexDfaState(const unsigned int *pcs, unsigned long count);
+
+/**
+ * @brief Add a state of a DFA of a regex to the slots of the states.
+ * @param dfa the DFA.
+ * @param state the state.
+ */
+static void insertRegexDfaSlot(RegexDfa *dfa, unsigned long state);
+
+/**
+ * @brief Find the state of a DFA of a regex whose threads are the list of the regex, or
+ * add it.
+ * @param regex the regex.
+ * @param dfa the DFA.
+ * @param count the length of the list.
+ * @return the state, or REGEX_FAILED_STATE on failure.
+ */
+static int internRegexDfaState(MyStringRegex *regex, RegexDfa *dfa, unsigned int count);
+
+/**
+ * @brief Find the state a DFA of a regex starts at.
+ * @param regex the regex.
+ * @param dfa the DFA.
+ * @param atBegin whether it starts at the start of the text.
+ * @param atEnd whether it starts at the end of the text.
+ * @return the state, REGEX_DEAD_STATE if it has no threads, or REGEX_FAILED_STATE on
+ * failure.
+ */
+static int getRegexDfaStart(MyStringRegex *regex, RegexDfa *dfa, bool atBegin, bool atEnd);
+
+/**
+ * @brief Build the transition of a state of a DFA of a regex by a byte class, or by the
+ * end of the text.
+ * @param regex the regex.
+ * @param dfa the DFA.
+ * @param state the state.
+ * @param byteClass the byte class, or the number of byte classes for the end of the text.
+ * @return the next state, REGEX_DEAD_STATE if it has no threads, or REGEX_FAILED_STATE on
+ * failure.
+ */
+static int stepRegexDfa(MyStringRegex *regex, RegexDfa *dfa, int state, unsigned int byteClass);
+
+/**
+ * @brief Find the state a DFA of a regex is at after a byte class, building the
+ * transition if it isn't known yet.
+ * @param regex the regex.
+ * @param dfa the DFA.
+ * @param state the state.
+ * @param byteClass the byte class, or the number of byte classes for the end of the text.
+ * @return the next state, REGEX_DEAD_STATE if it has no threads, or REGEX_FAILED_STATE on
+ * failure.
+ */
+static int nextRegexDfaState(MyStringRegex *regex, RegexDfa *dfa, int state,
+                             unsigned int byteClass);
+
+/**
+ * @brief Find where the leftmost first match of a regex in text ends, by the DFA of
+ * searches. Where no match is in progress, the search skips to the next literal prefix,
+ * or over the bytes which can't start a match.
+ * @param regex the regex.
+ * @param text the text.
+ * @param end pointer to set to the end of the match.
+ * @return TRUE if there is a match, FALSE otherwise, MYSTR_ERROR_CODE on failure.
+ */
+static int findRegexMatchEnd(MyStringRegex *regex, MyStringView text, unsigned long *end);
+
+/**
+ * @brief Find the leftmost first match of a regex in text. The DFA of searches finds
+ * where it ends, and the reverse DFA, run back from there for the longest match, where
+ * it starts: no match starts before the leftmost one.
+ * @param regex the regex.
+ * @param text the text.
+ * @param start pointer to set to the start of the match.
+ * @param end pointer to set to the end of the match.
+ * @return TRUE if there is a match, FALSE otherwise, MYSTR_ERROR_CODE on failure.
+ */
+static int findRegexMatch(MyStringRegex *regex, MyStringView text, unsigned long *start,
+                          unsigned long *end);
+
+/**
+ * @brief Add the threads which an instruction leads to without a char, in the order of
+ * their priority, to a list of threads of the NFA of a regex with the positions of their
+ * slots. The positions are saved in the slots of the regex, and put back after the visit.
+ * @param regex the regex.
+ * @param list the list, 0 or 1.
+ * @param count pointer to the length of the list.
+ * @param pc the instruction.
+ * @param position the position in the text.
+ * @param length the length of the text.
+ */
+static void addRegexGroupThreads(MyStringRegex *regex, int list, unsigned int *count,
+                                 unsigned int pc, unsigned long position, unsigned long length);
+
+/**
+ * @brief Find the groups of a match of a regex, by running its NFA over the match with
+ * the positions of the slots of every thread, as a Pike VM does.
+ * @param regex the regex.
+ * @param text the text.
+ * @param start the start of the match.
+ * @param end the end of the match.
+ * @param groups the views to set to the groups, of which those which didn't match are
+ * set to NULL.
+ */
+static void findRegexGroups(MyStringRegex *regex, MyStringView text, unsigned long start,
+                            unsigned long end, MyStringView groups[]);
+
+// ------------------------------ implementation -----------------------------
+
+/**
+ * @brief Compiles a regex, to a Thompson NFA which is run by lazily built DFAs.
+ * @param pattern
+ * @param cacheBytes the bound of the memory of the DFAs, 0 for the default.
+ * RETURN VALUE:
+ *  @return the regex, or NULL on failure or if the pattern isn't valid.
+ *
+ *  Complexity: O(m) for a pattern of m chars, with its repetitions expanded.
+ */
+MyStringRegex * myStringRegexCompile(MyStringView pattern, unsigned long cacheBytes)
+{
+    if (pattern._chars == NULL && pattern._length != EMPTY_STRING_LENGTH)
+    {
+        return NULL;
+    }
+    MyStringRegex *regex = (MyStringRegex *) calloc(1, sizeof(MyStringRegex));
+    if (regex == NULL)
+    {
+        return NULL;
+    }
+    RegexParser parser = {pattern, 0, NULL, 0, 0, 0, regex};
+    unsigned int root = parseRegexAlternation(&parser);
+    // Only an unmatched ')' stops the parsing before the end.
+    if (root == REGEX_NO_NODE || parser._position < pattern._length ||
+        !compileRegexPrograms(regex, parser._nodes, root))
+    {
+        free(parser._nodes);
+        myStringRegexFree(regex);
+        return NULL;
+    }
+    regex -> _prefix = (char *) malloc(pattern._length + 1);
+    if (regex -> _prefix == NULL)
+    {
+        free(parser._nodes);
+        myStringRegexFree(regex);
+        return NULL;
+    }
+    addRegexLiteralPrefix(regex, parser._nodes, root);
+    free(parser._nodes);
+    setRegexByteClasses(regex);
+    if (cacheBytes == 0)
+    {
+        cacheBytes = REGEX_DEFAULT_CACHE_BYTES;
+    }
+    initRegexDfa(&regex -> _searchDfa, regex -> _program._insts, 0, true, cacheBytes / REGEX_DFAS);
+    initRegexDfa(&regex -> _matchDfa, regex -> _program._insts, regex -> _anchoredStart, false,
+                 cacheBytes / REGEX_DFAS);
+    initRegexDfa(&regex -> _reverseDfa, regex -> _reverseProgram._insts, regex -> _reverseStart,
+                 false, cacheBytes / REGEX_DFAS);
+    if (!allocRegexScratch(regex))
+    {
+        myStringRegexFree(regex);
+        return NULL;
+    }
+    return regex;
+}
+
+/**
+ * @brief Frees a regex.
+ * @param regex
+ */
+void myStringRegexFree(MyStringRegex *regex)
+{
+    if (regex == NULL)
+    {
+        return;
+    }
+    free(regex -> _program._insts);
+    free(regex -> _reverseProgram._insts);
+    free(regex -> _classes);
+    free(regex -> _prefix);
+    freeRegexDfa(&regex -> _searchDfa);
+    freeRegexDfa(&regex -> _matchDfa);
+    freeRegexDfa(&regex -> _reverseDfa);
+    free(regex -> _visitedDense);
+    free(regex -> _visitedSparse);
+    free(regex -> _stack);
+    free(regex -> _list);
+    for (int i = 0; i < 2; i++)
+    {
+        free(regex -> _threadDense[i]);
+        free(regex -> _threadSparse[i]);
+        free(regex -> _threadSlots[i]);
+    }
+    free(regex -> _slots);
+    free(regex -> _frames);
+    free(regex);
+}
+
+/**
+ * @brief Returns the number of the capturing groups of a regex.
+ * @param regex
+ * RETURN VALUE:
+ *  @return the number of groups, 0 if regex is NULL.
+ *
+ *  Complexity: O(1).
+ */
+unsigned long myStringRegexGroups(const MyStringRegex *regex)
+{
+    return regex == NULL ? 0 : regex -> _groups;
+}
+
+/**
+ * @brief Checks if the whole of text matches a regex.
+ * @param regex
+ * @param text
+ * RETURN VALUE:
+ *  @return TRUE if it does, FALSE otherwise, MYSTR_ERROR_CODE on failure.
+ *
+ *  Complexity: O(n) for n chars, with a lookup of a transition for every char once its
+ *  state is built, and O(m) for every state built for a regex of m instructions.
+ */
+int myStringRegexMatch(MyStringRegex *regex, MyStringView text)
+{
+    if (regex == NULL || (text._chars == NULL && text._length != EMPTY_STRING_LENGTH))
+    {
+        return MYSTR_ERROR_CODE;
+    }
+    RegexDfa *dfa = &regex -> _matchDfa;
+    const unsigned char *chars = (const unsigned char *) text._chars;
+    unsigned long stride = regex -> _byteClasses + 1;
+    int state = getRegexDfaStart(regex, dfa, true, text._length == 0);
+    for (unsigned long i = 0; i < text._length && state >= 0; i++)
+    {
+        unsigned int byteClass = regex -> _byteMap[chars[i]];
+        int next = dfa -> _next[state * stride + byteClass];
+        state = next != REGEX_UNKNOWN_STATE ? next : stepRegexDfa(regex, dfa, state, byteClass);
+    }
+    if (state == REGEX_FAILED_STATE)
+    {
+        return MYSTR_ERROR_CODE;
+    }
+    if (state == REGEX_DEAD_STATE)
+    {
+        return FALSE;
+    }
+    if (dfa -> _states[state]._isMatch)
+    {
+        return TRUE;
+    }
+    state = stepRegexDfa(regex, dfa, state, regex -> _byteClasses);
+    if (state == REGEX_FAILED_STATE)
+    {
+        return MYSTR_ERROR_CODE;
+    }
+    return state >= 0 && dfa -> _states[state]._isMatch ? TRUE : FALSE;
+}
+
+/**
+ * @brief Finds the leftmost match of a regex in text, preferring the alternatives and
+ * 	repetitions of the regex as a backtracking engine would.
+ * @param regex
+ * @param text
+ * @param match pointer to set to the match, a view of text.
+ * RETURN VALUE:
+ *  @return TRUE if there is a match, FALSE otherwise, MYSTR_ERROR_CODE on failure.
+ *
+ *  Complexity: O(n) for n chars: a forward DFA finds where the match ends and a reverse
+ *  one, from there, where it starts.
+ */
+int myStringRegexSearch(MyStringRegex *regex, MyStringView text, MyStringView *match)
+{
+    if (regex == NULL || match == NULL ||
+        (text._chars == NULL && text._length != EMPTY_STRING_LENGTH))
+    {
+        return MYSTR_ERROR_CODE;
+    }
+    unsigned long start = 0;
+    unsigned long end = 0;
+    int retVal = findRegexMatch(regex, text, &start, &end);
+    if (retVal == TRUE)
+    {
+        match -> _chars = text._chars + start;
+        match -> _length = end - start;
+    }
+    return retVal;
+}
+
+/**
+ * @brief Finds the leftmost match of a regex in text, as myStringRegexSearch does, and
+ * 	the chars of its groups.
+ * @param regex
+ * @param text
+ * @param groups
+ * RETURN VALUE:
+ *  @return TRUE if there is a match, FALSE otherwise, MYSTR_ERROR_CODE on failure.
+ *
+ *  Complexity: O(n) for the search, and O(k * m) for a match of k chars, which an NFA
+ *  of m instructions is run over to find the groups.
+ */
+int myStringRegexCaptures(MyStringRegex *regex, MyStringView text, MyStringView groups[])
+{
+    if (regex == NULL || groups == NULL ||
+        (text._chars == NULL && text._length != EMPTY_STRING_LENGTH))
+    {
+        return MYSTR_ERROR_CODE;
+    }
+    unsigned long start = 0;
+    unsigned long end = 0;
+    int retVal = findRegexMatch(regex, text, &start, &end);
+    if (retVal != TRUE)
+    {
+        return retVal;
+    }
+    groups[0]._chars = text._chars + start;
+    groups[0]._length = end - start;
+    if (regex -> _groups > 0)
+    {
+        findRegexGroups(regex, text, start, end, groups + 1);
+    }
+    return TRUE;
+}
+
+/**
+ * @brief Add a node to those of a regex being parsed.
+ * @param parser the parser.
+ * @param type the type of the node.
+ * @return the node, or REGEX_NO_NODE on failure.
+ */
+static unsigned int addRegexNode(RegexParser *parser, unsigned int type)
+{
+    if (parser -> _count == parser -> _capacity)
+    {
+        unsigned int capacity = parser -> _capacity == 0 ? REGEX_MIN_STATES :
+                                parser -> _capacity * 2;
+        RegexNode *nodes = (RegexNode *) realloc(parser -> _nodes, capacity * sizeof(RegexNode));
+        if (nodes == NULL)
+        {
+            return REGEX_NO_NODE;
+        }
+        parser -> _nodes = nodes;
+        parser -> _capacity = capacity;
+    }
+    RegexNode *node = &parser -> _nodes[parser -> _count];
+    node -> _type = type;
+    node -> _first = REGEX_NO_NODE;
+    node -> _last = REGEX_NO_NODE;
+    node -> _nextSibling = REGEX_NO_NODE;
+    node -> _prevSibling = REGEX_NO_NODE;
+    node -> _min = 0;
+    node -> _max = 0;
+    node -> _isGreedy = true;
+    node -> _arg = 0;
+    return parser -> _count++;
+}
+
+/**
+ * @brief Add a child to the end of the children of a node.
+ * @param parser the parser.
+ * @param parent the node.
+ * @param child the child.
+ */
+static void appendRegexChild(RegexParser *parser, unsigned int parent, unsigned int child)
+{
+    RegexNode *nodes = parser -> _nodes;
+    nodes[child]._prevSibling = nodes[parent]._last;
+    if (nodes[parent]._last == REGEX_NO_NODE)
+    {
+        nodes[parent]._first = child;
+    }
+    else
+    {
+        nodes[nodes[parent]._last]._nextSibling = child;
+    }
+    nodes[parent]._last = child;
+}
+
+/**
+ * @brief Add a class of chars to a regex.
+ * @param regex the regex.
+ * @param members the bits of the chars of the class.
+ * @return the class, or REGEX_NO_NODE on failure.
+ */
+static unsigned int addRegexClass(MyStringRegex *regex, const unsigned long long *members)
+{
+    if (regex -> _classCount == regex -> _classCapacity)
+    {
+        unsigned int capacity = regex -> _classCapacity == 0 ? REGEX_MIN_STATES :
+                                regex -> _classCapacity * 2;
+        unsigned long long *classes = (unsigned long long *) realloc(
+            regex -> _classes, capacity * REGEX_CLASS_WORDS * sizeof(unsigned long long));
+        if (classes == NULL)
+        {
+            return REGEX_NO_NODE;
+        }
+        regex -> _classes = classes;
+        regex -> _classCapacity = capacity;
+    }
+    memcpy(regex -> _classes + regex -> _classCount * REGEX_CLASS_WORDS, members,
+           REGEX_CLASS_WORDS * sizeof(unsigned long long));
+    return regex -> _classCount++;
+}
+
+/**
+ * @brief Add a class node of the given chars.
+ * @param parser the parser.
+ * @param members the bits of the chars.
+ * @return the node, or REGEX_NO_NODE on failure.
+ */
+static unsigned int addRegexClassNode(RegexParser *parser, const unsigned long long *members)
+{
+    unsigned int classIndex = addRegexClass(parser -> _regex, members);
+    unsigned int node = classIndex == REGEX_NO_NODE ? REGEX_NO_NODE :
+                        addRegexNode(parser, REGEX_NODE_CLASS);
+    if (node != REGEX_NO_NODE)
+    {
+        parser -> _nodes[node]._arg = classIndex;
+    }
+    return node;
+}
+
+/**
+ * @brief Set the bit of a char in the bits of a class.
+ * @param members the bits.
+ * @param c the char.
+ */
+static void setRegexBit(unsigned long long *members, unsigned char c)
+{
+    members[c / REGEX_WORD_BITS] |= 1ULL << (c % REGEX_WORD_BITS);
+}
+
+/**
+ * @brief Check if a char is a member of a class of a regex.
+ * @param regex the regex.
+ * @param classIndex the class.
+ * @param c the char.
+ * @return true if it is, false otherwise.
+ */
+static bool isRegexClassMember(const MyStringRegex *regex, unsigned int classIndex,
+                               unsigned char c)
+{
+    const unsigned long long *members = regex -> _classes + classIndex * REGEX_CLASS_WORDS;
+    return (members[c / REGEX_WORD_BITS] >> (c % REGEX_WORD_BITS)) & 1ULL;
+}
+
+/**
+ * @brief Set the bits of the chars of an escape: a class such as \d, a control char
+ * such as \n, or any other char but a letter or a digit, which is taken literally.
+ * @param c the char after the '\'.
+ * @param members the bits to set.
+ * @param single pointer to set to the char of an escape of a single char, or to -1.
+ * @return true if the escape is valid, false otherwise.
+ */
+static bool addRegexEscape(char c, unsigned long long *members, int *single)
+{
+    unsigned long long chars[REGEX_CLASS_WORDS] = {0};
+    bool isNegated = c == 'D' || c == 'W' || c == 'S';
+    char lower = isNegated ? (char) (c - 'A' + 'a') : c;
+    *single = -1;
+    for (unsigned int i = 0; i < REGEX_BYTES; i++)
+    {
+        bool isDigit = i >= '0' && i <= '9';
+        bool isWord = isDigit || (i >= 'a' && i <= 'z') || (i >= 'A' && i <= 'Z') || i == '_';
+        bool isSpace = i == ' ' || (i >= '\t' && i <= '\r');
+        if ((lower == 'd' && isDigit) || (lower == 'w' && isWord) || (lower == 's' && isSpace))
+        {
+            setRegexBit(chars, (unsigned char) i);
+        }
+    }
+    if (lower != 'd' && lower != 'w' && lower != 's')
+    {
+        const char *controls = "ntrfv";
+        const char *controlChars = "\n\t\r\f\v";
+        const char *control = strchr(controls, c);
+        if (control != NULL && c != END_OF_C_STRING)
+        {
+            *single = (unsigned char) controlChars[control - controls];
+        }
+        // Any other char but a letter or a digit, which may be an escape some day.
+        else if (c != END_OF_C_STRING && !(c >= '0' && c <= '9') &&
+                 !(c >= 'a' && c <= 'z') && !(c >= 'A' && c <= 'Z'))
+        {
+            *single = (unsigned char) c;
+        }
+        else
+        {
+            return false;
+        }
+        setRegexBit(chars, (unsigned char) *single);
+    }
+    for (unsigned int i = 0; i < REGEX_CLASS_WORDS; i++)
+    {
+        members[i] |= isNegated ? ~chars[i] : chars[i];
+    }
+    return true;
+}
+
+/**
+ * @brief Parse a class of a regex, from its '['.
+ * @param parser the parser.
+ * @return the node, or REGEX_NO_NODE on failure or if the class isn't valid.
+ */
+static unsigned int parseRegexClass(RegexParser *parser)
+{
+    const char *chars = parser -> _pattern._chars;
+    unsigned long length = parser -> _pattern._length;
+    unsigned long long members[REGEX_CLASS_WORDS] = {0};
+    unsigned long i = parser -> _position + 1;
+    bool isNegated = i < length && chars[i] == REGEX_CLASS_NOT;
+    if (isNegated)
+    {
+        i++;
+    }
+    // A ']' right after the '[' is a member.
+    bool isFirst = true;
+    while (i < length && (chars[i] != REGEX_CLASS_END || isFirst))
+    {
+        isFirst = false;
+        int low = (unsigned char) chars[i];
+        if (chars[i] == REGEX_ESCAPE)
+        {
+            if (i + 1 == length || !addRegexEscape(chars[i + 1], members, &low))
+            {
+                return REGEX_NO_NODE;
+            }
+            i++;
+        }
+        i++;
+        // A range, unless the '-' is the last member.
+        if (low >= 0 && i + 1 < length && chars[i] == REGEX_CLASS_RANGE &&
+            chars[i + 1] != REGEX_CLASS_END)
+        {
+            int high = (unsigned char) chars[i + 1];
+            i += 2;
+            if (high == REGEX_ESCAPE)
+            {
+                if (i == length || !addRegexEscape(chars[i], members, &high) || high < 0)
+                {
+                    return REGEX_NO_NODE;
+                }
+                i++;
+            }
+            if (high < low)
+            {
+                return REGEX_NO_NODE;
+            }
+            for (int c = low; c <= high; c++)
+            {
+                setRegexBit(members, (unsigned char) c);
+            }
+        }
+        else if (low >= 0)
+        {
+            setRegexBit(members, (unsigned char) low);
+        }
+    }
+    if (i == length)
+    {
+        return REGEX_NO_NODE;
+    }
+    parser -> _position = i + 1;
+    for (unsigned int j = 0; isNegated && j < REGEX_CLASS_WORDS; j++)
+    {
+        members[j] = ~members[j];
+    }
+    return addRegexClassNode(parser, members);
+}
+
+/**
+ * @brief Parse an atom of a regex: a char, a class, an anchor or a group.
+ * @param parser the parser.
+ * @return the node, or REGEX_NO_NODE on failure or if the atom isn't valid.
+ */
+static unsigned int parseRegexAtom(RegexParser *parser)
+{
+    const char *chars = parser -> _pattern._chars;
+    unsigned long length = parser -> _pattern._length;
+    char c = chars[parser -> _position];
+    unsigned long long members[REGEX_CLASS_WORDS] = {0};
+    if (c == REGEX_GROUP_START)
+    {
+        if (parser -> _depth == REGEX_MAX_DEPTH)
+        {
+            return REGEX_NO_NODE;
+        }
+        parser -> _position++;
+        bool isCapturing = true;
+        if (parser -> _position < length && chars[parser -> _position] == REGEX_GROUP_FLAG)
+        {
+            if (parser -> _position + 1 == length ||
+                chars[parser -> _position + 1] != REGEX_NON_CAPTURING)
+            {
+                return REGEX_NO_NODE;
+            }
+            isCapturing = false;
+            parser -> _position += 2;
+        }
+        unsigned int index = isCapturing ? ++parser -> _regex -> _groups : 0;
+        parser -> _depth++;
+        unsigned int inner = parseRegexAlternation(parser);
+        parser -> _depth--;
+        if (inner == REGEX_NO_NODE || parser -> _position == length ||
+            chars[parser -> _position] != REGEX_GROUP_END)
+        {
+            return REGEX_NO_NODE;
+        }
+        parser -> _position++;
+        if (!isCapturing)
+        {
+            return inner;
+        }
+        unsigned int group = addRegexNode(parser, REGEX_NODE_GROUP);
+        if (group != REGEX_NO_NODE)
+        {
+            parser -> _nodes[group]._arg = index;
+            appendRegexChild(parser, group, inner);
+        }
+        return group;
+    }
+    if (c == REGEX_STAR || c == REGEX_PLUS || c == REGEX_QUESTION)
+    {
+        return REGEX_NO_NODE;
+    }
+    if (c == REGEX_CLASS_START)
+    {
+        return parseRegexClass(parser);
+    }
+    parser -> _position++;
+    if (c == REGEX_BEGIN || c == REGEX_END)
+    {
+        return addRegexNode(parser, c == REGEX_BEGIN ? REGEX_NODE_BEGIN : REGEX_NODE_END);
+    }
+    if (c == REGEX_ANY)
+    {
+        memset(members, UCHAR_MAX, sizeof(members));
+        members['\n' / REGEX_WORD_BITS] &= ~(1ULL << ('\n' % REGEX_WORD_BITS));
+    }
+    else if (c == REGEX_ESCAPE)
+    {
+        int single = 0;
+        if (parser -> _position == length ||
+            !addRegexEscape(chars[parser -> _position], members, &single))
+        {
+            return REGEX_NO_NODE;
+        }
+        parser -> _position++;
+    }
+    else
+    {
+        setRegexBit(members, (unsigned char) c);
+    }
+    return addRegexClassNode(parser, members);
+}
+
+/**
+ * @brief Parse the bounds of a repetition from its '{', if they are valid.
+ * @param parser the parser, whose position is moved after the '}' if they are.
+ * @param min pointer to set to the min.
+ * @param max pointer to set to the max, REGEX_UNBOUNDED for none.
+ * @return true if they are valid, false if the '{' is a literal char.
+ */
+static bool parseRegexBounds(RegexParser *parser, unsigned int *min, unsigned int *max)
+{
+    const char *chars = parser -> _pattern._chars;
+    unsigned long length = parser -> _pattern._length;
+    unsigned long i = parser -> _position + 1;
+    unsigned long bounds[2] = {0, 0};
+    unsigned int digits[2] = {0, 0};
+    unsigned int bound = 0;
+    for (; i < length && chars[i] != REGEX_REPEAT_END; i++)
+    {
+        if (chars[i] == REGEX_REPEAT_SEPARATOR && bound == 0)
+        {
+            bound = 1;
+        }
+        else if (chars[i] >= '0' && chars[i] <= '9')
+        {
+            // Bounds over the max are kept just over it, for the repetition to fail.
+            bounds[bound] = bounds[bound] * DIGIT_DIVIDER + (chars[i] - '0');
+            if (bounds[bound] > REGEX_MAX_REPEAT)
+            {
+                bounds[bound] = REGEX_MAX_REPEAT + 1;
+            }
+            digits[bound]++;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    if (i == length || digits[0] == 0)
+    {
+        return false;
+    }
+    *min = (unsigned int) bounds[0];
+    *max = bound == 0 ? *min : (digits[1] == 0 ? REGEX_UNBOUNDED : (unsigned int) bounds[1]);
+    parser -> _position = i + 1;
+    return true;
+}
+
+/**
+ * @brief Parse a quantifier of a regex.
+ * @param parser the parser, moved after the quantifier if there is one.
+ * @param min pointer to set to the min.
+ * @param max pointer to set to the max.
+ * @return true if there is a quantifier, false otherwise.
+ */
+static bool parseRegexQuantifier(RegexParser *parser, unsigned int *min, unsigned int *max)
+{
+    if (parser -> _position == parser -> _pattern._length)
+    {
+        return false;
+    }
+    char c = parser -> _pattern._chars[parser -> _position];
+    *min = c == REGEX_PLUS ? 1 : 0;
+    *max = c == REGEX_QUESTION ? 1 : REGEX_UNBOUNDED;
+    if (c == REGEX_REPEAT_START)
+    {
+        return parseRegexBounds(parser, min, max);
+    }
+    if (c != REGEX_STAR && c != REGEX_PLUS && c != REGEX_QUESTION)
+    {
+        return false;
+    }
+    parser -> _position++;
+    return true;
+}
+
+/**
+ * @brief Parse an atom of a regex with the repetition after it, if there is one.
+ * @param parser the parser.
+ * @return the node, or REGEX_NO_NODE on failure or if it isn't valid.
+ */
+static unsigned int parseRegexRepetition(RegexParser *parser)
+{
+    const char *chars = parser -> _pattern._chars;
+    unsigned long length = parser -> _pattern._length;
+    unsigned int node = parseRegexAtom(parser);
+    unsigned int min = 0;
+    unsigned int max = REGEX_UNBOUNDED;
+    if (node == REGEX_NO_NODE || !parseRegexQuantifier(parser, &min, &max))
+    {
+        return node;
+    }
+    if (min > REGEX_MAX_REPEAT || (max != REGEX_UNBOUNDED && (max < min ||
+                                                              max > REGEX_MAX_REPEAT)))
+    {
+        return REGEX_NO_NODE;
+    }
+    bool isGreedy = parser -> _position == length || chars[parser -> _position] != REGEX_LAZY;
+    if (!isGreedy)
+    {
+        parser -> _position++;
+    }
+    // Perl reads a quantifier after another one, as in a++, as possessive, which can't be
+    // matched by an NFA, so it isn't valid rather than taken as a repetition of a
+    // repetition.
+    unsigned int ignoredMin = 0;
+    unsigned int ignoredMax = 0;
+    if (parseRegexQuantifier(parser, &ignoredMin, &ignoredMax))
+    {
+        return REGEX_NO_NODE;
+    }
+    unsigned int repetition = addRegexNode(parser, REGEX_NODE_REPETITION);
+    if (repetition != REGEX_NO_NODE)
+    {
+        parser -> _nodes[repetition]._min = min;
+        parser -> _nodes[repetition]._max = max;
+        parser -> _nodes[repetition]._isGreedy = isGreedy;
+        appendRegexChild(parser, repetition, node);
+    }
+    return repetition;
+}
+
+/**
+ * @brief Parse a concatenation of a regex, up to a '|', a ')' or the end.
+ * @param parser the parser.
+ * @return the node, or REGEX_NO_NODE on failure or if it isn't valid.
+ */
+static unsigned int parseRegexConcatenation(RegexParser *parser)
+{
+    const char *chars = parser -> _pattern._chars;
+    unsigned long length = parser -> _pattern._length;
+    unsigned int concatenation = addRegexNode(parser, REGEX_NODE_CONCATENATION);
+    while (concatenation != REGEX_NO_NODE && parser -> _position < length &&
+           chars[parser -> _position] != REGEX_ALTERNATION &&
+           chars[parser -> _position] != REGEX_GROUP_END)
+    {
+        unsigned int node = parseRegexRepetition(parser);
+        if (node == REGEX_NO_NODE)
+        {
+            return REGEX_NO_NODE;
+        }
+        appendRegexChild(parser, concatenation, node);
+    }
+    return concatenation;
+}
+
+/**
+ * @brief Parse an alternation of a regex, up to a ')' or the end.
+ * @param parser the parser.
+ * @return the node, or REGEX_NO_NODE on failure or if it isn't valid.
+ */
+static unsigned int parseRegexAlternation(RegexParser *parser)
+{
+    const char *chars = parser -> _pattern._chars;
+    unsigned long length = parser -> _pattern._length;
+    unsigned int first = parseRegexConcatenation(parser);
+    if (first == REGEX_NO_NODE || parser -> _position == length ||
+        chars[parser -> _position] != REGEX_ALTERNATION)
+    {
+        return first;
+    }
+    unsigned int alternation = addRegexNode(parser, REGEX_NODE_ALTERNATION);
+    if (alternation == REGEX_NO_NODE)
+    {
+        return REGEX_NO_NODE;
+    }
+    appendRegexChild(parser, alternation, first);
+    while (parser -> _position < length && chars[parser -> _position] == REGEX_ALTERNATION)
+    {
+        parser -> _position++;
+        unsigned int node = parseRegexConcatenation(parser);
+        if (node == REGEX_NO_NODE)
+        {
+            return REGEX_NO_NODE;
+        }
+        appendRegexChild(parser, alternation, node);
+    }
+    return alternation;
+}
+
+/**
+ * @brief Emit an instruction to a program of a regex.
+ * @param program the program.
+ * @param op the op of the instruction.
+ * @param next its next instruction.
+ * @param arg its arg.
+ * @return the instruction, or REGEX_NO_INST on failure or if there are too many.
+ */
+static unsigned int emitRegexInst(RegexProgram *program, unsigned int op, unsigned int next,
+                                  unsigned int arg)
+{
+    if (next == REGEX_NO_INST || program -> _count == REGEX_MAX_INSTS)
+    {
+        return REGEX_NO_INST;
+    }
+    if (program -> _count == program -> _capacity)
+    {
+        unsigned int capacity = program -> _capacity == 0 ? REGEX_MIN_STATES :
+                                program -> _capacity * 2;
+        RegexInst *insts = (RegexInst *) realloc(program -> _insts, capacity * sizeof(RegexInst));
+        if (insts == NULL)
+        {
+            return REGEX_NO_INST;
+        }
+        program -> _insts = insts;
+        program -> _capacity = capacity;
+    }
+    RegexInst *inst = &program -> _insts[program -> _count];
+    inst -> _op = op;
+    inst -> _next = next;
+    inst -> _arg = arg;
+    return program -> _count++;
+}
+
+/**
+ * @brief Compile a node of a regex to the instructions which match it and then go on to
+ * next. The instructions are emitted backwards, so next is always known.
+ * @param program the program.
+ * @param nodes the nodes.
+ * @param node the node.
+ * @param next the instruction after the node.
+ * @param isReverse whether the program matches the text backwards.
+ * @return the first instruction, or REGEX_NO_INST on failure.
+ */
+static unsigned int compileRegexNode(RegexProgram *program, const RegexNode *nodes,
+                                     unsigned int node, unsigned int next, bool isReverse)
+{
+    const RegexNode *current = &nodes[node];
+    unsigned int child = current -> _first;
+    switch (current -> _type)
+    {
+        case REGEX_NODE_CLASS:
+            return emitRegexInst(program, REGEX_OP_CLASS, next, current -> _arg);
+        case REGEX_NODE_BEGIN:
+        case REGEX_NODE_END:
+            // Backwards the start of the text is its end.
+            return emitRegexInst(program, (current -> _type == REGEX_NODE_BEGIN) != isReverse ?
+                                 REGEX_OP_BEGIN : REGEX_OP_END, next, 0);
+        case REGEX_NODE_GROUP:
+            if (isReverse)
+            {
+                return compileRegexNode(program, nodes, child, next, isReverse);
+            }
+            next = emitRegexInst(program, REGEX_OP_SAVE, next, 2 * (current -> _arg - 1) + 1);
+            next = compileRegexNode(program, nodes, child, next, isReverse);
+            return emitRegexInst(program, REGEX_OP_SAVE, next, 2 * (current -> _arg - 1));
+        case REGEX_NODE_CONCATENATION:
+            // The last child is emitted first, as it comes before next.
+            for (child = isReverse ? current -> _first : current -> _last; child != REGEX_NO_NODE;
+                 child = isReverse ? nodes[child]._nextSibling : nodes[child]._prevSibling)
+            {
+                next = compileRegexNode(program, nodes, child, next, isReverse);
+            }
+            return next;
+        case REGEX_NODE_ALTERNATION:
+        {
+            // The alternatives are tried in order, so the first is the first of the splits.
+            unsigned int split = compileRegexNode(program, nodes, current -> _last, next,
+                                                  isReverse);
+            for (child = nodes[current -> _last]._prevSibling; child != REGEX_NO_NODE;
+                 child = nodes[child]._prevSibling)
+            {
+                unsigned int alternative = compileRegexNode(program, nodes, child, next, isReverse);
+                split = alternative == REGEX_NO_INST || split == REGEX_NO_INST ? REGEX_NO_INST :
+                        emitRegexInst(program, REGEX_OP_SPLIT, alternative, split);
+            }
+            return split;
+        }
+        default:
+            return compileRegexRepetition(program, nodes, node, next, isReverse);
+    }
+}
+
+/**
+ * @brief Compile a repetition of a regex, as compileRegexNode does: its min copies, and
+ * then a loop if it's unbounded, or max - min nested optional copies otherwise.
+ * @param program the program.
+ * @param nodes the nodes.
+ * @param node the node of the repetition.
+ * @param next the instruction after the node.
+ * @param isReverse whether the program matches the text backwards.
+ * @return the first instruction, or REGEX_NO_INST on failure.
+ */
+static unsigned int compileRegexRepetition(RegexProgram *program, const RegexNode *nodes,
+                                           unsigned int node, unsigned int next, bool isReverse)
+{
+    const RegexNode *repetition = &nodes[node];
+    unsigned int child = repetition -> _first;
+    unsigned int rest = next;
+    if (repetition -> _max == REGEX_UNBOUNDED)
+    {
+        // The loop is split to the child, which goes back to the split, and to next.
+        unsigned int loop = emitRegexInst(program, REGEX_OP_SPLIT, next, next);
+        unsigned int body = compileRegexNode(program, nodes, child, loop, isReverse);
+        if (body == REGEX_NO_INST)
+        {
+            return REGEX_NO_INST;
+        }
+        program -> _insts[loop]._next = repetition -> _isGreedy ? body : next;
+        program -> _insts[loop]._arg = repetition -> _isGreedy ? next : body;
+        rest = loop;
+    }
+    else
+    {
+        for (unsigned int i = repetition -> _min; i < repetition -> _max && rest != REGEX_NO_INST;
+             i++)
+        {
+            unsigned int body = compileRegexNode(program, nodes, child, rest, isReverse);
+            rest = body == REGEX_NO_INST ? REGEX_NO_INST :
+                   emitRegexInst(program, REGEX_OP_SPLIT, repetition -> _isGreedy ? body : next,
+                                 repetition -> _isGreedy ? next : body);
+        }
+    }
+    for (unsigned int i = 0; i < repetition -> _min && rest != REGEX_NO_INST; i++)
+    {
+        rest = compileRegexNode(program, nodes, child, rest, isReverse);
+    }
+    return rest;
+}
+
+/**
+ * @brief Compile the program of a regex and its reverse program. The program of searches
+ * starts with a lazy loop over any byte, which starts a match at every position.
+ * @param regex the regex.
+ * @param nodes the nodes.
+ * @param root the node of the whole regex.
+ * @return true on success, false on failure.
+ */
+static bool compileRegexPrograms(MyStringRegex *regex, const RegexNode *nodes, unsigned int root)
+{
+    unsigned long long members[REGEX_CLASS_WORDS];
+    memset(members, UCHAR_MAX, sizeof(members));
+    unsigned int any = addRegexClass(regex, members);
+    RegexProgram *program = &regex -> _program;
+    if (any == REGEX_NO_NODE || emitRegexInst(program, REGEX_OP_SPLIT, 0, 1) == REGEX_NO_INST ||
+        emitRegexInst(program, REGEX_OP_CLASS, 0, any) == REGEX_NO_INST)
+    {
+        return false;
+    }
+    unsigned int match = emitRegexInst(program, REGEX_OP_MATCH, 0, 0);
+    regex -> _anchoredStart = compileRegexNode(program, nodes, root, match, false);
+    program -> _insts[0]._next = regex -> _anchoredStart;
+    match = emitRegexInst(&regex -> _reverseProgram, REGEX_OP_MATCH, 0, 0);
+    regex -> _reverseStart = compileRegexNode(&regex -> _reverseProgram, nodes, root, match, true);
+    return regex -> _anchoredStart != REGEX_NO_INST && regex -> _reverseStart != REGEX_NO_INST;
+}
+
+/**
+ * @brief Add the literal chars a node starts with to the prefix of a regex.
+ * @param regex the regex.
+ * @param nodes the nodes.
+ * @param node the node.
+ * @return true if the node is all literal chars, so the prefix may go on after it.
+ */
+static bool addRegexLiteralPrefix(MyStringRegex *regex, const RegexNode *nodes, unsigned int node)
+{
+    const RegexNode *current = &nodes[node];
+    if (current -> _type == REGEX_NODE_CLASS)
+    {
+        const unsigned long long *members = regex -> _classes + current -> _arg * REGEX_CLASS_WORDS;
+        int literal = -1;
+        for (unsigned int i = 0; i < REGEX_BYTES; i++)
+        {
+            if ((members[i / REGEX_WORD_BITS] >> (i % REGEX_WORD_BITS)) & 1ULL)
+            {
+                if (literal >= 0)
+                {
+                    return false;
+                }
+                literal = (int) i;
+            }
+        }
+        if (literal < 0)
+        {
+            return false;
+        }
+        regex -> _prefix[regex -> _prefixLength++] = (char) literal;
+        return true;
+    }
+    if (current -> _type == REGEX_NODE_GROUP)
+    {
+        return addRegexLiteralPrefix(regex, nodes, current -> _first);
+    }
+    if (current -> _type != REGEX_NODE_CONCATENATION)
+    {
+        return false;
+    }
+    for (unsigned int child = current -> _first; child != REGEX_NO_NODE;
+         child = nodes[child]._nextSibling)
+    {
+        if (!addRegexLiteralPrefix(regex, nodes, child))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Split the bytes to the byte classes of a regex: the bytes between two changes of
+ * the membership in any class are treated alike by all of them.
+ * @param regex the regex.
+ */
+static void setRegexByteClasses(MyStringRegex *regex)
+{
+    bool isChange[REGEX_BYTES] = {false};
+    for (unsigned int i = 0; i < regex -> _classCount; i++)
+    {
+        for (unsigned int c = 1; c < REGEX_BYTES; c++)
+        {
+            isChange[c] = isChange[c] || isRegexClassMember(regex, i, (unsigned char) c) !=
+                                         isRegexClassMember(regex, i, (unsigned char) (c - 1));
+        }
+    }
+    unsigned int byteClass = 0;
+    regex -> _representatives[0] = 0;
+    for (unsigned int c = 0; c < REGEX_BYTES; c++)
+    {
+        if (isChange[c])
+        {
+            byteClass++;
+            regex -> _representatives[byteClass] = (unsigned char) c;
+        }
+        regex -> _byteMap[c] = (unsigned char) byteClass;
+    }
+    regex -> _byteClasses = byteClass + 1;
+}
+
+/**
+ * @brief Allocate the scratch of a regex, for the larger of its programs.
+ * @param regex the regex.
+ * @return true on success, false on failure.
+ */
+static bool allocRegexScratch(MyStringRegex *regex)
+{
+    unsigned long insts = regex -> _program._count > regex -> _reverseProgram._count ?
+                          regex -> _program._count : regex -> _reverseProgram._count;
+    // Every instruction visited pushes at most 2 others, or an instruction and a slot.
+    unsigned long stackSize = 2 * insts + 1;
+    regex -> _visitedDense = (unsigned int *) calloc(insts, sizeof(unsigned int));
+    regex -> _visitedSparse = (unsigned int *) calloc(insts, sizeof(unsigned int));
+    regex -> _stack = (unsigned int *) malloc(stackSize * sizeof(unsigned int));
+    regex -> _list = (unsigned int *) malloc(insts * sizeof(unsigned int));
+    if (regex -> _visitedDense == NULL || regex -> _visitedSparse == NULL ||
+        regex -> _stack == NULL || regex -> _list == NULL)
+    {
+        return false;
+    }
+    if (regex -> _groups == 0)
+    {
+        return true;
+    }
+    unsigned long slots = 2 * (unsigned long) regex -> _groups;
+    for (int i = 0; i < 2; i++)
+    {
+        regex -> _threadDense[i] = (unsigned int *) calloc(insts, sizeof(unsigned int));
+        regex -> _threadSparse[i] = (unsigned int *) calloc(insts, sizeof(unsigned int));
+        regex -> _threadSlots[i] = (unsigned long *) malloc(insts * slots * sizeof(unsigned long));
+        if (regex -> _threadDense[i] == NULL || regex -> _threadSparse[i] == NULL ||
+            regex -> _threadSlots[i] == NULL)
+        {
+            return false;
+        }
+    }
+    regex -> _slots = (unsigned long *) malloc(slots * sizeof(unsigned long));
+    regex -> _frames = (RegexFrame *) malloc(stackSize * sizeof(RegexFrame));
+    return regex -> _slots != NULL && regex -> _frames != NULL;
+}
+
+/**
+ * @brief Set up a DFA of a regex, without states.
+ * @param dfa the DFA.
+ * @param insts the instructions it runs.
+ * @param start the instruction its threads start at.
+ * @param isFirst whether the threads after a match are dropped.
+ * @param maxBytes the bound of the memory of its states.
+ */
+static void initRegexDfa(RegexDfa *dfa, const RegexInst *insts, unsigned int start, bool isFirst,
+                         unsigned long maxBytes)
+{
+    memset(dfa, 0, sizeof(RegexDfa));
+    dfa -> _insts = insts;
+    dfa -> _start = start;
+    dfa -> _isFirst = isFirst;
+    dfa -> _maxBytes = maxBytes;
+    for (int i = 0; i < REGEX_START_KINDS; i++)
+    {
+        dfa -> _startStates[i] = REGEX_UNKNOWN_STATE;
+    }
+}
+
+/**
+ * @brief Free the states of a DFA of a regex.
+ * @param dfa the DFA.
+ */
+static void freeRegexDfa(RegexDfa *dfa)
+{
+    free(dfa -> _states);
+    free(dfa -> _next);
+    free(dfa -> _pcs);
+    free(dfa -> _slots);
+}
+
+/**
+ * @brief Add the threads which an instruction leads to without a char, in the order of
+ * their priority, to the list of a regex. An instruction already visited since the list
+ * was started was added by a thread of a higher priority.
+ * @param regex the regex.
+ * @param insts the instructions.
+ * @param pc the instruction.
+ * @param atBegin whether the position is the start of the text.
+ * @param atEnd whether the position is the end of the text. Otherwise the assertions of
+ * the end are added as threads, which the end of the text moves on.
+ * @param isFirst whether the threads after a match are dropped.
+ * @param count pointer to the length of the list.
+ * @return true if a match was added and the threads after it are dropped.
+ */
+static bool addRegexDfaThreads(MyStringRegex *regex, const RegexInst *insts, unsigned int pc,
+                               bool atBegin, bool atEnd, bool isFirst, unsigned int *count)
+{
+    unsigned int *stack = regex -> _stack;
+    unsigned long top = 0;
+    stack[top++] = pc;
+    while (top > 0)
+    {
+        pc = stack[--top];
+        unsigned int index = regex -> _visitedSparse[pc];
+        if (index < regex -> _visitedCount && regex -> _visitedDense[index] == pc)
+        {
+            continue;
+        }
+        regex -> _visitedSparse[pc] = regex -> _visitedCount;
+        regex -> _visitedDense[regex -> _visitedCount++] = pc;
+        const RegexInst *inst = &insts[pc];
+        switch (inst -> _op)
+        {
+            case REGEX_OP_SPLIT:
+                // The next instruction is visited first.
+                stack[top++] = inst -> _arg;
+                stack[top++] = inst -> _next;
+                break;
+            case REGEX_OP_SAVE:
+                stack[top++] = inst -> _next;
+                break;
+            case REGEX_OP_BEGIN:
+                if (atBegin)
+                {
+                    stack[top++] = inst -> _next;
+                }
+                break;
+            case REGEX_OP_END:
+                if (atEnd)
+                {
+                    stack[top++] = inst -> _next;
+                }
+                else
+                {
+                    regex -> _list[(*count)++] = pc;
+                }
+                break;
+            case REGEX_OP_MATCH:
+                regex -> _list[(*count)++] = pc;
+                if (isFirst)
+                {
+                    return true;
+                }
+                break;
+            default:
+                regex -> _list[(*count)++] = pc;
+                break;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Compute the size of the memory of the states of a DFA of a regex.
+ * @param regex the regex.
+ * @param states the number of states.
+ * @param pcs the number of instructions of all the states.
+ * @return the size in bytes.
+ */
+static unsigned long getRegexDfaBytes(const MyStringRegex *regex, unsigned long states,
+                                      unsigned long pcs)
+{
+    // There are two slots for every state.
+    return states * (sizeof(RegexDfaState) + (regex -> _byteClasses + 1) * sizeof(int) +
+                     2 * sizeof(unsigned int)) + pcs * sizeof(unsigned int);
+}
+
+/**
+ * @brief Make room for a state of count instructions in a DFA of a regex. When its
+ * memory would grow over its bound, and it has at least REGEX_MIN_STATES states, its
+ * states are forgotten instead.
+ * @param regex the regex.
+ * @param dfa the DFA.
+ * @param count the number of instructions of the state.
+ * @return true on success, false on failure.
+ */
+static bool reserveRegexDfaState(MyStringRegex *regex, RegexDfa *dfa, unsigned long count)
+{
+    bool hasState = dfa -> _count < dfa -> _capacity;
+    bool hasPcs = dfa -> _pcCount + count <= dfa -> _pcCapacity;
+    if (hasState && hasPcs)
+    {
+        return true;
+    }
+    unsigned long capacity = hasState ? dfa -> _capacity : dfa -> _capacity * 2;
+    unsigned long pcCapacity = hasPcs ? dfa -> _pcCapacity : dfa -> _pcCapacity * 2;
+    if (dfa -> _count >= REGEX_MIN_STATES &&
+        getRegexDfaBytes(regex, capacity, pcCapacity) > dfa -> _maxBytes)
+    {
+        dfa -> _count = 0;
+        dfa -> _pcCount = 0;
+        memset(dfa -> _slots, 0, dfa -> _slotCount * sizeof(unsigned int));
+        for (int i = 0; i < REGEX_START_KINDS; i++)
+        {
+            dfa -> _startStates[i] = REGEX_UNKNOWN_STATE;
+        }
+        dfa -> _flushes++;
+        if (count <= dfa -> _pcCapacity)
+        {
+            return true;
+        }
+        capacity = dfa -> _capacity;
+    }
+    if (capacity < REGEX_MIN_STATES)
+    {
+        capacity = REGEX_MIN_STATES;
+    }
+    while (pcCapacity < dfa -> _pcCount + count)
+    {
+        pcCapacity = pcCapacity < REGEX_MIN_STATES ? REGEX_MIN_STATES : pcCapacity * 2;
+    }
+    unsigned long stride = regex -> _byteClasses + 1;
+    RegexDfaState *states = (RegexDfaState *) realloc(dfa -> _states,
+                                                      capacity * sizeof(RegexDfaState));
+    if (states == NULL)
+    {
+        return false;
+    }
+    dfa -> _states = states;
+    int *next = (int *) realloc(dfa -> _next, capacity * stride * sizeof(int));
+    if (next == NULL)
+    {
+        return false;
+    }
+    dfa -> _next = next;
+    unsigned int *pcs = (unsigned int *) realloc(dfa -> _pcs, pcCapacity * sizeof(unsigned int));
+    if (pcs == NULL)
+    {
+        return false;
+    }
+    dfa -> _pcs = pcs;
+    dfa -> _pcCapacity = pcCapacity;
+    if (capacity == dfa -> _capacity)
+    {
+        return true;
+    }
+    unsigned int *slots = (unsigned int *) calloc(2 * capacity, sizeof(unsigned int));
+    if (slots == NULL)
+    {
+        return false;
+    }
+    free(dfa -> _slots);
+    dfa -> _slots = slots;
+    dfa -> _slotCount = 2 * capacity;
+    dfa -> _capacity = capacity;
+    for (unsigned long i = 0; i < dfa -> _count; i++)
+    {
+        insertRegexDfaSlot(dfa, i);
+    }
+    return true;
+}
+
+/**
+ * @brief Compute the hash of the instructions of a state of a DFA of a regex.
+ * @param pcs the instructions.
+ * @param count their number.
+ * @return the hash.
+ */
+static unsigned long long hashRegexDfaState(const unsigned int *pcs, unsigned long count)
+{
+    MyStringView view = {(const char *) pcs, count * sizeof(unsigned int)};
+    return myStringHashView(view);
+}
+
+/**
+ * @brief Add a state of a DFA of a regex to the slots of the states.
+ * @param dfa the DFA.
+ * @param state the state.
+ */
+static void insertRegexDfaSlot(RegexDfa *dfa, unsigned long state)
+{
+    const RegexDfaState *dfaState = &dfa -> _states[state];
+    unsigned long mask = dfa -> _slotCount - 1;
+    unsigned long i = hashRegexDfaState(dfa -> _pcs + dfaState -> _pcStart,
+                                        dfaState -> _pcCount) & mask;
+    while (dfa -> _slots[i] != 0)
+    {
+        i = (i + 1) & mask;
+    }
+    dfa -> _slots[i] = (unsigned int) state + 1;
+}
+
+/**
+ * @brief Find the state of a DFA of a regex whose threads are the list of the regex, or
+ * add it.
+ * @param regex the regex.
+ * @param dfa the DFA.
+ * @param count the length of the list.
+ * @return the state, or REGEX_FAILED_STATE on failure.
+ */
+static int internRegexDfaState(MyStringRegex *regex, RegexDfa *dfa, unsigned int count)
+{
+    const unsigned int *list = regex -> _list;
+    unsigned long mask = dfa -> _slotCount - 1;
+    unsigned long long hash = hashRegexDfaState(list, count);
+    for (unsigned long i = hash & mask; dfa -> _slotCount > 0 && dfa -> _slots[i] != 0;
+         i = (i + 1) & mask)
+    {
+        const RegexDfaState *dfaState = &dfa -> _states[dfa -> _slots[i] - 1];
+        if (dfaState -> _pcCount == count &&
+            memcmp(dfa -> _pcs + dfaState -> _pcStart, list, count * sizeof(unsigned int)) == 0)
+        {
+            return (int) dfa -> _slots[i] - 1;
+        }
+    }
+    if (!reserveRegexDfaState(regex, dfa, count))
+    {
+        return REGEX_FAILED_STATE;
+    }
+    unsigned long state = dfa -> _count++;
+    RegexDfaState *dfaState = &dfa -> _states[state];
+    dfaState -> _pcStart = dfa -> _pcCount;
+    dfaState -> _pcCount = count;
+    dfaState -> _isMatch = false;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        dfaState -> _isMatch = dfaState -> _isMatch || dfa -> _insts[list[i]]._op == REGEX_OP_MATCH;
+    }
+    memcpy(dfa -> _pcs + dfa -> _pcCount, list, count * sizeof(unsigned int));
+    dfa -> _pcCount += count;
+    unsigned long stride = regex -> _byteClasses + 1;
+    for (unsigned long i = 0; i < stride; i++)
+    {
+        dfa -> _next[state * stride + i] = REGEX_UNKNOWN_STATE;
+    }
+    insertRegexDfaSlot(dfa, state);
+    return (int) state;
+}
+
+/**
+ * @brief Find the state a DFA of a regex starts at.
+ * @param regex the regex.
+ * @param dfa the DFA.
+ * @param atBegin whether it starts at the start of the text.
+ * @param atEnd whether it starts at the end of the text.
+ * @return the state, REGEX_DEAD_STATE if it has no threads, or REGEX_FAILED_STATE on
+ * failure.
+ */
+static int getRegexDfaStart(MyStringRegex *regex, RegexDfa *dfa, bool atBegin, bool atEnd)
+{
+    unsigned int kind = (atBegin ? REGEX_START_AT_BEGIN : 0) | (atEnd ? REGEX_START_AT_END : 0);
+    if (dfa -> _startStates[kind] != REGEX_UNKNOWN_STATE)
+    {
+        return dfa -> _startStates[kind];
+    }
+    unsigned int count = 0;
+    regex -> _visitedCount = 0;
+    addRegexDfaThreads(regex, dfa -> _insts, dfa -> _start, atBegin, atEnd, dfa -> _isFirst,
+                       &count);
+    int state = count == 0 ? REGEX_DEAD_STATE : internRegexDfaState(regex, dfa, count);
+    if (state != REGEX_FAILED_STATE)
+    {
+        dfa -> _startStates[kind] = state;
+    }
+    return state;
+}
+
+/**
+ * @brief Build the transition of a state of a DFA of a regex by a byte class, or by the
+ * end of the text.
+ * @param regex the regex.
+ * @param dfa the DFA.
+ * @param state the state.
+ * @param byteClass the byte class, or the number of byte classes for the end of the text.
+ * @return the next state, REGEX_DEAD_STATE if it has no threads, or REGEX_FAILED_STATE on
+ * failure.
+ */
+static int stepRegexDfa(MyStringRegex *regex, RegexDfa *dfa, int state, unsigned int byteClass)
+{
+    const RegexDfaState *dfaState = &dfa -> _states[state];
+    const unsigned int *pcs = dfa -> _pcs + dfaState -> _pcStart;
+    bool isEnd = byteClass == regex -> _byteClasses;
+    unsigned char c = regex -> _representatives[isEnd ? 0 : byteClass];
+    unsigned int count = 0;
+    regex -> _visitedCount = 0;
+    for (unsigned int i = 0; i < dfaState -> _pcCount; i++)
+    {
+        const RegexInst *inst = &dfa -> _insts[pcs[i]];
+        bool isMoved = isEnd ? inst -> _op == REGEX_OP_END :
+                       inst -> _op == REGEX_OP_CLASS && isRegexClassMember(regex, inst -> _arg, c);
+        if (isMoved && addRegexDfaThreads(regex, dfa -> _insts, inst -> _next, false, isEnd,
+                                          dfa -> _isFirst, &count))
+        {
+            break;
+        }
+    }
+    unsigned long flushes = dfa -> _flushes;
+    int next = count == 0 ? REGEX_DEAD_STATE : internRegexDfaState(regex, dfa, count);
+    // After a flush the state is forgotten, and so is its transition.
+    if (next != REGEX_FAILED_STATE && dfa -> _flushes == flushes)
+    {
+        dfa -> _next[state * (regex -> _byteClasses + 1) + byteClass] = next;
+    }
+    return next;
+}
+
+/**
+ * @brief Find the state a DFA of a regex is at after a byte class, building the
+ * transition if it isn't known yet.
+ * @param regex the regex.
+ * @param dfa the DFA.
+ * @param state the state.
+ * @param byteClass the byte class, or the number of byte classes for the end of the text.
+ * @return the next state, REGEX_DEAD_STATE if it has no threads, or REGEX_FAILED_STATE on
+ * failure.
+ */
+static int nextRegexDfaState(MyStringRegex *regex, RegexDfa *dfa, int state,
+                             unsigned int byteClass)
+{
+    int next = dfa -> _next[state * (regex -> _byteClasses + 1) + byteClass];
+    return next != REGEX_UNKNOWN_STATE ? next : stepRegexDfa(regex, dfa, state, byteClass);
+}
+
+/**
+ * @brief Find where the leftmost first match of a regex in text ends, by the DFA of
+ * searches. Where no match is in progress, the search skips to the next literal prefix,
+ * or over the bytes which can't start a match.
+ * @param regex the regex.
+ * @param text the text.
+ * @param end pointer to set to the end of the match.
+ * @return TRUE if there is a match, FALSE otherwise, MYSTR_ERROR_CODE on failure.
+ */
+static int findRegexMatchEnd(MyStringRegex *regex, MyStringView text, unsigned long *end)
+{
+    RegexDfa *dfa = &regex -> _searchDfa;
+    const unsigned char *chars = (const unsigned char *) text._chars;
+    unsigned long length = text._length;
+    unsigned long flushes = dfa -> _flushes;
+    int state = getRegexDfaStart(regex, dfa, true, length == 0);
+    // The state between matches. A flush can't follow a flush before REGEX_MIN_STATES
+    // states are added, so after one, both states are built again and stay valid.
+    int middle = getRegexDfaStart(regex, dfa, false, false);
+    if (dfa -> _flushes != flushes)
+    {
+        flushes = dfa -> _flushes;
+        state = getRegexDfaStart(regex, dfa, true, length == 0);
+        middle = getRegexDfaStart(regex, dfa, false, false);
+    }
+    if (state == REGEX_FAILED_STATE || middle == REGEX_FAILED_STATE)
+    {
+        return MYSTR_ERROR_CODE;
+    }
+    unsigned long matchEnd = state >= 0 && dfa -> _states[state]._isMatch ? 0 : REGEX_NO_POSITION;
+    unsigned long i = 0;
+    while (i < length && state >= 0)
+    {
+        if (state == middle && regex -> _prefixLength > 0)
+        {
+            const char *found = myStringFindChars(text._chars + i, length - i, regex -> _prefix,
+                                                  regex -> _prefixLength);
+            if (found == NULL)
+            {
+                break;
+            }
+            i = (unsigned long) (found - text._chars);
+        }
+        // Without a prefix, the bytes which lead back to the state between matches are
+        // skipped by their known transitions, which don't depend on each other.
+        else if (state == middle && !dfa -> _states[middle]._isMatch)
+        {
+            const int *middleNext = dfa -> _next + middle * (regex -> _byteClasses + 1);
+            while (i < length && middleNext[regex -> _byteMap[chars[i]]] == middle)
+            {
+                i++;
+            }
+            if (i == length)
+            {
+                continue;
+            }
+        }
+        state = nextRegexDfaState(regex, dfa, state, regex -> _byteMap[chars[i++]]);
+        if (dfa -> _flushes != flushes)
+        {
+            flushes = dfa -> _flushes;
+            middle = getRegexDfaStart(regex, dfa, false, false);
+            if (middle == REGEX_FAILED_STATE)
+            {
+                return MYSTR_ERROR_CODE;
+            }
+        }
+        if (state >= 0 && dfa -> _states[state]._isMatch)
+        {
+            matchEnd = i;
+        }
+    }
+    if (state == REGEX_FAILED_STATE)
+    {
+        return MYSTR_ERROR_CODE;
+    }
+    if (i == length && state >= 0)
+    {
+        state = nextRegexDfaState(regex, dfa, state, regex -> _byteClasses);
+        if (state == REGEX_FAILED_STATE)
+        {
+            return MYSTR_ERROR_CODE;
+        }
+        if (state >= 0 && dfa -> _states[state]._isMatch)
+        {
+            matchEnd = length;
+        }
+    }
+    if (matchEnd == REGEX_NO_POSITION)
+    {
+        return FALSE;
+    }
+    *end = matchEnd;
+    return TRUE;
+}
+
+/**
+ * @brief Find the leftmost first match of a regex in text. The DFA of searches finds
+ * where it ends, and the reverse DFA, run back from there for the longest match, where
+ * it starts: no match starts before the leftmost one.
+ * @param regex the regex.
+ * @param text the text.
+ * @param start pointer to set to the start of the match.
+ * @param end pointer to set to the end of the match.
+ * @return TRUE if there is a match, FALSE otherwise, MYSTR_ERROR_CODE on failure.
+ */
+static int findRegexMatch(MyStringRegex *regex, MyStringView text, unsigned long *start,
+                          unsigned long *end)
+{
+    int retVal = findRegexMatchEnd(regex, text, end);
+    if (retVal != TRUE)
+    {
+        return retVal;
+    }
+    RegexDfa *dfa = &regex -> _reverseDfa;
+    const unsigned char *chars = (const unsigned char *) text._chars;
+    unsigned long i = *end;
+    int state = getRegexDfaStart(regex, dfa, i == text._length, i == 0);
+    *start = i;
+    while (i > 0 && state >= 0)
+    {
+        state = nextRegexDfaState(regex, dfa, state, regex -> _byteMap[chars[--i]]);
+        if (state >= 0 && dfa -> _states[state]._isMatch)
+        {
+            *start = i;
+        }
+    }
+    if (i == 0 && state >= 0)
+    {
+        state = nextRegexDfaState(regex, dfa, state, regex -> _byteClasses);
+        if (state >= 0 && dfa -> _states[state]._isMatch)
+        {
+            *start = 0;
+        }
+    }
+    return state == REGEX_FAILED_STATE ? MYSTR_ERROR_CODE : TRUE;
+}
+
+/**
+ * @brief Add the threads which an instruction leads to without a char, in the order of
+ * their priority, to a list of threads of the NFA of a regex with the positions of their
+ * slots. The positions are saved in the slots of the regex, and put back after the visit.
+ * @param regex the regex.
+ * @param list the list, 0 or 1.
+ * @param count pointer to the length of the list.
+ * @param pc the instruction.
+ * @param position the position in the text.
+ * @param length the length of the text.
+ */
+static void addRegexGroupThreads(MyStringRegex *regex, int list, unsigned int *count,
+                                 unsigned int pc, unsigned long position, unsigned long length)
+{
+    const RegexInst *insts = regex -> _program._insts;
+    unsigned int *dense = regex -> _threadDense[list];
+    unsigned int *sparse = regex -> _threadSparse[list];
+    unsigned long slotCount = 2 * (unsigned long) regex -> _groups;
+    RegexFrame *frames = regex -> _frames;
+    unsigned long top = 0;
+    frames[top++] = (RegexFrame) {pc, REGEX_NO_SLOT, 0};
+    while (top > 0)
+    {
+        RegexFrame frame = frames[--top];
+        if (frame._slot != REGEX_NO_SLOT)
+        {
+            regex -> _slots[frame._slot] = frame._position;
+            continue;
+        }
+        pc = frame._pc;
+        if (sparse[pc] < *count && dense[sparse[pc]] == pc)
+        {
+            continue;
+        }
+        sparse[pc] = *count;
+        dense[(*count)++] = pc;
+        const RegexInst *inst = &insts[pc];
+        switch (inst -> _op)
+        {
+            case REGEX_OP_SPLIT:
+                frames[top++] = (RegexFrame) {inst -> _arg, REGEX_NO_SLOT, 0};
+                frames[top++] = (RegexFrame) {inst -> _next, REGEX_NO_SLOT, 0};
+                break;
+            case REGEX_OP_SAVE:
+                frames[top++] = (RegexFrame) {0, inst -> _arg, regex -> _slots[inst -> _arg]};
+                regex -> _slots[inst -> _arg] = position;
+                frames[top++] = (RegexFrame) {inst -> _next, REGEX_NO_SLOT, 0};
+                break;
+            case REGEX_OP_BEGIN:
+                if (position == 0)
+                {
+                    frames[top++] = (RegexFrame) {inst -> _next, REGEX_NO_SLOT, 0};
+                }
+                break;
+            case REGEX_OP_END:
+                if (position == length)
+                {
+                    frames[top++] = (RegexFrame) {inst -> _next, REGEX_NO_SLOT, 0};
+                }
+                break;
+            default:
+                memcpy(regex -> _threadSlots[list] + sparse[pc] * slotCount, regex -> _slots,
+                       slotCount * sizeof(unsigned long));
+                break;
+        }
+    }
+}
+
+/**
+ * @brief Find the groups of a match of a regex, by running its NFA over the match with
+ * the positions of the slots of every thread, as a Pike VM does.
+ * @param regex the regex.
+ * @param text the text.
+ * @param start the start of the match.
+ * @param end the end of the match.
+ * @param groups the views to set to the groups, of which those which didn't match are
+ * set to NULL.
+ */
+static void findRegexGroups(MyStringRegex *regex, MyStringView text, unsigned long start,
+                            unsigned long end, MyStringView groups[])
+{
+    const RegexInst *insts = regex -> _program._insts;
+    const unsigned char *chars = (const unsigned char *) text._chars;
+    unsigned long slotCount = 2 * (unsigned long) regex -> _groups;
+    unsigned long *matchSlots = NULL;
+    unsigned int counts[2] = {0, 0};
+    int list = 0;
+    for (unsigned long i = 0; i < slotCount; i++)
+    {
+        regex -> _slots[i] = REGEX_NO_POSITION;
+    }
+    addRegexGroupThreads(regex, list, &counts[list], regex -> _anchoredStart, start,
+                         text._length);
+    for (unsigned long position = start; counts[list] > 0; position++)
+    {
+        int nextList = 1 - list;
+        counts[nextList] = 0;
+        for (unsigned int i = 0; i < counts[list]; i++)
+        {
+            const RegexInst *inst = &insts[regex -> _threadDense[list][i]];
+            unsigned long *threadSlots = regex -> _threadSlots[list] + i * slotCount;
+            if (inst -> _op == REGEX_OP_MATCH)
+            {
+                // The threads after a match have a lower priority.
+                if (position == end)
+                {
+                    matchSlots = threadSlots;
+                }
+                break;
+            }
+            if (inst -> _op == REGEX_OP_CLASS && position < end &&
+                isRegexClassMember(regex, inst -> _arg, chars[position]))
+            {
+                memcpy(regex -> _slots, threadSlots, slotCount * sizeof(unsigned long));
+                addRegexGroupThreads(regex, nextList, &counts[nextList], inst -> _next,
+                                     position + 1, text._length);
+            }
+        }
+        if (position == end)
+        {
+            break;
+        }
+        list = nextList;
+    }
+    for (unsigned long i = 0; i < regex -> _groups; i++)
+    {
+        bool isSet = matchSlots != NULL && matchSlots[2 * i] != REGEX_NO_POSITION &&
+                     matchSlots[2 * i + 1] != REGEX_NO_POSITION;
+        groups[i]._chars = isSet ? text._chars + matchSlots[2 * i] : NULL;
+        groups[i]._length = isSet ? matchSlots[2 * i + 1] - matchSlots[2 * i] : 0;
+    }
+}
@@ -0,0 +1,122 @@
+/**
+ * @file MyStringSort.c
+ * @author  orib
+ *
+ * @brief Sorts the strings of a file which may be bigger than the memory, by
+ * myStringExternalSort.
+ * 	Usage: MyStringSort [-u | -c] [-l] [-m megabytes] [-T directory] [input [output]]
+ * 	-u writes every distinct string once, and -c also writes how many times it was
+ * 	read before it. -l reads and writes length-prefixed strings rather than lines.
+ * 	-m sets the memory budget and -T the directory of the temporary files. The input
+ * 	and the output are stdin and stdout unless they are given.
+ */
+
+#include "MyString.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define USAGE "Usage: MyStringSort [-u | -c] [-l] [-m megabytes] [-T directory] " \
+			  "[input [output]]\n"
+#define ERROR_OPENING_FILE "Couldn't open file %s!\n"
+#define ERROR_SORTING "Error in sorting!\n"
+#define MEGABYTE_SHIFT 20
+#define DECIMAL_BASE 10
+
+/**
+ * @brief Parses the options of the command line.
+ * @param argc
+ * @param argv
+ * @param options the options to set.
+ * @param paths set to the input and output paths, NULL for the standard ones.
+ * @return true if the command line is valid, false otherwise.
+ */
+static bool parseArguments(int argc, char *argv[], MyStringExternalSortOptions *options,
+						   char *paths[2])
+{
+	int pathCount = 0;
+	for (int i = 1; i < argc; i++)
+	{
+		char *argument = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (strcmp(argument, "-u") == 0)
+		{
+			options -> _mode = MYSTRING_MERGE_UNIQUE;
+		}
+		else if (strcmp(argument, "-c") == 0)
+		{
+			options -> _mode = MYSTRING_MERGE_COUNT;
+		}
+		else if (strcmp(argument, "-l") == 0)
+		{
+			options -> _format = MYSTRING_RECORDS_LENGTH_PREFIXED;
+		}
+		else if (strcmp(argument, "-m") == 0 && hasValue)
+		{
+			char *end = NULL;
+			unsigned long megabytes = strtoul(argv[++i], &end, DECIMAL_BASE);
+			if (*end != '\0' || megabytes == 0)
+			{
+				return false;
+			}
+			options -> _memoryBudget = megabytes << MEGABYTE_SHIFT;
+		}
+		else if (strcmp(argument, "-T") == 0 && hasValue)
+		{
+			options -> _tempDir = argv[++i];
+		}
+		else if (argument[0] != '-' && pathCount < 2)
+		{
+			paths[pathCount++] = argument;
+		}
+		else
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief the main function.
+ */
+int main(int argc, char *argv[])
+{
+	MyStringExternalSortOptions options;
+	myStringExternalSortDefaults(&options);
+	char *paths[2] = {NULL, NULL};
+	if (!parseArguments(argc, argv, &options, paths))
+	{
+		fprintf(stderr, USAGE);
+		return EXIT_FAILURE;
+	}
+	FILE *in = paths[0] == NULL ? stdin : fopen(paths[0], "rb");
+	if (in == NULL)
+	{
+		fprintf(stderr, ERROR_OPENING_FILE, paths[0]);
+		return EXIT_FAILURE;
+	}
+	FILE *out = paths[1] == NULL ? stdout : fopen(paths[1], "wb");
+	if (out == NULL)
+	{
+		fprintf(stderr, ERROR_OPENING_FILE, paths[1]);
+		fclose(in);
+		return EXIT_FAILURE;
+	}
+	MyStringRetVal result = myStringExternalSort(in, out, &options);
+	myStringReleaseThreadCache();
+	if (in != stdin)
+	{
+		fclose(in);
+	}
+	if (out != stdout && fclose(out) != 0)
+	{
+		result = MYSTRING_ERROR;
+	}
+	if (result == MYSTRING_ERROR)
+	{
+		fprintf(stderr, ERROR_SORTING);
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
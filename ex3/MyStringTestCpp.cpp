@@ -0,0 +1,161 @@
+/**
+ * @file MyStringTestCpp.cpp
+ * @author  orib
+ *
+ * @brief The tests of MyString.hpp, built both as C++17 and as C++20 so both the
+ * operator<=> and the comparison operators it falls back to are compiled and run.
+ */
+
+#include "MyString.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+#include <utility>
+
+#define MAPPED_FILE "myStringTestCppFile.txt"
+#define MAPPED_TEXT "mapped text"
+
+/**
+ * @brief Print the failed test and exit.
+ * @param testName the name of the test.
+ */
+static void exitBad(const char *testName)
+{
+	std::printf("Error in test %s\n", testName);
+	std::exit(EXIT_FAILURE);
+}
+
+static void uniqueMyStringMove()
+{
+	const char *testName = "uniqueMyStringMove";
+	std::printf("Running %s\n", testName);
+	UniqueMyString empty;
+	UniqueMyString str("abc");
+	const MyString *owned = str.get();
+	UniqueMyString moved(std::move(str));
+	bool isMoved = empty.get() == nullptr && empty.empty() && str.get() == nullptr &&
+				   moved.get() == owned && moved.view() == "abc";
+	empty = std::move(moved);
+	isMoved = isMoved && moved.get() == nullptr && empty.get() == owned;
+	MyString *released = empty.release();
+	isMoved = isMoved && empty.get() == nullptr && std::strcmp(empty.c_str(), "") == 0;
+	empty.reset(released);
+	isMoved = isMoved && empty.view() == "abc";
+	if (!isMoved)
+	{
+		std::printf("Expected result : abc\n");
+		std::printf("Actual result : %s\n", empty.c_str());
+		exitBad(testName);
+	}
+	std::printf("PASS\n");
+}
+
+static void uniqueMyStringClone()
+{
+	const char *testName = "uniqueMyStringClone";
+	std::printf("Running %s\n", testName);
+	UniqueMyString str("abc");
+	UniqueMyString cloned = str.clone();
+	cloned += "def";
+	bool isCloned = cloned.get() != str.get() && str.view() == "abc" &&
+					cloned.view() == "abcdef" && cloned.size() == 6;
+	// An empty string clones to an empty string without allocating.
+	isCloned = isCloned && UniqueMyString().clone().get() == nullptr;
+	if (!isCloned)
+	{
+		std::printf("Expected result : abc, abcdef\n");
+		std::printf("Actual result : %s, %s\n", str.c_str(), cloned.c_str());
+		exitBad(testName);
+	}
+	std::printf("PASS\n");
+}
+
+static void uniqueMyStringCompare()
+{
+	const char *testName = "uniqueMyStringCompare";
+	std::printf("Running %s\n", testName);
+	UniqueMyString empty;
+	UniqueMyString allocatedEmpty("");
+	UniqueMyString abc("abc");
+	UniqueMyString abd("abd");
+	bool isOrdered = empty == allocatedEmpty && !(empty != allocatedEmpty) && abc < abd &&
+					 abd > abc && abc <= abc && abc >= abc && abc != abd && empty < abc &&
+					 !(abc < empty) && abc == abc.clone();
+#if __cplusplus >= 202002L
+	isOrdered = isOrdered && (abc <=> abd) == std::strong_ordering::less &&
+				(abd <=> abc) == std::strong_ordering::greater &&
+				(empty <=> allocatedEmpty) == std::strong_ordering::equal;
+#endif
+	if (!isOrdered)
+	{
+		std::printf("Expected result : \"\" == \"\" < abc < abd\n");
+		std::printf("Actual result : other\n");
+		exitBad(testName);
+	}
+	std::printf("PASS\n");
+}
+
+static void uniqueMyStringView()
+{
+	const char *testName = "uniqueMyStringView";
+	std::printf("Running %s\n", testName);
+	// The chars may hold '\0', and the view keeps them.
+	std::string_view chars("a\0b", 3);
+	UniqueMyString str(chars);
+	std::string_view view = str;
+	bool isViewed = view == chars && view.data() == str.c_str() && str.c_str()[3] == '\0' &&
+					UniqueMyString().view().empty();
+	if (!isViewed)
+	{
+		std::printf("Expected result : a\\0b\n");
+		std::printf("Actual result : %s\n", str.c_str());
+		exitBad(testName);
+	}
+	std::printf("PASS\n");
+}
+
+static void uniqueMyStringAssignInner()
+{
+	const char *testName = "uniqueMyStringAssignInner";
+	std::printf("Running %s\n", testName);
+	// A view into the string itself overlaps the chars it's assigned to.
+	UniqueMyString str("hello world");
+	str.assign(std::string_view(str).substr(6));
+	bool isAssigned = str.view() == "world";
+	str.assign(str);
+	isAssigned = isAssigned && str.view() == "world";
+	// A view into mapped chars outlives the mapping it points into.
+	std::FILE *file = std::fopen(MAPPED_FILE, "w");
+	isAssigned = isAssigned && file != nullptr && std::fputs(MAPPED_TEXT, file) >= 0;
+	if (file != nullptr)
+	{
+		std::fclose(file);
+	}
+	UniqueMyString mapped(myStringMapFile(MAPPED_FILE));
+	isAssigned = isAssigned && mapped.get() != nullptr;
+	if (isAssigned)
+	{
+		mapped.assign(std::string_view(mapped).substr(7));
+		isAssigned = mapped.view() == "text";
+	}
+	std::remove(MAPPED_FILE);
+	if (!isAssigned)
+	{
+		std::printf("Expected result : world, text\n");
+		std::printf("Actual result : %s, %s\n", str.c_str(), mapped.c_str());
+		exitBad(testName);
+	}
+	std::printf("PASS\n");
+}
+
+int main()
+{
+	std::printf("Testing UniqueMyString (C++%ld):\n", __cplusplus / 100 % 100);
+	uniqueMyStringMove();
+	uniqueMyStringClone();
+	uniqueMyStringCompare();
+	uniqueMyStringView();
+	uniqueMyStringAssignInner();
+	return EXIT_SUCCESS;
+}